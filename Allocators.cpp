@@ -0,0 +1,248 @@
+#include "Allocators.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// constant initialized, operator new can run before any dynamic
+// initialization
+static std::atomic<uint64_t> s_Allocations = 0;
+static std::atomic<uint64_t> s_AllocatedBytes = 0;
+
+AllocationCounters GetAllocationCounters()
+{
+    return {
+        s_Allocations.load(std::memory_order_relaxed),
+        s_AllocatedBytes.load(std::memory_order_relaxed)};
+}
+
+uint64_t GetResidentBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.WorkingSetSize;
+    }
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(
+            mach_task_self(), MACH_TASK_BASIC_INFO,
+            reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+    {
+        return info.resident_size;
+    }
+    return 0;
+#elif defined(__linux__)
+    // "size resident shared ..." in pages, read with plain syscalls since
+    // a stream would allocate its buffer
+    int file = open("/proc/self/statm", O_RDONLY);
+    if (file < 0)
+    {
+        return 0;
+    }
+    char text[128];
+    ssize_t length = read(file, text, sizeof(text) - 1);
+    close(file);
+    if (length <= 0)
+    {
+        return 0;
+    }
+    text[length] = '\0';
+    unsigned long long size = 0;
+    unsigned long long resident = 0;
+    if (std::sscanf(text, "%llu %llu", &size, &resident) != 2)
+    {
+        return 0;
+    }
+    return resident * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+static void* CountedAllocate(size_t bytes, size_t alignment, bool nothrow)
+{
+    s_Allocations.fetch_add(1, std::memory_order_relaxed);
+    s_AllocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    bytes = std::max<size_t>(bytes, 1);
+
+    void* pointer;
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        pointer = std::malloc(bytes);
+    }
+    else
+    {
+#if defined(_WIN32)
+        pointer = _aligned_malloc(bytes, alignment);
+#else
+        // aligned_alloc wants the size to be a multiple of the alignment
+        pointer = std::aligned_alloc(
+            alignment, (bytes + alignment - 1) / alignment * alignment);
+#endif
+    }
+    if (!pointer && !nothrow)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+static void CountedFree(void* pointer, size_t alignment)
+{
+#if defined(_WIN32)
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+    {
+        _aligned_free(pointer);
+        return;
+    }
+#endif
+    (void)alignment;
+    std::free(pointer);
+}
+
+void* operator new(size_t bytes)
+{
+    return CountedAllocate(bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__, false);
+}
+
+void* operator new[](size_t bytes)
+{
+    return CountedAllocate(bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__, false);
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__, true);
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(bytes, __STDCPP_DEFAULT_NEW_ALIGNMENT__, true);
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment)
+{
+    return CountedAllocate(bytes, static_cast<size_t>(alignment), false);
+}
+
+void* operator new[](size_t bytes, std::align_val_t alignment)
+{
+    return CountedAllocate(bytes, static_cast<size_t>(alignment), false);
+}
+
+void* operator new(
+    size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(bytes, static_cast<size_t>(alignment), true);
+}
+
+void* operator new[](
+    size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(bytes, static_cast<size_t>(alignment), true);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    CountedFree(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    CountedFree(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    CountedFree(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+    CountedFree(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept
+{
+    CountedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept
+{
+    CountedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete(
+    void* pointer, size_t, std::align_val_t alignment) noexcept
+{
+    CountedFree(pointer, static_cast<size_t>(alignment));
+}
+
+void operator delete[](
+    void* pointer, size_t, std::align_val_t alignment) noexcept
+{
+    CountedFree(pointer, static_cast<size_t>(alignment));
+}
+
+LinearArena::LinearArena(size_t capacity, std::pmr::memory_resource* upstream)
+    : m_Upstream(upstream),
+      m_Block(static_cast<std::byte*>(
+          upstream->allocate(capacity, alignof(std::max_align_t)))),
+      m_Capacity(capacity)
+{
+}
+
+LinearArena::~LinearArena()
+{
+    Reset();
+    m_Upstream->deallocate(m_Block, m_Capacity, alignof(std::max_align_t));
+}
+
+void LinearArena::Reset()
+{
+    for (const Overflow& overflow : m_Overflows)
+    {
+        m_Upstream->deallocate(
+            overflow.pointer, overflow.bytes, overflow.alignment);
+    }
+    m_Overflows.clear();
+    m_OverflowBytes = 0;
+    m_Offset = 0;
+}
+
+void* LinearArena::do_allocate(size_t bytes, size_t alignment)
+{
+    // the block itself is only aligned for max_align_t, so it is the
+    // address that gets aligned rather than the offset
+    void* pointer = m_Block + m_Offset;
+    size_t space = m_Capacity - m_Offset;
+    if (std::align(alignment, bytes, pointer, space))
+    {
+        m_Offset = static_cast<size_t>(
+                       static_cast<std::byte*>(pointer) - m_Block) +
+                   bytes;
+        m_Peak = std::max(m_Peak, GetUsed());
+        return pointer;
+    }
+
+    pointer = m_Upstream->allocate(bytes, alignment);
+    m_Overflows.push_back({pointer, bytes, alignment});
+    m_OverflowBytes += bytes;
+    m_Peak = std::max(m_Peak, GetUsed());
+    return pointer;
+}
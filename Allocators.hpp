@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+#include <vector>
+
+// every global operator new in the process is counted, so a frame can be
+// checked for heap traffic by diffing two snapshots
+struct AllocationCounters
+{
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+AllocationCounters GetAllocationCounters();
+
+// physical memory the process holds right now, heap, stacks, mapped files
+// and driver allocations alike. 0 where the platform does not say. reads
+// it without allocating, so it is fine to call every frame
+uint64_t GetResidentBytes();
+
+// bump allocator over one block taken up front. deallocate does nothing,
+// Reset releases everything at once. a request that does not fit goes to
+// the upstream resource instead of failing, and shows up in GetOverflowBytes
+// so an arena that is too small gets noticed. not thread safe
+class LinearArena : public std::pmr::memory_resource
+{
+public:
+    LinearArena(
+        size_t capacity,
+        std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+    LinearArena(const LinearArena&) = delete;
+    ~LinearArena();
+
+    // everything allocated since the last reset is gone after this
+    void Reset();
+
+    size_t GetCapacity() const { return m_Capacity; }
+    // including overflow
+    size_t GetUsed() const { return m_Offset + m_OverflowBytes; }
+    size_t GetOverflowBytes() const { return m_OverflowBytes; }
+    // most ever used between two resets
+    size_t GetPeak() const { return m_Peak; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const
+        noexcept override
+    {
+        return this == &other;
+    }
+
+private:
+    struct Overflow
+    {
+        void* pointer;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    std::pmr::memory_resource* m_Upstream;
+    std::byte* m_Block;
+    size_t m_Capacity;
+    size_t m_Offset = 0;
+    size_t m_Peak = 0;
+    std::vector<Overflow> m_Overflows;
+    size_t m_OverflowBytes = 0;
+};
+
+// fixed size slots for one type, carved out of pages of SlotsPerPage at a
+// time. destroyed slots go on a free list and are handed out again before
+// a new page is allocated, pages are only returned when the pool goes.
+// addresses are stable. not thread safe
+template <typename T, size_t SlotsPerPage = 64> class ObjectPool
+{
+public:
+    ObjectPool() = default;
+    ObjectPool(const ObjectPool&) = delete;
+    // objects still alive are not destroyed, only their memory is freed
+    ~ObjectPool() = default;
+
+    template <typename... Args> T* Create(Args&&... args)
+    {
+        if (!m_Free)
+        {
+            AddPage();
+        }
+        Slot* slot = m_Free;
+        m_Free = slot->next;
+        T* object = new (slot->storage) T(std::forward<Args>(args)...);
+        m_Live++;
+        return object;
+    }
+
+    void Destroy(T* object)
+    {
+        object->~T();
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = m_Free;
+        m_Free = slot;
+        m_Live--;
+    }
+
+    size_t GetLiveCount() const { return m_Live; }
+    size_t GetCapacity() const { return m_Pages.size() * SlotsPerPage; }
+
+private:
+    union Slot
+    {
+        Slot* next;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    void AddPage()
+    {
+        Slot* page = m_Pages.emplace_back(new Slot[SlotsPerPage]).get();
+        for (size_t i = SlotsPerPage; i > 0; i--)
+        {
+            page[i - 1].next = m_Free;
+            m_Free = &page[i - 1];
+        }
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> m_Pages;
+    Slot* m_Free = nullptr;
+    size_t m_Live = 0;
+};
@@ -1,7 +1,211 @@
 #include "Application.hpp"
+#include "Components.hpp"
+#include <algorithm>
+#include <cmath>
 #include <SDL2/SDL.h>
+#include <array>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
 
-Application::Application() {}
+// rolling terrain from a few sine waves, the same on every run, until
+// levels come from the asset pack. runs on the job system
+static void GenerateChunk(glm::i32vec2 chunk, std::span<TileId> tiles)
+{
+    for (int32_t y = 0; y < CHUNK_TILES; y++)
+    {
+        for (int32_t x = 0; x < CHUNK_TILES; x++)
+        {
+            float worldX = static_cast<float>(chunk.x * CHUNK_TILES + x);
+            float worldY = static_cast<float>(chunk.y * CHUNK_TILES + y);
+            float height = std::sin(worldX * 0.11f) +
+                           std::cos(worldY * 0.077f) +
+                           0.5f * std::sin((worldX + worldY) * 0.037f);
+            // water, sand, grass and rock
+            TileId id = height < -0.6f  ? 1
+                        : height < -0.3f ? 2
+                        : height < 1.0f  ? 3
+                                         : 4;
+            tiles[y * CHUNK_TILES + x] = id;
+        }
+    }
+}
+
+Application::Application()
+    : m_Video(m_Jobs), m_Tilemap(m_Jobs, GenerateChunk),
+      m_LastUpdate(std::chrono::steady_clock::now())
+{
+    // same spin the old hard coded theta had, 0.1 degrees a frame at 60hz
+    m_Player = m_World.CreateEntity(
+        Position{{0.0f, 0.0f}}, Rotation{0.0f},
+        AngularVelocity{glm::radians(6.0f)}, Scale{{1.0f, 1.0f}});
+
+    // the triangle spins around the origin, so its box has to hold the
+    // furthest vertex at any angle
+    float radius = 0.0f;
+    for (const Vertex& vertex : vertices)
+    {
+        radius = std::max(radius, glm::length(vertex.pos.Unpack()));
+    }
+    m_World.Add(m_Player, Bounds{{radius, radius}});
+    m_World.Add(m_Player, MeshLodState{});
+    m_World.Add(
+        m_Player, SpatialHandle{m_SpatialGrid.Insert(
+                      {glm::vec2(-radius), glm::vec2(radius)},
+                      m_Player.index)});
+    CollisionShape shape{ShapeType::Circle, {radius, 0.0f}};
+    m_World.Add(
+        m_Player, Collider{shape, m_Broadphase.Insert(
+                                      GetShapeBounds(shape, {0.0f, 0.0f}),
+                                      m_Player.index)});
+
+    RegisterSystems();
+    m_Video.SetLateLatch([this]() { return LatchInput(); });
+}
+
+InputQueue::Clock::time_point Application::LatchInput()
+{
+    m_Input.Pump();
+    InputQueue::Clock::time_point oldest;
+    InputQueue::Event input;
+    while (m_Input.Pop(input))
+    {
+        if (input.event.type == SDL_MOUSEMOTION &&
+            (input.event.motion.state & SDL_BUTTON_LMASK))
+        {
+            m_CameraRotation +=
+                input.event.motion.xrel * CAMERA_DEGREES_PER_PIXEL;
+            if (oldest == InputQueue::Clock::time_point())
+            {
+                oldest = input.time;
+            }
+        }
+    }
+    m_Video.SetViewRotation(m_CameraRotation);
+    return oldest;
+}
+
+void Application::RegisterSystems()
+{
+    m_Systems.SetExecutor(
+        [this](std::span<std::function<void()>> tasks)
+        {
+            JobCounter counter;
+            for (std::function<void()>& task : tasks)
+            {
+                m_Jobs.Run(task, &counter);
+            }
+            m_Jobs.Wait(counter);
+        });
+
+    m_Systems.AddSystem<Position, const Velocity>(
+        "movement",
+        [this](World& world)
+        {
+            world.EachChunk<Position, const Velocity>(
+                [this](
+                    std::span<const Entity>, std::span<Position> positions,
+                    std::span<const Velocity> velocities)
+                {
+                    m_Jobs.ParallelFor(
+                        0, positions.size(), 16 * 1024,
+                        [&](size_t begin, size_t end)
+                        {
+                            for (size_t i = begin; i < end; i++)
+                            {
+                                positions[i].value +=
+                                    velocities[i].value * m_DeltaTime;
+                            }
+                        });
+                });
+        });
+
+    m_Systems.AddSystem<Rotation, const AngularVelocity>(
+        "spin",
+        [this](World& world)
+        {
+            world.EachChunk<Rotation, const AngularVelocity>(
+                [this](
+                    std::span<const Entity>, std::span<Rotation> rotations,
+                    std::span<const AngularVelocity> angularVelocities)
+                {
+                    m_Jobs.ParallelFor(
+                        0, rotations.size(), 16 * 1024,
+                        [&](size_t begin, size_t end)
+                        {
+                            for (size_t i = begin; i < end; i++)
+                            {
+                                rotations[i].radians +=
+                                    angularVelocities[i].radiansPerSecond *
+                                    m_DeltaTime;
+                            }
+                        });
+                });
+        });
+
+    // the only system touching the grid, so it needs no locking
+    m_Systems.AddSystem<const Position, const Bounds, const SpatialHandle>(
+        "spatial index",
+        [this](World& world)
+        {
+            world.EachChunk<const Position, const Bounds, const SpatialHandle>(
+                [this](
+                    std::span<const Entity>,
+                    std::span<const Position> positions,
+                    std::span<const Bounds> bounds,
+                    std::span<const SpatialHandle> handles)
+                {
+                    for (size_t i = 0; i < positions.size(); i++)
+                    {
+                        m_SpatialGrid.Update(
+                            handles[i].proxy,
+                            {positions[i].value - bounds[i].halfExtents,
+                             positions[i].value + bounds[i].halfExtents});
+                    }
+                });
+        });
+
+    // no velocities or masses yet, overlapping bodies are only pushed
+    // apart, half the depth each
+    m_Systems.AddSystem<Position, const Collider>(
+        "collision",
+        [this](World& world)
+        {
+            world.EachChunk<Position, const Collider>(
+                [this](
+                    std::span<const Entity>,
+                    std::span<Position> positions,
+                    std::span<const Collider> colliders)
+                {
+                    for (size_t i = 0; i < positions.size(); i++)
+                    {
+                        m_Broadphase.Update(
+                            colliders[i].proxy,
+                            GetShapeBounds(
+                                colliders[i].shape, positions[i].value));
+                    }
+                });
+
+            m_Broadphase.FindPairs(m_Jobs, m_CollisionPairs);
+            for (const CollisionPair& pair : m_CollisionPairs)
+            {
+                Entity a = world.GetEntity(pair.a);
+                Entity b = world.GetEntity(pair.b);
+                Position& positionA = world.Get<Position>(a);
+                Position& positionB = world.Get<Position>(b);
+                Contact contact;
+                if (Collide(
+                        world.Get<Collider>(a).shape, positionA.value,
+                        world.Get<Collider>(b).shape, positionB.value,
+                        contact))
+                {
+                    glm::vec2 push = contact.normal * (contact.depth * 0.5f);
+                    positionA.value -= push;
+                    positionB.value += push;
+                }
+            }
+        });
+}
 
 void Application::Run()
 {
@@ -25,9 +229,119 @@ void Application::Update()
             case SDL_WINDOWEVENT_CLOSE:
                 m_Running = false;
                 break;
+            case SDL_WINDOWEVENT_SIZE_CHANGED:
+                m_Video.OnResize();
+                break;
+            }
+            break;
+        case SDL_KEYDOWN:
+            if (event.key.keysym.sym == SDLK_F12 && !m_Video.IsCapturing())
+            {
+                m_Video.StartCapture(
+                    std::filesystem::path(WORKING_DIRECTORY)
+                        .append("build")
+                        .append("capture.ufcp"),
+                    CAPTURE_FRAMES);
             }
+            if (event.key.keysym.sym == SDLK_F2)
+            {
+                std::filesystem::path path =
+                    std::filesystem::path(WORKING_DIRECTORY)
+                        .append("build")
+                        .append(fmt::format(
+                            "screenshot_{}.png",
+                            m_Video.GetFrameStats().frame));
+                m_Video.RequestReadback([path](const ReadbackImage& image)
+                                        { SavePng(image, path); });
+            }
+            if (event.key.keysym.sym == SDLK_F3)
+            {
+                m_Video.SetHudVisible(!m_Video.IsHudVisible());
+            }
+            break;
+        }
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    m_DeltaTime = std::chrono::duration<float>(now - m_LastUpdate).count();
+    m_LastUpdate = now;
+
+    m_Systems.Run(m_World);
+    m_Tilemap.Update(m_Camera);
+    m_Video.DrawTilemap(m_Tilemap, m_Camera);
+    SubmitVisible();
+    m_Audio.Update();
+}
+
+void Application::SubmitVisible()
+{
+    m_Visible.clear();
+    m_SpatialGrid.Query(m_Camera, m_Visible);
+    if (m_Visible.empty())
+    {
+        return;
+    }
+
+    // the camera's height fills the window
+    std::span<const MeshLod> lods = m_Video.GetMeshLods();
+    float pixelsPerUnit = static_cast<float>(
+                              m_Video.GetOutputExtent().height) /
+                          (m_Camera.max.y - m_Camera.min.y);
+    std::array<uint32_t, MAX_MESH_LODS> lodCounts{};
+    m_VisibleLods.clear();
+    for (uint32_t index : m_Visible)
+    {
+        Entity entity = m_World.GetEntity(index);
+        glm::vec2 halfExtents = m_World.Get<Bounds>(entity).halfExtents;
+        glm::vec2 scale = glm::abs(m_World.Get<Scale>(entity).value);
+        float screenRadius = std::max(halfExtents.x, halfExtents.y) *
+                             std::max(scale.x, scale.y) * pixelsPerUnit;
+        MeshLodState& state = m_World.Get<MeshLodState>(entity);
+        state.level = SelectLod(lods, screenRadius, state.level);
+        m_VisibleLods.push_back(state.level);
+        lodCounts[state.level]++;
+    }
+
+    // counting sort by level, each level's instances end up contiguous so
+    // it is one instanced draw
+    std::array<uint32_t, MAX_MESH_LODS> lodOffsets{};
+    for (size_t level = 1; level < MAX_MESH_LODS; level++)
+    {
+        lodOffsets[level] = lodOffsets[level - 1] + lodCounts[level - 1];
+    }
+
+    // culled entities never reach the instance buffer or the render queue
+    m_InstancePositions.resize(m_Visible.size());
+    m_InstanceRotations.resize(m_Visible.size());
+    m_InstanceScales.resize(m_Visible.size());
+    std::array<uint32_t, MAX_MESH_LODS> cursors = lodOffsets;
+    for (size_t i = 0; i < m_Visible.size(); i++)
+    {
+        Entity entity = m_World.GetEntity(m_Visible[i]);
+        uint32_t slot = cursors[m_VisibleLods[i]]++;
+        m_InstancePositions[slot] = m_World.Get<Position>(entity).value;
+        m_InstanceRotations[slot] = m_World.Get<Rotation>(entity).radians;
+        m_InstanceScales[slot] = m_World.Get<Scale>(entity).value;
+    }
+
+    // every visible entity is the same mesh, so one instanced draw per level
+    uint32_t firstInstance = m_Video.WriteInstances(
+        {m_InstancePositions.data(), m_InstanceRotations.data(),
+         m_InstanceScales.data(), m_InstancePositions.size()});
+    // the depth in the key is a placeholder, so the front to back sort is a
+    // no-op here. everything is drawn flat at z = 0 and a level's
+    // instances share one draw, so no draw has a depth of its own to order
+    // by. until entities carry a depth that reaches the shader, the
+    // sequence alone orders the levels
+    for (uint32_t level = 0; level < lods.size(); level++)
+    {
+        if (lodCounts[level] == 0)
+        {
+            continue;
         }
+        m_Video.GetRenderQueue().Submit(
+            {SortKey::Make(RenderBucket::Opaque, 0, 0.5f, level),
+             lods[level].indexCount, lods[level].firstIndex, lodCounts[level],
+             firstInstance + lodOffsets[level]});
     }
-    m_Video.UpdateUnformBuffers(m_Theta);
-    m_Theta += 0.1f;
-}
\ No newline at end of file
+}
@@ -1,6 +1,19 @@
 #pragma once
 
+#include "Audio.hpp"
+#include "Collision.hpp"
+#include "ECS.hpp"
+#include "Input.hpp"
+#include "JobSystem.hpp"
+#include "SpatialGrid.hpp"
+#include "Tilemap.hpp"
 #include "Video.hpp"
+#include <chrono>
+
+// frames recorded by the capture hotkey, f12
+constexpr uint32_t CAPTURE_FRAMES = 300;
+// view rotation while dragging with the left mouse button
+constexpr float CAMERA_DEGREES_PER_PIXEL = 0.25f;
 
 class Application
 {
@@ -10,7 +23,38 @@ public:
     void Update();
 
 private:
+    void RegisterSystems();
+    void SubmitVisible();
+    InputQueue::Clock::time_point LatchInput();
+
+    // constructed first so the main thread is registered as worker 0
+    JobSystem m_Jobs;
+    InputQueue m_Input;
+    AudioEngine m_Audio;
     Video m_Video;
+    World m_World;
+    SystemScheduler m_Systems;
+    Entity m_Player;
+    SpatialGrid m_SpatialGrid;
+    Broadphase m_Broadphase;
+    // reused every Update
+    std::vector<CollisionPair> m_CollisionPairs;
+    // world space rect that is on screen, the triangle is still drawn
+    // straight in clip space so for now this is the clip space square
+    Aabb m_Camera{{-1.0f, -1.0f}, {1.0f, 1.0f}};
+    // streamed around the camera
+    Tilemap m_Tilemap;
+    // entity indices that passed culling this frame
+    std::vector<uint32_t> m_Visible;
+    // visible transforms gathered for Video::WriteInstances
+    std::vector<glm::vec2> m_InstancePositions;
+    std::vector<float> m_InstanceRotations;
+    std::vector<glm::vec2> m_InstanceScales;
+    // lod level of each visible entity, instances are grouped by it
+    std::vector<uint32_t> m_VisibleLods;
+    // rotates the whole view, in degrees, only touched by LatchInput
+    float m_CameraRotation = 0.0f;
     bool m_Running;
-    float m_Theta;
-};
\ No newline at end of file
+    float m_DeltaTime = 0.0f;
+    std::chrono::steady_clock::time_point m_LastUpdate;
+};
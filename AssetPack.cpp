@@ -0,0 +1,277 @@
+#include "AssetPack.hpp"
+#include "Log.hpp"
+#include <algorithm>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    m_File = CreateFileW(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_File == INVALID_HANDLE_VALUE)
+    {
+        m_File = nullptr;
+        LogError(fmt::format("Could not open {}", path.string()));
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_File, &size);
+    m_Size = static_cast<size_t>(size.QuadPart);
+    if (m_Size == 0)
+    {
+        return;
+    }
+
+    m_Mapping =
+        CreateFileMappingW(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping)
+    {
+        m_Data = static_cast<const std::byte*>(
+            MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+    if (!m_Data)
+    {
+        LogError(fmt::format("Could not map {}", path.string()));
+    }
+}
+
+void MappedFile::Prefetch() const
+{
+    if (!m_Data)
+    {
+        return;
+    }
+    WIN32_MEMORY_RANGE_ENTRY range{const_cast<std::byte*>(m_Data), m_Size};
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Data)
+    {
+        UnmapViewOfFile(m_Data);
+    }
+    if (m_Mapping)
+    {
+        CloseHandle(m_Mapping);
+    }
+    if (m_File)
+    {
+        CloseHandle(m_File);
+    }
+}
+#else
+MappedFile::MappedFile(const std::filesystem::path& path)
+{
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        LogError(fmt::format("Could not open {}", path.string()));
+    }
+    struct stat status;
+    fstat(file, &status);
+    m_Size = static_cast<size_t>(status.st_size);
+    if (m_Size == 0)
+    {
+        close(file);
+        return;
+    }
+
+    void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+    // the mapping keeps the file alive on its own
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        LogError(fmt::format("Could not map {}", path.string()));
+    }
+    // assets are mostly read front to back into staging buffers
+    madvise(data, m_Size, MADV_SEQUENTIAL);
+    m_Data = static_cast<const std::byte*>(data);
+}
+
+void MappedFile::Prefetch() const
+{
+    if (m_Data)
+    {
+        madvise(const_cast<std::byte*>(m_Data), m_Size, MADV_WILLNEED);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_Data)
+    {
+        munmap(const_cast<std::byte*>(m_Data), m_Size);
+    }
+}
+#endif
+
+uint32_t PackedImage::GetMipWidth(uint32_t level) const
+{
+    return std::max(width >> level, 1u);
+}
+
+uint32_t PackedImage::GetMipHeight(uint32_t level) const
+{
+    return std::max(height >> level, 1u);
+}
+
+uint64_t PackedImage::GetMipOffset(uint32_t level) const
+{
+    uint64_t offset = 0;
+    for (uint32_t i = 0; i < level; i++)
+    {
+        offset += uint64_t(GetMipWidth(i)) * GetMipHeight(i) * BYTES_PER_TEXEL;
+    }
+    return offset;
+}
+
+AssetPack::AssetPack(const std::filesystem::path& path) : m_File(path)
+{
+    std::span<const std::byte> file = m_File.GetData();
+    if (file.size() < sizeof(PackHeader))
+    {
+        LogError(fmt::format("{} is not an asset pack", path.string()));
+    }
+    const PackHeader& header =
+        *reinterpret_cast<const PackHeader*>(file.data());
+    if (header.magic != PACK_MAGIC)
+    {
+        LogError(fmt::format("{} is not an asset pack", path.string()));
+    }
+    if (header.version != PACK_VERSION)
+    {
+        LogError(fmt::format(
+            "{} has version {}, expected {}, recook the assets",
+            path.string(), header.version, PACK_VERSION));
+    }
+    uint64_t tocSize = uint64_t(header.entryCount) * sizeof(PackEntry);
+    if (header.fileSize != file.size() ||
+        header.tocOffset % alignof(PackEntry) != 0 ||
+        header.tocOffset + tocSize > file.size() ||
+        header.stringsOffset + header.stringsSize > file.size())
+    {
+        LogError(fmt::format("{} is truncated or corrupt", path.string()));
+    }
+
+    m_Entries = {
+        reinterpret_cast<const PackEntry*>(file.data() + header.tocOffset),
+        header.entryCount};
+    m_Strings = {
+        reinterpret_cast<const char*>(file.data() + header.stringsOffset),
+        header.stringsSize};
+
+    for (const PackEntry& entry : m_Entries)
+    {
+        if (entry.offset + entry.size > header.tocOffset ||
+            entry.offset % PACK_ALIGNMENT != 0 ||
+            uint64_t(entry.nameOffset) + entry.nameLength > m_Strings.size())
+        {
+            LogError(fmt::format("{} is truncated or corrupt", path.string()));
+        }
+    }
+}
+
+const PackEntry* AssetPack::Find(std::string_view name) const
+{
+    uint64_t hash = HashAssetName(name);
+    auto it = std::lower_bound(
+        m_Entries.begin(), m_Entries.end(), hash,
+        [](const PackEntry& entry, uint64_t value)
+        { return entry.nameHash < value; });
+    for (; it != m_Entries.end() && it->nameHash == hash; it++)
+    {
+        if (GetName(*it) == name)
+        {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+std::string_view AssetPack::GetName(const PackEntry& entry) const
+{
+    return m_Strings.substr(entry.nameOffset, entry.nameLength);
+}
+
+std::span<const std::byte> AssetPack::GetData(const PackEntry& entry) const
+{
+    return m_File.GetData().subspan(entry.offset, entry.size);
+}
+
+PackedMesh AssetPack::GetMesh(const PackEntry& entry) const
+{
+    if (entry.type != AssetType::Mesh)
+    {
+        LogError(fmt::format("{} is not a mesh", GetName(entry)));
+    }
+    std::span<const std::byte> data = GetData(entry);
+    PackedMesh mesh;
+    mesh.vertexCount = entry.parameters[0];
+    mesh.vertexStride = entry.parameters[1];
+    mesh.indexCount = entry.parameters[2];
+    uint64_t indexOffset = entry.parameters[3];
+    uint64_t vertexBytes = uint64_t(mesh.vertexCount) * mesh.vertexStride;
+    uint64_t indexBytes = uint64_t(mesh.indexCount) * sizeof(uint32_t);
+    uint32_t lodCount = entry.parameters[4];
+    uint64_t lodBytes = uint64_t(lodCount) * sizeof(MeshLod);
+    if (vertexBytes > indexOffset ||
+        indexOffset + indexBytes + lodBytes > data.size() || lodCount == 0 ||
+        lodCount > MAX_MESH_LODS)
+    {
+        LogError(fmt::format("Mesh {} is corrupt", GetName(entry)));
+    }
+    mesh.vertices = data.subspan(0, vertexBytes);
+    mesh.indices = data.subspan(indexOffset, indexBytes);
+    // indices are 4 byte aligned and so are the levels after them
+    mesh.lods = {
+        reinterpret_cast<const MeshLod*>(
+            data.data() + indexOffset + indexBytes),
+        lodCount};
+    for (const MeshLod& lod : mesh.lods)
+    {
+        if (uint64_t(lod.firstIndex) + lod.indexCount > mesh.indexCount ||
+            lod.indexCount % 3 != 0)
+        {
+            LogError(fmt::format(
+                "Mesh {} has a level outside its indices", GetName(entry)));
+        }
+    }
+    return mesh;
+}
+
+PackedImage AssetPack::GetImage(const PackEntry& entry) const
+{
+    if (entry.type != AssetType::Image)
+    {
+        LogError(fmt::format("{} is not an image", GetName(entry)));
+    }
+    PackedImage image;
+    image.width = entry.parameters[0];
+    image.height = entry.parameters[1];
+    image.mipLevels = entry.parameters[2];
+    image.format = entry.parameters[3];
+    image.data = GetData(entry);
+    if (image.GetMipOffset(image.mipLevels) > image.data.size())
+    {
+        LogError(fmt::format("Image {} is corrupt", GetName(entry)));
+    }
+    return image;
+}
+
+std::filesystem::path AssetPack::GetDefaultPath()
+{
+    return std::filesystem::path(WORKING_DIRECTORY)
+        .append("build")
+        .append("assets.pack");
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "MeshLod.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// cooked asset pack, written by the AssetCooker tool and memory mapped at
+// runtime. everything is stored in the layout the gpu wants, so loading an
+// asset is handing out a span into the mapping, there is no parsing step
+//
+//   header
+//   asset data, every blob aligned to PACK_ALIGNMENT
+//   table of contents, PackEntry[entryCount] sorted by name hash
+//   string table with the entry names
+//
+// all integers are little endian. the version is bumped on every layout
+// change, old packs are rejected rather than misread
+
+constexpr uint32_t PACK_MAGIC = 0x4b504155; // "UAPK"
+constexpr uint32_t PACK_VERSION = 3;
+// covers optimalBufferCopyOffsetAlignment and nonCoherentAtomSize on every
+// device we care about, and the 4 byte alignment spir-v needs
+constexpr uint64_t PACK_ALIGNMENT = 256;
+
+enum class AssetType : uint32_t
+{
+    Shader = 0,
+    Mesh = 1,
+    Image = 2
+};
+
+struct PackHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+    uint64_t tocOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t fileSize;
+};
+
+struct PackEntry
+{
+    uint64_t nameHash;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    AssetType type;
+    // type specific, see PackedMesh and PackedImage
+    uint32_t parameters[5];
+    uint64_t offset;
+    uint64_t size;
+};
+
+static_assert(sizeof(PackHeader) == 48);
+static_assert(sizeof(PackEntry) == 56);
+
+// fnv-1a, used for the table of contents lookup
+constexpr uint64_t HashAssetName(std::string_view name)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : name)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// vertices in the engine's Vertex layout followed by 32 bit indices at
+// indexOffset and the lod chain right after the indices, parameters are
+// {vertexCount, vertexStride, indexCount, indexOffset, lodCount}. indexCount
+// covers every level, the levels are ranges of the one index buffer
+struct PackedMesh
+{
+    uint32_t vertexCount;
+    uint32_t vertexStride;
+    uint32_t indexCount;
+    std::span<const std::byte> vertices;
+    std::span<const std::byte> indices;
+    // finest first, level 0 is the mesh as authored
+    std::span<const MeshLod> lods;
+};
+
+// full mip chain of R8G8B8A8 texels, largest level first with every level
+// tightly packed, parameters are {width, height, mipLevels, vkFormat}
+struct PackedImage
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipLevels;
+    // VkFormat value
+    uint32_t format;
+    std::span<const std::byte> data;
+
+    static constexpr uint32_t BYTES_PER_TEXEL = 4;
+    uint32_t GetMipWidth(uint32_t level) const;
+    uint32_t GetMipHeight(uint32_t level) const;
+    // byte offset of a level into data, for vk::BufferImageCopy
+    uint64_t GetMipOffset(uint32_t level) const;
+};
+
+// read only mapping of a whole file
+class MappedFile
+{
+public:
+    MappedFile(const std::filesystem::path& path);
+    MappedFile(const MappedFile&) = delete;
+    ~MappedFile();
+
+    std::span<const std::byte> GetData() const { return {m_Data, m_Size}; }
+    // asks the os to start reading the whole file in the background, so
+    // later page faults dont stall on the disk
+    void Prefetch() const;
+
+private:
+    const std::byte* m_Data = nullptr;
+    size_t m_Size = 0;
+#if defined(_WIN32)
+    void* m_File = nullptr;
+    void* m_Mapping = nullptr;
+#endif
+};
+
+class AssetPack
+{
+public:
+    AssetPack(const std::filesystem::path& path);
+
+    // nullptr when the pack has no asset with that name
+    const PackEntry* Find(std::string_view name) const;
+    std::span<const PackEntry> GetEntries() const { return m_Entries; }
+    std::string_view GetName(const PackEntry& entry) const;
+    // zero copy, valid as long as the pack is alive
+    std::span<const std::byte> GetData(const PackEntry& entry) const;
+
+    PackedMesh GetMesh(const PackEntry& entry) const;
+    PackedImage GetImage(const PackEntry& entry) const;
+    void Prefetch() const { m_File.Prefetch(); }
+
+    // default location the build cooks assets to
+    static std::filesystem::path GetDefaultPath();
+
+private:
+    MappedFile m_File;
+    std::span<const PackEntry> m_Entries;
+    std::string_view m_Strings;
+};
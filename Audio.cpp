@@ -0,0 +1,498 @@
+#include "Audio.hpp"
+#include "Log.hpp"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+// frames decoded per read on the stream thread
+constexpr size_t STREAM_CHUNK_FRAMES = 1024;
+// how often the stream thread tops up the rings when nothing wakes it, the
+// rings hold well over 100 ms at 48 khz stereo
+constexpr std::chrono::milliseconds STREAM_POLL_INTERVAL{10};
+
+// reads the samples of a riff wave file in chunks, 16 bit pcm or 32 bit
+// float, mono or stereo
+class WavDecoder
+{
+public:
+    // false, with a warning, when the file cant be streamed
+    bool Open(const std::filesystem::path& path);
+    // up to frames frames of interleaved float, 0 at the end of the data
+    size_t Read(float* output, size_t frames);
+    void Rewind();
+
+    uint32_t GetChannels() const { return m_Channels; }
+    uint32_t GetSampleRate() const { return m_SampleRate; }
+
+private:
+    std::ifstream m_File;
+    uint16_t m_Format = 0;
+    uint16_t m_BitsPerSample = 0;
+    uint32_t m_Channels = 0;
+    uint32_t m_SampleRate = 0;
+    std::streamoff m_DataStart = 0;
+    uint32_t m_DataSize = 0;
+    uint32_t m_DataRead = 0;
+    std::vector<char> m_Raw;
+};
+
+constexpr uint16_t WAVE_FORMAT_PCM = 1;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+
+bool WavDecoder::Open(const std::filesystem::path& path)
+{
+    m_File.open(path, std::ios::binary);
+    char riff[12];
+    if (!m_File.read(riff, sizeof(riff)) || std::memcmp(riff, "RIFF", 4) != 0 ||
+        std::memcmp(riff + 8, "WAVE", 4) != 0)
+    {
+        LogWarning(fmt::format("{} is not a wave file", path.string()));
+        return false;
+    }
+
+    // chunks in any order, fmt has to come before data
+    char header[8];
+    while (m_File.read(header, sizeof(header)))
+    {
+        uint32_t size;
+        std::memcpy(&size, header + 4, sizeof(size));
+        if (std::memcmp(header, "fmt ", 4) == 0 && size >= 16)
+        {
+            char format[16];
+            m_File.read(format, sizeof(format));
+            uint16_t channels;
+            std::memcpy(&m_Format, format, 2);
+            std::memcpy(&channels, format + 2, 2);
+            std::memcpy(&m_SampleRate, format + 4, 4);
+            std::memcpy(&m_BitsPerSample, format + 14, 2);
+            m_Channels = channels;
+            m_File.seekg(size - 16 + (size & 1), std::ios::cur);
+        }
+        else if (std::memcmp(header, "data", 4) == 0)
+        {
+            m_DataStart = m_File.tellg();
+            m_DataSize = size;
+            break;
+        }
+        else
+        {
+            // chunks are padded to an even size
+            m_File.seekg(size + (size & 1), std::ios::cur);
+        }
+    }
+
+    bool supported =
+        (m_Format == WAVE_FORMAT_PCM && m_BitsPerSample == 16) ||
+        (m_Format == WAVE_FORMAT_IEEE_FLOAT && m_BitsPerSample == 32);
+    if (!m_File || m_DataStart == 0 || !supported || m_Channels < 1 ||
+        m_Channels > 2 || m_SampleRate == 0)
+    {
+        LogWarning(fmt::format(
+            "{} is not 16 bit or float mono or stereo wave", path.string()));
+        return false;
+    }
+    return true;
+}
+
+size_t WavDecoder::Read(float* output, size_t frames)
+{
+    size_t frameSize = m_Channels * m_BitsPerSample / 8;
+    frames = std::min<size_t>(frames, (m_DataSize - m_DataRead) / frameSize);
+    m_Raw.resize(frames * frameSize);
+    m_File.read(m_Raw.data(), m_Raw.size());
+    frames = static_cast<size_t>(m_File.gcount()) / frameSize;
+    m_DataRead += static_cast<uint32_t>(frames * frameSize);
+
+    size_t samples = frames * m_Channels;
+    if (m_Format == WAVE_FORMAT_IEEE_FLOAT)
+    {
+        std::memcpy(output, m_Raw.data(), samples * sizeof(float));
+        return frames;
+    }
+    for (size_t i = 0; i < samples; i++)
+    {
+        int16_t sample;
+        std::memcpy(&sample, m_Raw.data() + i * 2, sizeof(sample));
+        output[i] = sample / 32768.0f;
+    }
+    return frames;
+}
+
+void WavDecoder::Rewind()
+{
+    m_File.clear();
+    m_File.seekg(m_DataStart);
+    m_DataRead = 0;
+}
+
+AudioEngine::AudioEngine(const AudioConfig& config)
+{
+    SDL_AudioSpec desired{};
+    desired.freq = static_cast<int>(config.sampleRate);
+    desired.format = AUDIO_F32SYS;
+    desired.channels = 2;
+    desired.samples = config.bufferFrames;
+    desired.callback = &AudioEngine::OnAudio;
+    desired.userdata = this;
+    // the mixer only writes float stereo, rate and buffer size are up to
+    // the device
+    m_Device = SDL_OpenAudioDevice(
+        config.device, 0, &desired, &m_Spec,
+        SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_SAMPLES_CHANGE);
+    if (m_Device == 0)
+    {
+        LogError(
+            fmt::format("Could not open audio device: {}", SDL_GetError()));
+    }
+    LogDebug(fmt::format(
+        "Audio device {} at {} hz, {} frame buffer",
+        config.device ? config.device : "default", m_Spec.freq,
+        m_Spec.samples));
+
+    m_Mixer = std::make_unique<AudioMixer>(static_cast<uint32_t>(m_Spec.freq));
+    m_Slots.resize(MAX_VOICES);
+    for (uint32_t i = MAX_VOICES; i > 0; i--)
+    {
+        m_FreeSlots.push_back(i - 1);
+    }
+    m_StreamThread = std::thread([this]() { RunStreams(); });
+    // devices open paused
+    SDL_PauseAudioDevice(m_Device, 0);
+}
+
+AudioEngine::~AudioEngine()
+{
+    // no callback runs once this returns, so the stream buffers can go
+    SDL_CloseAudioDevice(m_Device);
+    {
+        std::scoped_lock lock(m_StreamMutex);
+        m_StopStreams = true;
+    }
+    m_StreamWake.notify_one();
+    m_StreamThread.join();
+}
+
+std::shared_ptr<const AudioClip> AudioEngine::LoadClip(
+    const std::filesystem::path& path) const
+{
+    SDL_AudioSpec spec;
+    Uint8* wav;
+    Uint32 length;
+    if (!SDL_LoadWAV(path.string().c_str(), &spec, &wav, &length))
+    {
+        LogError(fmt::format(
+            "Could not load {}: {}", path.string(), SDL_GetError()));
+    }
+
+    auto clip = std::make_shared<AudioClip>();
+    clip->channels = std::min<uint32_t>(spec.channels, 2);
+    SDL_AudioCVT convert;
+    if (SDL_BuildAudioCVT(
+            &convert, spec.format, spec.channels, spec.freq, AUDIO_F32SYS,
+            static_cast<Uint8>(clip->channels), m_Spec.freq) < 0)
+    {
+        SDL_FreeWAV(wav);
+        LogError(fmt::format(
+            "Could not convert {}: {}", path.string(), SDL_GetError()));
+    }
+    std::vector<Uint8> buffer(length * convert.len_mult);
+    std::memcpy(buffer.data(), wav, length);
+    SDL_FreeWAV(wav);
+    convert.buf = buffer.data();
+    convert.len = static_cast<int>(length);
+    SDL_ConvertAudio(&convert);
+
+    clip->samples.resize(convert.len_cvt / sizeof(float));
+    std::memcpy(clip->samples.data(), buffer.data(), convert.len_cvt);
+    return clip;
+}
+
+VoiceHandle AudioEngine::Play(
+    std::shared_ptr<const AudioClip> clip, const PlayParams& params)
+{
+    if (!clip)
+    {
+        return {};
+    }
+    VoiceHandle voice = Allocate();
+    if (!voice.IsValid())
+    {
+        return {};
+    }
+    AudioCommand command{AudioCommandType::Play, voice};
+    command.clip = clip.get();
+    command.params = params;
+    if (!m_Mixer->Submit(command))
+    {
+        m_DroppedCommands++;
+        m_Slots[voice.index].used = false;
+        m_FreeSlots.push_back(voice.index);
+        return {};
+    }
+    m_Slots[voice.index].clip = std::move(clip);
+    return voice;
+}
+
+VoiceHandle AudioEngine::Stream(
+    const std::filesystem::path& path, const PlayParams& params)
+{
+    // only the header is read here, the samples are read on the stream
+    // thread
+    auto decoder = std::make_unique<WavDecoder>();
+    if (!decoder->Open(path))
+    {
+        return {};
+    }
+    VoiceHandle voice = Allocate();
+    if (!voice.IsValid())
+    {
+        return {};
+    }
+
+    AudioStreamBuffer* buffer = new AudioStreamBuffer;
+    buffer->channels = decoder->GetChannels();
+    buffer->sampleRate = decoder->GetSampleRate();
+    // decoding starts before the voice does, so the first callback usually
+    // finds data waiting
+    RequestStream({buffer, std::move(decoder), params.loop});
+
+    AudioCommand command{AudioCommandType::Play, voice};
+    command.stream = buffer;
+    command.params = params;
+    // looping is up to the decoder, the mixer just keeps reading
+    command.params.loop = false;
+    if (!m_Mixer->Submit(command))
+    {
+        m_DroppedCommands++;
+        RequestStream({buffer, nullptr});
+        m_Slots[voice.index].used = false;
+        m_FreeSlots.push_back(voice.index);
+        return {};
+    }
+    m_Slots[voice.index].stream = buffer;
+    return voice;
+}
+
+void AudioEngine::Stop(VoiceHandle voice)
+{
+    Submit({AudioCommandType::Stop, voice});
+}
+
+void AudioEngine::SetVolume(VoiceHandle voice, float volume)
+{
+    AudioCommand command{AudioCommandType::SetVolume, voice};
+    command.value = volume;
+    Submit(command);
+}
+
+void AudioEngine::SetPan(VoiceHandle voice, float pan)
+{
+    AudioCommand command{AudioCommandType::SetPan, voice};
+    command.value = pan;
+    Submit(command);
+}
+
+void AudioEngine::SetPitch(VoiceHandle voice, float pitch)
+{
+    AudioCommand command{AudioCommandType::SetPitch, voice};
+    command.value = pitch;
+    Submit(command);
+}
+
+void AudioEngine::SetBus(AudioBus bus, float volume, float lowpassHz)
+{
+    AudioCommand command{AudioCommandType::SetBus};
+    command.bus = bus;
+    command.value = volume;
+    command.cutoff = lowpassHz;
+    if (!m_Mixer->Submit(command))
+    {
+        m_DroppedCommands++;
+    }
+}
+
+void AudioEngine::Update()
+{
+    VoiceHandle voice;
+    while (m_Mixer->PopFinished(voice))
+    {
+        VoiceSlot& slot = m_Slots[voice.index];
+        if (slot.stream)
+        {
+            RequestStream({slot.stream, nullptr});
+        }
+        slot.clip.reset();
+        slot.stream = nullptr;
+        slot.used = false;
+        // stale handles to the old voice stop matching
+        slot.generation++;
+        m_FreeSlots.push_back(voice.index);
+    }
+}
+
+AudioStats AudioEngine::GetStats()
+{
+    AudioStats stats;
+    stats.activeVoices = m_Mixer->GetActiveVoices();
+    stats.starvations = m_Mixer->GetStarvations();
+    stats.droppedCommands = m_DroppedCommands;
+    stats.callbackMs = m_CallbackMs.exchange(0.0f, std::memory_order_relaxed);
+    stats.lateCallbacks = m_LateCallbacks.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void AudioEngine::OnAudio(void* userData, Uint8* data, int length)
+{
+    AudioEngine& engine = *static_cast<AudioEngine*>(userData);
+    auto start = std::chrono::steady_clock::now();
+    size_t frames = static_cast<size_t>(length) / (sizeof(float) * 2);
+    engine.m_Mixer->Mix(reinterpret_cast<float*>(data), frames);
+
+    float ms = std::chrono::duration<float, std::milli>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+    float slowest = engine.m_CallbackMs.load(std::memory_order_relaxed);
+    while (ms > slowest && !engine.m_CallbackMs.compare_exchange_weak(
+                               slowest, ms, std::memory_order_relaxed))
+    {
+    }
+    // a callback slower than the audio it produced means an underrun
+    if (ms * engine.m_Spec.freq > frames * 1000.0f)
+    {
+        engine.m_LateCallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+VoiceHandle AudioEngine::Allocate()
+{
+    if (m_FreeSlots.empty())
+    {
+        return {};
+    }
+    uint32_t index = m_FreeSlots.back();
+    m_FreeSlots.pop_back();
+    m_Slots[index].used = true;
+    return {index, m_Slots[index].generation};
+}
+
+void AudioEngine::Submit(const AudioCommand& command)
+{
+    const VoiceSlot& slot = m_Slots.at(command.voice.index);
+    if (!slot.used || slot.generation != command.voice.generation)
+    {
+        return;
+    }
+    if (!m_Mixer->Submit(command))
+    {
+        m_DroppedCommands++;
+    }
+}
+
+void AudioEngine::RequestStream(StreamRequest request)
+{
+    {
+        std::scoped_lock lock(m_StreamMutex);
+        m_StreamRequests.push_back(std::move(request));
+    }
+    m_StreamWake.notify_one();
+}
+
+void AudioEngine::RunStreams()
+{
+    struct OpenStream
+    {
+        AudioStreamBuffer* buffer;
+        // reset once the last frame is pushed
+        std::unique_ptr<WavDecoder> decoder;
+        bool loop;
+    };
+    std::vector<OpenStream> streams;
+    std::vector<StreamRequest> requests;
+    std::vector<float> chunk(STREAM_CHUNK_FRAMES * 2);
+
+    // a close only ever comes after the mixer reported the voice finished,
+    // so nothing reads the buffer anymore
+    auto apply = [&]()
+    {
+        for (StreamRequest& request : requests)
+        {
+            if (request.decoder)
+            {
+                streams.push_back(
+                    {request.buffer, std::move(request.decoder),
+                     request.loop});
+                continue;
+            }
+            std::erase_if(
+                streams, [&](const OpenStream& stream)
+                { return stream.buffer == request.buffer; });
+            delete request.buffer;
+        }
+        requests.clear();
+    };
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(m_StreamMutex);
+            m_StreamWake.wait_for(
+                lock, STREAM_POLL_INTERVAL,
+                [this]()
+                { return m_StopStreams || !m_StreamRequests.empty(); });
+            requests.swap(m_StreamRequests);
+            if (m_StopStreams)
+            {
+                break;
+            }
+        }
+        apply();
+
+        for (OpenStream& stream : streams)
+        {
+            if (!stream.decoder)
+            {
+                continue;
+            }
+            AudioStreamBuffer& buffer = *stream.buffer;
+            uint32_t channels = buffer.channels;
+            bool rewound = false;
+            while (true)
+            {
+                // whole frames only, and only what fits, so every push
+                // goes through in full
+                size_t space =
+                    (buffer.samples.capacity() - buffer.samples.size()) /
+                    channels;
+                if (space == 0)
+                {
+                    break;
+                }
+                size_t frames = stream.decoder->Read(
+                    chunk.data(), std::min(space, STREAM_CHUNK_FRAMES));
+                if (frames > 0)
+                {
+                    buffer.samples.Push(chunk.data(), frames * channels);
+                    rewound = false;
+                    continue;
+                }
+                if (stream.loop && !rewound)
+                {
+                    stream.decoder->Rewind();
+                    rewound = true;
+                    continue;
+                }
+                buffer.finished.store(true, std::memory_order_release);
+                stream.decoder.reset();
+                break;
+            }
+        }
+    }
+
+    apply();
+    for (OpenStream& stream : streams)
+    {
+        delete stream.buffer;
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "AudioMixer.hpp"
+#include <SDL2/SDL_audio.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct AudioConfig
+{
+    // what we ask for, the device may pick something else
+    uint32_t sampleRate = 48000;
+    // frames per callback, this is most of the output latency
+    uint16_t bufferFrames = 256;
+    // nullptr for the default device
+    const char* device = nullptr;
+};
+
+struct AudioStats
+{
+    uint32_t activeVoices = 0;
+    // stream voices that ran dry before their stream finished
+    uint64_t starvations = 0;
+    // commands lost to a full command queue
+    uint64_t droppedCommands = 0;
+    // slowest callback since the last GetStats
+    float callbackMs = 0.0f;
+    // callbacks that took longer than the audio they produced
+    uint64_t lateCallbacks = 0;
+};
+
+class WavDecoder;
+
+// sdl audio device with an AudioMixer on its callback. everything here is
+// game thread only, the audio thread only ever sees the mixer's queues, and
+// streams are decoded ahead on a thread of their own so the callback never
+// touches a file. SDL_AUDIODRIVER=dummy runs it without sound hardware, and
+// SDL_AUDIODRIVER=disk writes the mix to sdlaudio.raw
+class AudioEngine
+{
+public:
+    AudioEngine(const AudioConfig& config = {});
+    AudioEngine(const AudioEngine&) = delete;
+    ~AudioEngine();
+
+    // whole file decoded up front and converted to the device format, for
+    // short sounds. wav only
+    std::shared_ptr<const AudioClip> LoadClip(
+        const std::filesystem::path& path) const;
+
+    // an invalid handle when every voice is taken
+    VoiceHandle Play(
+        std::shared_ptr<const AudioClip> clip, const PlayParams& params = {});
+    // decoded while it plays, for music and long ambience. loop restarts
+    // the file. wav only
+    VoiceHandle Stream(
+        const std::filesystem::path& path, const PlayParams& params = {});
+    void Stop(VoiceHandle voice);
+    void SetVolume(VoiceHandle voice, float volume);
+    void SetPan(VoiceHandle voice, float pan);
+    void SetPitch(VoiceHandle voice, float pitch);
+    // lowpassHz 0 turns the bus filter off
+    void SetBus(AudioBus bus, float volume, float lowpassHz = 0.0f);
+
+    // recycles the voices the mixer finished with, once a frame
+    void Update();
+    AudioStats GetStats();
+    uint32_t GetSampleRate() const { return m_Mixer->GetSampleRate(); }
+
+private:
+    struct VoiceSlot
+    {
+        uint32_t generation = 0;
+        bool used = false;
+        // kept alive until the mixer is done with it
+        std::shared_ptr<const AudioClip> clip;
+        AudioStreamBuffer* stream = nullptr;
+    };
+
+    struct StreamRequest
+    {
+        AudioStreamBuffer* buffer;
+        // nullptr closes the stream and frees the buffer
+        std::unique_ptr<WavDecoder> decoder;
+        bool loop = false;
+    };
+
+    static void OnAudio(void* userData, Uint8* data, int length);
+    VoiceHandle Allocate();
+    void Submit(const AudioCommand& command);
+    void RequestStream(StreamRequest request);
+    void RunStreams();
+
+    SDL_AudioDeviceID m_Device = 0;
+    SDL_AudioSpec m_Spec{};
+    std::unique_ptr<AudioMixer> m_Mixer;
+    std::vector<VoiceSlot> m_Slots;
+    std::vector<uint32_t> m_FreeSlots;
+    uint64_t m_DroppedCommands = 0;
+
+    // written by the callback
+    std::atomic<float> m_CallbackMs = 0.0f;
+    std::atomic<uint64_t> m_LateCallbacks = 0;
+
+    std::mutex m_StreamMutex;
+    std::condition_variable m_StreamWake;
+    std::vector<StreamRequest> m_StreamRequests;
+    bool m_StopStreams = false;
+    std::thread m_StreamThread;
+};
@@ -0,0 +1,478 @@
+#include "AudioMixer.hpp"
+#include "Simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+AudioMixer::AudioMixer(uint32_t sampleRate)
+    : m_SampleRate(sampleRate), m_Voices(MAX_VOICES),
+      m_Scratch(MAX_STREAM_VOICES * SCRATCH_FRAMES * 2),
+      m_ScratchFrames(MAX_STREAM_VOICES)
+{
+    m_Active.reserve(MAX_VOICES);
+    for (uint32_t i = MAX_STREAM_VOICES; i > 0; i--)
+    {
+        m_FreeScratch.push_back(i - 1);
+    }
+}
+
+void AudioMixer::Accumulate(
+    const float* source, uint32_t channels, double position, float step,
+    size_t frames, const Gains& gains, float* left, float* right)
+{
+    size_t base = static_cast<size_t>(position);
+    float fraction = static_cast<float>(position - base);
+    size_t i = 0;
+
+#if defined(SIMD_FLOAT4)
+    using namespace Simd;
+    const float laneData[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+    Float4 lanes = Load(laneData);
+    Float4 gainLeft = Add(Splat(gains.left), Mul(Splat(gains.rampLeft), lanes));
+    Float4 gainRight =
+        Add(Splat(gains.right), Mul(Splat(gains.rampRight), lanes));
+    Float4 rampLeft = Splat(gains.rampLeft * 4.0f);
+    Float4 rampRight = Splat(gains.rampRight * 4.0f);
+
+    auto add = [&](size_t frame, Float4 sampleLeft, Float4 sampleRight)
+    {
+        Store(
+            left + frame, Add(Load(left + frame), Mul(sampleLeft, gainLeft)));
+        Store(
+            right + frame,
+            Add(Load(right + frame), Mul(sampleRight, gainRight)));
+        gainLeft = Add(gainLeft, rampLeft);
+        gainRight = Add(gainRight, rampRight);
+    };
+
+    if (step == 1.0f)
+    {
+        // native rate, the fraction stays put and both taps are plain
+        // contiguous loads
+        Float4 weight = Splat(fraction);
+        for (; i + 4 <= frames; i += 4)
+        {
+            if (channels == 1)
+            {
+                Float4 a = Load(source + base + i);
+                Float4 b = Load(source + base + i + 1);
+                Float4 sample = Add(a, Mul(Sub(b, a), weight));
+                add(i, sample, sample);
+            }
+            else
+            {
+                Float4 aLeft, aRight, bLeft, bRight;
+                LoadDeinterleaved(source + (base + i) * 2, aLeft, aRight);
+                LoadDeinterleaved(
+                    source + (base + i + 1) * 2, bLeft, bRight);
+                add(i, Add(aLeft, Mul(Sub(bLeft, aLeft), weight)),
+                    Add(aRight, Mul(Sub(bRight, aRight), weight)));
+            }
+        }
+    }
+    else
+    {
+        // taps are gathered one lane at a time, the interpolation and
+        // gain run 4 wide
+        alignas(16) float a[2][4];
+        alignas(16) float b[2][4];
+        alignas(16) float weights[4];
+        for (; i + 4 <= frames; i += 4)
+        {
+            for (size_t lane = 0; lane < 4; lane++)
+            {
+                double offset = position + (i + lane) * double(step);
+                size_t index = static_cast<size_t>(offset);
+                weights[lane] = static_cast<float>(offset - index);
+                for (uint32_t c = 0; c < 2; c++)
+                {
+                    uint32_t channel = std::min(c, channels - 1);
+                    a[c][lane] = source[index * channels + channel];
+                    b[c][lane] = source[(index + 1) * channels + channel];
+                }
+            }
+            Float4 weight = Load(weights);
+            Float4 aLeft = Load(a[0]), aRight = Load(a[1]);
+            add(i, Add(aLeft, Mul(Sub(Load(b[0]), aLeft), weight)),
+                Add(aRight, Mul(Sub(Load(b[1]), aRight), weight)));
+        }
+    }
+#endif
+
+    for (; i < frames; i++)
+    {
+        double offset = position + i * double(step);
+        size_t index = static_cast<size_t>(offset);
+        float weight = static_cast<float>(offset - index);
+        const float* a = source + index * channels;
+        const float* b = a + channels;
+        float sampleLeft = a[0] + (b[0] - a[0]) * weight;
+        float sampleRight = channels == 1
+                                ? sampleLeft
+                                : a[1] + (b[1] - a[1]) * weight;
+        left[i] += sampleLeft * (gains.left + gains.rampLeft * i);
+        right[i] += sampleRight * (gains.right + gains.rampRight * i);
+    }
+}
+
+void AudioMixer::Mix(float* output, size_t frames)
+{
+    while (frames > 0)
+    {
+        size_t block = std::min<size_t>(frames, AUDIO_BLOCK_FRAMES);
+        MixBlock(output, block);
+        output += block * 2;
+        frames -= block;
+    }
+    m_ActiveVoices.store(
+        static_cast<uint32_t>(m_Active.size()), std::memory_order_relaxed);
+}
+
+void AudioMixer::ProcessCommands()
+{
+    AudioCommand command;
+    while (m_Commands.Pop(command))
+    {
+        if (command.type == AudioCommandType::Play)
+        {
+            Play(command);
+            continue;
+        }
+        if (command.type == AudioCommandType::SetBus)
+        {
+            Bus& bus = m_Buses[static_cast<size_t>(command.bus)];
+            bus.volume = command.value;
+            bus.coefficient =
+                command.cutoff <= 0.0f
+                    ? 1.0f
+                    : 1.0f - std::exp(
+                                 -2.0f * std::numbers::pi_v<float> *
+                                 command.cutoff / m_SampleRate);
+            continue;
+        }
+
+        // the voice may have ended before the command got here
+        Voice* voice = Find(command.voice);
+        if (!voice)
+        {
+            continue;
+        }
+        switch (command.type)
+        {
+        case AudioCommandType::Stop:
+            voice->stopping = true;
+            break;
+        case AudioCommandType::SetVolume:
+            voice->params.volume = command.value;
+            break;
+        case AudioCommandType::SetPan:
+            voice->params.pan = std::clamp(command.value, -1.0f, 1.0f);
+            break;
+        case AudioCommandType::SetPitch:
+            SetPitch(*voice, command.value);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void AudioMixer::Play(const AudioCommand& command)
+{
+    Voice& voice = m_Voices[command.voice.index];
+    if (voice.active)
+    {
+        return;
+    }
+    voice = {};
+    voice.active = true;
+    voice.generation = command.voice.generation;
+    voice.clip = command.clip;
+    voice.stream = command.stream;
+    voice.params = command.params;
+    voice.params.pan = std::clamp(voice.params.pan, -1.0f, 1.0f);
+    if (voice.stream && voice.stream->sampleRate != 0)
+    {
+        voice.rate = static_cast<float>(voice.stream->sampleRate) /
+                     static_cast<float>(m_SampleRate);
+    }
+    SetPitch(voice, voice.params.pitch);
+    // starts at full gain, ramping up from silence would blunt the attack
+    UpdateGains(voice, voice.gainLeft, voice.gainRight);
+    m_Active.push_back(command.voice.index);
+
+    if (voice.stream)
+    {
+        if (m_FreeScratch.empty())
+        {
+            // reported as finished straight away so the game side can
+            // close the stream
+            voice.stream = nullptr;
+            voice.stopping = true;
+            return;
+        }
+        voice.scratch = m_FreeScratch.back();
+        m_FreeScratch.pop_back();
+        m_ScratchFrames[voice.scratch] = 0;
+    }
+}
+
+AudioMixer::Voice* AudioMixer::Find(VoiceHandle handle)
+{
+    if (handle.index >= MAX_VOICES)
+    {
+        return nullptr;
+    }
+    Voice& voice = m_Voices[handle.index];
+    if (!voice.active || voice.generation != handle.generation)
+    {
+        return nullptr;
+    }
+    return &voice;
+}
+
+void AudioMixer::SetPitch(Voice& voice, float pitch)
+{
+    voice.params.pitch = pitch;
+    voice.step = std::clamp(pitch * voice.rate, 1.0f / 64.0f, MAX_PITCH);
+}
+
+void AudioMixer::UpdateGains(Voice& voice, float& left, float& right) const
+{
+    if (voice.stopping)
+    {
+        left = right = 0.0f;
+        return;
+    }
+    // constant power, the centre sits at -3 db on both sides
+    float angle = (voice.params.pan + 1.0f) * std::numbers::pi_v<float> / 4.0f;
+    left = std::cos(angle) * voice.params.volume;
+    right = std::sin(angle) * voice.params.volume;
+}
+
+void AudioMixer::MixBlock(float* output, size_t frames)
+{
+    ProcessCommands();
+    for (Bus& bus : m_Buses)
+    {
+        std::fill_n(bus.left.begin(), frames, 0.0f);
+        std::fill_n(bus.right.begin(), frames, 0.0f);
+    }
+
+    for (size_t i = 0; i < m_Active.size();)
+    {
+        uint32_t index = m_Active[i];
+        Voice& voice = m_Voices[index];
+        Bus& bus = m_Buses[static_cast<size_t>(voice.params.bus)];
+        if (MixVoice(voice, bus, frames))
+        {
+            i++;
+            continue;
+        }
+        Finish(index);
+        m_Active[i] = m_Active.back();
+        m_Active.pop_back();
+    }
+
+    alignas(16) std::array<float, AUDIO_BLOCK_FRAMES> left{};
+    alignas(16) std::array<float, AUDIO_BLOCK_FRAMES> right{};
+    for (Bus& bus : m_Buses)
+    {
+        if (bus.coefficient < 1.0f)
+        {
+            // one pole low pass, each sample depends on the last so this
+            // stays scalar
+            for (size_t i = 0; i < frames; i++)
+            {
+                bus.stateLeft +=
+                    bus.coefficient * (bus.left[i] - bus.stateLeft);
+                bus.stateRight +=
+                    bus.coefficient * (bus.right[i] - bus.stateRight);
+                bus.left[i] = bus.stateLeft;
+                bus.right[i] = bus.stateRight;
+            }
+        }
+
+        size_t i = 0;
+#if defined(SIMD_FLOAT4)
+        using namespace Simd;
+        Float4 volume = Splat(bus.volume);
+        for (; i + 4 <= frames; i += 4)
+        {
+            Store(
+                &left[i],
+                Add(Load(&left[i]), Mul(Load(&bus.left[i]), volume)));
+            Store(
+                &right[i],
+                Add(Load(&right[i]), Mul(Load(&bus.right[i]), volume)));
+        }
+#endif
+        for (; i < frames; i++)
+        {
+            left[i] += bus.left[i] * bus.volume;
+            right[i] += bus.right[i] * bus.volume;
+        }
+    }
+
+    for (size_t i = 0; i < frames; i++)
+    {
+        output[i * 2] = std::clamp(left[i], -1.0f, 1.0f);
+        output[i * 2 + 1] = std::clamp(right[i], -1.0f, 1.0f);
+    }
+}
+
+bool AudioMixer::MixVoice(Voice& voice, Bus& bus, size_t frames)
+{
+    // gain changes are spread over the block so they dont click
+    float targetLeft, targetRight;
+    UpdateGains(voice, targetLeft, targetRight);
+    Gains gains{
+        voice.gainLeft, voice.gainRight,
+        (targetLeft - voice.gainLeft) / frames,
+        (targetRight - voice.gainRight) / frames};
+    voice.gainLeft = targetLeft;
+    voice.gainRight = targetRight;
+
+    bool playing = true;
+    if (voice.clip)
+    {
+        playing = MixClip(voice, bus, frames, gains);
+    }
+    else if (voice.stream)
+    {
+        playing = MixStream(voice, bus, frames, gains);
+    }
+    return playing && !voice.stopping;
+}
+
+bool AudioMixer::MixClip(Voice& voice, Bus& bus, size_t frames, Gains gains)
+{
+    const AudioClip& clip = *voice.clip;
+    size_t count = clip.GetFrameCount();
+    if (count == 0)
+    {
+        return false;
+    }
+    // the last frame interpolates toward the first when looping and toward
+    // silence otherwise, so it is mixed on its own
+    double last = static_cast<double>(count - 1);
+    size_t done = 0;
+    while (done < frames)
+    {
+        if (voice.position >= count)
+        {
+            if (!voice.params.loop)
+            {
+                return false;
+            }
+            voice.position = std::fmod(voice.position, double(count));
+        }
+
+        if (voice.position < last)
+        {
+            size_t run = std::min<size_t>(
+                frames - done,
+                static_cast<size_t>(
+                    std::ceil((last - voice.position) / voice.step)));
+            // rounding can put the final position on the last frame
+            while (run > 0 && voice.position + (run - 1) * double(voice.step) >=
+                                  last)
+            {
+                run--;
+            }
+            if (run > 0)
+            {
+                Accumulate(
+                    clip.samples.data(), clip.channels, voice.position,
+                    voice.step, run, gains, bus.left.data() + done,
+                    bus.right.data() + done);
+                gains.Advance(run);
+                voice.position += run * double(voice.step);
+                done += run;
+                continue;
+            }
+        }
+
+        const float* a = clip.samples.data() + (count - 1) * clip.channels;
+        float weight = static_cast<float>(voice.position - last);
+        float next[2] = {};
+        if (voice.params.loop)
+        {
+            next[0] = clip.samples[0];
+            next[1] = clip.samples[clip.channels - 1];
+        }
+        float sampleLeft = a[0] + (next[0] - a[0]) * weight;
+        float sampleRight = a[clip.channels - 1] +
+                            (next[1] - a[clip.channels - 1]) * weight;
+        bus.left[done] += sampleLeft * gains.left;
+        bus.right[done] += sampleRight * gains.right;
+        gains.Advance(1);
+        voice.position += voice.step;
+        done++;
+    }
+    return true;
+}
+
+bool AudioMixer::MixStream(Voice& voice, Bus& bus, size_t frames, Gains gains)
+{
+    AudioStreamBuffer& stream = *voice.stream;
+    uint32_t channels = stream.channels;
+    float* scratch = m_Scratch.data() + voice.scratch * SCRATCH_FRAMES * 2;
+    size_t& held = m_ScratchFrames[voice.scratch];
+
+    // the block reads up to the frame after its last position
+    double lastPosition = voice.position + (frames - 1) * double(voice.step);
+    size_t needed = static_cast<size_t>(lastPosition) + 2;
+    // finished is read before popping, so everything pushed before it was
+    // set is seen by the pop
+    bool finished = stream.finished.load(std::memory_order_acquire);
+    if (held < needed)
+    {
+        size_t popped = stream.samples.Pop(
+            scratch + held * channels, (needed - held) * channels);
+        held += popped / channels;
+        voice.streamStarted |= popped > 0;
+    }
+    bool ending = false;
+    if (held < needed)
+    {
+        if (finished)
+        {
+            ending = true;
+        }
+        else if (voice.streamStarted)
+        {
+            m_Starvations.fetch_add(1, std::memory_order_relaxed);
+        }
+        // the gap plays as silence
+        std::fill(scratch + held * channels, scratch + needed * channels, 0.0f);
+        held = needed;
+    }
+
+    Accumulate(
+        scratch, channels, voice.position, voice.step, frames, gains,
+        bus.left.data(), bus.right.data());
+
+    // only the frames still needed for interpolation are kept
+    voice.position += frames * double(voice.step);
+    size_t consumed = std::min(held, static_cast<size_t>(voice.position));
+    std::memmove(
+        scratch, scratch + consumed * channels,
+        (held - consumed) * channels * sizeof(float));
+    held -= consumed;
+    voice.position -= consumed;
+    return !ending;
+}
+
+void AudioMixer::Finish(uint32_t index)
+{
+    Voice& voice = m_Voices[index];
+    voice.active = false;
+    if (voice.stream)
+    {
+        m_FreeScratch.push_back(voice.scratch);
+    }
+    // never full, a slot is only reused once the game side popped it
+    m_Finished.Push({index, voice.generation});
+}
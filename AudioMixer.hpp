@@ -0,0 +1,216 @@
+#pragma once
+
+#include "SpscQueue.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// voices the mixer can play at once
+constexpr uint32_t MAX_VOICES = 512;
+// voices that can read from a stream at once, each needs its own scratch
+constexpr uint32_t MAX_STREAM_VOICES = 16;
+// longest stretch mixed in one go, longer requests are split
+constexpr uint32_t AUDIO_BLOCK_FRAMES = 256;
+// pitch is clamped to this, it bounds how much source a block can read
+constexpr float MAX_PITCH = 4.0f;
+
+enum class AudioBus : uint8_t
+{
+    Music = 0,
+    Effects = 1,
+    Interface = 2,
+    Count = 3
+};
+
+// decoded pcm at the mixer's sample rate, interleaved float samples with 1
+// or 2 channels
+struct AudioClip
+{
+    std::vector<float> samples;
+    uint32_t channels = 1;
+
+    size_t GetFrameCount() const { return samples.size() / channels; }
+};
+
+// fed by the streaming thread, read by the mixer. interleaved float samples
+// pushed a whole frame at a time, the producer sets finished after its last
+// push
+struct AudioStreamBuffer
+{
+    SpscQueue<float, 16 * 1024> samples;
+    uint32_t channels = 1;
+    // resampled on the fly when it differs from the mixer's, 0 means the same
+    uint32_t sampleRate = 0;
+    std::atomic<bool> finished = false;
+};
+
+// game side handle, the generation tells a recycled voice slot apart from
+// the voice that used to be in it
+struct VoiceHandle
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return index != UINT32_MAX; }
+};
+
+struct PlayParams
+{
+    float volume = 1.0f;
+    // -1 is hard left, 1 hard right
+    float pan = 0.0f;
+    // playback speed, also shifts the pitch
+    float pitch = 1.0f;
+    AudioBus bus = AudioBus::Effects;
+    bool loop = false;
+};
+
+enum class AudioCommandType : uint8_t
+{
+    Play,
+    Stop,
+    SetVolume,
+    SetPan,
+    SetPitch,
+    SetBus
+};
+
+struct AudioCommand
+{
+    AudioCommandType type;
+    VoiceHandle voice;
+    // Play, exactly one of the two is set
+    const AudioClip* clip = nullptr;
+    AudioStreamBuffer* stream = nullptr;
+    PlayParams params;
+    // SetVolume, SetPan, SetPitch and SetBus volume
+    float value = 0.0f;
+    // SetBus
+    AudioBus bus = AudioBus::Effects;
+    // SetBus low pass cutoff in hz, 0 turns the filter off
+    float cutoff = 0.0f;
+};
+
+// mixes voices into interleaved stereo float. the game thread talks to it
+// only through Submit and PopFinished, both lock free, and Mix never locks
+// or allocates, everything it touches is allocated up front
+class AudioMixer
+{
+public:
+    AudioMixer(uint32_t sampleRate);
+    AudioMixer(const AudioMixer&) = delete;
+
+    // game thread, false when the command queue is full
+    bool Submit(const AudioCommand& command)
+    {
+        return m_Commands.Push(command);
+    }
+    // game thread, voices that ended or were stopped, once each
+    bool PopFinished(VoiceHandle& voice) { return m_Finished.Pop(voice); }
+
+    // audio thread
+    void Mix(float* output, size_t frames);
+
+    uint32_t GetSampleRate() const { return m_SampleRate; }
+    uint32_t GetActiveVoices() const
+    {
+        return m_ActiveVoices.load(std::memory_order_relaxed);
+    }
+    // times a stream voice ran dry before its stream finished
+    uint64_t GetStarvations() const
+    {
+        return m_Starvations.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Voice
+    {
+        bool active = false;
+        // fading out over the current block, finishes after it
+        bool stopping = false;
+        uint32_t generation = 0;
+        const AudioClip* clip = nullptr;
+        AudioStreamBuffer* stream = nullptr;
+        // scratch slot for stream voices
+        uint32_t scratch = 0;
+        // a stream is only starving once it has had data
+        bool streamStarted = false;
+        // in source frames, relative to the scratch start for streams
+        double position = 0.0;
+        // source rate over mixer rate
+        float rate = 1.0f;
+        // source frames per output frame, rate times pitch
+        float step = 1.0f;
+        PlayParams params;
+        float gainLeft = 0.0f;
+        float gainRight = 0.0f;
+    };
+
+    struct Gains
+    {
+        float left;
+        float right;
+        // added per output frame
+        float rampLeft;
+        float rampRight;
+
+        void Advance(size_t frames)
+        {
+            left += rampLeft * frames;
+            right += rampRight * frames;
+        }
+    };
+
+    struct Bus
+    {
+        float volume = 1.0f;
+        // one pole low pass, coefficient 1 lets everything through
+        float coefficient = 1.0f;
+        float stateLeft = 0.0f;
+        float stateRight = 0.0f;
+        alignas(16) std::array<float, AUDIO_BLOCK_FRAMES> left;
+        alignas(16) std::array<float, AUDIO_BLOCK_FRAMES> right;
+    };
+
+    // per stream voice, enough for a block at max pitch plus the frames
+    // carried over for interpolation, in stereo
+    static constexpr size_t SCRATCH_FRAMES =
+        static_cast<size_t>(AUDIO_BLOCK_FRAMES * MAX_PITCH) + 4;
+
+    void ProcessCommands();
+    void Play(const AudioCommand& command);
+    Voice* Find(VoiceHandle handle);
+    void UpdateGains(Voice& voice, float& left, float& right) const;
+    void MixBlock(float* output, size_t frames);
+    // false once the voice has nothing left to play
+    bool MixVoice(Voice& voice, Bus& bus, size_t frames);
+    bool MixClip(Voice& voice, Bus& bus, size_t frames, Gains gains);
+    bool MixStream(Voice& voice, Bus& bus, size_t frames, Gains gains);
+    void Finish(uint32_t index);
+    void SetPitch(Voice& voice, float pitch);
+
+    // adds frames of source, read from position on in steps of step and
+    // linearly interpolated, into left and right. every source frame touched
+    // has to exist, including the one after the last position
+    static void Accumulate(
+        const float* source, uint32_t channels, double position, float step,
+        size_t frames, const Gains& gains, float* left, float* right);
+
+    uint32_t m_SampleRate;
+    SpscQueue<AudioCommand, 1024> m_Commands;
+    SpscQueue<VoiceHandle, MAX_VOICES> m_Finished;
+
+    std::vector<Voice> m_Voices;
+    // indices of active voices, so idle slots cost nothing
+    std::vector<uint32_t> m_Active;
+    std::array<Bus, static_cast<size_t>(AudioBus::Count)> m_Buses;
+    std::vector<float> m_Scratch;
+    std::vector<uint32_t> m_FreeScratch;
+    // frames of source currently held in each scratch slot
+    std::vector<size_t> m_ScratchFrames;
+
+    std::atomic<uint32_t> m_ActiveVoices = 0;
+    std::atomic<uint64_t> m_Starvations = 0;
+};
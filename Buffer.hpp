@@ -3,6 +3,7 @@
 #include "Device.hpp"
 #include "Log.hpp"
 #include <span>
+#include <utility>
 #include <vulkan/vulkan_raii.hpp>
 
 template <typename T> class Buffer
@@ -28,7 +29,13 @@ public:
         m_Buffer.bindMemory(*m_DeviceMemory, 0);
     }
     Buffer(const Buffer&) = delete;
-    Buffer(Buffer&&) = default;
+    // the moved from buffer must not unmap memory it no longer owns
+    Buffer(Buffer&& other) noexcept
+        : m_Count(other.m_Count), m_Buffer(std::move(other.m_Buffer)),
+          m_DeviceMemory(std::move(other.m_DeviceMemory)),
+          m_Memory(std::exchange(other.m_Memory, nullptr))
+    {
+    }
     ~Buffer()
     {
         if (m_Memory)
@@ -0,0 +1,446 @@
+#include "Collision.hpp"
+#include "Simd.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+static void
+AddPair(std::vector<CollisionPair>& pairs, uint32_t first, uint32_t second)
+{
+    pairs.push_back({std::min(first, second), std::max(first, second)});
+}
+
+// pairs body with every body whose lane is set, low lanes first
+static void WritePairs(
+    uint32_t mask, size_t base, uint32_t body, const uint32_t* userData,
+    std::vector<CollisionPair>& pairs)
+{
+    while (mask)
+    {
+        AddPair(pairs, body, userData[base + std::countr_zero(mask)]);
+        mask &= mask - 1;
+    }
+}
+
+Broadphase::Broadphase(float bandHeight) : m_BandHeight(bandHeight) {}
+
+CollisionProxy Broadphase::Insert(const Aabb& bounds, uint32_t userData)
+{
+    CollisionProxy proxy;
+    if (!m_FreeProxies.empty())
+    {
+        proxy = m_FreeProxies.back();
+        m_FreeProxies.pop_back();
+    }
+    else
+    {
+        proxy = static_cast<CollisionProxy>(m_Records.size());
+        m_Records.emplace_back();
+    }
+    m_Records[proxy] = {bounds, userData, true};
+    m_Inserted.push_back(proxy);
+    m_ProxyCount++;
+    return proxy;
+}
+
+void Broadphase::Update(CollisionProxy proxy, const Aabb& bounds)
+{
+    m_Records.at(proxy).bounds = bounds;
+}
+
+void Broadphase::Remove(CollisionProxy proxy)
+{
+    ProxyRecord& record = m_Records.at(proxy);
+    if (!record.alive)
+    {
+        return;
+    }
+    record.alive = false;
+    m_Removed.push_back(proxy);
+    m_ProxyCount--;
+}
+
+void Broadphase::FindPairs(JobSystem& jobs, std::vector<CollisionPair>& pairs)
+{
+    Sort();
+    Gather();
+
+    size_t count = m_Keys.size();
+    size_t blockCount =
+        (count + BROADPHASE_BLOCK_SIZE - 1) / BROADPHASE_BLOCK_SIZE;
+    if (m_BlockPairs.size() < blockCount)
+    {
+        m_BlockPairs.resize(blockCount);
+    }
+    jobs.ParallelFor(
+        0, blockCount, 1,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t block = begin; block < end; block++)
+            {
+                m_BlockPairs[block].clear();
+                Sweep(
+                    block * BROADPHASE_BLOCK_SIZE,
+                    std::min((block + 1) * BROADPHASE_BLOCK_SIZE, count),
+                    m_BlockPairs[block]);
+            }
+        });
+
+    // block order, not completion order, keeps the output deterministic
+    pairs.clear();
+    for (size_t block = 0; block < blockCount; block++)
+    {
+        pairs.insert(
+            pairs.end(), m_BlockPairs[block].begin(),
+            m_BlockPairs[block].end());
+    }
+}
+
+int32_t Broadphase::GetBand(float y) const
+{
+    // clamped so far away bodies share the outermost bands rather than
+    // overflowing
+    float band = std::floor(y / m_BandHeight);
+    return static_cast<int32_t>(std::clamp(band, -1e9f, 1e9f));
+}
+
+bool Broadphase::SweepsBefore(const SortKey& a, const SortKey& b)
+{
+    return a.band < b.band ||
+           (a.band == b.band && a.bounds.min.x < b.bounds.min.x);
+}
+
+Broadphase::SortKey Broadphase::GetSortKey(CollisionProxy proxy) const
+{
+    const ProxyRecord& record = m_Records[proxy];
+    return {
+        GetBand(record.bounds.min.y), proxy, record.userData, record.bounds};
+}
+
+void Broadphase::Sort()
+{
+    // last tick's order with fresh keys, bodies that changed band would move
+    // past most of a band one step at a time so they are taken out.
+    // removed bodies are dropped here, only now can their proxies be reused
+    m_Movers.clear();
+    size_t kept = 0;
+    for (const SortKey& previous : m_Keys)
+    {
+        if (!m_Records[previous.proxy].alive)
+        {
+            continue;
+        }
+        SortKey key = GetSortKey(previous.proxy);
+        if (key.band == previous.band)
+        {
+            m_Keys[kept++] = key;
+        }
+        else
+        {
+            m_Movers.push_back(key);
+        }
+    }
+    m_Keys.resize(kept);
+    m_FreeProxies.insert(
+        m_FreeProxies.end(), m_Removed.begin(), m_Removed.end());
+    m_Removed.clear();
+
+    for (CollisionProxy proxy : m_Inserted)
+    {
+        if (m_Records[proxy].alive)
+        {
+            m_Movers.push_back(GetSortKey(proxy));
+        }
+    }
+    m_Inserted.clear();
+
+    // bodies jumping around inside their band, one full sort is cheaper
+    if (!InsertionSort(m_Keys.size() * 8))
+    {
+        std::sort(m_Keys.begin(), m_Keys.end(), SweepsBefore);
+    }
+    if (m_Movers.empty())
+    {
+        return;
+    }
+    std::sort(m_Movers.begin(), m_Movers.end(), SweepsBefore);
+    m_Merged.resize(m_Keys.size() + m_Movers.size());
+    std::merge(
+        m_Keys.begin(), m_Keys.end(), m_Movers.begin(), m_Movers.end(),
+        m_Merged.begin(), SweepsBefore);
+    std::swap(m_Keys, m_Merged);
+}
+
+bool Broadphase::InsertionSort(size_t moveLimit)
+{
+    size_t moves = 0;
+    for (size_t i = 1; i < m_Keys.size(); i++)
+    {
+        SortKey key = m_Keys[i];
+        size_t j = i;
+        for (; j > 0 && SweepsBefore(key, m_Keys[j - 1]); j--)
+        {
+            m_Keys[j] = m_Keys[j - 1];
+        }
+        m_Keys[j] = key;
+
+        moves += i - j;
+        if (moves > moveLimit)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Broadphase::Gather()
+{
+    size_t count = m_Keys.size();
+    m_MinX.resize(count);
+    m_MinY.resize(count);
+    m_MaxX.resize(count);
+    m_MaxY.resize(count);
+    m_UserData.resize(count);
+    m_Bands.clear();
+    for (size_t i = 0; i < count; i++)
+    {
+        const SortKey& key = m_Keys[i];
+        m_MinX[i] = key.bounds.min.x;
+        m_MinY[i] = key.bounds.min.y;
+        m_MaxX[i] = key.bounds.max.x;
+        m_MaxY[i] = key.bounds.max.y;
+        m_UserData[i] = key.userData;
+
+        if (m_Bands.empty() || m_Bands.back().band != key.band)
+        {
+            m_Bands.push_back({key.band, i, i, 0.0f});
+        }
+        BandRange& range = m_Bands.back();
+        range.end = i + 1;
+        range.maxWidth = std::max(range.maxWidth, m_MaxX[i] - m_MinX[i]);
+    }
+}
+
+void Broadphase::Sweep(
+    size_t begin, size_t end, std::vector<CollisionPair>& pairs) const
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    auto band = std::upper_bound(
+        m_Bands.begin(), m_Bands.end(), begin,
+        [](size_t body, const BandRange& range) { return body < range.end; });
+
+    for (size_t i = begin; i < end; i++)
+    {
+        if (i >= band->end)
+        {
+            ++band;
+        }
+        // the rest of the body's own band all starts right of it
+        SweepRun(i, i + 1, band->end, pairs);
+
+        // bands above reached by the box, their bodies can start left of
+        // it by up to the band's widest box
+        int32_t lastBand = GetBand(m_MaxY[i]);
+        for (auto above = band + 1;
+             above != m_Bands.end() && above->band <= lastBand; ++above)
+        {
+            auto first = std::lower_bound(
+                m_MinX.begin() + above->begin, m_MinX.begin() + above->end,
+                m_MinX[i] - above->maxWidth);
+            SweepRun(i, first - m_MinX.begin(), above->end, pairs);
+        }
+    }
+}
+
+void Broadphase::SweepRun(
+    size_t body, size_t begin, size_t end,
+    std::vector<CollisionPair>& pairs) const
+{
+    // sorted by minX, so the first box starting past the body's right edge
+    // ends the run
+    const float* minX = m_MinX.data();
+    const float* minY = m_MinY.data();
+    const float* maxX = m_MaxX.data();
+    const float* maxY = m_MaxY.data();
+    const uint32_t* userData = m_UserData.data();
+    const Aabb bounds{{minX[body], minY[body]}, {maxX[body], maxY[body]}};
+    size_t j = begin;
+    bool open = true;
+
+#if defined(SIMD_AVX2)
+    const __m256 boundsMinX = _mm256_set1_ps(bounds.min.x);
+    const __m256 boundsMinY = _mm256_set1_ps(bounds.min.y);
+    const __m256 boundsMaxX = _mm256_set1_ps(bounds.max.x);
+    const __m256 boundsMaxY = _mm256_set1_ps(bounds.max.y);
+    for (; open && j + 8 <= end; j += 8)
+    {
+        __m256 starts =
+            _mm256_cmp_ps(_mm256_loadu_ps(minX + j), boundsMaxX, _CMP_LE_OQ);
+        __m256 x = _mm256_and_ps(
+            starts,
+            _mm256_cmp_ps(_mm256_loadu_ps(maxX + j), boundsMinX, _CMP_GE_OQ));
+        __m256 y = _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_loadu_ps(maxY + j), boundsMinY, _CMP_GE_OQ),
+            _mm256_cmp_ps(_mm256_loadu_ps(minY + j), boundsMaxY, _CMP_LE_OQ));
+        WritePairs(
+            static_cast<uint32_t>(_mm256_movemask_ps(_mm256_and_ps(x, y))), j,
+            userData[body], userData, pairs);
+        open = _mm256_movemask_ps(starts) == 0xff;
+    }
+#elif defined(SIMD_FLOAT4)
+    using namespace Simd;
+    const Float4 boundsMinX = Splat(bounds.min.x);
+    const Float4 boundsMinY = Splat(bounds.min.y);
+    const Float4 boundsMaxX = Splat(bounds.max.x);
+    const Float4 boundsMaxY = Splat(bounds.max.y);
+    for (; open && j + 4 <= end; j += 4)
+    {
+        Float4 starts = LessEqual(Load(minX + j), boundsMaxX);
+        Float4 x = And(starts, GreaterEqual(Load(maxX + j), boundsMinX));
+        Float4 y = And(
+            GreaterEqual(Load(maxY + j), boundsMinY),
+            LessEqual(Load(minY + j), boundsMaxY));
+        WritePairs(
+            MoveMask(And(x, y)), j, userData[body], userData, pairs);
+        open = MoveMask(starts) == 0xf;
+    }
+#endif
+
+    // remainder, or everything without simd
+    for (; open && j < end && minX[j] <= bounds.max.x; j++)
+    {
+        if (maxX[j] >= bounds.min.x && maxY[j] >= bounds.min.y &&
+            minY[j] <= bounds.max.y)
+        {
+            AddPair(pairs, userData[body], userData[j]);
+        }
+    }
+}
+
+Aabb GetShapeBounds(const CollisionShape& shape, glm::vec2 position)
+{
+    glm::vec2 extents = shape.type == ShapeType::Circle
+                            ? glm::vec2(shape.extents.x)
+                            : shape.extents;
+    return {position - extents, position + extents};
+}
+
+static float Sign(float value) { return value < 0.0f ? -1.0f : 1.0f; }
+
+static bool CollideCircles(
+    glm::vec2 centerA, float radiusA, glm::vec2 centerB, float radiusB,
+    Contact& contact)
+{
+    glm::vec2 offset = centerB - centerA;
+    float radius = radiusA + radiusB;
+    float distanceSquared = glm::dot(offset, offset);
+    if (distanceSquared > radius * radius)
+    {
+        return false;
+    }
+    float distance = std::sqrt(distanceSquared);
+    // concentric circles have no direction between them, any will do
+    contact.normal =
+        distance > 0.0f ? offset / distance : glm::vec2(0.0f, 1.0f);
+    contact.depth = radius - distance;
+    contact.point = centerA + contact.normal * (radiusA - contact.depth * 0.5f);
+    return true;
+}
+
+static bool CollideBoxes(
+    glm::vec2 centerA, glm::vec2 extentsA, glm::vec2 centerB,
+    glm::vec2 extentsB, Contact& contact)
+{
+    glm::vec2 offset = centerB - centerA;
+    glm::vec2 overlap = extentsA + extentsB - glm::abs(offset);
+    if (overlap.x < 0.0f || overlap.y < 0.0f)
+    {
+        return false;
+    }
+    // out along the shallower axis
+    if (overlap.x < overlap.y)
+    {
+        contact.normal = {Sign(offset.x), 0.0f};
+        contact.depth = overlap.x;
+    }
+    else
+    {
+        contact.normal = {0.0f, Sign(offset.y)};
+        contact.depth = overlap.y;
+    }
+    glm::vec2 overlapMin = glm::max(centerA - extentsA, centerB - extentsB);
+    glm::vec2 overlapMax = glm::min(centerA + extentsA, centerB + extentsB);
+    contact.point = (overlapMin + overlapMax) * 0.5f;
+    return true;
+}
+
+// normal from the circle toward the box
+static bool CollideCircleBox(
+    glm::vec2 center, float radius, glm::vec2 boxCenter, glm::vec2 extents,
+    Contact& contact)
+{
+    glm::vec2 local = center - boxCenter;
+    glm::vec2 closest = glm::clamp(local, -extents, extents);
+    if (closest != local)
+    {
+        glm::vec2 offset = closest - local;
+        float distanceSquared = glm::dot(offset, offset);
+        if (distanceSquared > radius * radius)
+        {
+            return false;
+        }
+        float distance = std::sqrt(distanceSquared);
+        contact.normal = offset / distance;
+        contact.depth = radius - distance;
+        contact.point = boxCenter + closest;
+        return true;
+    }
+
+    // center inside the box, the circle leaves through the nearest face
+    glm::vec2 faceDistance = extents - glm::abs(local);
+    if (faceDistance.x < faceDistance.y)
+    {
+        contact.normal = {-Sign(local.x), 0.0f};
+        contact.depth = faceDistance.x + radius;
+    }
+    else
+    {
+        contact.normal = {0.0f, -Sign(local.y)};
+        contact.depth = faceDistance.y + radius;
+    }
+    contact.point = center;
+    return true;
+}
+
+bool Collide(
+    const CollisionShape& a, glm::vec2 positionA, const CollisionShape& b,
+    glm::vec2 positionB, Contact& contact)
+{
+    if (a.type == ShapeType::Circle && b.type == ShapeType::Circle)
+    {
+        return CollideCircles(
+            positionA, a.extents.x, positionB, b.extents.x, contact);
+    }
+    if (a.type == ShapeType::Box && b.type == ShapeType::Box)
+    {
+        return CollideBoxes(
+            positionA, a.extents, positionB, b.extents, contact);
+    }
+    if (a.type == ShapeType::Circle)
+    {
+        return CollideCircleBox(
+            positionA, a.extents.x, positionB, b.extents, contact);
+    }
+    if (!CollideCircleBox(
+            positionB, b.extents.x, positionA, a.extents, contact))
+    {
+        return false;
+    }
+    contact.normal = -contact.normal;
+    return true;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "Culling.hpp"
+#include "JobSystem.hpp"
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <vector>
+
+using CollisionProxy = uint32_t;
+
+// bodies swept by one job in FindPairs, small enough that a few hundred
+// thousand bodies still spread over every worker
+constexpr size_t BROADPHASE_BLOCK_SIZE = 4096;
+
+// two bodies whose boxes overlap, by user data with a < b
+struct CollisionPair
+{
+    uint32_t a;
+    uint32_t b;
+
+    bool operator==(const CollisionPair&) const = default;
+};
+
+// sort and sweep over the x axis, run separately in horizontal bands so a
+// level that is as tall as it is wide does not put thousands of bodies in
+// every body's x interval. a body belongs to the band its bottom edge is
+// in, it is swept against the rest of its band and the bands above that its
+// box reaches into. bounds are kept in separate arrays in sweep order and 4
+// or 8 bodies are tested at a time.
+// bodies move a little between ticks, so last tick's order is nearly sorted
+// already and an insertion sort fixes it in about linear time. the few
+// bodies that changed band are sorted on their own and merged back in
+class Broadphase
+{
+public:
+    // a few times the typical body height, smaller bands sweep fewer bodies
+    // but tall bodies then reach into more of them
+    Broadphase(float bandHeight = 4.0f);
+
+    CollisionProxy Insert(const Aabb& bounds, uint32_t userData);
+    void Update(CollisionProxy proxy, const Aabb& bounds);
+    void Remove(CollisionProxy proxy);
+
+    // replaces pairs with every overlapping pair, sweeping on the job
+    // system. pairs come out in the same order for the same bodies and
+    // bounds, however the jobs were scheduled
+    void FindPairs(JobSystem& jobs, std::vector<CollisionPair>& pairs);
+
+    float GetBandHeight() const { return m_BandHeight; }
+    size_t GetProxyCount() const { return m_ProxyCount; }
+
+private:
+    struct ProxyRecord
+    {
+        Aabb bounds{};
+        uint32_t userData = 0;
+        bool alive = false;
+    };
+
+    // carries a copy of the body so the sweep arrays are filled in order,
+    // rather than from the records in proxy order
+    struct SortKey
+    {
+        int32_t band;
+        CollisionProxy proxy;
+        uint32_t userData;
+        Aabb bounds;
+    };
+
+    // a run of bodies in sweep order sharing a band
+    struct BandRange
+    {
+        int32_t band;
+        size_t begin;
+        size_t end;
+        // widest box in the band, bounds how far left of a body a box
+        // reaching it can start
+        float maxWidth;
+    };
+
+    // sweep order, by band and then by left edge
+    static bool SweepsBefore(const SortKey& a, const SortKey& b);
+    int32_t GetBand(float y) const;
+    SortKey GetSortKey(CollisionProxy proxy) const;
+    void Sort();
+    // gives up once it has moved more than moveLimit bodies
+    bool InsertionSort(size_t moveLimit);
+    void Gather();
+    void
+    Sweep(size_t begin, size_t end, std::vector<CollisionPair>& pairs) const;
+    void SweepRun(
+        size_t body, size_t begin, size_t end,
+        std::vector<CollisionPair>& pairs) const;
+
+    float m_BandHeight;
+    std::vector<ProxyRecord> m_Records;
+    // only refilled by Sort, a removed proxy stays in m_Keys until then
+    std::vector<CollisionProxy> m_FreeProxies;
+    std::vector<CollisionProxy> m_Removed;
+    // not swept yet, merged in by Sort
+    std::vector<CollisionProxy> m_Inserted;
+    size_t m_ProxyCount = 0;
+
+    // every proxy by band and then by the left edge of its box, as they
+    // were when last sorted
+    std::vector<SortKey> m_Keys;
+    std::vector<SortKey> m_Movers;
+    std::vector<SortKey> m_Merged;
+    // the bounds copied out in sweep order
+    std::vector<float> m_MinX;
+    std::vector<float> m_MinY;
+    std::vector<float> m_MaxX;
+    std::vector<float> m_MaxY;
+    std::vector<uint32_t> m_UserData;
+    std::vector<BandRange> m_Bands;
+    // one per block, so jobs never share an output
+    std::vector<std::vector<CollisionPair>> m_BlockPairs;
+};
+
+enum class ShapeType : uint32_t
+{
+    Circle,
+    Box,
+};
+
+// axis aligned, centered on the body's position
+struct CollisionShape
+{
+    ShapeType type;
+    // half size for boxes, x is the radius for circles
+    glm::vec2 extents;
+};
+
+struct Contact
+{
+    // from the first shape toward the second, unit length
+    glm::vec2 normal;
+    // how far the shapes have to move apart along normal to only touch
+    float depth;
+    // inside both shapes, where a response pushes them apart
+    glm::vec2 point;
+};
+
+Aabb GetShapeBounds(const CollisionShape& shape, glm::vec2 position);
+// false, and contact untouched, when the shapes do not overlap
+bool Collide(
+    const CollisionShape& a, glm::vec2 positionA, const CollisionShape& b,
+    glm::vec2 positionB, Contact& contact);
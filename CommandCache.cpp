@@ -0,0 +1,61 @@
+#include "CommandCache.hpp"
+
+CommandCache::CommandCache(
+    Device& device, uint32_t queueFamilyIndex, size_t frameCount)
+    : m_FrameCount(frameCount),
+      m_CommandPool(
+          device.Get(),
+          vk::CommandPoolCreateInfo(
+              vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+              queueFamilyIndex))
+{
+}
+
+void CommandCache::Resize(Device& device, size_t imageCount)
+{
+    // images are new, nothing recorded against the old ones stays valid
+    Invalidate();
+    m_ImageCount = imageCount;
+    size_t count = m_FrameCount * imageCount;
+    if (count <= m_Entries.size())
+    {
+        return;
+    }
+    vk::raii::CommandBuffers allocated(
+        device.Get(), vk::CommandBufferAllocateInfo(
+                          *m_CommandPool, vk::CommandBufferLevel::ePrimary,
+                          static_cast<uint32_t>(count - m_Entries.size())));
+    m_Entries.reserve(count);
+    for (vk::raii::CommandBuffer& commandBuffer : allocated)
+    {
+        m_Entries.push_back({std::move(commandBuffer)});
+    }
+}
+
+vk::raii::CommandBuffer&
+CommandCache::Get(size_t frame, uint32_t imageIndex)
+{
+    return m_Entries.at(GetIndex(frame, imageIndex)).commandBuffer;
+}
+
+bool CommandCache::IsRecorded(size_t frame, uint32_t imageIndex) const
+{
+    return m_Entries.at(GetIndex(frame, imageIndex)).version == m_Version;
+}
+
+void CommandCache::MarkRecorded(size_t frame, uint32_t imageIndex)
+{
+    m_Entries.at(GetIndex(frame, imageIndex)).version = m_Version;
+}
+
+void CommandCache::MarkStale(size_t frame, uint32_t imageIndex)
+{
+    m_Entries.at(GetIndex(frame, imageIndex)).version = 0;
+}
+
+size_t CommandCache::GetIndex(size_t frame, uint32_t imageIndex) const
+{
+    // frame major, so a buffer belongs to the same frame whatever the image
+    // count and is never reused while an earlier submission is in flight
+    return static_cast<size_t>(imageIndex) * m_FrameCount + frame;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Device.hpp"
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+// command buffers that are recorded once and submitted again for as long as
+// nothing they were recorded from changes. there is one per frame in flight
+// and swapchain image, since both are baked into what gets recorded, and a
+// frame's fence guards its buffers like any other per frame resource. data
+// that changes every frame goes through mapped buffers, so only changes to
+// the commands themselves need a new recording
+class CommandCache
+{
+public:
+    CommandCache(Device& device, uint32_t queueFamilyIndex, size_t frameCount);
+
+    // after every swapchain recreate. buffers are only ever added, so ones
+    // from before that are still in flight are never freed
+    void Resize(Device& device, size_t imageCount);
+    // every recording made before this is stale
+    void Invalidate() { m_Version++; }
+
+    vk::raii::CommandBuffer& Get(size_t frame, uint32_t imageIndex);
+    // false when the buffer has to be recorded again before it is submitted
+    bool IsRecorded(size_t frame, uint32_t imageIndex) const;
+    // after recording the buffer, it stays valid until the next Invalidate
+    void MarkRecorded(size_t frame, uint32_t imageIndex);
+    // recorded for one submission only, such as a frame with a readback
+    void MarkStale(size_t frame, uint32_t imageIndex);
+
+private:
+    struct Entry
+    {
+        vk::raii::CommandBuffer commandBuffer;
+        // 0 before the first recording, versions start at 1
+        uint64_t version = 0;
+    };
+
+    size_t GetIndex(size_t frame, uint32_t imageIndex) const;
+
+    size_t m_FrameCount;
+    size_t m_ImageCount = 0;
+    uint64_t m_Version = 1;
+    vk::raii::CommandPool m_CommandPool;
+    std::vector<Entry> m_Entries;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Collision.hpp"
+#include <cstdint>
+#include <glm/vec2.hpp>
+
+// plain data components for the ECS, kept split per field so the hot systems
+// only pull in the arrays they actually touch
+
+struct Position
+{
+    glm::vec2 value;
+};
+
+struct Velocity
+{
+    glm::vec2 value;
+};
+
+struct Rotation
+{
+    float radians;
+};
+
+struct AngularVelocity
+{
+    float radiansPerSecond;
+};
+
+struct Scale
+{
+    glm::vec2 value;
+};
+
+// half size of the axis aligned box around the position, used for culling
+struct Bounds
+{
+    glm::vec2 halfExtents;
+};
+
+// level of the mesh's lod chain the entity was drawn with last frame, see
+// SelectLod
+struct MeshLodState
+{
+    uint32_t level = 0;
+};
+
+// the entity's slot in the application's SpatialGrid
+struct SpatialHandle
+{
+    uint32_t proxy;
+};
+
+// the entity's shape and its slot in the application's Broadphase
+struct Collider
+{
+    CollisionShape shape;
+    CollisionProxy proxy;
+};
@@ -0,0 +1,98 @@
+#include "Culling.hpp"
+#include "Simd.hpp"
+#include <bit>
+
+static bool Overlaps(const AabbArrays& bounds, size_t i, const Aabb& view)
+{
+    return bounds.maxX[i] >= view.min.x && bounds.minX[i] <= view.max.x &&
+           bounds.maxY[i] >= view.min.y && bounds.minY[i] <= view.max.y;
+}
+
+// appends the lane index of every set bit, lanes are visited low to high so
+// the output stays sorted
+static size_t WriteMask(uint32_t mask, size_t base, uint32_t* visible)
+{
+    size_t count = 0;
+    while (mask)
+    {
+        visible[count++] = static_cast<uint32_t>(base + std::countr_zero(mask));
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+size_t
+CullAabbsScalar(const AabbArrays& bounds, const Aabb& view, uint32_t* visible)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < bounds.count; i++)
+    {
+        // branchless compaction, the slot is always written but only kept
+        // when the test passes
+        visible[count] = static_cast<uint32_t>(i);
+        count += Overlaps(bounds, i, view);
+    }
+    return count;
+}
+
+size_t CullAabbs(const AabbArrays& bounds, const Aabb& view, uint32_t* visible)
+{
+    size_t count = 0;
+    size_t i = 0;
+
+#if defined(SIMD_AVX2)
+    const __m256 viewMinX = _mm256_set1_ps(view.min.x);
+    const __m256 viewMinY = _mm256_set1_ps(view.min.y);
+    const __m256 viewMaxX = _mm256_set1_ps(view.max.x);
+    const __m256 viewMaxY = _mm256_set1_ps(view.max.y);
+    for (; i + 8 <= bounds.count; i += 8)
+    {
+        __m256 x = _mm256_and_ps(
+            _mm256_cmp_ps(
+                _mm256_loadu_ps(bounds.maxX + i), viewMinX, _CMP_GE_OQ),
+            _mm256_cmp_ps(
+                _mm256_loadu_ps(bounds.minX + i), viewMaxX, _CMP_LE_OQ));
+        __m256 y = _mm256_and_ps(
+            _mm256_cmp_ps(
+                _mm256_loadu_ps(bounds.maxY + i), viewMinY, _CMP_GE_OQ),
+            _mm256_cmp_ps(
+                _mm256_loadu_ps(bounds.minY + i), viewMaxY, _CMP_LE_OQ));
+        uint32_t mask =
+            static_cast<uint32_t>(_mm256_movemask_ps(_mm256_and_ps(x, y)));
+        count += WriteMask(mask, i, visible + count);
+    }
+#elif defined(SIMD_FLOAT4)
+    using namespace Simd;
+    const Float4 viewMinX = Splat(view.min.x);
+    const Float4 viewMinY = Splat(view.min.y);
+    const Float4 viewMaxX = Splat(view.max.x);
+    const Float4 viewMaxY = Splat(view.max.y);
+    for (; i + 4 <= bounds.count; i += 4)
+    {
+        Float4 x = And(
+            GreaterEqual(Load(bounds.maxX + i), viewMinX),
+            LessEqual(Load(bounds.minX + i), viewMaxX));
+        Float4 y = And(
+            GreaterEqual(Load(bounds.maxY + i), viewMinY),
+            LessEqual(Load(bounds.minY + i), viewMaxY));
+        count += WriteMask(MoveMask(And(x, y)), i, visible + count);
+    }
+#endif
+
+    // remainder, or everything without simd
+    for (; i < bounds.count; i++)
+    {
+        visible[count] = static_cast<uint32_t>(i);
+        count += Overlaps(bounds, i, view);
+    }
+    return count;
+}
+
+const char* GetCullingInstructionSet()
+{
+#if defined(SIMD_AVX2)
+    return "avx2";
+#else
+    return GetSimdInstructionSet();
+#endif
+}
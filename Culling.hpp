@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+
+struct Aabb
+{
+    glm::vec2 min;
+    glm::vec2 max;
+};
+
+// bounds packed as separate arrays so one vector load covers the same field
+// of 4 (sse, neon) or 8 (avx2) objects
+struct AabbArrays
+{
+    const float* minX;
+    const float* minY;
+    const float* maxX;
+    const float* maxY;
+    size_t count;
+};
+
+// writes the index of every aabb overlapping view to visible, which must hold
+// bounds.count entries, and returns how many were written. indices come out
+// in ascending order
+size_t CullAabbs(const AabbArrays& bounds, const Aabb& view, uint32_t* visible);
+// reference version, also what CullAabbs falls back to without simd
+size_t
+CullAabbsScalar(const AabbArrays& bounds, const Aabb& view, uint32_t* visible);
+
+// instruction set CullAabbs was compiled for
+const char* GetCullingInstructionSet();
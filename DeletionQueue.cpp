@@ -0,0 +1,49 @@
+#include "DeletionQueue.hpp"
+
+uint64_t DeletionQueue::MarkSubmitted()
+{
+    std::scoped_lock lock(m_Mutex);
+    return m_PendingSerial++;
+}
+
+void DeletionQueue::Collect(
+    uint64_t completedSerial, std::chrono::microseconds budget)
+{
+    auto start = std::chrono::steady_clock::now();
+    while (true)
+    {
+        std::unique_ptr<RetiredBase> retired;
+        {
+            std::scoped_lock lock(m_Mutex);
+            if (m_Retired.empty() ||
+                m_Retired.front().serial > completedSerial)
+            {
+                return;
+            }
+            retired = std::move(m_Retired.front().retired);
+            m_Retired.pop_front();
+        }
+        // destroyed outside the lock, a driver call can take a while
+        retired.reset();
+        if (std::chrono::steady_clock::now() - start >= budget)
+        {
+            return;
+        }
+    }
+}
+
+void DeletionQueue::Flush()
+{
+    std::scoped_lock lock(m_Mutex);
+    // in the order retired, views are retired ahead of their images
+    while (!m_Retired.empty())
+    {
+        m_Retired.pop_front();
+    }
+}
+
+size_t DeletionQueue::GetPendingCount()
+{
+    std::scoped_lock lock(m_Mutex);
+    return m_Retired.size();
+}
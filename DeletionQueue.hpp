@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+// time per frame spent destroying retired resources, anything left over
+// waits for the next frame
+constexpr std::chrono::microseconds DELETION_BUDGET{250};
+
+// holds on to gpu resources that are no longer needed but may still be used
+// by submitted frames. every submission gets a serial, a resource retired
+// while building submission n is destroyed once the fence of n has
+// signalled, in the order resources were retired. anything movable can be
+// retired, vk::raii handles, Buffer or containers of them. retiring is
+// thread safe
+class DeletionQueue
+{
+public:
+    DeletionQueue() = default;
+    DeletionQueue(const DeletionQueue&) = delete;
+    // the device has to be idle by now
+    ~DeletionQueue() { Flush(); }
+
+    template <typename T> void Retire(T&& resource)
+    {
+        static_assert(
+            !std::is_lvalue_reference_v<T>, "resources are moved in");
+        auto retired = std::make_unique<Retired<T>>(std::move(resource));
+        std::scoped_lock lock(m_Mutex);
+        m_Retired.push_back({m_PendingSerial, std::move(retired)});
+    }
+
+    // after every queue submit, returns the serial of that submission
+    uint64_t MarkSubmitted();
+    // destroys what submissions up to completedSerial were holding on to,
+    // stops once budget is used up but always makes some progress
+    void Collect(
+        uint64_t completedSerial,
+        std::chrono::microseconds budget = DELETION_BUDGET);
+    // destroys everything, only once the device is idle
+    void Flush();
+
+    size_t GetPendingCount();
+
+private:
+    struct RetiredBase
+    {
+        virtual ~RetiredBase() = default;
+    };
+
+    template <typename T> struct Retired : RetiredBase
+    {
+        Retired(T&& resource) : resource(std::move(resource)) {}
+        T resource;
+    };
+
+    struct Entry
+    {
+        uint64_t serial;
+        std::unique_ptr<RetiredBase> retired;
+    };
+
+    std::mutex m_Mutex;
+    // ordered by serial, since serials only grow
+    std::deque<Entry> m_Retired;
+    // serial of the submission being built
+    uint64_t m_PendingSerial = 1;
+};
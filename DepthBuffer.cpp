@@ -0,0 +1,100 @@
+#include "DepthBuffer.hpp"
+#include "Log.hpp"
+#include <array>
+#include <utility>
+
+DepthBuffer::DepthBuffer(Device& device, vk::Extent2D extent)
+    : m_Format(PickDepthFormat(device)),
+      m_Image(CreateImage(device, extent)),
+      m_DeviceMemory(AllocateMemory(device)),
+      m_ImageView(CreateImageView(device))
+{
+}
+
+void DepthBuffer::Recreate(
+    Device& device, vk::Extent2D extent, DeletionQueue& deletions)
+{
+    // order matters, the view has to go before the image it points at
+    deletions.Retire(std::exchange(m_ImageView, nullptr));
+    deletions.Retire(std::exchange(m_Image, CreateImage(device, extent)));
+    deletions.Retire(std::move(m_DeviceMemory));
+    m_DeviceMemory = AllocateMemory(device);
+    m_ImageView = CreateImageView(device);
+}
+
+vk::Format DepthBuffer::PickDepthFormat(Device& device)
+{
+    // no stencil needed, so prefer the pure depth formats
+    constexpr std::array<vk::Format, 4> candidates = {
+        vk::Format::eD32Sfloat, vk::Format::eX8D24UnormPack32,
+        vk::Format::eD24UnormS8Uint, vk::Format::eD16Unorm};
+
+    for (vk::Format format : candidates)
+    {
+        vk::FormatProperties properties =
+            device.GetPhysicalDevice().getFormatProperties(format);
+        if (properties.optimalTilingFeatures &
+            vk::FormatFeatureFlagBits::eDepthStencilAttachment)
+        {
+            LogDebug(fmt::format("Depth format: {}", format));
+            return format;
+        }
+    }
+    LogError("No supported depth format found");
+    return vk::Format::eUndefined;
+}
+
+vk::raii::Image DepthBuffer::CreateImage(Device& device, vk::Extent2D extent)
+{
+    // depth is cleared on load and never stored, so tile based gpus can keep
+    // it entirely on chip
+    vk::ImageCreateInfo createInfo(
+        {}, vk::ImageType::e2D, m_Format, vk::Extent3D(extent, 1), 1, 1,
+        vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal,
+        vk::ImageUsageFlagBits::eDepthStencilAttachment |
+            vk::ImageUsageFlagBits::eTransientAttachment,
+        vk::SharingMode::eExclusive, 0, nullptr, vk::ImageLayout::eUndefined);
+
+    return device.Get().createImage(createInfo);
+}
+
+vk::raii::DeviceMemory DepthBuffer::AllocateMemory(Device& device)
+{
+    vk::MemoryRequirements memoryRequirements =
+        m_Image.getMemoryRequirements();
+
+    vk::PhysicalDeviceMemoryProperties memoryProperties =
+        device.GetPhysicalDevice().getMemoryProperties();
+
+    vk::MemoryPropertyFlags memoryPropertyFlags =
+        vk::MemoryPropertyFlagBits::eDeviceLocal;
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+    {
+        if ((memoryRequirements.memoryTypeBits & (1 << i)) &&
+            (memoryProperties.memoryTypes[i].propertyFlags &
+             vk::MemoryPropertyFlagBits::eLazilyAllocated))
+        {
+            memoryPropertyFlags = vk::MemoryPropertyFlagBits::eLazilyAllocated;
+            break;
+        }
+    }
+
+    uint32_t memoryTypeIndex =
+        device.FindMemoryType(memoryRequirements, memoryPropertyFlags);
+
+    vk::raii::DeviceMemory deviceMemory(
+        device.Get(),
+        vk::MemoryAllocateInfo(memoryRequirements.size, memoryTypeIndex));
+    m_Image.bindMemory(*deviceMemory, 0);
+    return deviceMemory;
+}
+
+vk::raii::ImageView DepthBuffer::CreateImageView(Device& device)
+{
+    vk::ImageSubresourceRange subresourceRange(
+        vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1);
+    vk::ImageViewCreateInfo createInfo(
+        {}, *m_Image, vk::ImageViewType::e2D, m_Format, {}, subresourceRange);
+
+    return device.Get().createImageView(createInfo);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "DeletionQueue.hpp"
+#include "Device.hpp"
+#include <vulkan/vulkan_raii.hpp>
+
+class DepthBuffer
+{
+public:
+    DepthBuffer(Device& device, vk::Extent2D extent);
+
+    // the old image is retired, frames in flight may still render to it
+    void Recreate(
+        Device& device, vk::Extent2D extent, DeletionQueue& deletions);
+
+    constexpr vk::Format GetFormat() { return m_Format; }
+    constexpr vk::raii::Image& GetImage() { return m_Image; }
+    constexpr vk::raii::ImageView& GetImageView() { return m_ImageView; }
+
+    static vk::Format PickDepthFormat(Device& device);
+
+private:
+    vk::raii::Image CreateImage(Device& device, vk::Extent2D extent);
+    vk::raii::DeviceMemory AllocateMemory(Device& device);
+    vk::raii::ImageView CreateImageView(Device& device);
+
+    vk::Format m_Format;
+    vk::raii::Image m_Image;
+    vk::raii::DeviceMemory m_DeviceMemory;
+    vk::raii::ImageView m_ImageView;
+};
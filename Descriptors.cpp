@@ -1,21 +1,27 @@
 #include "Descriptors.hpp"
+#include <array>
+#include <memory_resource>
 
 Descriptors::Descriptors(
-    Device& device, std::vector<Buffer<UniformBufferObject>>& uniformBuffers,
-    size_t imageCount)
+    Device& device, LayoutCache& layouts,
+    std::vector<Buffer<InstanceData>>& instanceBuffers, size_t imageCount)
     : m_DescriptorPool(CreateDescriptorPool(device, imageCount)),
-      m_DescriptorSetLayouts(CreateDescriptorSetLayouts(device, imageCount)),
-      m_DescriptorSets(CreateDescriptorSets(device))
+      m_DescriptorSetLayout(CreateDescriptorSetLayout(layouts)),
+      m_DescriptorSets(CreateDescriptorSets(device, imageCount))
 {
-    std::vector<vk::WriteDescriptorSet> descriptorWriteSets;
+    std::array<std::byte, 1024> scratch;
+    std::pmr::monotonic_buffer_resource memory(scratch.data(), scratch.size());
+    std::pmr::vector<vk::DescriptorBufferInfo> bufferInfos(&memory);
+    bufferInfos.reserve(imageCount);
+    std::pmr::vector<vk::WriteDescriptorSet> descriptorWriteSets(&memory);
     for (size_t i = 0; i < imageCount; i++)
     {
         // need a more dynamic solution
-        vk::DescriptorBufferInfo bufferInfo(
-            *uniformBuffers.at(i).Get(), 0, sizeof(UniformBufferObject));
+        bufferInfos.emplace_back(
+            *instanceBuffers.at(i).Get(), 0, instanceBuffers.at(i).size());
         descriptorWriteSets.emplace_back(
-            *m_DescriptorSets.at(i), 0, 0, vk::DescriptorType::eUniformBuffer,
-            nullptr, bufferInfo, nullptr);
+            *m_DescriptorSets.at(i), 0, 0, vk::DescriptorType::eStorageBuffer,
+            nullptr, bufferInfos.back(), nullptr);
     }
     device.Get().updateDescriptorSets(descriptorWriteSets, nullptr);
 }
@@ -24,42 +30,32 @@ vk::raii::DescriptorPool
 Descriptors::CreateDescriptorPool(Device& device, size_t imageCount)
 {
     vk::DescriptorPoolSize discriptorPoolSize(
-        vk::DescriptorType::eUniformBuffer, imageCount);
+        vk::DescriptorType::eStorageBuffer, imageCount);
     vk::DescriptorPoolCreateInfo createInfo(
         vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet, imageCount,
         discriptorPoolSize);
     return device.Get().createDescriptorPool(createInfo);
 }
 
-std::vector<vk::raii::DescriptorSetLayout>
-Descriptors::CreateDescriptorSetLayouts(Device& device, size_t imageCount)
+vk::DescriptorSetLayout
+Descriptors::CreateDescriptorSetLayout(LayoutCache& layouts)
 {
+    // per instance transforms, indexed by gl_InstanceIndex. per draw state
+    // goes through push constants instead
     vk::DescriptorSetLayoutBinding descriptorSetLayoutBinding(
-        0, vk::DescriptorType::eUniformBuffer, 1,
+        0, vk::DescriptorType::eStorageBuffer, 1,
         vk::ShaderStageFlagBits::eVertex);
-
-    m_DescriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
-
-    vk::DescriptorSetLayoutCreateInfo createInfo(
-        {}, m_DescriptorSetLayoutBindings);
-
-    std::vector<vk::raii::DescriptorSetLayout> descriptorSetLayouts;
-
-    for (size_t i = 0; i < imageCount; i++)
-    {
-        descriptorSetLayouts.emplace_back(
-            device.Get().createDescriptorSetLayout(createInfo));
-    }
-    return descriptorSetLayouts;
+    return layouts.GetDescriptorSetLayout({&descriptorSetLayoutBinding, 1});
 }
 
-vk::raii::DescriptorSets Descriptors::CreateDescriptorSets(Device& device)
+vk::raii::DescriptorSets
+Descriptors::CreateDescriptorSets(Device& device, size_t imageCount)
 {
-    std::vector<vk::DescriptorSetLayout> setLayouts;
-    for (auto& layout : m_DescriptorSetLayouts)
-    {
-        setLayouts.push_back(*layout);
-    }
+    // every frame's set has the same layout
+    std::array<std::byte, 256> scratch;
+    std::pmr::monotonic_buffer_resource memory(scratch.data(), scratch.size());
+    std::pmr::vector<vk::DescriptorSetLayout> setLayouts(
+        imageCount, m_DescriptorSetLayout, &memory);
 
     vk::DescriptorSetAllocateInfo allocInfo(*m_DescriptorPool, setLayouts);
     return vk::raii::DescriptorSets(device.Get(), allocInfo);
@@ -1,7 +1,8 @@
 #pragma once
 #include "Buffer.hpp"
 #include "Device.hpp"
-#include "UniformBuffer.hpp"
+#include "LayoutCache.hpp"
+#include "Transforms.hpp"
 #include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
@@ -9,12 +10,12 @@ class Descriptors
 {
 public:
     Descriptors(
-        Device& device,
-        std::vector<Buffer<UniformBufferObject>>& uniformBuffers,
-        size_t imageCount);
-    constexpr std::vector<vk::raii::DescriptorSetLayout>& GetLayouts()
+        Device& device, LayoutCache& layouts,
+        std::vector<Buffer<InstanceData>>& instanceBuffers, size_t imageCount);
+    // shared by every frame's set, owned by the layout cache
+    constexpr vk::DescriptorSetLayout GetLayout() const
     {
-        return m_DescriptorSetLayouts;
+        return m_DescriptorSetLayout;
     }
     constexpr vk::raii::DescriptorPool& GetPool() { return m_DescriptorPool; }
     constexpr vk::raii::DescriptorSets& GetSets() { return m_DescriptorSets; }
@@ -22,16 +23,13 @@ public:
 private:
     vk::raii::DescriptorPool
     CreateDescriptorPool(Device& device, size_t imageCount);
-    std::vector<vk::raii::DescriptorSetLayout>
-    CreateDescriptorSetLayouts(Device& device, size_t imageCount);
+    vk::DescriptorSetLayout CreateDescriptorSetLayout(LayoutCache& layouts);
     vk::raii::DescriptorSets
-    CreateDescriptorSets(Device& device);
+    CreateDescriptorSets(Device& device, size_t imageCount);
 
 private:
     vk::raii::DescriptorPool m_DescriptorPool;
-    // probably doesnt need to be a member variable
-    std::vector<vk::DescriptorSetLayoutBinding> m_DescriptorSetLayoutBindings;
-    std::vector<vk::raii::DescriptorSetLayout> m_DescriptorSetLayouts;
+    vk::DescriptorSetLayout m_DescriptorSetLayout;
     vk::raii::DescriptorSets m_DescriptorSets;
 
 };
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "Device.hpp"
 #include "vulkan/vulkan_beta.h"
+#include <array>
 #include <string_view>
 
 Device::Device(VulkanInstance& instance, Surface& surface)
@@ -10,8 +11,10 @@ Device::Device(VulkanInstance& instance, Surface& surface)
 
 vk::raii::Device Device::CreateDevice(Surface& surface)
 {
-    std::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos =
-        GetDeviceQueueCreateInfos(surface);
+    std::array<std::byte, 1024> scratch;
+    std::pmr::monotonic_buffer_resource memory(scratch.data(), scratch.size());
+    std::pmr::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos =
+        GetDeviceQueueCreateInfos(surface, memory);
     std::vector<const char*> deviceExtensions = GetDeviceExtentionNames();
 
     std::vector<const char*> deviceLayers;
@@ -23,13 +26,14 @@ vk::raii::Device Device::CreateDevice(Surface& surface)
     return m_PhysicalDevice.createDevice(createInfo);
 }
 
-std::vector<vk::DeviceQueueCreateInfo>
-Device::GetDeviceQueueCreateInfos(Surface& surface)
+std::pmr::vector<vk::DeviceQueueCreateInfo> Device::GetDeviceQueueCreateInfos(
+    Surface& surface, std::pmr::memory_resource& memory)
 {
     std::vector<vk::QueueFamilyProperties> queueFamilyProperties =
         m_PhysicalDevice.getQueueFamilyProperties();
 
-    std::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos;
+    std::pmr::vector<vk::DeviceQueueCreateInfo> deviceQueueCreateInfos(
+        &memory);
     deviceQueueCreateInfos.reserve(queueFamilyProperties.size());
 
     m_DeviceQueues.reserve(queueFamilyProperties.size());
@@ -83,6 +87,15 @@ std::vector<const char*> Device::GetDeviceExtentionNames()
             deviceExtensions.push_back(
                 VK_KHR_PORTABILITY_SUBSET_EXTENSION_NAME);
         }
+        // the instance already has get_physical_device_properties2, which
+        // it builds on
+        if (!strcmp(
+                extension.extensionName,
+                VK_EXT_MEMORY_BUDGET_EXTENSION_NAME))
+        {
+            deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            m_MemoryBudgetSupported = true;
+        }
     }
 
     return deviceExtensions;
@@ -94,6 +107,33 @@ vk::raii::PhysicalDevice& Device::GetPhysicalDevice()
     return m_PhysicalDevice;
 }
 
+std::optional<DeviceMemoryUsage> Device::GetDeviceLocalMemoryUsage()
+{
+    if (!m_MemoryBudgetSupported)
+    {
+        return std::nullopt;
+    }
+    auto chain = m_PhysicalDevice.getMemoryProperties2<
+        vk::PhysicalDeviceMemoryProperties2,
+        vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+    const vk::PhysicalDeviceMemoryProperties& properties =
+        chain.get<vk::PhysicalDeviceMemoryProperties2>().memoryProperties;
+    const vk::PhysicalDeviceMemoryBudgetPropertiesEXT& budget =
+        chain.get<vk::PhysicalDeviceMemoryBudgetPropertiesEXT>();
+
+    DeviceMemoryUsage usage{0, 0};
+    for (uint32_t i = 0; i < properties.memoryHeapCount; i++)
+    {
+        if (properties.memoryHeaps[i].flags &
+            vk::MemoryHeapFlagBits::eDeviceLocal)
+        {
+            usage.usedBytes += budget.heapUsage[i];
+            usage.budgetBytes += budget.heapBudget[i];
+        }
+    }
+    return usage;
+}
+
 uint32_t Device::FindMemoryType(
     vk::MemoryRequirements memoryRequirements,
     vk::MemoryPropertyFlags memoryPropertyFlags)
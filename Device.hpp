@@ -2,9 +2,20 @@
 #include "DeviceQueue.hpp"
 #include "Log.hpp"
 #include "Surface.hpp"
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
 #include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
+// device local memory across every heap that has it
+struct DeviceMemoryUsage
+{
+    uint64_t usedBytes;
+    // what the process can use before the driver starts evicting
+    uint64_t budgetBytes;
+};
+
 class Device
 {
 public:
@@ -13,14 +24,18 @@ public:
     // std::vector<vk::raii::PhysicalDevice>
     // GetPhysicalDevices(vk::raii::Instance& instance);
     // VkPhysicalDevice ChoosePhysicalDevice(vk::raii::Instance& instance);
-    std::vector<vk::DeviceQueueCreateInfo>
-    GetDeviceQueueCreateInfos(Surface& surface);
+    std::pmr::vector<vk::DeviceQueueCreateInfo> GetDeviceQueueCreateInfos(
+        Surface& surface, std::pmr::memory_resource& memory);
     std::vector<const char*> GetDeviceExtentionNames();
     vk::raii::Device CreateDevice(Surface& surface);
 
     vk::raii::Device& Get();
     vk::raii::PhysicalDevice& GetPhysicalDevice();
 
+    // this process's share, from VK_EXT_memory_budget. nothing when the
+    // device does not have it
+    std::optional<DeviceMemoryUsage> GetDeviceLocalMemoryUsage();
+
     uint32_t FindMemoryType(
         vk::MemoryRequirements memoryRequirements,
         vk::MemoryPropertyFlags memoryPropertyFlags);
@@ -33,5 +48,7 @@ public:
 private:
     std::vector<DeviceQueue> m_DeviceQueues;
     vk::raii::PhysicalDevice m_PhysicalDevice;
+    // set while the device is created
+    bool m_MemoryBudgetSupported = false;
     vk::raii::Device m_Device;
 };
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "DynamicResolution.hpp"
+#include <algorithm>
+#include <cmath>
+
+// quantize the scale so the render extent doesnt change on every frame
+constexpr float SCALE_STEPS = 64.0f;
+
+DynamicResolution::DynamicResolution(const DynamicResolutionConfig& config)
+{
+    SetConfig(config);
+}
+
+void DynamicResolution::SetConfig(const DynamicResolutionConfig& config)
+{
+    m_Config = config;
+    m_Config.maxScale = std::clamp(m_Config.maxScale, 0.1f, 2.0f);
+    m_Config.minScale = std::clamp(m_Config.minScale, 0.1f, m_Config.maxScale);
+    m_Scale = m_Config.maxScale;
+    m_FilteredTimeMs = 0.0f;
+}
+
+float DynamicResolution::Update(float frameTimeMs)
+{
+    if (!m_Config.enabled || frameTimeMs <= 0.0f)
+    {
+        return GetScale();
+    }
+
+    m_FilteredTimeMs =
+        m_FilteredTimeMs == 0.0f
+            ? frameTimeMs
+            : std::lerp(m_FilteredTimeMs, frameTimeMs, m_Config.smoothing);
+
+    // gpu cost goes roughly with pixel count, which is scale squared
+    float idealScale = m_Scale * std::sqrt(
+                                     m_Config.targetFrameTimeMs /
+                                     std::max(m_FilteredTimeMs, 0.01f));
+    float rate = idealScale < m_Scale ? m_Config.decreaseRate
+                                      : m_Config.increaseRate;
+    m_Scale += (idealScale - m_Scale) * rate;
+    m_Scale = std::clamp(m_Scale, m_Config.minScale, m_Config.maxScale);
+
+    return GetScale();
+}
+
+float DynamicResolution::GetScale() const
+{
+    if (!m_Config.enabled)
+    {
+        return m_Config.maxScale;
+    }
+    return std::clamp(
+        std::round(m_Scale * SCALE_STEPS) / SCALE_STEPS, m_Config.minScale,
+        m_Config.maxScale);
+}
+
+vk::Extent2D
+DynamicResolution::GetAllocationExtent(vk::Extent2D outputExtent) const
+{
+    return vk::Extent2D(
+        std::max(1u, static_cast<uint32_t>(
+                         std::ceil(outputExtent.width * m_Config.maxScale))),
+        std::max(1u, static_cast<uint32_t>(
+                         std::ceil(outputExtent.height * m_Config.maxScale))));
+}
+
+vk::Extent2D DynamicResolution::GetRenderExtent(vk::Extent2D outputExtent) const
+{
+    float scale = GetScale();
+    vk::Extent2D allocationExtent = GetAllocationExtent(outputExtent);
+    return vk::Extent2D(
+        std::clamp(
+            static_cast<uint32_t>(outputExtent.width * scale), 1u,
+            allocationExtent.width),
+        std::clamp(
+            static_cast<uint32_t>(outputExtent.height * scale), 1u,
+            allocationExtent.height));
+}
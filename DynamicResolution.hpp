@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vulkan/vulkan.hpp>
+
+struct DynamicResolutionConfig
+{
+    bool enabled = true;
+    float minScale = 0.5f;
+    float maxScale = 1.0f;
+    // budget for gpu time, leaves some headroom under a 60hz vblank
+    float targetFrameTimeMs = 15.0f;
+    // fraction of the distance to the ideal scale covered per frame, dropping
+    // resolution is faster than raising it so spikes recover quickly
+    float increaseRate = 0.05f;
+    float decreaseRate = 0.3f;
+    // exponential smoothing of the measured frame time
+    float smoothing = 0.2f;
+};
+
+class DynamicResolution
+{
+public:
+    DynamicResolution(const DynamicResolutionConfig& config = {});
+
+    void SetConfig(const DynamicResolutionConfig& config);
+    constexpr const DynamicResolutionConfig& GetConfig() { return m_Config; }
+
+    // feed the last measured frame time, returns the scale for the next frame
+    float Update(float frameTimeMs);
+
+    float GetScale() const;
+    // size of the backing target, everything is rendered into a sub rect of it
+    vk::Extent2D GetAllocationExtent(vk::Extent2D outputExtent) const;
+    vk::Extent2D GetRenderExtent(vk::Extent2D outputExtent) const;
+
+private:
+    DynamicResolutionConfig m_Config;
+    float m_Scale;
+    float m_FilteredTimeMs = 0.0f;
+};
@@ -0,0 +1,345 @@
+#include "ECS.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+
+namespace
+{
+    struct ComponentInfo
+    {
+        size_t size;
+        size_t alignment;
+    };
+
+    std::mutex s_ComponentMutex;
+    std::vector<ComponentInfo> s_Components;
+}
+
+ComponentId RegisterComponent(size_t size, size_t alignment)
+{
+    std::scoped_lock lock(s_ComponentMutex);
+    if (s_Components.size() >= MAX_COMPONENTS)
+    {
+        LogError(fmt::format(
+            "Too many component types, only {} are supported",
+            MAX_COMPONENTS));
+    }
+    if (alignment > COLUMN_ALIGNMENT)
+    {
+        LogError(fmt::format(
+            "Component alignment {} exceeds column alignment", alignment));
+    }
+    s_Components.push_back({size, alignment});
+    return static_cast<ComponentId>(s_Components.size() - 1);
+}
+
+static size_t GetComponentSize(ComponentId id)
+{
+    std::scoped_lock lock(s_ComponentMutex);
+    return s_Components.at(id).size;
+}
+
+Column::Column(size_t elementSize) : m_ElementSize(elementSize) {}
+
+Column::Column(Column&& other) noexcept
+    : m_Data(other.m_Data), m_ElementSize(other.m_ElementSize),
+      m_Count(other.m_Count), m_Capacity(other.m_Capacity)
+{
+    other.m_Data = nullptr;
+    other.m_Count = 0;
+    other.m_Capacity = 0;
+}
+
+Column::~Column()
+{
+    if (m_Data)
+    {
+        ::operator delete(m_Data, std::align_val_t(COLUMN_ALIGNMENT));
+    }
+}
+
+void Column::Reserve(size_t capacity)
+{
+    if (capacity <= m_Capacity)
+    {
+        return;
+    }
+    std::byte* data = static_cast<std::byte*>(::operator new(
+        capacity * m_ElementSize, std::align_val_t(COLUMN_ALIGNMENT)));
+    if (m_Data)
+    {
+        std::memcpy(data, m_Data, m_Count * m_ElementSize);
+        ::operator delete(m_Data, std::align_val_t(COLUMN_ALIGNMENT));
+    }
+    m_Data = data;
+    m_Capacity = capacity;
+}
+
+void Column::Resize(size_t count)
+{
+    if (count > m_Capacity)
+    {
+        Reserve(std::max(count, m_Capacity * 2));
+    }
+    if (count > m_Count)
+    {
+        std::memset(At(m_Count), 0, (count - m_Count) * m_ElementSize);
+    }
+    m_Count = count;
+}
+
+void Column::SwapRemove(size_t row)
+{
+    if (row != m_Count - 1)
+    {
+        std::memcpy(At(row), At(m_Count - 1), m_ElementSize);
+    }
+    m_Count--;
+}
+
+void Column::PushFrom(const Column& other, size_t row)
+{
+    Resize(m_Count + 1);
+    std::memcpy(At(m_Count - 1), other.At(row), m_ElementSize);
+}
+
+int Archetype::GetColumnIndex(ComponentId id) const
+{
+    auto it = std::lower_bound(components.begin(), components.end(), id);
+    if (it == components.end() || *it != id)
+    {
+        LogError(fmt::format("Archetype has no component {}", id));
+    }
+    return static_cast<int>(it - components.begin());
+}
+
+World::World()
+{
+    // archetype 0 is the empty one
+    GetOrCreateArchetype(0);
+}
+
+uint32_t World::GetOrCreateArchetype(ComponentMask mask)
+{
+    auto it = m_ArchetypeLookup.find(mask);
+    if (it != m_ArchetypeLookup.end())
+    {
+        return it->second;
+    }
+
+    Archetype archetype;
+    archetype.mask = mask;
+    for (ComponentMask bits = mask; bits; bits &= bits - 1)
+    {
+        ComponentId id = static_cast<ComponentId>(std::countr_zero(bits));
+        archetype.components.push_back(id);
+        archetype.columns.emplace_back(GetComponentSize(id));
+    }
+
+    uint32_t index = static_cast<uint32_t>(m_Archetypes.size());
+    m_Archetypes.push_back(std::move(archetype));
+    m_ArchetypeLookup.emplace(mask, index);
+    return index;
+}
+
+World::EntityRecord& World::GetRecord(Entity entity)
+{
+    if (!IsAlive(entity))
+    {
+        LogError(fmt::format("Entity {} is not alive", entity.index));
+    }
+    return m_Records.at(entity.index);
+}
+
+bool World::IsAlive(Entity entity) const
+{
+    return entity.index < m_Records.size() &&
+           m_Records.at(entity.index).alive &&
+           m_Records.at(entity.index).generation == entity.generation;
+}
+
+void World::AllocateEntities(size_t count, std::vector<Entity>& entities)
+{
+    entities.reserve(entities.size() + count);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t index;
+        if (!m_FreeIndices.empty())
+        {
+            index = m_FreeIndices.back();
+            m_FreeIndices.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(m_Records.size());
+            m_Records.emplace_back();
+        }
+        EntityRecord& record = m_Records.at(index);
+        record.alive = true;
+        entities.push_back({index, record.generation});
+    }
+    m_LiveCount += count;
+}
+
+void World::DestroyEntities(std::span<const Entity> entities)
+{
+    struct Removal
+    {
+        uint32_t archetype;
+        uint32_t row;
+    };
+    std::vector<Removal> removals;
+    removals.reserve(entities.size());
+    for (const Entity& entity : entities)
+    {
+        if (!IsAlive(entity))
+        {
+            continue;
+        }
+        EntityRecord& record = m_Records.at(entity.index);
+        removals.push_back({record.archetype, record.row});
+        record.alive = false;
+        record.generation++;
+        m_FreeIndices.push_back(entity.index);
+    }
+
+    // highest rows first, swap removal only ever pulls rows from the end so
+    // nothing still queued gets moved
+    std::sort(
+        removals.begin(), removals.end(),
+        [](const Removal& a, const Removal& b)
+        {
+            return a.archetype != b.archetype ? a.archetype < b.archetype
+                                              : a.row > b.row;
+        });
+    for (const Removal& removal : removals)
+    {
+        RemoveRow(removal.archetype, removal.row);
+    }
+    m_LiveCount -= removals.size();
+}
+
+void World::RemoveRow(uint32_t archetypeIndex, uint32_t row)
+{
+    Archetype& archetype = m_Archetypes.at(archetypeIndex);
+    for (Column& column : archetype.columns)
+    {
+        column.SwapRemove(row);
+    }
+    if (row != archetype.entities.size() - 1)
+    {
+        Entity moved = archetype.entities.back();
+        archetype.entities.at(row) = moved;
+        m_Records.at(moved.index).row = row;
+    }
+    archetype.entities.pop_back();
+}
+
+void World::MoveEntity(Entity entity, ComponentMask newMask)
+{
+    EntityRecord& record = GetRecord(entity);
+    uint32_t oldIndex = record.archetype;
+    uint32_t oldRow = record.row;
+    uint32_t newIndex = GetOrCreateArchetype(newMask);
+
+    // GetOrCreateArchetype may have grown m_Archetypes
+    Archetype& oldArchetype = m_Archetypes.at(oldIndex);
+    Archetype& newArchetype = m_Archetypes.at(newIndex);
+
+    uint32_t newRow = static_cast<uint32_t>(newArchetype.size());
+    newArchetype.entities.push_back(entity);
+    for (size_t i = 0; i < newArchetype.components.size(); i++)
+    {
+        ComponentId id = newArchetype.components.at(i);
+        Column& column = newArchetype.columns.at(i);
+        if (oldArchetype.mask & (ComponentMask(1) << id))
+        {
+            column.PushFrom(
+                oldArchetype.columns.at(oldArchetype.GetColumnIndex(id)),
+                oldRow);
+        }
+        else
+        {
+            column.Resize(newRow + 1);
+        }
+    }
+
+    RemoveRow(oldIndex, oldRow);
+    record.archetype = newIndex;
+    record.row = newRow;
+}
+
+void SystemScheduler::AddSystem(
+    const std::string& name, ComponentMask reads, ComponentMask writes,
+    const SystemFunction& system)
+{
+    m_Systems.push_back({name, reads, writes, system});
+    size_t index = m_Systems.size() - 1;
+
+    // goes in the first stage after the last one holding a conflicting
+    // system, which keeps the declared order between conflicting systems
+    size_t stage = 0;
+    for (size_t i = m_Stages.size(); i-- > 0;)
+    {
+        bool conflict = std::any_of(
+            m_Stages.at(i).begin(), m_Stages.at(i).end(),
+            [&](size_t other)
+            { return Conflicts(m_Systems.at(other), m_Systems.at(index)); });
+        if (conflict)
+        {
+            stage = i + 1;
+            break;
+        }
+    }
+    if (stage == m_Stages.size())
+    {
+        m_Stages.emplace_back();
+    }
+    m_Stages.at(stage).push_back(index);
+}
+
+bool SystemScheduler::Conflicts(const System& a, const System& b)
+{
+    return (a.writes & (b.reads | b.writes)) || (b.writes & a.reads);
+}
+
+void SystemScheduler::Run(World& world)
+{
+    for (const std::vector<size_t>& stage : m_Stages)
+    {
+        // two pointers fit std::function's inline storage, so with the task
+        // list kept between runs nothing here touches the heap
+        m_Tasks.clear();
+        for (size_t index : stage)
+        {
+            m_Tasks.push_back([system = &m_Systems.at(index), &world]()
+                              { system->function(world); });
+        }
+        if (m_Tasks.size() == 1)
+        {
+            m_Tasks.front()();
+        }
+        else if (m_Executor)
+        {
+            m_Executor(m_Tasks);
+        }
+        else
+        {
+            RunOnThreads(m_Tasks);
+        }
+    }
+}
+
+void SystemScheduler::RunOnThreads(std::span<std::function<void()>> tasks)
+{
+    std::vector<std::jthread> threads;
+    for (size_t i = 1; i < tasks.size(); i++)
+    {
+        threads.emplace_back(tasks[i]);
+    }
+    tasks.front()();
+}
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// archetype based entity component system. every unique set of components
+// gets its own archetype, which stores each component in its own aligned
+// array (structure of arrays), so queries walk memory linearly and hand out
+// spans that can be fed straight into simd code
+//
+// components have to be trivially copyable, rows are moved with memcpy
+
+struct Entity
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0;
+
+    bool operator==(const Entity&) const = default;
+};
+
+using ComponentId = uint32_t;
+using ComponentMask = uint64_t;
+
+constexpr size_t MAX_COMPONENTS = 64;
+// columns are aligned for avx loads
+constexpr size_t COLUMN_ALIGNMENT = 64;
+
+ComponentId RegisterComponent(size_t size, size_t alignment);
+
+template <typename T> ComponentId GetComponentId()
+{
+    if constexpr (std::is_const_v<T>)
+    {
+        // const and non const queries have to share one id
+        return GetComponentId<std::remove_const_t<T>>();
+    }
+    else
+    {
+        static_assert(
+            std::is_trivially_copyable_v<T>,
+            "components are moved with memcpy");
+        static const ComponentId id = RegisterComponent(sizeof(T), alignof(T));
+        return id;
+    }
+}
+
+template <typename... Components> ComponentMask GetComponentMask()
+{
+    return ((ComponentMask(1) << GetComponentId<Components>()) | ... | 0);
+}
+
+class Column
+{
+public:
+    Column(size_t elementSize);
+    Column(const Column&) = delete;
+    Column(Column&& other) noexcept;
+    ~Column();
+
+    void Reserve(size_t capacity);
+    void Resize(size_t count);
+    void SwapRemove(size_t row);
+    // appends a copy of other's row
+    void PushFrom(const Column& other, size_t row);
+
+    std::byte* Data() { return m_Data; }
+    std::byte* At(size_t row) { return m_Data + row * m_ElementSize; }
+    const std::byte* At(size_t row) const
+    {
+        return m_Data + row * m_ElementSize;
+    }
+    size_t size() const { return m_Count; }
+
+private:
+    std::byte* m_Data = nullptr;
+    size_t m_ElementSize;
+    size_t m_Count = 0;
+    size_t m_Capacity = 0;
+};
+
+struct Archetype
+{
+    ComponentMask mask = 0;
+    // sorted component ids, parallel to columns
+    std::vector<ComponentId> components;
+    std::vector<Column> columns;
+    std::vector<Entity> entities;
+
+    int GetColumnIndex(ComponentId id) const;
+
+    template <typename T> T* Data()
+    {
+        int column = GetColumnIndex(GetComponentId<T>());
+        return reinterpret_cast<T*>(columns.at(column).Data());
+    }
+    size_t size() const { return entities.size(); }
+};
+
+class World
+{
+public:
+    World();
+
+    // creates count entities sharing one archetype in a single allocation
+    template <typename... Components>
+    std::vector<Entity> CreateEntities(
+        size_t count, const Components&... components);
+    template <typename... Components>
+    Entity CreateEntity(const Components&... components)
+    {
+        return CreateEntities<Components...>(1, components...).front();
+    }
+
+    // destroys a batch, grouped so every archetype is compacted once
+    void DestroyEntities(std::span<const Entity> entities);
+    void DestroyEntity(Entity entity) { DestroyEntities({&entity, 1}); }
+
+    bool IsAlive(Entity entity) const;
+    // the entity currently holding index, for indices stored outside the
+    // world such as spatial index user data
+    Entity GetEntity(uint32_t index) const
+    {
+        return {index, m_Records.at(index).generation};
+    }
+    size_t GetEntityCount() const { return m_LiveCount; }
+
+    template <typename T> bool Has(Entity entity);
+    template <typename T> T& Get(Entity entity);
+    template <typename T> void Add(Entity entity, const T& component);
+    template <typename T> void Remove(Entity entity);
+
+    // calls f(Entity, Components&...) for every entity that has all of them,
+    // const components are read only
+    template <typename... Components, typename Function>
+    void Each(Function&& function);
+    // calls f(span<const Entity>, span<Components>...) once per archetype,
+    // this is the path for batch and simd work
+    template <typename... Components, typename Function>
+    void EachChunk(Function&& function);
+    template <typename... Components> size_t Count();
+
+private:
+    struct EntityRecord
+    {
+        uint32_t generation = 0;
+        uint32_t archetype = 0;
+        uint32_t row = 0;
+        bool alive = false;
+    };
+
+    uint32_t GetOrCreateArchetype(ComponentMask mask);
+    EntityRecord& GetRecord(Entity entity);
+    void AllocateEntities(size_t count, std::vector<Entity>& entities);
+    // moves an entity's row into the archetype with the new mask
+    void MoveEntity(Entity entity, ComponentMask newMask);
+    void RemoveRow(uint32_t archetypeIndex, uint32_t row);
+
+    std::vector<Archetype> m_Archetypes;
+    std::unordered_map<ComponentMask, uint32_t> m_ArchetypeLookup;
+    std::vector<EntityRecord> m_Records;
+    std::vector<uint32_t> m_FreeIndices;
+    size_t m_LiveCount = 0;
+};
+
+template <typename... Components>
+std::vector<Entity>
+World::CreateEntities(size_t count, const Components&... components)
+{
+    std::vector<Entity> entities;
+    AllocateEntities(count, entities);
+
+    uint32_t archetypeIndex =
+        GetOrCreateArchetype(GetComponentMask<Components...>());
+    Archetype& archetype = m_Archetypes.at(archetypeIndex);
+
+    uint32_t firstRow = static_cast<uint32_t>(archetype.size());
+    archetype.entities.insert(
+        archetype.entities.end(), entities.begin(), entities.end());
+    for (Column& column : archetype.columns)
+    {
+        column.Resize(archetype.size());
+    }
+
+    auto fill = [&]<typename T>(const T& component)
+    {
+        T* data = archetype.Data<T>();
+        std::fill(data + firstRow, data + firstRow + count, component);
+    };
+    (fill(components), ...);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        EntityRecord& record = m_Records.at(entities.at(i).index);
+        record.archetype = archetypeIndex;
+        record.row = firstRow + i;
+    }
+    return entities;
+}
+
+template <typename T> bool World::Has(Entity entity)
+{
+    const EntityRecord& record = GetRecord(entity);
+    return m_Archetypes.at(record.archetype).mask &
+           (ComponentMask(1) << GetComponentId<T>());
+}
+
+template <typename T> T& World::Get(Entity entity)
+{
+    const EntityRecord& record = GetRecord(entity);
+    return m_Archetypes.at(record.archetype).Data<T>()[record.row];
+}
+
+template <typename T> void World::Add(Entity entity, const T& component)
+{
+    EntityRecord& record = GetRecord(entity);
+    ComponentMask mask = m_Archetypes.at(record.archetype).mask;
+    ComponentMask bit = ComponentMask(1) << GetComponentId<T>();
+    if (!(mask & bit))
+    {
+        MoveEntity(entity, mask | bit);
+    }
+    Get<T>(entity) = component;
+}
+
+template <typename T> void World::Remove(Entity entity)
+{
+    EntityRecord& record = GetRecord(entity);
+    ComponentMask mask = m_Archetypes.at(record.archetype).mask;
+    ComponentMask bit = ComponentMask(1) << GetComponentId<T>();
+    if (mask & bit)
+    {
+        MoveEntity(entity, mask & ~bit);
+    }
+}
+
+template <typename... Components, typename Function>
+void World::Each(Function&& function)
+{
+    EachChunk<Components...>(
+        [&](std::span<const Entity> entities, std::span<Components>... data)
+        {
+            for (size_t i = 0; i < entities.size(); i++)
+            {
+                function(entities[i], data[i]...);
+            }
+        });
+}
+
+template <typename... Components, typename Function>
+void World::EachChunk(Function&& function)
+{
+    ComponentMask mask = GetComponentMask<Components...>();
+    for (Archetype& archetype : m_Archetypes)
+    {
+        if ((archetype.mask & mask) != mask || archetype.size() == 0)
+        {
+            continue;
+        }
+        function(
+            std::span<const Entity>(archetype.entities),
+            std::span<Components>(
+                archetype.Data<Components>(), archetype.size())...);
+    }
+}
+
+template <typename... Components> size_t World::Count()
+{
+    size_t count = 0;
+    ComponentMask mask = GetComponentMask<Components...>();
+    for (Archetype& archetype : m_Archetypes)
+    {
+        if ((archetype.mask & mask) == mask)
+        {
+            count += archetype.size();
+        }
+    }
+    return count;
+}
+
+// groups systems into stages where no two systems touch the same component
+// with at least one of them writing, each stage can then run in parallel.
+// systems must not create or destroy entities, do that between runs
+class SystemScheduler
+{
+public:
+    using SystemFunction = std::function<void(World&)>;
+    // runs every task and returns once all of them are done
+    using Executor = std::function<void(std::span<std::function<void()>>)>;
+
+    // const components are reads, everything else is a write
+    template <typename... Components>
+    void AddSystem(const std::string& name, const SystemFunction& system)
+    {
+        ComponentMask reads = 0;
+        ComponentMask writes = 0;
+        ((std::is_const_v<Components>
+              ? reads |= ComponentMask(1) << GetComponentId<Components>()
+              : writes |= ComponentMask(1) << GetComponentId<Components>()),
+         ...);
+        AddSystem(name, reads, writes, system);
+    }
+    void AddSystem(
+        const std::string& name, ComponentMask reads, ComponentMask writes,
+        const SystemFunction& system);
+
+    void Run(World& world);
+    void SetExecutor(const Executor& executor) { m_Executor = executor; }
+
+    size_t GetStageCount() const { return m_Stages.size(); }
+
+private:
+    struct System
+    {
+        std::string name;
+        ComponentMask reads;
+        ComponentMask writes;
+        SystemFunction function;
+    };
+
+    static bool Conflicts(const System& a, const System& b);
+    void RunOnThreads(std::span<std::function<void()>> tasks);
+
+    std::vector<System> m_Systems;
+    // indices into m_Systems
+    std::vector<std::vector<size_t>> m_Stages;
+    Executor m_Executor;
+    // one stage's tasks, kept so Run reuses the capacity
+    std::vector<std::function<void()>> m_Tasks;
+};
@@ -0,0 +1,256 @@
+#include "FrameCapture.hpp"
+#include "Log.hpp"
+#include "Video.hpp"
+#include <cstring>
+
+// a CaptureChunk followed by the chunk's tiles
+constexpr size_t CAPTURE_CHUNK_BYTES =
+    sizeof(CaptureChunk) + sizeof(TileChunk::tiles);
+static_assert(CAPTURE_CHUNK_BYTES % 4 == 0);
+
+CaptureWriter::CaptureWriter(
+    const std::filesystem::path& path, vk::Extent2D extent,
+    uint32_t frameCount)
+    : m_Path(path), m_File(path, std::ios::binary | std::ios::trunc),
+      m_Header{
+          CAPTURE_MAGIC, CAPTURE_VERSION, 0, extent.width, extent.height, 0},
+      m_FramesLeft(frameCount)
+{
+    if (!m_File.is_open())
+    {
+        LogError(fmt::format("Could not write {}", path.string()));
+    }
+    // frame count is patched in once the capture is done
+    m_File.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+}
+
+CaptureWriter::~CaptureWriter()
+{
+    if (m_FramesLeft > 0)
+    {
+        LogWarning(fmt::format(
+            "Capture {} stopped early with {} frames", m_Path.string(),
+            m_Header.frameCount));
+        Finish();
+    }
+}
+
+void CaptureWriter::SetViewRotation(float theta)
+{
+    BeginRecord(CaptureRecord::ViewRotation, sizeof(theta));
+    Append(&theta, sizeof(theta));
+}
+
+void CaptureWriter::WriteInstances(const TransformArrays& transforms)
+{
+    uint32_t count = static_cast<uint32_t>(transforms.count);
+    BeginRecord(
+        CaptureRecord::Instances,
+        sizeof(count) + count * (sizeof(glm::vec2) * 2 + sizeof(float)));
+    Append(&count, sizeof(count));
+    Append(transforms.positions, count * sizeof(glm::vec2));
+    Append(transforms.rotations, count * sizeof(float));
+    Append(transforms.scales, count * sizeof(glm::vec2));
+}
+
+void CaptureWriter::Draw(std::span<const DrawItem> items)
+{
+    if (items.empty())
+    {
+        return;
+    }
+    BeginRecord(CaptureRecord::Draws, items.size_bytes());
+    Append(items.data(), items.size_bytes());
+}
+
+void CaptureWriter::DrawTileChunks(std::span<const TileChunk* const> chunks)
+{
+    uint32_t count = static_cast<uint32_t>(chunks.size());
+    BeginRecord(
+        CaptureRecord::TileChunks, sizeof(count) + count * CAPTURE_CHUNK_BYTES);
+    Append(&count, sizeof(count));
+    for (const TileChunk* chunk : chunks)
+    {
+        CaptureChunk header{
+            chunk->coord.x, chunk->coord.y,
+            static_cast<uint32_t>(chunk->version),
+            static_cast<uint32_t>(chunk->version >> 32)};
+        Append(&header, sizeof(header));
+        Append(chunk->tiles.data(), sizeof(chunk->tiles));
+    }
+}
+
+bool CaptureWriter::EndFrame()
+{
+    if (m_FramesLeft == 0)
+    {
+        return true;
+    }
+    BeginRecord(CaptureRecord::EndFrame, 0);
+    m_File.write(reinterpret_cast<const char*>(m_Frame.data()), m_Frame.size());
+    m_Frame.clear();
+    m_Header.frameCount++;
+    if (--m_FramesLeft > 0)
+    {
+        return false;
+    }
+    Finish();
+    LogDebug(fmt::format(
+        "Captured {} frames to {}", m_Header.frameCount, m_Path.string()));
+    return true;
+}
+
+void CaptureWriter::BeginRecord(CaptureRecord type, size_t size)
+{
+    CaptureRecordHeader header{type, static_cast<uint32_t>(size)};
+    Append(&header, sizeof(header));
+}
+
+void CaptureWriter::Append(const void* data, size_t size)
+{
+    const std::byte* bytes = static_cast<const std::byte*>(data);
+    m_Frame.insert(m_Frame.end(), bytes, bytes + size);
+}
+
+void CaptureWriter::Finish()
+{
+    m_FramesLeft = 0;
+    m_File.seekp(0);
+    m_File.write(reinterpret_cast<const char*>(&m_Header), sizeof(m_Header));
+    m_File.close();
+}
+
+CaptureReader::CaptureReader(const std::filesystem::path& path) : m_File(path)
+{
+    std::span<const std::byte> file = m_File.GetData();
+    if (file.size() < sizeof(CaptureHeader))
+    {
+        LogError(fmt::format("{} is not a frame capture", path.string()));
+    }
+    std::memcpy(&m_Header, file.data(), sizeof(m_Header));
+    if (m_Header.magic != CAPTURE_MAGIC)
+    {
+        LogError(fmt::format("{} is not a frame capture", path.string()));
+    }
+    if (m_Header.version != CAPTURE_VERSION)
+    {
+        LogError(fmt::format(
+            "{} has version {}, expected {}", path.string(), m_Header.version,
+            CAPTURE_VERSION));
+    }
+
+    // one pass up front so replay can jump straight to any frame, and a
+    // truncated file is caught here rather than halfway through a run
+    size_t offset = sizeof(CaptureHeader);
+    size_t frameStart = offset;
+    while (offset < file.size())
+    {
+        CaptureRecordHeader header;
+        if (file.size() - offset < sizeof(header))
+        {
+            break;
+        }
+        std::memcpy(&header, file.data() + offset, sizeof(header));
+        offset += sizeof(header);
+        if (file.size() - offset < header.size || header.size % 4 != 0)
+        {
+            break;
+        }
+        offset += header.size;
+        if (header.type == CaptureRecord::EndFrame)
+        {
+            m_Frames.push_back(frameStart);
+            frameStart = offset;
+        }
+    }
+    if (m_Frames.size() != m_Header.frameCount || offset != file.size())
+    {
+        LogError(fmt::format("{} is truncated or corrupt", path.string()));
+    }
+}
+
+void CaptureReader::Replay(uint32_t frame, Video& video) const
+{
+    std::span<const std::byte> file = m_File.GetData();
+    size_t offset = m_Frames.at(frame);
+    while (true)
+    {
+        CaptureRecordHeader header;
+        std::memcpy(&header, file.data() + offset, sizeof(header));
+        const std::byte* payload = file.data() + offset + sizeof(header);
+        offset += sizeof(header) + header.size;
+
+        switch (header.type)
+        {
+        case CaptureRecord::ViewRotation:
+        {
+            float theta;
+            std::memcpy(&theta, payload, sizeof(theta));
+            video.SetViewRotation(theta);
+            break;
+        }
+        case CaptureRecord::Instances:
+        {
+            uint32_t count;
+            std::memcpy(&count, payload, sizeof(count));
+            const std::byte* arrays = payload + sizeof(count);
+            // the same batches in the same order land at the same offsets,
+            // so the captured draws firstInstance still match
+            video.WriteInstances(
+                {reinterpret_cast<const glm::vec2*>(arrays),
+                 reinterpret_cast<const float*>(
+                     arrays + count * sizeof(glm::vec2)),
+                 reinterpret_cast<const glm::vec2*>(
+                     arrays + count * (sizeof(glm::vec2) + sizeof(float))),
+                 count});
+            break;
+        }
+        case CaptureRecord::Draws:
+        {
+            size_t count = header.size / sizeof(DrawItem);
+            for (size_t i = 0; i < count; i++)
+            {
+                DrawItem item;
+                std::memcpy(
+                    &item, payload + i * sizeof(DrawItem), sizeof(item));
+                video.GetRenderQueue().Submit(item);
+            }
+            break;
+        }
+        case CaptureRecord::TileChunks:
+        {
+            uint32_t count;
+            std::memcpy(&count, payload, sizeof(count));
+            if (header.size != sizeof(count) + count * CAPTURE_CHUNK_BYTES)
+            {
+                LogError("Capture tile chunk record has the wrong size");
+            }
+            const std::byte* chunkData = payload + sizeof(count);
+            std::vector<TileChunk> chunks(count);
+            std::vector<const TileChunk*> visible;
+            visible.reserve(count);
+            for (TileChunk& chunk : chunks)
+            {
+                CaptureChunk chunkHeader;
+                std::memcpy(&chunkHeader, chunkData, sizeof(chunkHeader));
+                chunkData += sizeof(chunkHeader);
+                std::memcpy(chunk.tiles.data(), chunkData, sizeof(chunk.tiles));
+                chunkData += sizeof(chunk.tiles);
+                chunk.coord = {chunkHeader.x, chunkHeader.y};
+                chunk.version =
+                    static_cast<uint64_t>(chunkHeader.versionHigh) << 32 |
+                    chunkHeader.versionLow;
+                visible.push_back(&chunk);
+            }
+            video.DrawTileChunks(visible);
+            break;
+        }
+        case CaptureRecord::EndFrame:
+            return;
+        default:
+            LogError(fmt::format(
+                "Unknown capture record {}",
+                static_cast<uint32_t>(header.type)));
+        }
+    }
+}
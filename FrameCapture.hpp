@@ -0,0 +1,119 @@
+#pragma once
+
+#include "AssetPack.hpp"
+#include "RenderQueue.hpp"
+#include "Tilemap.hpp"
+#include "Transforms.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+class Video;
+
+// renderer level command stream of a run of frames, everything the game
+// hands to Video, so a frame can be rendered again without the game state
+// that produced it
+//
+//   header
+//   records, each a CaptureRecordHeader followed by its payload, until an
+//   EndFrame record closes the frame
+//
+// every payload is a multiple of 4 bytes, so the arrays in it can be read
+// straight out of the mapping
+constexpr uint32_t CAPTURE_MAGIC = 0x50434655; // "UFCP"
+constexpr uint32_t CAPTURE_VERSION = 3;
+
+enum class CaptureRecord : uint32_t
+{
+    // float theta
+    ViewRotation = 0,
+    // uint32 count, then positions, rotations and scales, one array each
+    Instances = 1,
+    // DrawItem[], in submission order
+    Draws = 2,
+    EndFrame = 3,
+    // uint32 count, then a CaptureChunk and its tiles for every visible
+    // chunk. tiles are written every frame, so any frame replays on its own
+    TileChunks = 4
+};
+
+struct CaptureChunk
+{
+    int32_t x;
+    int32_t y;
+    // TileChunk::version, split so the payload stays 4 byte aligned
+    uint32_t versionLow;
+    uint32_t versionHigh;
+};
+
+struct CaptureHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t frameCount;
+    // swapchain extent while capturing
+    uint32_t width;
+    uint32_t height;
+    uint32_t reserved;
+};
+
+struct CaptureRecordHeader
+{
+    CaptureRecord type;
+    uint32_t size;
+};
+
+// frames are buffered in memory and written out whole at EndFrame, the file
+// is only valid once the last frame went out
+class CaptureWriter
+{
+public:
+    CaptureWriter(
+        const std::filesystem::path& path, vk::Extent2D extent,
+        uint32_t frameCount);
+    ~CaptureWriter();
+
+    void SetViewRotation(float theta);
+    void WriteInstances(const TransformArrays& transforms);
+    void Draw(std::span<const DrawItem> items);
+    void DrawTileChunks(std::span<const TileChunk* const> chunks);
+    // true once every requested frame is written
+    bool EndFrame();
+
+private:
+    void BeginRecord(CaptureRecord type, size_t size);
+    void Append(const void* data, size_t size);
+    void Finish();
+
+    std::filesystem::path m_Path;
+    std::ofstream m_File;
+    CaptureHeader m_Header;
+    std::vector<std::byte> m_Frame;
+    uint32_t m_FramesLeft;
+};
+
+class CaptureReader
+{
+public:
+    CaptureReader(const std::filesystem::path& path);
+
+    uint32_t GetFrameCount() const
+    {
+        return static_cast<uint32_t>(m_Frames.size());
+    }
+    vk::Extent2D GetExtent() const { return {m_Header.width, m_Header.height}; }
+
+    // issues one frame's calls against video in the order they were
+    // captured, rendering it is left to the caller
+    void Replay(uint32_t frame, Video& video) const;
+
+private:
+    MappedFile m_File;
+    CaptureHeader m_Header;
+    // offset of each frame's first record
+    std::vector<size_t> m_Frames;
+};
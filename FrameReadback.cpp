@@ -0,0 +1,289 @@
+#include "FrameReadback.hpp"
+#include "Log.hpp"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+void SavePng(const ReadbackImage& image, const std::filesystem::path& path)
+{
+    // sdl only reads from the pixels, the surface just wraps them
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(
+        const_cast<uint8_t*>(image.pixels.data()),
+        static_cast<int>(image.width), static_cast<int>(image.height), 32,
+        static_cast<int>(image.width * 4), SDL_PIXELFORMAT_RGBA32);
+    if (!surface)
+    {
+        LogError(fmt::format(
+            "Could not wrap {}: {}", path.string(), SDL_GetError()));
+    }
+    int result = IMG_SavePNG(surface, path.string().c_str());
+    SDL_FreeSurface(surface);
+    if (result != 0)
+    {
+        LogError(fmt::format(
+            "Could not save {}: {}", path.string(), IMG_GetError()));
+    }
+}
+
+ReadbackImage
+LoadPng(const std::filesystem::path& path, std::vector<uint8_t>& pixels)
+{
+    SDL_Surface* loaded = IMG_Load(path.string().c_str());
+    if (!loaded)
+    {
+        LogError(fmt::format(
+            "Could not load {}: {}", path.string(), IMG_GetError()));
+    }
+    SDL_Surface* surface =
+        SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!surface)
+    {
+        LogError(fmt::format(
+            "Could not convert {}: {}", path.string(), SDL_GetError()));
+    }
+
+    ReadbackImage image;
+    image.width = static_cast<uint32_t>(surface->w);
+    image.height = static_cast<uint32_t>(surface->h);
+    pixels.resize(image.width * image.height * 4);
+    for (uint32_t y = 0; y < image.height; y++)
+    {
+        std::memcpy(
+            pixels.data() + y * image.width * 4,
+            static_cast<const uint8_t*>(surface->pixels) + y * surface->pitch,
+            image.width * 4);
+    }
+    SDL_FreeSurface(surface);
+    // same as a readback, alpha is not part of the comparison
+    for (size_t i = 3; i < pixels.size(); i += 4)
+    {
+        pixels[i] = 255;
+    }
+    image.pixels = pixels;
+    return image;
+}
+
+ImageDifference CompareImages(
+    const ReadbackImage& a, const ReadbackImage& b, uint8_t tolerance,
+    std::vector<uint8_t>* diff)
+{
+    ImageDifference difference;
+    if (a.width != b.width || a.height != b.height)
+    {
+        difference.comparable = false;
+        return difference;
+    }
+    if (diff)
+    {
+        diff->assign(a.pixels.size(), 0);
+    }
+    for (size_t i = 0; i < a.pixels.size(); i += 4)
+    {
+        uint8_t pixelMax = 0;
+        for (size_t channel = 0; channel < 3; channel++)
+        {
+            int delta =
+                std::abs(a.pixels[i + channel] - b.pixels[i + channel]);
+            pixelMax = std::max(pixelMax, static_cast<uint8_t>(delta));
+        }
+        difference.maxChannel = std::max(difference.maxChannel, pixelMax);
+        if (pixelMax > tolerance)
+        {
+            difference.pixels++;
+            if (diff)
+            {
+                (*diff)[i] = 255;
+            }
+        }
+        if (diff)
+        {
+            (*diff)[i + 3] = 255;
+        }
+    }
+    return difference;
+}
+
+FrameReadback::FrameReadback(Surface& surface)
+{
+    vk::Format format = surface.surfaceFormat.format;
+    m_Bgra = format == vk::Format::eB8G8R8A8Unorm ||
+             format == vk::Format::eB8G8R8A8Srgb;
+    bool rgba = format == vk::Format::eR8G8B8A8Unorm ||
+                format == vk::Format::eR8G8B8A8Srgb;
+    bool transferSrc = static_cast<bool>(
+        surface.surfaceCapabilities.supportedUsageFlags &
+        vk::ImageUsageFlagBits::eTransferSrc);
+    m_Supported = (m_Bgra || rgba) && transferSrc;
+
+    m_Thread = std::thread([this]() { Run(); });
+}
+
+FrameReadback::~FrameReadback()
+{
+    {
+        std::scoped_lock lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_one();
+    m_Thread.join();
+}
+
+void FrameReadback::Request(ReadbackCallback callback)
+{
+    if (!m_Supported)
+    {
+        LogWarning("Swapchain images cant be read back");
+        return;
+    }
+    m_Requests.push_back(std::move(callback));
+}
+
+void FrameReadback::Record(
+    Device& device, vk::raii::CommandBuffer& commandBuffer, vk::Image image,
+    vk::Extent2D extent, size_t frame)
+{
+    if (m_Requests.empty())
+    {
+        return;
+    }
+
+    Slot* slot = nullptr;
+    {
+        std::scoped_lock lock(m_Mutex);
+        for (Slot& candidate : m_Slots)
+        {
+            if (candidate.state == SlotState::Free)
+            {
+                slot = &candidate;
+                break;
+            }
+        }
+    }
+    // every slot is busy, the request stays queued for a later frame
+    if (!slot)
+    {
+        return;
+    }
+
+    // a free slot is touched by nothing else, so no lock from here on
+    size_t bytes = static_cast<size_t>(extent.width) * extent.height * 4;
+    if (!slot->buffer || slot->buffer->size() < bytes)
+    {
+        slot->buffer = std::make_unique<Buffer<std::byte>>(
+            device, bytes, vk::BufferUsageFlagBits::eTransferDst);
+        // mapped here, the readback thread only reads
+        slot->buffer->GetMemory();
+    }
+
+    vk::BufferImageCopy region(
+        0, 0, 0, {vk::ImageAspectFlagBits::eColor, 0, 0, 1}, {},
+        vk::Extent3D(extent, 1));
+    commandBuffer.copyImageToBuffer(
+        image, vk::ImageLayout::eTransferSrcOptimal, *slot->buffer->Get(),
+        region);
+    // the fence alone does not make the copy visible to the host
+    vk::MemoryBarrier barrier(
+        vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eHostRead);
+    commandBuffer.pipelineBarrier(
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost,
+        {}, barrier, nullptr, nullptr);
+
+    slot->extent = extent;
+    slot->frame = frame;
+    slot->callback = std::move(m_Requests.front());
+    m_Requests.erase(m_Requests.begin());
+
+    std::scoped_lock lock(m_Mutex);
+    slot->state = SlotState::Copying;
+}
+
+void FrameReadback::OnFrameComplete(size_t frame)
+{
+    bool ready = false;
+    {
+        std::scoped_lock lock(m_Mutex);
+        for (size_t i = 0; i < m_Slots.size(); i++)
+        {
+            Slot& slot = m_Slots.at(i);
+            if (slot.state == SlotState::Copying && slot.frame == frame)
+            {
+                slot.state = SlotState::Converting;
+                m_Ready.push_back(i);
+                ready = true;
+            }
+        }
+    }
+    if (ready)
+    {
+        m_Wake.notify_one();
+    }
+}
+
+void FrameReadback::Wait()
+{
+    std::unique_lock lock(m_Mutex);
+    m_Done.wait(
+        lock,
+        [this]()
+        {
+            return std::none_of(
+                m_Slots.begin(), m_Slots.end(), [](const Slot& slot)
+                { return slot.state == SlotState::Converting; });
+        });
+}
+
+void FrameReadback::Run()
+{
+    std::unique_lock lock(m_Mutex);
+    while (true)
+    {
+        m_Wake.wait(lock, [this]() { return m_Stop || !m_Ready.empty(); });
+        // whatever was handed over is still delivered before stopping
+        if (m_Ready.empty())
+        {
+            return;
+        }
+        Slot& slot = m_Slots.at(m_Ready.front());
+        m_Ready.erase(m_Ready.begin());
+
+        lock.unlock();
+        Convert(slot);
+        lock.lock();
+
+        slot.callback = nullptr;
+        slot.state = SlotState::Free;
+        m_Done.notify_all();
+    }
+}
+
+void FrameReadback::Convert(Slot& slot)
+{
+    std::span<const std::byte> source = slot.buffer->GetMemory();
+    size_t bytes = static_cast<size_t>(slot.extent.width) *
+                   slot.extent.height * 4;
+    slot.pixels.resize(bytes);
+    uint8_t* pixels = slot.pixels.data();
+    std::memcpy(pixels, source.data(), bytes);
+    // presentation ignores alpha, so it is not worth keeping either
+    for (size_t i = 0; i < bytes; i += 4)
+    {
+        if (m_Bgra)
+        {
+            std::swap(pixels[i], pixels[i + 2]);
+        }
+        pixels[i + 3] = 255;
+    }
+
+    ReadbackImage image{slot.extent.width, slot.extent.height, slot.pixels};
+    try
+    {
+        slot.callback(image);
+    }
+    catch (std::exception& e)
+    {
+        LogWarning(fmt::format("Readback failed: {}", e.what()));
+    }
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Buffer.hpp"
+#include "Device.hpp"
+#include "Surface.hpp"
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+// readbacks that can be in flight or waiting for the readback thread at
+// once, further requests wait for a slot to come free
+constexpr size_t READBACK_SLOTS = 4;
+
+// tightly packed rgba8, alpha always 255, rows top to bottom
+struct ReadbackImage
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::span<const uint8_t> pixels;
+};
+
+struct ImageDifference
+{
+    // pixels with any channel further apart than the tolerance
+    uint64_t pixels = 0;
+    uint8_t maxChannel = 0;
+    // false when the sizes differ, nothing else is filled in then
+    bool comparable = true;
+};
+
+// runs on the readback thread, the image is only valid during the call
+using ReadbackCallback = std::function<void(const ReadbackImage&)>;
+
+void SavePng(const ReadbackImage& image, const std::filesystem::path& path);
+// the returned image points into pixels
+ReadbackImage
+LoadPng(const std::filesystem::path& path, std::vector<uint8_t>& pixels);
+// diff is filled with a red on black mask of the differing pixels when given
+ImageDifference CompareImages(
+    const ReadbackImage& a, const ReadbackImage& b, uint8_t tolerance,
+    std::vector<uint8_t>* diff = nullptr);
+
+// copies presented frames into a ring of host visible buffers. the copy is
+// recorded into the frame itself and picked up once that frame's fence has
+// signalled, which the renderer waits for anyway before reusing the frame,
+// so reading back never stalls the gpu or the render loop. conversion and
+// the callback run on a thread of their own
+class FrameReadback
+{
+public:
+    // after the swapchain, which fills in the surface capabilities
+    FrameReadback(Surface& surface);
+    FrameReadback(const FrameReadback&) = delete;
+    ~FrameReadback();
+
+    // swapchain images can only be copied from when the surface allows
+    // transfer src usage and the format is 8 bits per channel rgba or bgra
+    bool IsSupported() const { return m_Supported; }
+
+    // the next frame recorded is read back
+    void Request(ReadbackCallback callback);
+    bool HasRequests() const { return !m_Requests.empty(); }
+    // inside a pass that has image in transfer src layout
+    void Record(
+        Device& device, vk::raii::CommandBuffer& commandBuffer, vk::Image image,
+        vk::Extent2D extent, size_t frame);
+    // frame's fence has signalled, its copies go to the readback thread
+    void OnFrameComplete(size_t frame);
+    // blocks until the readback thread has delivered everything handed to
+    // it, copies of frames that have not completed are not waited for
+    void Wait();
+
+private:
+    enum class SlotState
+    {
+        Free,
+        // recorded, waiting on the frame's fence
+        Copying,
+        // with the readback thread
+        Converting
+    };
+
+    struct Slot
+    {
+        std::unique_ptr<Buffer<std::byte>> buffer;
+        vk::Extent2D extent;
+        size_t frame = 0;
+        SlotState state = SlotState::Free;
+        ReadbackCallback callback;
+        // rgba, reused between readbacks
+        std::vector<uint8_t> pixels;
+    };
+
+    void Run();
+    void Convert(Slot& slot);
+
+    bool m_Supported = false;
+    // bytes 0 and 2 swap on the way out
+    bool m_Bgra = false;
+    // game thread only
+    std::vector<ReadbackCallback> m_Requests;
+
+    // slot states and m_Ready are shared with the readback thread
+    std::array<Slot, READBACK_SLOTS> m_Slots;
+    std::mutex m_Mutex;
+    std::condition_variable m_Wake;
+    std::condition_variable m_Done;
+    std::vector<size_t> m_Ready;
+    bool m_Stop = false;
+    std::thread m_Thread;
+};
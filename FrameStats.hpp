@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vulkan/vulkan.hpp>
+
+struct FrameStats
+{
+    uint64_t frame = 0;
+    float cpuFrameTimeMs = 0.0f;
+    // from timestamp queries, lags a few frames behind. without timestamps
+    // it is the cpu frame time when presentation is not tied to vblank, and
+    // 0 when it is, dynamic resolution then holds its scale
+    float gpuTimeMs = 0.0f;
+    float renderScale = 1.0f;
+    vk::Extent2D renderExtent;
+    uint32_t drawCount = 0;
+    // false when the frame was submitted with command buffers recorded for
+    // an earlier one
+    bool commandsRecorded = true;
+    // from the oldest input event applied by the late latch to queueing the
+    // present of the frame it went into, kept from the last frame with input
+    float inputLatencyMs = 0.0f;
+    // performance warnings from the validation layers so far, stays 0 unless
+    // validation is enabled
+    uint64_t performanceWarnings = 0;
+    // global operator new calls on any thread from the end of the previous
+    // frame to the end of this one, 0 once the game is in steady state
+    uint64_t heapAllocations = 0;
+    uint64_t heapBytes = 0;
+    // taken from this frame's arena, past its capacity means it overflowed
+    // to the heap
+    size_t frameArenaBytes = 0;
+    // what the process holds rather than what it churns through, only
+    // sampled while the hud is visible. device memory is device local use
+    // and budget from VK_EXT_memory_budget, both 0 without it
+    uint64_t deviceMemoryBytes = 0;
+    uint64_t deviceMemoryBudget = 0;
+    uint64_t residentBytes = 0;
+};
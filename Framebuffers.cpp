@@ -1,18 +1,21 @@
 #include "Framebuffers.hpp"
+#include <array>
 
-Framebuffers::Framebuffers(
-    Swapchain& swapchain, RenderPass& renderPass, Device& device)
+void Framebuffers::Recreate(
+    std::span<const vk::ImageView> colorViews, RenderPass& renderPass,
+    DepthBuffer& depthBuffer, vk::Extent2D extent, Device& device,
+    DeletionQueue& deletions)
 {
-    vk::Extent2D swapchainExtent = swapchain.GetExtent();
-    std::vector<vk::raii::ImageView>& swapchainImageViews =
-        swapchain.GetImageViews();
-        
-    m_Framebuffers.reserve(swapchainImageViews.size());
-    for (auto& imageView : swapchainImageViews)
+    deletions.Retire(std::move(m_Framebuffers));
+    m_Framebuffers.clear();
+    m_Framebuffers.reserve(colorViews.size());
+    for (vk::ImageView imageView : colorViews)
     {
+        std::array<vk::ImageView, 2> attachments = {
+            imageView, *depthBuffer.GetImageView()};
         vk::FramebufferCreateInfo framebufferCreateInfo(
-            {}, *renderPass.Get(), *imageView, swapchainExtent.width,
-            swapchainExtent.height, 1);
+            {}, *renderPass.Get(), attachments, extent.width, extent.height,
+            1);
 
         m_Framebuffers.emplace_back(device.Get(), framebufferCreateInfo);
     }
@@ -1,16 +1,25 @@
+#include <span>
 #include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
+#include "DeletionQueue.hpp"
+#include "DepthBuffer.hpp"
 #include "Device.hpp"
 #include "RenderPass.hpp"
-#include "Swapchain.hpp"
 
 class Framebuffers
 {
 public:
-    Framebuffers(Swapchain& swapchain, RenderPass& renderPass, Device& device);
+    Framebuffers() = default;
     vk::raii::Framebuffer& operator[](size_t index);
 
+    // one framebuffer per color view, all sharing the same depth buffer. the
+    // old ones are retired
+    void Recreate(
+        std::span<const vk::ImageView> colorViews, RenderPass& renderPass,
+        DepthBuffer& depthBuffer, vk::Extent2D extent, Device& device,
+        DeletionQueue& deletions);
+
 private:
     std::vector<vk::raii::Framebuffer> m_Framebuffers;
-};
\ No newline at end of file
+};
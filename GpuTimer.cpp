@@ -0,0 +1,91 @@
+#include "GpuTimer.hpp"
+#include "Log.hpp"
+
+GpuTimer::GpuTimer(Device& device, uint32_t queueFamilyIndex, size_t frameCount)
+    : m_Pending(frameCount, false), m_QueryPool(nullptr)
+{
+    vk::PhysicalDeviceLimits limits =
+        device.GetPhysicalDevice().getProperties().limits;
+    uint32_t validBits = device.GetPhysicalDevice()
+                             .getQueueFamilyProperties()
+                             .at(queueFamilyIndex)
+                             .timestampValidBits;
+
+    m_Supported = validBits != 0 && limits.timestampPeriod > 0.0f;
+    m_TimestampPeriod = limits.timestampPeriod;
+    m_TimestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    if (m_Supported)
+    {
+        m_QueryPool = CreateQueryPool(device, frameCount);
+    }
+    else
+    {
+        LogWarning("GPU timestamps not supported");
+    }
+}
+
+vk::raii::QueryPool GpuTimer::CreateQueryPool(Device& device, size_t frameCount)
+{
+    vk::QueryPoolCreateInfo createInfo(
+        {}, vk::QueryType::eTimestamp, static_cast<uint32_t>(frameCount * 2));
+    return device.Get().createQueryPool(createInfo);
+}
+
+void GpuTimer::Reset(vk::raii::CommandBuffer& commandBuffer, size_t frame)
+{
+    if (!m_Supported)
+    {
+        return;
+    }
+    commandBuffer.resetQueryPool(
+        *m_QueryPool, static_cast<uint32_t>(frame * 2), 2);
+}
+
+void GpuTimer::Begin(vk::raii::CommandBuffer& commandBuffer, size_t frame)
+{
+    if (!m_Supported)
+    {
+        return;
+    }
+    commandBuffer.writeTimestamp(
+        vk::PipelineStageFlagBits::eTopOfPipe, *m_QueryPool,
+        static_cast<uint32_t>(frame * 2));
+}
+
+void GpuTimer::End(vk::raii::CommandBuffer& commandBuffer, size_t frame)
+{
+    if (!m_Supported)
+    {
+        return;
+    }
+    commandBuffer.writeTimestamp(
+        vk::PipelineStageFlagBits::eBottomOfPipe, *m_QueryPool,
+        static_cast<uint32_t>(frame * 2 + 1));
+}
+
+void GpuTimer::MarkSubmitted(size_t frame)
+{
+    m_Pending.at(frame) = m_Supported;
+}
+
+std::optional<float> GpuTimer::Resolve(size_t frame)
+{
+    if (!m_Supported || !m_Pending.at(frame))
+    {
+        return std::nullopt;
+    }
+
+    auto [result, timestamps] = m_QueryPool.getResults<uint64_t>(
+        static_cast<uint32_t>(frame * 2), 2, 2 * sizeof(uint64_t),
+        sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+    if (result != vk::Result::eSuccess)
+    {
+        return std::nullopt;
+    }
+    m_Pending.at(frame) = false;
+
+    uint64_t ticks =
+        (timestamps.at(1) - timestamps.at(0)) & m_TimestampMask;
+    return static_cast<float>(ticks * m_TimestampPeriod / 1'000'000.0);
+}
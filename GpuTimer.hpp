@@ -0,0 +1,37 @@
+#pragma once
+#include "Device.hpp"
+#include <optional>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+// measures gpu time of whole frames with a pair of timestamps per frame in
+// flight, results are only read back once the frame's fence has signalled
+class GpuTimer
+{
+public:
+    GpuTimer(Device& device, uint32_t queueFamilyIndex, size_t frameCount);
+
+    // outside any render pass, before Begin
+    void Reset(vk::raii::CommandBuffer& commandBuffer, size_t frame);
+    // after the first pass's barriers, a timestamp at the very start of the
+    // command buffer would count the queue and acquire waits as gpu time.
+    // vertex work that overlaps the acquire wait is still counted
+    void Begin(vk::raii::CommandBuffer& commandBuffer, size_t frame);
+    void End(vk::raii::CommandBuffer& commandBuffer, size_t frame);
+    // the frame's timestamps were submitted, recorded this frame or earlier
+    // in a command buffer that is submitted again
+    void MarkSubmitted(size_t frame);
+    // call after waiting on the frame's fence, nullopt if nothing was recorded
+    std::optional<float> Resolve(size_t frame);
+
+    constexpr bool IsSupported() { return m_Supported; }
+
+private:
+    vk::raii::QueryPool CreateQueryPool(Device& device, size_t frameCount);
+
+    bool m_Supported;
+    float m_TimestampPeriod;
+    uint64_t m_TimestampMask;
+    std::vector<bool> m_Pending;
+    vk::raii::QueryPool m_QueryPool;
+};
@@ -0,0 +1,432 @@
+#include "Hud.hpp"
+#include "PushConstants.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fmt/format.h>
+#include <utility>
+
+// the font covers printable ascii, 32 to 127, as 8 rows of 5 bits per glyph
+constexpr uint32_t FONT_FIRST = 32;
+constexpr uint32_t FONT_GLYPHS = 96;
+constexpr uint32_t FONT_ROWS = 8;
+// pixels per font pixel, glyphs are 5x7 in a 6x8 cell
+constexpr float HUD_SCALE = 2.0f;
+const glm::vec2 HUD_CELL{6.0f * HUD_SCALE, 8.0f * HUD_SCALE};
+const glm::vec2 HUD_ORIGIN{16.0f, 16.0f};
+constexpr float HUD_PADDING = 8.0f;
+constexpr float HUD_COLUMNS = 24.0f;
+// the graph is 2 pixels per frame and tops out at 40ms
+const glm::vec2 HUD_GRAPH_SIZE{HUD_HISTORY * 2.0f, 80.0f};
+constexpr float HUD_GRAPH_MS = 40.0f;
+
+constexpr uint32_t HudColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255)
+{
+    return r | g << 8 | b << 16 | static_cast<uint32_t>(a) << 24;
+}
+
+constexpr uint32_t HUD_PANEL_COLOR = HudColor(0, 0, 0, 176);
+constexpr uint32_t HUD_TEXT_COLOR = HudColor(255, 255, 255);
+constexpr uint32_t HUD_CPU_COLOR = HudColor(80, 200, 120);
+constexpr uint32_t HUD_GPU_COLOR = HudColor(255, 160, 40);
+constexpr uint32_t HUD_REFERENCE_COLOR = HudColor(255, 255, 255, 96);
+
+struct GlyphBitmap
+{
+    char character;
+    // top to bottom, the leftmost pixel in bit 4
+    std::array<uint8_t, 7> rows;
+};
+
+// only what the overlay prints, lowercase is drawn as uppercase and anything
+// missing comes out blank
+constexpr std::array<GlyphBitmap, 43> FONT = {{
+    {'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}},
+    {'1', {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}},
+    {'3', {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}},
+    {'4', {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}},
+    {'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+    {'6', {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}},
+    {'7', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+    {'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}},
+    {'9', {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},
+    {'A', {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}},
+    {'B', {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},
+    {'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}},
+    {'D', {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}},
+    {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}},
+    {'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},
+    {'G', {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}},
+    {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+    {'I', {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'J', {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}},
+    {'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}},
+    {'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},
+    {'M', {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}},
+    {'N', {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},
+    {'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'P', {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},
+    {'Q', {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}},
+    {'R', {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},
+    {'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}},
+    {'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+    {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}},
+    {'V', {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}},
+    {'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}},
+    {'X', {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},
+    {'Y', {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}},
+    {'Z', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},
+    {'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}},
+    {':', {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}},
+    {'/', {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}},
+    {'%', {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}},
+    {'-', {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}},
+    {'(', {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}},
+    {')', {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}},
+}};
+
+// formats into a fixed buffer so building the overlay never allocates,
+// anything past the end is cut off
+template <typename... Args>
+static std::string_view
+Format(std::span<char> out, fmt::format_string<Args...> format, Args&&... args)
+{
+    auto result = fmt::format_to_n(
+        out.data(), out.size(), format, std::forward<Args>(args)...);
+    return {out.data(), static_cast<size_t>(result.out - out.data())};
+}
+
+Hud::Hud(
+    Device& device, LayoutCache& layouts, vk::Format colorFormat,
+    size_t frameCount)
+    : m_Layouts(layouts), m_RenderPass(CreateRenderPass(device, colorFormat)),
+      m_Font(
+          device, FONT_GLYPHS * FONT_ROWS,
+          vk::BufferUsageFlagBits::eStorageBuffer),
+      m_DescriptorSetLayout(CreateDescriptorSetLayout()),
+      m_DescriptorPool(CreateDescriptorPool(device, frameCount)),
+      m_DescriptorSets(CreateDescriptorSets(device, frameCount))
+{
+    m_QuadBuffers.reserve(frameCount);
+    for (size_t i = 0; i < frameCount; i++)
+    {
+        m_QuadBuffers.emplace_back(
+            device, MAX_HUD_QUADS, vk::BufferUsageFlagBits::eStorageBuffer);
+        // mapped once up front and left mapped
+        m_QuadBuffers.back().GetMemory();
+    }
+    FillFont();
+    WriteDescriptorSets(device);
+}
+
+void Hud::FillFont()
+{
+    std::span<uint32_t> rows = m_Font.GetMemory();
+    std::fill(rows.begin(), rows.end(), 0);
+    for (const GlyphBitmap& glyph : FONT)
+    {
+        uint32_t index = static_cast<uint8_t>(glyph.character) - FONT_FIRST;
+        std::copy(
+            glyph.rows.begin(), glyph.rows.end(),
+            rows.begin() + index * FONT_ROWS);
+    }
+    for (uint32_t character = 'a'; character <= 'z'; character++)
+    {
+        uint32_t lower = (character - FONT_FIRST) * FONT_ROWS;
+        uint32_t upper = (character - 'a' + 'A' - FONT_FIRST) * FONT_ROWS;
+        std::copy_n(rows.begin() + upper, FONT_ROWS, rows.begin() + lower);
+    }
+}
+
+vk::raii::RenderPass Hud::CreateRenderPass(Device& device, vk::Format format)
+{
+    // drawn over what the earlier passes left in the image, the render graph
+    // has already moved it to color attachment layout
+    vk::AttachmentDescription colorAttachment(
+        {}, format, vk::SampleCountFlagBits::e1, vk::AttachmentLoadOp::eLoad,
+        vk::AttachmentStoreOp::eStore, vk::AttachmentLoadOp::eDontCare,
+        vk::AttachmentStoreOp::eDontCare,
+        vk::ImageLayout::eColorAttachmentOptimal,
+        vk::ImageLayout::eColorAttachmentOptimal);
+    vk::AttachmentReference colorAttachmentReference(
+        0, vk::ImageLayout::eColorAttachmentOptimal);
+    vk::SubpassDescription subpass(
+        {}, vk::PipelineBindPoint::eGraphics, {}, colorAttachmentReference);
+
+    vk::RenderPassCreateInfo renderPassCreateInfo({}, colorAttachment, subpass);
+    return device.Get().createRenderPass(renderPassCreateInfo);
+}
+
+vk::DescriptorSetLayout Hud::CreateDescriptorSetLayout()
+{
+    // quads are pulled by the vertex shader, glyph rows tested per fragment
+    std::array<vk::DescriptorSetLayoutBinding, 2> bindings = {{
+        {0, vk::DescriptorType::eStorageBuffer, 1,
+         vk::ShaderStageFlagBits::eVertex},
+        {1, vk::DescriptorType::eStorageBuffer, 1,
+         vk::ShaderStageFlagBits::eFragment},
+    }};
+    return m_Layouts.GetDescriptorSetLayout(bindings);
+}
+
+vk::raii::DescriptorPool
+Hud::CreateDescriptorPool(Device& device, size_t frameCount)
+{
+    vk::DescriptorPoolSize poolSize(
+        vk::DescriptorType::eStorageBuffer,
+        static_cast<uint32_t>(frameCount * 2));
+    vk::DescriptorPoolCreateInfo createInfo(
+        vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        static_cast<uint32_t>(frameCount), poolSize);
+    return device.Get().createDescriptorPool(createInfo);
+}
+
+vk::raii::DescriptorSets
+Hud::CreateDescriptorSets(Device& device, size_t frameCount)
+{
+    std::vector<vk::DescriptorSetLayout> setLayouts(
+        frameCount, m_DescriptorSetLayout);
+    vk::DescriptorSetAllocateInfo allocInfo(*m_DescriptorPool, setLayouts);
+    return vk::raii::DescriptorSets(device.Get(), allocInfo);
+}
+
+void Hud::WriteDescriptorSets(Device& device)
+{
+    vk::DescriptorBufferInfo fontInfo(*m_Font.Get(), 0, m_Font.size());
+    std::vector<vk::DescriptorBufferInfo> quadInfos;
+    quadInfos.reserve(m_QuadBuffers.size());
+    std::vector<vk::WriteDescriptorSet> writes;
+    for (size_t i = 0; i < m_QuadBuffers.size(); i++)
+    {
+        quadInfos.emplace_back(
+            *m_QuadBuffers.at(i).Get(), 0, m_QuadBuffers.at(i).size());
+        writes.emplace_back(
+            *m_DescriptorSets.at(i), 0, 0, vk::DescriptorType::eStorageBuffer,
+            nullptr, quadInfos.back(), nullptr);
+        writes.emplace_back(
+            *m_DescriptorSets.at(i), 1, 0, vk::DescriptorType::eStorageBuffer,
+            nullptr, fontInfo, nullptr);
+    }
+    device.Get().updateDescriptorSets(writes, nullptr);
+}
+
+void Hud::CreatePipeline(Device& device, const Shader& shader)
+{
+    m_PipelineLayout = m_Layouts.GetPipelineLayout(
+        shader, {&m_DescriptorSetLayout, 1},
+        PushConstantSize<HudConstants>::value);
+
+    std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages = {{
+        {{}, vk::ShaderStageFlagBits::eVertex, *shader.vertShaderModule,
+         "main"},
+        {{}, vk::ShaderStageFlagBits::eFragment, *shader.fragShaderModule,
+         "main"},
+    }};
+
+    // no vertex buffers, every vertex is built from gl_VertexIndex
+    vk::PipelineVertexInputStateCreateInfo vertexInputState{};
+    vk::PipelineInputAssemblyStateCreateInfo inputAssemblyState(
+        {}, vk::PrimitiveTopology::eTriangleList, {});
+    vk::PipelineViewportStateCreateInfo viewportState(
+        {}, 1, nullptr, 1, nullptr);
+
+    vk::PipelineRasterizationStateCreateInfo rasterizationState{};
+    rasterizationState.setCullMode(vk::CullModeFlagBits::eNone);
+    rasterizationState.setLineWidth(1.0f);
+
+    vk::PipelineMultisampleStateCreateInfo multisampleState{};
+
+    // quads are drawn in order, later ones blend over the panel
+    vk::PipelineColorBlendAttachmentState colorAttachment(
+        VK_TRUE, vk::BlendFactor::eSrcAlpha, vk::BlendFactor::eOneMinusSrcAlpha,
+        vk::BlendOp::eAdd, vk::BlendFactor::eOne, vk::BlendFactor::eZero,
+        vk::BlendOp::eAdd,
+        vk::FlagTraits<vk::ColorComponentFlagBits>::allFlags);
+    vk::PipelineColorBlendStateCreateInfo colorBlendState(
+        {}, VK_FALSE, vk::LogicOp::eClear, colorAttachment);
+
+    std::array<vk::DynamicState, 2> dynamicStates = {
+        vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+    vk::PipelineDynamicStateCreateInfo dynamicState({}, dynamicStates);
+
+    vk::GraphicsPipelineCreateInfo createInfo(
+        {}, shaderStages, &vertexInputState, &inputAssemblyState, {},
+        &viewportState, &rasterizationState, &multisampleState, nullptr,
+        &colorBlendState, &dynamicState, m_PipelineLayout, *m_RenderPass);
+
+    m_Pipeline = device.Get().createGraphicsPipeline(nullptr, createInfo);
+}
+
+void Hud::Recreate(
+    Device& device, std::span<const vk::ImageView> imageViews,
+    vk::Extent2D extent, DeletionQueue& deletions)
+{
+    m_Extent = extent;
+    deletions.Retire(std::move(m_Framebuffers));
+    m_Framebuffers.clear();
+    m_Framebuffers.reserve(imageViews.size());
+    for (vk::ImageView imageView : imageViews)
+    {
+        vk::FramebufferCreateInfo createInfo(
+            {}, *m_RenderPass, imageView, extent.width, extent.height, 1);
+        m_Framebuffers.emplace_back(device.Get(), createInfo);
+    }
+}
+
+void Hud::Update(const FrameStats& stats, size_t frame)
+{
+    m_CpuHistory.at(m_HistoryHead) = stats.cpuFrameTimeMs;
+    m_GpuHistory.at(m_HistoryHead) = stats.gpuTimeMs;
+    m_HistoryHead = (m_HistoryHead + 1) % HUD_HISTORY;
+
+    m_QuadCount = 0;
+    if (!m_Visible)
+    {
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+    m_Quads = m_QuadBuffers.at(frame).GetMemory();
+
+    constexpr size_t lines = 9;
+    glm::vec2 panelSize =
+        glm::vec2(
+            std::max(HUD_COLUMNS * HUD_CELL.x, HUD_GRAPH_SIZE.x),
+            lines * HUD_CELL.y + HUD_CELL.y / 2.0f + HUD_GRAPH_SIZE.y) +
+        2.0f * HUD_PADDING;
+    AddQuad(HUD_ORIGIN - HUD_PADDING, panelSize, HUD_PANEL_COLOR, HUD_SOLID);
+
+    std::array<char, 64> line;
+    glm::vec2 position = HUD_ORIGIN;
+    auto addLine = [&](std::string_view text)
+    {
+        AddText(position, text);
+        position.y += HUD_CELL.y;
+    };
+    addLine(Format(line, "FRAME {:7.2f} MS", stats.cpuFrameTimeMs));
+    addLine(Format(line, "GPU   {:7.2f} MS", stats.gpuTimeMs));
+    addLine(Format(line, "DRAWS {:7}", stats.drawCount));
+    addLine(Format(
+        line, "SCALE {:6.0f}% {}X{}", stats.renderScale * 100.0f,
+        stats.renderExtent.width, stats.renderExtent.height));
+    addLine(Format(
+        line, "HEAP  {:7} / {:.1f} KB", stats.heapAllocations,
+        stats.heapBytes / 1024.0f));
+    addLine(Format(line, "ARENA {:7.1f} KB", stats.frameArenaBytes / 1024.0f));
+    constexpr float mb = 1024.0f * 1024.0f;
+    if (stats.deviceMemoryBudget > 0)
+    {
+        addLine(Format(
+            line, "VRAM  {:7.1f} / {:.0f} MB", stats.deviceMemoryBytes / mb,
+            stats.deviceMemoryBudget / mb));
+    }
+    else
+    {
+        addLine("VRAM      N/A");
+    }
+    addLine(Format(line, "RSS   {:7.1f} MB", stats.residentBytes / mb));
+    addLine(Format(line, "HUD   {:7.3f} MS", m_UpdateMs));
+
+    position.y += HUD_CELL.y / 2.0f;
+    AddGraph(position);
+
+    m_UpdateMs = std::chrono::duration<float, std::milli>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+}
+
+void Hud::AddQuad(
+    glm::vec2 position, glm::vec2 size, uint32_t color, uint32_t glyph)
+{
+    // the layout is fixed, running out means MAX_HUD_QUADS is too small
+    if (m_QuadCount == m_Quads.size())
+    {
+        return;
+    }
+    m_Quads[m_QuadCount++] = {position, size, color, glyph};
+}
+
+void Hud::AddText(glm::vec2 position, std::string_view text)
+{
+    for (char character : text)
+    {
+        uint32_t code = static_cast<uint8_t>(character);
+        // spaces only move the pen
+        if (code > FONT_FIRST && code < FONT_FIRST + FONT_GLYPHS)
+        {
+            AddQuad(position, HUD_CELL, HUD_TEXT_COLOR, code - FONT_FIRST);
+        }
+        position.x += HUD_CELL.x;
+    }
+}
+
+void Hud::AddGraph(glm::vec2 position)
+{
+    float barWidth = HUD_GRAPH_SIZE.x / HUD_HISTORY;
+    float bottom = position.y + HUD_GRAPH_SIZE.y;
+    auto barHeight = [](float ms)
+    { return std::min(ms / HUD_GRAPH_MS, 1.0f) * HUD_GRAPH_SIZE.y; };
+
+    // oldest on the left, gpu over cpu since it is usually the shorter one
+    for (size_t i = 0; i < HUD_HISTORY; i++)
+    {
+        size_t index = (m_HistoryHead + i) % HUD_HISTORY;
+        float x = position.x + i * barWidth;
+        float cpuHeight = barHeight(m_CpuHistory.at(index));
+        float gpuHeight = barHeight(m_GpuHistory.at(index));
+        if (cpuHeight > 0.0f)
+        {
+            AddQuad(
+                {x, bottom - cpuHeight}, {barWidth, cpuHeight}, HUD_CPU_COLOR,
+                HUD_SOLID);
+        }
+        if (gpuHeight > 0.0f)
+        {
+            AddQuad(
+                {x, bottom - gpuHeight}, {barWidth, gpuHeight}, HUD_GPU_COLOR,
+                HUD_SOLID);
+        }
+    }
+
+    // 60 and 30 fps
+    for (float ms : {1000.0f / 60.0f, 1000.0f / 30.0f})
+    {
+        AddQuad(
+            {position.x, bottom - barHeight(ms)}, {HUD_GRAPH_SIZE.x, 1.0f},
+            HUD_REFERENCE_COLOR, HUD_SOLID);
+    }
+}
+
+void Hud::Record(
+    vk::raii::CommandBuffer& commandBuffer, size_t frame, uint32_t imageIndex)
+{
+    if (!m_Visible || m_QuadCount == 0)
+    {
+        return;
+    }
+
+    vk::RenderPassBeginInfo renderPassBeginInfo(
+        *m_RenderPass, *m_Framebuffers.at(imageIndex),
+        vk::Rect2D({}, m_Extent));
+    commandBuffer.beginRenderPass(
+        renderPassBeginInfo, vk::SubpassContents::eInline);
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *m_Pipeline);
+    commandBuffer.setViewport(
+        0, vk::Viewport(
+               0.0f, 0.0f, static_cast<float>(m_Extent.width),
+               static_cast<float>(m_Extent.height), 0.0f, 1.0f));
+    commandBuffer.setScissor(0, vk::Rect2D({}, m_Extent));
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics, m_PipelineLayout, 0,
+        *m_DescriptorSets.at(frame), nullptr);
+
+    HudConstants constants{
+        {2.0f / static_cast<float>(m_Extent.width),
+         2.0f / static_cast<float>(m_Extent.height)}};
+    PushConstants(
+        commandBuffer, m_PipelineLayout, vk::ShaderStageFlagBits::eVertex,
+        constants);
+
+    // every quad in one draw, 6 vertices each
+    commandBuffer.draw(m_QuadCount * 6, 1, 0, 0);
+    commandBuffer.endRenderPass();
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "Buffer.hpp"
+#include "DeletionQueue.hpp"
+#include "Device.hpp"
+#include "FrameStats.hpp"
+#include "LayoutCache.hpp"
+#include "Shader.hpp"
+#include <array>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+// capacity of each frame's quad buffer, text and graphs together
+constexpr uint32_t MAX_HUD_QUADS = 2048;
+// frames shown by the frame time graph
+constexpr size_t HUD_HISTORY = 120;
+// glyph index of a quad that is filled instead of drawn as a character
+constexpr uint32_t HUD_SOLID = UINT32_MAX;
+
+// one quad of the overlay, std430 layout matching Quad in hud.vert
+struct HudQuad
+{
+    // pixels from the top left of the swapchain image
+    glm::vec2 position;
+    glm::vec2 size;
+    // rgba8, red in the low byte
+    uint32_t color;
+    // character code - 32 into the font, or HUD_SOLID
+    uint32_t glyph;
+};
+
+// matches the push_constant block in hud.vert
+struct HudConstants
+{
+    glm::vec2 pixelToClip;
+};
+
+// performance overlay drawn straight onto the swapchain image after
+// everything else. the font is a small bitmap baked into the binary and
+// packed into a storage buffer once, every frame the text and graphs are
+// written as quads into that frame's mapped buffer and drawn with a single
+// non-indexed draw, the vertex shader expanding each quad from
+// gl_VertexIndex
+class Hud
+{
+public:
+    Hud(
+        Device& device, LayoutCache& layouts, vk::Format colorFormat,
+        size_t frameCount);
+    Hud(const Hud&) = delete;
+
+    // shaders load after the renderer is up, Record must not be called
+    // before this
+    void CreatePipeline(Device& device, const Shader& shader);
+    // one framebuffer per swapchain image, after every swapchain recreate.
+    // the old ones are retired
+    void Recreate(
+        Device& device, std::span<const vk::ImageView> imageViews,
+        vk::Extent2D extent, DeletionQueue& deletions);
+
+    void SetVisible(bool visible) { m_Visible = visible; }
+    bool IsVisible() const { return m_Visible; }
+
+    // samples the graphs every frame so they are full when the overlay is
+    // turned on, the quads are only written while it is visible. the
+    // frame's fence has to have signalled
+    void Update(const FrameStats& stats, size_t frame);
+    // what Record draws as of the last Update, the quads themselves are
+    // read from the frame's buffer
+    uint32_t GetQuadCount() const { return m_Visible ? m_QuadCount : 0; }
+    // does nothing while hidden
+    void Record(
+        vk::raii::CommandBuffer& commandBuffer, size_t frame,
+        uint32_t imageIndex);
+
+private:
+    vk::raii::RenderPass CreateRenderPass(Device& device, vk::Format format);
+    vk::DescriptorSetLayout CreateDescriptorSetLayout();
+    vk::raii::DescriptorPool
+    CreateDescriptorPool(Device& device, size_t frameCount);
+    vk::raii::DescriptorSets
+    CreateDescriptorSets(Device& device, size_t frameCount);
+    void FillFont();
+    void WriteDescriptorSets(Device& device);
+
+    void AddQuad(
+        glm::vec2 position, glm::vec2 size, uint32_t color, uint32_t glyph);
+    void AddText(glm::vec2 position, std::string_view text);
+    void AddGraph(glm::vec2 position);
+
+    LayoutCache& m_Layouts;
+    bool m_Visible = false;
+    vk::Extent2D m_Extent;
+    vk::raii::RenderPass m_RenderPass;
+    std::vector<vk::raii::Framebuffer> m_Framebuffers;
+    Buffer<uint32_t> m_Font;
+    // stay mapped for the lifetime of the hud
+    std::vector<Buffer<HudQuad>> m_QuadBuffers;
+    vk::DescriptorSetLayout m_DescriptorSetLayout;
+    vk::raii::DescriptorPool m_DescriptorPool;
+    vk::raii::DescriptorSets m_DescriptorSets;
+    vk::PipelineLayout m_PipelineLayout = nullptr;
+    vk::raii::Pipeline m_Pipeline = nullptr;
+
+    // written by Update, only valid for the frame it was called for
+    std::span<HudQuad> m_Quads;
+    uint32_t m_QuadCount = 0;
+
+    std::array<float, HUD_HISTORY> m_CpuHistory{};
+    std::array<float, HUD_HISTORY> m_GpuHistory{};
+    size_t m_HistoryHead = 0;
+    // cpu time of the previous Update, shown on the overlay itself
+    float m_UpdateMs = 0.0f;
+};
@@ -0,0 +1,185 @@
+#include "InitGraph.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <utility>
+
+InitGraph::InitGraph(JobSystem& jobs, Clock::time_point startTime)
+    : m_Jobs(jobs), m_StartTime(startTime), m_LastPhase(startTime)
+{
+}
+
+InitGraph::~InitGraph() { Cancel(); }
+
+InitGraph::StepId InitGraph::Add(
+    std::string name, std::vector<StepId> dependencies, StepFunction function)
+{
+    if (m_Started)
+    {
+        LogError(fmt::format("Init step {} added after start", name));
+    }
+    StepId id = static_cast<StepId>(m_Steps.size());
+    for (StepId dependency : dependencies)
+    {
+        if (dependency >= id)
+        {
+            LogError(fmt::format(
+                "Init step {} depends on a step that does not exist yet",
+                name));
+        }
+        m_Steps[dependency]->dependents.push_back(id);
+    }
+
+    auto step = std::make_unique<Step>();
+    step->name = std::move(name);
+    step->function = std::move(function);
+    step->dependencyCount = static_cast<uint32_t>(dependencies.size());
+    step->remaining.store(step->dependencyCount, std::memory_order_relaxed);
+    step->timing = {step->name, 0.0f, 0.0f, -1};
+    m_Steps.push_back(std::move(step));
+    return id;
+}
+
+void InitGraph::Start()
+{
+    m_Started = true;
+    // roots are collected first, a root finishing early would otherwise
+    // schedule its dependents while this loop still reads them
+    std::vector<Step*> roots;
+    for (std::unique_ptr<Step>& step : m_Steps)
+    {
+        if (step->dependencyCount == 0)
+        {
+            roots.push_back(step.get());
+        }
+    }
+    for (Step* step : roots)
+    {
+        Schedule(*step);
+    }
+}
+
+void InitGraph::MarkPhase(std::string name)
+{
+    Clock::time_point now = Clock::now();
+    m_Phases.push_back(
+        {std::move(name), GetMilliseconds(m_LastPhase),
+         std::chrono::duration<float, std::milli>(now - m_LastPhase).count(),
+         -1});
+    m_LastPhase = now;
+}
+
+bool InitGraph::IsDone(StepId step) const
+{
+    return m_Steps.at(step)->done.load(std::memory_order_acquire);
+}
+
+void InitGraph::Poll()
+{
+    if (m_Jobs.GetWorkerCount() == 1)
+    {
+        m_Jobs.Wait(m_Counter);
+    }
+    std::scoped_lock lock(m_ErrorMutex);
+    if (m_Error)
+    {
+        std::rethrow_exception(std::exchange(m_Error, nullptr));
+    }
+}
+
+void InitGraph::Wait()
+{
+    m_Jobs.Wait(m_Counter);
+    Poll();
+}
+
+void InitGraph::Cancel()
+{
+    m_Cancelled.store(true, std::memory_order_relaxed);
+    m_Jobs.Wait(m_Counter);
+}
+
+std::vector<InitGraph::Timing> InitGraph::GetTimings() const
+{
+    std::vector<Timing> timings = m_Phases;
+    for (const std::unique_ptr<Step>& step : m_Steps)
+    {
+        if (step->done.load(std::memory_order_acquire))
+        {
+            timings.push_back(step->timing);
+        }
+    }
+    std::sort(
+        timings.begin(), timings.end(),
+        [](const Timing& a, const Timing& b) { return a.startMs < b.startMs; });
+    return timings;
+}
+
+void InitGraph::Report() const
+{
+    // printed in every build, unlike LogDebug, startup time is worth
+    // watching in release builds most of all
+    float endMs = 0.0f;
+    for (const Timing& timing : GetTimings())
+    {
+        std::string thread =
+            timing.worker < 0 ? std::string("main")
+                              : fmt::format("worker {}", timing.worker);
+        fmt::print(
+            std::cout, "\t{:8.2f} ms {:8.2f} ms  {:<10} {}\n", timing.startMs,
+            timing.durationMs, thread, timing.name);
+        endMs = std::max(endMs, timing.startMs + timing.durationMs);
+    }
+    fmt::print(std::cout, "Startup took {:.2f} ms\n", endMs);
+}
+
+void InitGraph::Schedule(Step& step)
+{
+    m_Jobs.Run([this, &step]() { Execute(step); }, &m_Counter);
+}
+
+void InitGraph::Execute(Step& step)
+{
+    Clock::time_point start = Clock::now();
+    bool succeeded = false;
+    // after a failure or cancel the rest of the graph still runs through,
+    // without doing any work, so the counter drains
+    if (!m_Cancelled.load(std::memory_order_relaxed))
+    {
+        try
+        {
+            step.function();
+            succeeded = true;
+        }
+        catch (...)
+        {
+            std::scoped_lock lock(m_ErrorMutex);
+            if (!m_Error)
+            {
+                m_Error = std::current_exception();
+            }
+            m_Cancelled.store(true, std::memory_order_relaxed);
+        }
+    }
+    step.timing.startMs = GetMilliseconds(start);
+    step.timing.durationMs =
+        std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    step.timing.worker = m_Jobs.GetWorkerIndex();
+    step.done.store(succeeded, std::memory_order_release);
+
+    // scheduled before this job returns, so the counter cant hit zero while
+    // dependents are still pending
+    for (StepId dependent : step.dependents)
+    {
+        Step& next = *m_Steps[dependent];
+        if (next.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            Schedule(next);
+        }
+    }
+}
+
+float InitGraph::GetMilliseconds(Clock::time_point time) const
+{
+    return std::chrono::duration<float, std::milli>(time - m_StartTime)
+        .count();
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "JobSystem.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// startup work as a dependency graph. each step runs on the job system as
+// soon as the steps it depends on have finished, so independent loading
+// overlaps instead of running back to back. work that stays on the main
+// thread is timed with MarkPhase against the same clock, and both end up in
+// one report
+class InitGraph
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using StepId = uint32_t;
+    using StepFunction = std::function<void()>;
+
+    struct Timing
+    {
+        std::string name;
+        // relative to the graph's start time
+        float startMs;
+        float durationMs;
+        // job system worker the step ran on, -1 for inline phases
+        int worker;
+    };
+
+    InitGraph(JobSystem& jobs, Clock::time_point startTime = Clock::now());
+    InitGraph(const InitGraph&) = delete;
+    // cancels and waits for whatever is still running
+    ~InitGraph();
+
+    // steps only run once Start is called, dependencies have to be added
+    // before the steps that use them
+    StepId Add(
+        std::string name, std::vector<StepId> dependencies,
+        StepFunction function);
+    void Start();
+
+    // records a main thread phase from the end of the previous one, or the
+    // start time, up to now. only call it from the thread that owns the graph
+    void MarkPhase(std::string name);
+
+    // true once the step ran without throwing
+    bool IsDone(StepId step) const;
+    // true once no steps are outstanding, whether they failed or not
+    bool IsFinished() const { return m_Counter.IsDone(); }
+    // rethrows the first error a step threw. with a single worker nothing
+    // else runs the steps, so this also finishes them
+    void Poll();
+    // runs steps on this thread until every step finished, then rethrows
+    void Wait();
+    // steps that have not started yet are skipped, never throws
+    void Cancel();
+
+    std::vector<Timing> GetTimings() const;
+    // prints every timing and the total to stdout
+    void Report() const;
+
+private:
+    struct Step
+    {
+        std::string name;
+        StepFunction function;
+        std::vector<StepId> dependents;
+        uint32_t dependencyCount = 0;
+        std::atomic<uint32_t> remaining = 0;
+        std::atomic<bool> done = false;
+        Timing timing;
+    };
+
+    void Schedule(Step& step);
+    void Execute(Step& step);
+    float GetMilliseconds(Clock::time_point time) const;
+
+    JobSystem& m_Jobs;
+    Clock::time_point m_StartTime;
+    Clock::time_point m_LastPhase;
+    std::vector<std::unique_ptr<Step>> m_Steps;
+    std::vector<Timing> m_Phases;
+    JobCounter m_Counter;
+    bool m_Started = false;
+
+    std::atomic<bool> m_Cancelled = false;
+    std::mutex m_ErrorMutex;
+    std::exception_ptr m_Error;
+};
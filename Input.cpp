@@ -0,0 +1,32 @@
+#include "Input.hpp"
+#include <SDL2/SDL.h>
+
+InputQueue::InputQueue() { SDL_AddEventWatch(&InputQueue::OnEvent, this); }
+
+InputQueue::~InputQueue() { SDL_DelEventWatch(&InputQueue::OnEvent, this); }
+
+void InputQueue::Pump() { SDL_PumpEvents(); }
+
+int InputQueue::OnEvent(void* userData, SDL_Event* event)
+{
+    switch (event->type)
+    {
+    case SDL_MOUSEMOTION:
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+    case SDL_MOUSEWHEEL:
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+        break;
+    default:
+        return 0;
+    }
+
+    InputQueue& queue = *static_cast<InputQueue*>(userData);
+    if (!queue.m_Events.Push({Clock::now(), *event}))
+    {
+        queue.m_Dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    // return value is ignored for watches
+    return 0;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "SpscQueue.hpp"
+#include <SDL2/SDL_events.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// timestamped copy of every mouse and keyboard event, taken by an sdl event
+// watch the moment sdl pulls the event from the os. the normal event queue
+// still sees everything, this ring is for consumers that want input as late
+// as possible, see Video::SetLateLatch
+class InputQueue
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event
+    {
+        Clock::time_point time;
+        SDL_Event event;
+    };
+
+    InputQueue();
+    InputQueue(const InputQueue&) = delete;
+    ~InputQueue();
+
+    // pulls whatever the os delivered since the last poll into the ring,
+    // main thread only like every other sdl event call
+    void Pump();
+    bool Pop(Event& event) { return m_Events.Pop(event); }
+    // events lost because nobody drained the ring in time
+    uint64_t GetDropped() const
+    {
+        return m_Dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    static int OnEvent(void* userData, SDL_Event* event);
+
+    SpscQueue<Event, 1024> m_Events;
+    std::atomic<uint64_t> m_Dropped = 0;
+};
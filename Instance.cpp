@@ -1,11 +1,131 @@
 #include "Instance.hpp"
 #include "Log.hpp"
 #include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <string>
 #include <vulkan/vulkan_core.h>
 
+static constexpr const char* VALIDATION_LAYER_NAME =
+    "VK_LAYER_KHRONOS_validation";
+
+static bool IsExtensionSupported(
+    const std::vector<vk::ExtensionProperties>& supportedExtensions,
+    const char* extName)
+{
+    return std::find_if(
+               supportedExtensions.begin(), supportedExtensions.end(),
+               [extName](const vk::ExtensionProperties& properties) {
+                   return !strcmp(properties.extensionName, extName);
+               }) != supportedExtensions.end();
+}
+
+ValidationConfig ValidationConfig::FromEnvironment()
+{
+    ValidationConfig config;
+#ifdef UNTITLED_VALIDATION_DEFAULT
+    config.enabled = true;
+#endif
+
+    const char* variable = std::getenv("UNTITLED_VALIDATION");
+    if (!variable || !*variable)
+    {
+        return config;
+    }
+
+    config = {};
+    std::istringstream stream(variable);
+    std::string mode;
+    while (std::getline(stream, mode, ','))
+    {
+        if (mode == "0" || mode == "off")
+        {
+            config = {};
+        }
+        else if (mode == "1" || mode == "on")
+        {
+            config.enabled = true;
+        }
+        else if (mode == "gpu")
+        {
+            config.enabled = true;
+            config.gpuAssisted = true;
+        }
+        else if (mode == "best")
+        {
+            config.enabled = true;
+            config.bestPractices = true;
+        }
+        else
+        {
+            LogWarning(
+                fmt::format("Unknown UNTITLED_VALIDATION mode '{}'", mode));
+        }
+    }
+    return config;
+}
+
 VulkanInstance::VulkanInstance(const Window& window, vk::raii::Context& context)
-    : m_Instance(CreateInstance(window, context))
+    : m_Validation(ValidationConfig::FromEnvironment()),
+      m_MessageLog(std::make_unique<MessageLog>()),
+      m_Instance(CreateInstance(window, context)),
+      m_Messenger(CreateMessenger())
+{
+}
+
+VulkanInstance::~VulkanInstance()
 {
+    PerformanceWarnings warnings = GetPerformanceWarnings();
+    if (warnings.total > 0)
+    {
+        LogWarning(fmt::format(
+            "{} performance warnings, {} distinct", warnings.total,
+            warnings.distinct));
+    }
+}
+
+PerformanceWarnings VulkanInstance::GetPerformanceWarnings() const
+{
+    std::lock_guard lock(m_MessageLog->mutex);
+    return {
+        m_MessageLog->performanceTotal,
+        static_cast<uint32_t>(m_MessageLog->performanceCounts.size())};
+}
+
+VKAPI_ATTR VkBool32 VKAPI_CALL VulkanInstance::OnDebugMessage(
+    VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+    VkDebugUtilsMessageTypeFlagsEXT types,
+    const VkDebugUtilsMessengerCallbackDataEXT* data, void* userData)
+{
+    MessageLog& log = *static_cast<MessageLog*>(userData);
+    const char* message = data->pMessage ? data->pMessage : "";
+
+    if (types & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT)
+    {
+        // the same anti pattern tends to fire every frame, only the first
+        // one is worth reading
+        std::lock_guard lock(log.mutex);
+        log.performanceTotal++;
+        if (log.performanceCounts[data->messageIdNumber]++ > 0)
+        {
+            return VK_FALSE;
+        }
+    }
+
+    // never throw from here, the callback runs inside the driver's call stack
+    if (severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+    {
+        LogWarning(fmt::format("Vulkan error: {}", message));
+    }
+    else if (severity >= VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+    {
+        LogWarning(fmt::format("Vulkan: {}", message));
+    }
+    else
+    {
+        LogDebug(fmt::format("Vulkan: {}", message));
+    }
+    return VK_FALSE;
 }
 
 vk::raii::Instance
@@ -13,7 +133,9 @@ VulkanInstance::CreateInstance(const Window& window, vk::raii::Context& context)
 {
     vk::ApplicationInfo applicationInfo("Untitled Game", 1);
 
-    std::vector<const char*> instanceLayers = {"VK_LAYER_KHRONOS_validation"};
+    // layers first, validation is dropped when the layer is missing and that
+    // changes which extensions are asked for
+    std::vector<const char*> instanceLayers = GetLayerNames();
 
     std::vector<const char*> extNames = GetExtensionNames(window);
 
@@ -23,9 +145,94 @@ VulkanInstance::CreateInstance(const Window& window, vk::raii::Context& context)
     vk::InstanceCreateInfo createInfo(
         instanceCreateFlags, &applicationInfo, instanceLayers, extNames);
 
+    std::vector<vk::ValidationFeatureEnableEXT> enabledFeatures;
+    if (m_Validation.gpuAssisted)
+    {
+        enabledFeatures.push_back(vk::ValidationFeatureEnableEXT::eGpuAssisted);
+        enabledFeatures.push_back(
+            vk::ValidationFeatureEnableEXT::eGpuAssistedReserveBindingSlot);
+    }
+    if (m_Validation.bestPractices)
+    {
+        enabledFeatures.push_back(
+            vk::ValidationFeatureEnableEXT::eBestPractices);
+    }
+    vk::ValidationFeaturesEXT validationFeatures(enabledFeatures);
+
+    // chained in as well so instance creation and destruction get reported
+    vk::DebugUtilsMessengerCreateInfoEXT messengerInfo =
+        GetMessengerCreateInfo();
+    const void* next = nullptr;
+    if (m_DebugUtilsEnabled)
+    {
+        messengerInfo.pNext = next;
+        next = &messengerInfo;
+    }
+    if (!enabledFeatures.empty())
+    {
+        validationFeatures.pNext = next;
+        next = &validationFeatures;
+    }
+    createInfo.pNext = next;
+
     return context.createInstance(createInfo);
 }
 
+vk::raii::DebugUtilsMessengerEXT VulkanInstance::CreateMessenger()
+{
+    if (!m_DebugUtilsEnabled)
+    {
+        return nullptr;
+    }
+    return m_Instance.createDebugUtilsMessengerEXT(GetMessengerCreateInfo());
+}
+
+vk::DebugUtilsMessengerCreateInfoEXT VulkanInstance::GetMessengerCreateInfo()
+{
+    // filled in through the c struct, the c++ callback type changed between
+    // vulkan-hpp versions
+    VkDebugUtilsMessengerCreateInfoEXT createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
+    createInfo.messageSeverity =
+        VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT |
+        VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+        VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+    createInfo.messageType = VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT |
+                             VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+                             VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+    createInfo.pfnUserCallback = &VulkanInstance::OnDebugMessage;
+    createInfo.pUserData = m_MessageLog.get();
+    return vk::DebugUtilsMessengerCreateInfoEXT(createInfo);
+}
+
+std::vector<const char*> VulkanInstance::GetLayerNames()
+{
+    if (!m_Validation.enabled)
+    {
+        return {};
+    }
+
+    std::vector<vk::LayerProperties> supportedLayers =
+        vk::enumerateInstanceLayerProperties();
+    if (std::find_if(
+            supportedLayers.begin(), supportedLayers.end(),
+            [](vk::LayerProperties& properties) {
+                return !strcmp(properties.layerName, VALIDATION_LAYER_NAME);
+            }) == supportedLayers.end())
+    {
+        LogWarning(fmt::format(
+            "Validation requested but {} is not installed",
+            VALIDATION_LAYER_NAME));
+        m_Validation = {};
+        return {};
+    }
+
+    LogDebug(fmt::format(
+        "Validation enabled, gpu assisted {}, best practices {}",
+        m_Validation.gpuAssisted, m_Validation.bestPractices));
+    return {VALIDATION_LAYER_NAME};
+}
+
 vk::InstanceCreateFlags VulkanInstance::GetInstanceCreateFlags(
     const std::vector<const char*>& extentionNames)
 {
@@ -70,14 +277,50 @@ std::vector<const char*> VulkanInstance::GetExtensionNames(const Window& window)
         extNames.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
     }
 
+    // debug utils and validation features come with the layer rather than
+    // the loader on some platforms
+    if (m_Validation.enabled)
+    {
+        std::vector<vk::ExtensionProperties> layerExtensions =
+            vk::enumerateInstanceExtensionProperties(
+                std::string(VALIDATION_LAYER_NAME));
+        instanceSupportedExtensions.insert(
+            instanceSupportedExtensions.end(), layerExtensions.begin(),
+            layerExtensions.end());
+
+        m_DebugUtilsEnabled = IsExtensionSupported(
+            instanceSupportedExtensions, VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        if (m_DebugUtilsEnabled)
+        {
+            extNames.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+        }
+        else
+        {
+            LogWarning("Validation messages will not be logged, "
+                       "debug utils not supported");
+        }
+
+        if (m_Validation.gpuAssisted || m_Validation.bestPractices)
+        {
+            if (IsExtensionSupported(
+                    instanceSupportedExtensions,
+                    VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME))
+            {
+                extNames.push_back(VK_EXT_VALIDATION_FEATURES_EXTENSION_NAME);
+            }
+            else
+            {
+                LogWarning("Validation features not supported, using "
+                           "standard validation only");
+                m_Validation.gpuAssisted = false;
+                m_Validation.bestPractices = false;
+            }
+        }
+    }
+
     for (const char* extName : extNames)
     {
-        if (std::find_if(
-                instanceSupportedExtensions.begin(),
-                instanceSupportedExtensions.end(),
-                [extName](vk::ExtensionProperties& properties) {
-                    return !strcmp(properties.extensionName, extName);
-                }) == instanceSupportedExtensions.end())
+        if (!IsExtensionSupported(instanceSupportedExtensions, extName))
         {
             LogError(
                 fmt::format("Required extension {} not supported!", extName));
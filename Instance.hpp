@@ -1,20 +1,71 @@
 #pragma once
 #include "Window.hpp"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
+// which parts of the khronos validation layer to turn on
+struct ValidationConfig
+{
+    bool enabled = false;
+    // instruments every shader, expect a large slowdown
+    bool gpuAssisted = false;
+    bool bestPractices = false;
+
+    // on by default in debug builds and off otherwise. UNTITLED_VALIDATION
+    // overrides it, "0" turns it off and a comma separated list of "1",
+    // "gpu" and "best" turns it on with those modes
+    static ValidationConfig FromEnvironment();
+};
+
+// performance warnings reported through the debug messenger, each distinct
+// message is logged once but every occurrence is counted
+struct PerformanceWarnings
+{
+    uint64_t total = 0;
+    uint32_t distinct = 0;
+};
+
 class VulkanInstance
 {
 public:
     VulkanInstance(const Window& window, vk::raii::Context& context);
+    ~VulkanInstance();
     vk::raii::Instance& Get() { return m_Instance; }
 
+    const ValidationConfig& GetValidationConfig() const { return m_Validation; }
+    PerformanceWarnings GetPerformanceWarnings() const;
+
 private:
+    // the messenger callback can run on any thread that calls into vulkan
+    struct MessageLog
+    {
+        std::mutex mutex;
+        std::unordered_map<int32_t, uint64_t> performanceCounts;
+        uint64_t performanceTotal = 0;
+    };
+
+    static VKAPI_ATTR VkBool32 VKAPI_CALL OnDebugMessage(
+        VkDebugUtilsMessageSeverityFlagBitsEXT severity,
+        VkDebugUtilsMessageTypeFlagsEXT types,
+        const VkDebugUtilsMessengerCallbackDataEXT* data, void* userData);
+
     vk::raii::Instance
     CreateInstance(const Window& window, vk::raii::Context& context);
+    vk::raii::DebugUtilsMessengerEXT CreateMessenger();
+    vk::DebugUtilsMessengerCreateInfoEXT GetMessengerCreateInfo();
+    std::vector<const char*> GetLayerNames();
     std::vector<const char*> GetExtensionNames(const Window& window);
     vk::InstanceCreateFlags
     GetInstanceCreateFlags(const std::vector<const char*>& extentionNames);
 
+    ValidationConfig m_Validation;
+    bool m_DebugUtilsEnabled = false;
+    // stable address for the callback's user data
+    std::unique_ptr<MessageLog> m_MessageLog;
     vk::raii::Instance m_Instance;
-};
\ No newline at end of file
+    vk::raii::DebugUtilsMessengerEXT m_Messenger;
+};
@@ -0,0 +1,272 @@
+#include "JobSystem.hpp"
+#include "Log.hpp"
+#include <chrono>
+#include <random>
+#include <utility>
+
+namespace
+{
+    thread_local JobSystem* t_JobSystem = nullptr;
+    thread_local int t_WorkerIndex = -1;
+
+    std::string DescribeException(std::exception_ptr exception)
+    {
+        try
+        {
+            std::rethrow_exception(exception);
+        }
+        catch (const std::exception& e)
+        {
+            return e.what();
+        }
+        catch (...)
+        {
+            return "unknown exception";
+        }
+    }
+}
+
+JobSystem::JobSystem(size_t workerCount)
+{
+    workerCount = std::max<size_t>(workerCount, 1);
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        m_Queues.push_back(std::make_unique<WorkStealingQueue<Job*>>());
+    }
+
+    t_JobSystem = this;
+    t_WorkerIndex = 0;
+    for (size_t i = 1; i < workerCount; i++)
+    {
+        m_Threads.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+    LogDebug(fmt::format("Job system started with {} workers", workerCount));
+}
+
+JobSystem::~JobSystem()
+{
+    m_Running.store(false);
+    {
+        std::scoped_lock lock(m_SleepMutex);
+        m_SleepCondition.notify_all();
+    }
+    for (std::thread& thread : m_Threads)
+    {
+        thread.join();
+    }
+    if (t_JobSystem == this)
+    {
+        t_JobSystem = nullptr;
+        t_WorkerIndex = -1;
+    }
+}
+
+int JobSystem::GetWorkerIndex() const
+{
+    return t_JobSystem == this ? t_WorkerIndex : -1;
+}
+
+void JobSystem::Run(const JobFunction& function, JobCounter* counter)
+{
+    if (counter)
+    {
+        counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+    }
+    Schedule(new Job{function, counter});
+}
+
+void JobSystem::Continue(
+    JobCounter& dependency, const JobFunction& function, JobCounter* counter)
+{
+    if (counter)
+    {
+        counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+    }
+    Job* job = new Job{function, counter};
+    {
+        std::scoped_lock lock(dependency.m_Mutex);
+        if (!dependency.IsDone())
+        {
+            dependency.m_Continuations.push_back(job);
+            return;
+        }
+    }
+    Schedule(job);
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    while (!counter.IsDone())
+    {
+        if (!TryRunOne())
+        {
+            std::this_thread::yield();
+        }
+    }
+    std::scoped_lock lock(counter.m_Mutex);
+    if (counter.m_Exception)
+    {
+        std::rethrow_exception(std::exchange(counter.m_Exception, nullptr));
+    }
+}
+
+void JobSystem::Schedule(Job* job)
+{
+    int worker = GetWorkerIndex();
+    if (worker >= 0)
+    {
+        m_Queues.at(worker)->Push(job);
+    }
+    else
+    {
+        std::scoped_lock lock(m_InjectionMutex);
+        m_InjectionQueue.push_back(job);
+    }
+    m_QueuedJobs.fetch_add(1, std::memory_order_seq_cst);
+
+    if (m_SleepingWorkers.load(std::memory_order_seq_cst) > 0)
+    {
+        std::scoped_lock lock(m_SleepMutex);
+        m_SleepCondition.notify_one();
+    }
+}
+
+void JobSystem::Execute(Job* job)
+{
+    m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    // an exception leaving a worker thread would terminate, and one leaving
+    // Wait's helping loop would skip the counter and deadlock whoever waits
+    // on it. it is handed to the counter's waiter instead
+    std::exception_ptr exception;
+    try
+    {
+        job->function();
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+    if (job->counter)
+    {
+        Finish(*job->counter, exception);
+    }
+    else if (exception)
+    {
+        LogWarning(fmt::format(
+            "Job without a counter threw: {}", DescribeException(exception)));
+    }
+    delete job;
+}
+
+void JobSystem::Finish(JobCounter& counter, std::exception_ptr exception)
+{
+    std::vector<Job*> continuations;
+    {
+        std::scoped_lock lock(counter.m_Mutex);
+        if (exception && !counter.m_Exception)
+        {
+            counter.m_Exception = exception;
+        }
+        if (counter.m_Value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            continuations.swap(counter.m_Continuations);
+        }
+    }
+    for (Job* continuation : continuations)
+    {
+        Schedule(continuation);
+    }
+}
+
+bool JobSystem::TryRunOne()
+{
+    Job* job = FindJob();
+    if (!job)
+    {
+        return false;
+    }
+    Execute(job);
+    return true;
+}
+
+JobSystem::Job* JobSystem::FindJob()
+{
+    int worker = GetWorkerIndex();
+    if (worker >= 0)
+    {
+        if (Job* job = m_Queues.at(worker)->Pop())
+        {
+            return job;
+        }
+    }
+
+    {
+        std::scoped_lock lock(m_InjectionMutex);
+        if (!m_InjectionQueue.empty())
+        {
+            Job* job = m_InjectionQueue.front();
+            m_InjectionQueue.pop_front();
+            return job;
+        }
+    }
+
+    // start stealing at a random victim so thieves dont all pile onto one
+    thread_local std::minstd_rand random(
+        static_cast<unsigned>(std::hash<std::thread::id>()(
+            std::this_thread::get_id())));
+    size_t count = m_Queues.size();
+    size_t start = random() % count;
+    for (size_t i = 0; i < count; i++)
+    {
+        size_t victim = (start + i) % count;
+        if (static_cast<int>(victim) == worker)
+        {
+            continue;
+        }
+        if (Job* job = m_Queues.at(victim)->Steal())
+        {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::WorkerLoop(size_t index)
+{
+    t_JobSystem = this;
+    t_WorkerIndex = static_cast<int>(index);
+
+    constexpr int SPIN_COUNT = 64;
+    int idle = 0;
+    while (m_Running.load(std::memory_order_relaxed))
+    {
+        if (TryRunOne())
+        {
+            idle = 0;
+            continue;
+        }
+        if (++idle < SPIN_COUNT)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // the timeout covers a wakeup racing with going to sleep
+        std::unique_lock lock(m_SleepMutex);
+        m_SleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+        m_SleepCondition.wait_for(
+            lock, std::chrono::milliseconds(1),
+            [this]()
+            {
+                return !m_Running.load() ||
+                       m_QueuedJobs.load(std::memory_order_seq_cst) > 0;
+            });
+        m_SleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+        idle = 0;
+    }
+
+    // drain whatever is left so no job is leaked on shutdown
+    while (TryRunOne())
+    {
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "WorkStealingQueue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+struct JobSystemJob;
+
+// tracks outstanding jobs, jobs queued with Continue run once it hits zero
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+
+    bool IsDone() const { return m_Value.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> m_Value = 0;
+    // also taken when the last job finishes, so a waiter cant destroy the
+    // counter while the finishing thread is still touching it
+    std::mutex m_Mutex;
+    std::vector<JobSystemJob*> m_Continuations;
+    // first exception thrown by one of its jobs, rethrown by Wait
+    std::exception_ptr m_Exception;
+};
+
+struct JobSystemJob
+{
+    std::function<void()> function;
+    JobCounter* counter;
+};
+
+// one worker per core, the thread that constructs the job system counts as
+// worker 0 so the main thread never sits idle while jobs are outstanding.
+// waiting never blocks a worker, Wait keeps executing other jobs until the
+// counter drains, and Continue chains work without waiting at all
+class JobSystem
+{
+public:
+    using JobFunction = std::function<void()>;
+
+    JobSystem(size_t workerCount = std::thread::hardware_concurrency());
+    JobSystem(const JobSystem&) = delete;
+    ~JobSystem();
+
+    void Run(const JobFunction& function, JobCounter* counter = nullptr);
+    // schedules function once dependency reaches zero
+    void Continue(
+        JobCounter& dependency, const JobFunction& function,
+        JobCounter* counter = nullptr);
+    // runs other jobs on this thread until counter reaches zero, then
+    // rethrows the first exception any of its jobs threw. a throwing job
+    // still counts as finished, so continuations run regardless
+    void Wait(JobCounter& counter);
+
+    // splits [begin, end) into ranges of at most grainSize and calls
+    // function(rangeBegin, rangeEnd) for each, blocks (helping) unless a
+    // counter is given
+    template <typename Function>
+    void ParallelFor(
+        size_t begin, size_t end, size_t grainSize, Function&& function,
+        JobCounter* counter = nullptr);
+
+    size_t GetWorkerCount() const { return m_Queues.size(); }
+    // index of the calling worker, -1 for threads not owned by the system
+    int GetWorkerIndex() const;
+
+private:
+    using Job = JobSystemJob;
+
+    void Schedule(Job* job);
+    void Execute(Job* job);
+    void Finish(JobCounter& counter, std::exception_ptr exception);
+    bool TryRunOne();
+    Job* FindJob();
+    void WorkerLoop(size_t index);
+    template <typename Function>
+    void SplitRange(
+        size_t begin, size_t end, size_t grainSize,
+        std::shared_ptr<Function> function, JobCounter* counter);
+
+    std::vector<std::unique_ptr<WorkStealingQueue<Job*>>> m_Queues;
+    std::vector<std::thread> m_Threads;
+
+    // jobs submitted from threads that dont own a queue
+    std::mutex m_InjectionMutex;
+    std::deque<Job*> m_InjectionQueue;
+
+    std::atomic<bool> m_Running = true;
+    std::atomic<int64_t> m_QueuedJobs = 0;
+    std::atomic<uint32_t> m_SleepingWorkers = 0;
+    std::mutex m_SleepMutex;
+    std::condition_variable m_SleepCondition;
+};
+
+template <typename Function>
+void JobSystem::ParallelFor(
+    size_t begin, size_t end, size_t grainSize, Function&& function,
+    JobCounter* counter)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+    grainSize = std::max<size_t>(grainSize, 1);
+    auto shared = std::make_shared<std::decay_t<Function>>(
+        std::forward<Function>(function));
+
+    if (counter)
+    {
+        SplitRange(begin, end, grainSize, shared, counter);
+        return;
+    }
+    JobCounter local;
+    SplitRange(begin, end, grainSize, shared, &local);
+    Wait(local);
+}
+
+template <typename Function>
+void JobSystem::SplitRange(
+    size_t begin, size_t end, size_t grainSize,
+    std::shared_ptr<Function> function, JobCounter* counter)
+{
+    // binary splitting, the upper halves go to the queue where idle workers
+    // can steal them and split further
+    Run(
+        [this, begin, end, grainSize, function, counter]()
+        {
+            size_t rangeEnd = end;
+            while (rangeEnd - begin > grainSize)
+            {
+                size_t middle = begin + (rangeEnd - begin) / 2;
+                SplitRange(middle, rangeEnd, grainSize, function, counter);
+                rangeEnd = middle;
+            }
+            (*function)(begin, rangeEnd);
+        },
+        counter);
+}
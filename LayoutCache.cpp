@@ -0,0 +1,255 @@
+#include "LayoutCache.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace
+{
+    // the first word of every key, so keys of different kinds never compare
+    // equal
+    enum class KeyKind : uint32_t
+    {
+        DescriptorSetLayout,
+        PipelineLayout,
+        Sampler,
+    };
+
+    template <typename Handle>
+    void AppendHandle(std::vector<uint32_t>& key, Handle handle)
+    {
+        // non-dispatchable handles are 64 bit on every platform
+        uint64_t value = 0;
+        auto raw = static_cast<typename Handle::CType>(handle);
+        std::memcpy(&value, &raw, sizeof(raw));
+        key.push_back(static_cast<uint32_t>(value));
+        key.push_back(static_cast<uint32_t>(value >> 32));
+    }
+
+    bool BindingLess(
+        const vk::DescriptorSetLayoutBinding& a,
+        const vk::DescriptorSetLayoutBinding& b)
+    {
+        return a.binding < b.binding;
+    }
+}
+
+size_t LayoutCache::KeyHash::operator()(const Key& key) const
+{
+    // fnv-1a over the words, keys are a few dozen words at most
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint32_t word : key)
+    {
+        hash ^= word;
+        hash *= 0x100000001b3ull;
+    }
+    return static_cast<size_t>(hash);
+}
+
+LayoutCache::LayoutCache(Device& device)
+    : m_Device(device),
+      m_MaxPushConstantsSize(device.GetPhysicalDevice()
+                                 .getProperties()
+                                 .limits.maxPushConstantsSize)
+{
+}
+
+vk::DescriptorSetLayout LayoutCache::GetDescriptorSetLayout(
+    std::span<const vk::DescriptorSetLayoutBinding> bindings)
+{
+    std::vector<vk::DescriptorSetLayoutBinding> sorted(
+        bindings.begin(), bindings.end());
+    std::sort(sorted.begin(), sorted.end(), BindingLess);
+
+    Key key = {static_cast<uint32_t>(KeyKind::DescriptorSetLayout)};
+    for (const vk::DescriptorSetLayoutBinding& binding : sorted)
+    {
+        if (binding.pImmutableSamplers)
+        {
+            LogError("Immutable samplers are not supported by the layout "
+                     "cache");
+        }
+        key.push_back(binding.binding);
+        key.push_back(static_cast<uint32_t>(binding.descriptorType));
+        key.push_back(binding.descriptorCount);
+        key.push_back(static_cast<uint32_t>(binding.stageFlags));
+    }
+
+    std::scoped_lock lock(m_Mutex);
+    auto found = m_DescriptorSetLayouts.find(key);
+    if (found == m_DescriptorSetLayouts.end())
+    {
+        vk::DescriptorSetLayoutCreateInfo createInfo({}, sorted);
+        found = m_DescriptorSetLayouts
+                    .emplace(
+                        std::move(key),
+                        m_Device.Get().createDescriptorSetLayout(createInfo))
+                    .first;
+        m_SetBindings.emplace(
+            static_cast<VkDescriptorSetLayout>(*found->second),
+            std::move(sorted));
+    }
+    return *found->second;
+}
+
+vk::PipelineLayout LayoutCache::GetPipelineLayout(
+    std::span<const vk::DescriptorSetLayout> setLayouts,
+    std::span<const vk::PushConstantRange> pushConstantRanges)
+{
+    Key key = {static_cast<uint32_t>(KeyKind::PipelineLayout)};
+    for (vk::DescriptorSetLayout setLayout : setLayouts)
+    {
+        AppendHandle(key, setLayout);
+    }
+    for (const vk::PushConstantRange& range : pushConstantRanges)
+    {
+        if (range.offset + range.size > m_MaxPushConstantsSize)
+        {
+            LogError(fmt::format(
+                "Push constant range of {} bytes exceeds the device limit of "
+                "{}",
+                range.offset + range.size, m_MaxPushConstantsSize));
+        }
+        key.push_back(static_cast<uint32_t>(range.stageFlags));
+        key.push_back(range.offset);
+        key.push_back(range.size);
+    }
+
+    std::scoped_lock lock(m_Mutex);
+    auto found = m_PipelineLayouts.find(key);
+    if (found == m_PipelineLayouts.end())
+    {
+        vk::PipelineLayoutCreateInfo createInfo(
+            {}, setLayouts, pushConstantRanges);
+        found = m_PipelineLayouts
+                    .emplace(
+                        std::move(key),
+                        m_Device.Get().createPipelineLayout(createInfo))
+                    .first;
+    }
+    return *found->second;
+}
+
+vk::PipelineLayout LayoutCache::GetPipelineLayout(
+    const Shader& shader, std::span<const vk::DescriptorSetLayout> sets,
+    uint32_t pushConstantSize)
+{
+    const ShaderLayout& layout = shader.layout;
+    if (layout.GetSetCount() > sets.size())
+    {
+        LogError(fmt::format(
+            "Shader {} uses {} descriptor sets but the pipeline has {}",
+            shader.name, layout.GetSetCount(), sets.size()));
+    }
+
+    {
+        std::scoped_lock lock(m_Mutex);
+        for (const ShaderBinding& binding : layout.bindings)
+        {
+            auto setBindings = m_SetBindings.find(
+                static_cast<VkDescriptorSetLayout>(sets[binding.set]));
+            if (setBindings == m_SetBindings.end())
+            {
+                LogError(fmt::format(
+                    "Set {} of shader {} was not created by the layout cache",
+                    binding.set, shader.name));
+            }
+            // the set may declare more than the shader reads and make
+            // bindings visible to more stages, not less
+            auto declared = std::find_if(
+                setBindings->second.begin(), setBindings->second.end(),
+                [&](const vk::DescriptorSetLayoutBinding& candidate)
+                { return candidate.binding == binding.binding; });
+            if (declared == setBindings->second.end() ||
+                declared->descriptorType != binding.type ||
+                declared->descriptorCount < binding.count ||
+                (declared->stageFlags & binding.stages) != binding.stages)
+            {
+                LogError(fmt::format(
+                    "Set {} binding {} of shader {} does not match the "
+                    "descriptor set layout",
+                    binding.set, binding.binding, shader.name));
+            }
+        }
+    }
+
+    if (layout.pushConstantSize > pushConstantSize)
+    {
+        LogError(fmt::format(
+            "Shader {} reads {} bytes of push constants but only {} are "
+            "pushed",
+            shader.name, layout.pushConstantSize, pushConstantSize));
+    }
+    if (pushConstantSize == 0)
+    {
+        return GetPipelineLayout(sets, {});
+    }
+    if (!layout.pushConstantStages)
+    {
+        LogError(fmt::format(
+            "Shader {} has no push constant block to push to", shader.name));
+    }
+    // the whole pushed struct is in range, a shader that stops reading the
+    // last members still accepts the push
+    vk::PushConstantRange range(
+        layout.pushConstantStages, 0, pushConstantSize);
+    return GetPipelineLayout(sets, {&range, 1});
+}
+
+vk::Sampler LayoutCache::GetSampler(const vk::SamplerCreateInfo& createInfo)
+{
+    if (createInfo.pNext)
+    {
+        LogError("Sampler create info chains are not supported by the layout "
+                 "cache");
+    }
+    Key key = {
+        static_cast<uint32_t>(KeyKind::Sampler),
+        static_cast<uint32_t>(createInfo.flags),
+        static_cast<uint32_t>(createInfo.magFilter),
+        static_cast<uint32_t>(createInfo.minFilter),
+        static_cast<uint32_t>(createInfo.mipmapMode),
+        static_cast<uint32_t>(createInfo.addressModeU),
+        static_cast<uint32_t>(createInfo.addressModeV),
+        static_cast<uint32_t>(createInfo.addressModeW),
+        std::bit_cast<uint32_t>(createInfo.mipLodBias),
+        createInfo.anisotropyEnable,
+        std::bit_cast<uint32_t>(createInfo.maxAnisotropy),
+        createInfo.compareEnable,
+        static_cast<uint32_t>(createInfo.compareOp),
+        std::bit_cast<uint32_t>(createInfo.minLod),
+        std::bit_cast<uint32_t>(createInfo.maxLod),
+        static_cast<uint32_t>(createInfo.borderColor),
+        createInfo.unnormalizedCoordinates,
+    };
+
+    std::scoped_lock lock(m_Mutex);
+    auto found = m_Samplers.find(key);
+    if (found == m_Samplers.end())
+    {
+        found = m_Samplers
+                    .emplace(
+                        std::move(key),
+                        m_Device.Get().createSampler(createInfo))
+                    .first;
+    }
+    return *found->second;
+}
+
+size_t LayoutCache::GetDescriptorSetLayoutCount() const
+{
+    std::scoped_lock lock(m_Mutex);
+    return m_DescriptorSetLayouts.size();
+}
+
+size_t LayoutCache::GetPipelineLayoutCount() const
+{
+    std::scoped_lock lock(m_Mutex);
+    return m_PipelineLayouts.size();
+}
+
+size_t LayoutCache::GetSamplerCount() const
+{
+    std::scoped_lock lock(m_Mutex);
+    return m_Samplers.size();
+}
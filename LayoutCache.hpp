@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Device.hpp"
+#include "Shader.hpp"
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+// creates each distinct descriptor set layout, pipeline layout and sampler
+// once and hands out the same handle to everything asking for an identical
+// one. objects are keyed by a hash of their create info and live as long as
+// the cache, so it has to outlive every pipeline and descriptor set using
+// them. safe to call from any thread, pipelines are built on the job system
+class LayoutCache
+{
+public:
+    LayoutCache(Device& device);
+    LayoutCache(const LayoutCache&) = delete;
+
+    // bindings may come in any order, immutable samplers are not supported
+    vk::DescriptorSetLayout GetDescriptorSetLayout(
+        std::span<const vk::DescriptorSetLayoutBinding> bindings);
+    vk::PipelineLayout GetPipelineLayout(
+        std::span<const vk::DescriptorSetLayout> setLayouts,
+        std::span<const vk::PushConstantRange> pushConstantRanges);
+    // the layout the shader's reflection asks for. every set the shader
+    // declares has to be the layout at the same index of sets, which is
+    // what the caller allocated its descriptor sets with, and the shader's
+    // push constant block has to fit in pushConstantSize, the size of the
+    // struct pushed from c++
+    vk::PipelineLayout GetPipelineLayout(
+        const Shader& shader, std::span<const vk::DescriptorSetLayout> sets,
+        uint32_t pushConstantSize);
+    vk::Sampler GetSampler(const vk::SamplerCreateInfo& createInfo);
+
+    size_t GetDescriptorSetLayoutCount() const;
+    size_t GetPipelineLayoutCount() const;
+    size_t GetSamplerCount() const;
+
+private:
+    // the create info flattened to words, compared in full on a hash hit
+    using Key = std::vector<uint32_t>;
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    Device& m_Device;
+    uint32_t m_MaxPushConstantsSize;
+    mutable std::mutex m_Mutex;
+    std::unordered_map<Key, vk::raii::DescriptorSetLayout, KeyHash>
+        m_DescriptorSetLayouts;
+    std::unordered_map<Key, vk::raii::PipelineLayout, KeyHash>
+        m_PipelineLayouts;
+    std::unordered_map<Key, vk::raii::Sampler, KeyHash> m_Samplers;
+    // bindings of every cached set layout, sorted, to check shaders against
+    std::unordered_map<
+        VkDescriptorSetLayout, std::vector<vk::DescriptorSetLayoutBinding>>
+        m_SetBindings;
+};
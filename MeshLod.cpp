@@ -0,0 +1,29 @@
+#include "MeshLod.hpp"
+#include <algorithm>
+
+uint32_t SelectLod(
+    std::span<const MeshLod> lods, float screenRadius, uint32_t current,
+    const LodSelection& selection)
+{
+    // coarsest level within the limit and coarsest level comfortably within
+    // it, errors only grow along the chain
+    float comfortableError =
+        selection.maxPixelError * (1.0f - selection.hysteresis);
+    uint32_t allowed = 0;
+    uint32_t comfortable = 0;
+    for (uint32_t level = 1; level < lods.size(); level++)
+    {
+        float pixelError = lods[level].error * screenRadius;
+        if (pixelError <= selection.maxPixelError)
+        {
+            allowed = level;
+        }
+        if (pixelError <= comfortableError)
+        {
+            comfortable = level;
+        }
+    }
+    // refines as soon as the current level shows, coarsens only once the
+    // coarser level would not be close to showing
+    return std::clamp(current, comfortable, allowed);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+// most levels a mesh is cooked with, each has about half the triangles of
+// the one before
+constexpr uint32_t MAX_MESH_LODS = 8;
+
+// one level of a mesh's lod chain, a range of the mesh's index buffer. every
+// level indexes the same vertices, so switching levels only changes the
+// index range a draw reads
+struct MeshLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    // how far the level strays from the full mesh, as a fraction of the
+    // mesh's bounding radius. 0 for the full mesh, growing with every level
+    float error;
+};
+
+static_assert(sizeof(MeshLod) == 12);
+
+struct LodSelection
+{
+    // largest error allowed on screen, in pixels
+    float maxPixelError = 1.0f;
+    // a coarser level is only picked once its error is this fraction below
+    // the limit, so an object hovering around a switching distance does not
+    // pop back and forth every frame
+    float hysteresis = 0.25f;
+};
+
+// level to draw a mesh with whose bounding radius covers screenRadius
+// pixels, given the level it was drawn with last frame. lods are finest
+// first, as built by BuildLodChain
+uint32_t SelectLod(
+    std::span<const MeshLod> lods, float screenRadius, uint32_t current,
+    const LodSelection& selection = {});
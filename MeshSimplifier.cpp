@@ -0,0 +1,699 @@
+#include "MeshSimplifier.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <limits>
+#include <unordered_map>
+
+namespace
+{
+    // x, y, r, g, b, the space errors are measured in
+    constexpr size_t QUADRIC_DIMENSIONS = 5;
+    // a full swing from black to white costs as much as moving a quarter of
+    // the bounding radius
+    constexpr double COLOR_WEIGHT = 0.25;
+    // boundary edges outweigh the triangles next to them, so the outline is
+    // the last thing to go
+    constexpr double BOUNDARY_WEIGHT = 10.0;
+    // a pass stops at this many times the cost of the collapse halfway to
+    // its goal, expensive collapses wait for cheaper ones the next pass
+    // opens up
+    constexpr double PASS_COST_SLACK = 1.5;
+    // each level aims for this fraction of the previous level's triangles
+    constexpr float LOD_REDUCTION = 0.5f;
+    // a level keeping more than this fraction of the previous one is not
+    // worth a draw range of its own
+    constexpr float LOD_MIN_REDUCTION = 0.9f;
+    // levels further off than this no longer look like the same shape
+    constexpr float LOD_MAX_ERROR = 0.25f;
+    // twice the area over the longest edge squared below which a triangle
+    // counts as flat. a collapse along a row of collinear vertices would
+    // otherwise leave a sliver that rounding can turn either way
+    constexpr double MIN_TRIANGLE_SHAPE = 1e-3;
+
+    using Point = std::array<double, QUADRIC_DIMENSIONS>;
+
+    double Dot(const Point& a, const Point& b)
+    {
+        double sum = 0.0;
+        for (size_t i = 0; i < QUADRIC_DIMENSIONS; i++)
+        {
+            sum += a[i] * b[i];
+        }
+        return sum;
+    }
+
+    // weighted sum of squared distances to a set of flats, garland and
+    // heckbert's quadrics extended with color. the symmetric matrix is
+    // kept as its upper triangle, row by row
+    struct Quadric
+    {
+        std::array<double, QUADRIC_DIMENSIONS*(QUADRIC_DIMENSIONS + 1) / 2>
+            a{};
+        Point b{};
+        double c = 0.0;
+        double weight = 0.0;
+
+        void Add(const Quadric& other)
+        {
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                a[i] += other.a[i];
+            }
+            for (size_t i = 0; i < QUADRIC_DIMENSIONS; i++)
+            {
+                b[i] += other.b[i];
+            }
+            c += other.c;
+            weight += other.weight;
+        }
+
+        // weighted mean of the squared distances
+        double Evaluate(const Point& p) const
+        {
+            if (weight <= 0.0)
+            {
+                return 0.0;
+            }
+            double sum = c;
+            size_t k = 0;
+            for (size_t i = 0; i < QUADRIC_DIMENSIONS; i++)
+            {
+                sum += 2.0 * b[i] * p[i];
+                sum += a[k++] * p[i] * p[i];
+                for (size_t j = i + 1; j < QUADRIC_DIMENSIONS; j++)
+                {
+                    sum += 2.0 * a[k++] * p[i] * p[j];
+                }
+            }
+            // rounding can take an exact fit slightly below zero
+            return std::max(sum, 0.0) / weight;
+        }
+    };
+
+    // distance to the plane through origin spanned by the orthonormal
+    // e1 and e2, the triangle with its colors interpolated across it
+    Quadric MakeTriangleQuadric(
+        const Point& origin, const Point& e1, const Point& e2, double weight)
+    {
+        Quadric quadric;
+        double d1 = Dot(origin, e1);
+        double d2 = Dot(origin, e2);
+        size_t k = 0;
+        for (size_t i = 0; i < QUADRIC_DIMENSIONS; i++)
+        {
+            for (size_t j = i; j < QUADRIC_DIMENSIONS; j++)
+            {
+                double identity = i == j ? 1.0 : 0.0;
+                quadric.a[k++] =
+                    (identity - e1[i] * e1[j] - e2[i] * e2[j]) * weight;
+            }
+            quadric.b[i] = (d1 * e1[i] + d2 * e2[i] - origin[i]) * weight;
+        }
+        quadric.c = (Dot(origin, origin) - d1 * d1 - d2 * d2) * weight;
+        quadric.weight = weight;
+        return quadric;
+    }
+
+    // distance to the line through a boundary edge, in position only
+    Quadric MakeBoundaryQuadric(
+        double nx, double ny, double distance, double weight)
+    {
+        Quadric quadric;
+        // a00, a01 and a11 of the upper triangle
+        quadric.a[0] = nx * nx * weight;
+        quadric.a[1] = nx * ny * weight;
+        quadric.a[QUADRIC_DIMENSIONS] = ny * ny * weight;
+        quadric.b[0] = distance * nx * weight;
+        quadric.b[1] = distance * ny * weight;
+        quadric.c = distance * distance * weight;
+        quadric.weight = weight;
+        return quadric;
+    }
+
+    enum class VertexKind : uint8_t
+    {
+        Interior,
+        Boundary,
+        Locked,
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    uint64_t EdgeKey(uint32_t from, uint32_t to)
+    {
+        return static_cast<uint64_t>(from) << 32 | to;
+    }
+
+    class Simplifier
+    {
+    public:
+        Simplifier(
+            std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+            : m_Points(vertices.size()), m_Quadrics(vertices.size()),
+              m_Kinds(vertices.size())
+        {
+            m_Indices.reserve(indices.size());
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                uint32_t a = indices[i];
+                uint32_t b = indices[i + 1];
+                uint32_t c = indices[i + 2];
+                if (a != b && b != c && c != a)
+                {
+                    m_Indices.insert(m_Indices.end(), {a, b, c});
+                }
+            }
+            LoadPoints(vertices);
+            FindSeams(vertices);
+            ClassifyVertices();
+            AddQuadrics();
+        }
+
+        // collapses until targetIndexCount is reached or the cheapest
+        // collapse left costs more than maxCost, returns the highest cost
+        // paid
+        double Run(size_t targetIndexCount, double maxCost)
+        {
+            double worstCost = 0.0;
+            std::vector<uint32_t> remap(m_Points.size());
+            std::vector<uint8_t> touched(m_Points.size());
+            while (m_Indices.size() > targetIndexCount)
+            {
+                BuildAdjacency();
+                std::vector<Collapse> collapses = FindCollapses();
+                if (collapses.empty())
+                {
+                    break;
+                }
+
+                size_t triangleGoal = std::max<size_t>(
+                    (m_Indices.size() - targetIndexCount) / 3, 1);
+                size_t halfway =
+                    std::min(triangleGoal / 2, collapses.size() - 1);
+                double passCost = std::min(
+                    maxCost, collapses[halfway].cost * PASS_COST_SLACK);
+
+                for (uint32_t i = 0; i < remap.size(); i++)
+                {
+                    remap[i] = i;
+                }
+                std::fill(touched.begin(), touched.end(), 0);
+                size_t removed = 0;
+                size_t applied = 0;
+                for (const Collapse& collapse : collapses)
+                {
+                    if (removed >= triangleGoal || collapse.cost > maxCost ||
+                        (collapse.cost > passCost && applied > 0))
+                    {
+                        break;
+                    }
+                    // both ends stay put for the rest of the pass, so costs
+                    // and flip tests see a vertex move at most once
+                    if (touched[collapse.from] || touched[collapse.to])
+                    {
+                        continue;
+                    }
+                    size_t collapsed = 0;
+                    if (Flips(collapse, remap, collapsed))
+                    {
+                        continue;
+                    }
+                    remap[collapse.from] = collapse.to;
+                    m_Quadrics[collapse.to].Add(m_Quadrics[collapse.from]);
+                    touched[collapse.from] = 1;
+                    touched[collapse.to] = 1;
+                    removed += collapsed;
+                    applied++;
+                    worstCost = std::max(worstCost, collapse.cost);
+                }
+                if (applied == 0)
+                {
+                    break;
+                }
+
+                size_t count = 0;
+                for (size_t i = 0; i < m_Indices.size(); i += 3)
+                {
+                    uint32_t a = remap[m_Indices[i]];
+                    uint32_t b = remap[m_Indices[i + 1]];
+                    uint32_t c = remap[m_Indices[i + 2]];
+                    if (a != b && b != c && c != a)
+                    {
+                        m_Indices[count++] = a;
+                        m_Indices[count++] = b;
+                        m_Indices[count++] = c;
+                    }
+                }
+                m_Indices.resize(count);
+                ClassifyVertices();
+            }
+            return worstCost;
+        }
+
+        std::vector<uint32_t>& GetIndices() { return m_Indices; }
+
+    private:
+        void LoadPoints(std::span<const Vertex> vertices)
+        {
+            if (vertices.empty())
+            {
+                return;
+            }
+            glm::vec2 min = vertices[0].pos.Unpack();
+            glm::vec2 max = min;
+            for (const Vertex& vertex : vertices)
+            {
+                glm::vec2 position = vertex.pos.Unpack();
+                min = glm::min(min, position);
+                max = glm::max(max, position);
+            }
+            glm::vec2 center = (min + max) * 0.5f;
+            double radius = 0.0;
+            for (const Vertex& vertex : vertices)
+            {
+                radius = std::max(
+                    radius, static_cast<double>(
+                                glm::length(vertex.pos.Unpack() - center)));
+            }
+            if (radius == 0.0)
+            {
+                radius = 1.0;
+            }
+
+            for (size_t i = 0; i < vertices.size(); i++)
+            {
+                glm::vec2 position = vertices[i].pos.Unpack() - center;
+                glm::vec4 color = vertices[i].color.Unpack();
+                m_Points[i] = {
+                    position.x / radius, position.y / radius,
+                    color.x * COLOR_WEIGHT, color.y * COLOR_WEIGHT,
+                    color.z * COLOR_WEIGHT};
+            }
+        }
+
+        // edges are compared by position, so a seam between two colors is
+        // not mistaken for a boundary. the vertices along it are locked,
+        // collapsing one copy would tear the seam open
+        void FindSeams(std::span<const Vertex> vertices)
+        {
+            m_Positions.resize(vertices.size());
+            m_Seams.resize(vertices.size());
+            std::unordered_map<uint32_t, uint32_t> firstAt;
+            for (uint32_t i = 0; i < vertices.size(); i++)
+            {
+                uint32_t key = static_cast<uint32_t>(vertices[i].pos.x) |
+                               static_cast<uint32_t>(vertices[i].pos.y) << 16;
+                auto [found, inserted] = firstAt.emplace(key, i);
+                m_Positions[i] = found->second;
+                if (!inserted)
+                {
+                    m_Seams[i] = 1;
+                    m_Seams[found->second] = 1;
+                }
+            }
+        }
+
+        // directed edges by position, an edge without its reverse is on the
+        // boundary and one seen twice in the same direction is non-manifold
+        void ClassifyVertices()
+        {
+            m_Edges.clear();
+            for (size_t i = 0; i < m_Indices.size(); i += 3)
+            {
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    m_Edges.push_back(EdgeKey(
+                        m_Positions[m_Indices[i + corner]],
+                        m_Positions[m_Indices[i + (corner + 1) % 3]]));
+                }
+            }
+            std::sort(m_Edges.begin(), m_Edges.end());
+
+            for (size_t i = 0; i < m_Kinds.size(); i++)
+            {
+                m_Kinds[i] =
+                    m_Seams[i] ? VertexKind::Locked : VertexKind::Interior;
+            }
+            // the kind is kept per position, vertices read it through
+            // m_Positions
+            for (size_t i = 0; i < m_Edges.size(); i++)
+            {
+                uint32_t from = static_cast<uint32_t>(m_Edges[i] >> 32);
+                uint32_t to = static_cast<uint32_t>(m_Edges[i]);
+                if (i + 1 < m_Edges.size() && m_Edges[i + 1] == m_Edges[i])
+                {
+                    m_Kinds[from] = VertexKind::Locked;
+                    m_Kinds[to] = VertexKind::Locked;
+                }
+                else if (!HasEdge(to, from))
+                {
+                    MarkBoundary(from);
+                    MarkBoundary(to);
+                }
+            }
+        }
+
+        void MarkBoundary(uint32_t position)
+        {
+            if (m_Kinds[position] == VertexKind::Interior)
+            {
+                m_Kinds[position] = VertexKind::Boundary;
+            }
+        }
+
+        bool HasEdge(uint32_t from, uint32_t to) const
+        {
+            return std::binary_search(
+                m_Edges.begin(), m_Edges.end(), EdgeKey(from, to));
+        }
+
+        bool IsBoundaryEdge(uint32_t a, uint32_t b) const
+        {
+            uint32_t positionA = m_Positions[a];
+            uint32_t positionB = m_Positions[b];
+            return HasEdge(positionA, positionB) !=
+                   HasEdge(positionB, positionA);
+        }
+
+        VertexKind GetKind(uint32_t vertex) const
+        {
+            return m_Seams[vertex] ? VertexKind::Locked
+                                   : m_Kinds[m_Positions[vertex]];
+        }
+
+        void AddQuadrics()
+        {
+            for (size_t i = 0; i < m_Indices.size(); i += 3)
+            {
+                const Point& p0 = m_Points[m_Indices[i]];
+                const Point& p1 = m_Points[m_Indices[i + 1]];
+                const Point& p2 = m_Points[m_Indices[i + 2]];
+                double area = std::abs(
+                                  (p1[0] - p0[0]) * (p2[1] - p0[1]) -
+                                  (p1[1] - p0[1]) * (p2[0] - p0[0])) *
+                              0.5;
+                if (area == 0.0)
+                {
+                    continue;
+                }
+
+                // gram-schmidt, the position part alone already spans the
+                // plane so neither length can be 0
+                Point e1;
+                Point e2;
+                for (size_t k = 0; k < QUADRIC_DIMENSIONS; k++)
+                {
+                    e1[k] = p1[k] - p0[k];
+                    e2[k] = p2[k] - p0[k];
+                }
+                double length1 = std::sqrt(Dot(e1, e1));
+                for (double& value : e1)
+                {
+                    value /= length1;
+                }
+                double along = Dot(e2, e1);
+                for (size_t k = 0; k < QUADRIC_DIMENSIONS; k++)
+                {
+                    e2[k] -= along * e1[k];
+                }
+                double length2 = std::sqrt(Dot(e2, e2));
+                for (double& value : e2)
+                {
+                    value /= length2;
+                }
+
+                Quadric quadric = MakeTriangleQuadric(p0, e1, e2, area);
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    m_Quadrics[m_Indices[i + corner]].Add(quadric);
+                }
+            }
+
+            for (size_t i = 0; i < m_Indices.size(); i += 3)
+            {
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    uint32_t from = m_Indices[i + corner];
+                    uint32_t to = m_Indices[i + (corner + 1) % 3];
+                    if (!IsBoundaryEdge(from, to))
+                    {
+                        continue;
+                    }
+                    double dx = m_Points[to][0] - m_Points[from][0];
+                    double dy = m_Points[to][1] - m_Points[from][1];
+                    double length = std::sqrt(dx * dx + dy * dy);
+                    if (length == 0.0)
+                    {
+                        continue;
+                    }
+                    double nx = -dy / length;
+                    double ny = dx / length;
+                    double distance =
+                        -(nx * m_Points[from][0] + ny * m_Points[from][1]);
+                    Quadric quadric = MakeBoundaryQuadric(
+                        nx, ny, distance, BOUNDARY_WEIGHT * length * length);
+                    m_Quadrics[from].Add(quadric);
+                    m_Quadrics[to].Add(quadric);
+                }
+            }
+        }
+
+        // triangles around every vertex, rebuilt each pass
+        void BuildAdjacency()
+        {
+            m_TriangleOffsets.assign(m_Points.size() + 1, 0);
+            for (uint32_t index : m_Indices)
+            {
+                m_TriangleOffsets[index + 1]++;
+            }
+            for (size_t i = 1; i < m_TriangleOffsets.size(); i++)
+            {
+                m_TriangleOffsets[i] += m_TriangleOffsets[i - 1];
+            }
+            m_Triangles.resize(m_Indices.size());
+            std::vector<uint32_t> cursor(
+                m_TriangleOffsets.begin(), m_TriangleOffsets.end() - 1);
+            for (size_t i = 0; i < m_Indices.size(); i++)
+            {
+                m_Triangles[cursor[m_Indices[i]]++] =
+                    static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        bool CanCollapse(uint32_t from, uint32_t to) const
+        {
+            switch (GetKind(from))
+            {
+            case VertexKind::Interior:
+                return true;
+            case VertexKind::Boundary:
+                return IsBoundaryEdge(from, to);
+            case VertexKind::Locked:
+                return false;
+            }
+            return false;
+        }
+
+        // the cheaper direction of every edge that can collapse at all,
+        // cheapest first
+        std::vector<Collapse> FindCollapses() const
+        {
+            std::vector<uint64_t> edges;
+            edges.reserve(m_Indices.size());
+            for (size_t i = 0; i < m_Indices.size(); i += 3)
+            {
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    uint32_t a = m_Indices[i + corner];
+                    uint32_t b = m_Indices[i + (corner + 1) % 3];
+                    edges.push_back(EdgeKey(std::min(a, b), std::max(a, b)));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+            edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+            std::vector<Collapse> collapses;
+            collapses.reserve(edges.size());
+            for (uint64_t edge : edges)
+            {
+                uint32_t a = static_cast<uint32_t>(edge >> 32);
+                uint32_t b = static_cast<uint32_t>(edge);
+                Collapse best{0, 0, std::numeric_limits<double>::infinity()};
+                if (CanCollapse(a, b))
+                {
+                    best = {a, b, m_Quadrics[a].Evaluate(m_Points[b])};
+                }
+                if (CanCollapse(b, a))
+                {
+                    double cost = m_Quadrics[b].Evaluate(m_Points[a]);
+                    if (cost < best.cost)
+                    {
+                        best = {b, a, cost};
+                    }
+                }
+                if (best.cost != std::numeric_limits<double>::infinity())
+                {
+                    collapses.push_back(best);
+                }
+            }
+            std::sort(
+                collapses.begin(), collapses.end(),
+                [](const Collapse& x, const Collapse& y)
+                { return x.cost < y.cost; });
+            return collapses;
+        }
+
+        static double SignedArea(
+            const Point& a, const Point& b, const Point& c)
+        {
+            return (b[0] - a[0]) * (c[1] - a[1]) -
+                   (b[1] - a[1]) * (c[0] - a[0]);
+        }
+
+        static double SquaredLength(const Point& a, const Point& b)
+        {
+            double x = b[0] - a[0];
+            double y = b[1] - a[1];
+            return x * x + y * y;
+        }
+
+        // true when moving from onto to would fold, flatten or squash a
+        // triangle that survives the collapse. counts the triangles that
+        // collapse with the edge
+        bool Flips(
+            const Collapse& collapse, const std::vector<uint32_t>& remap,
+            size_t& collapsed) const
+        {
+            for (uint32_t t = m_TriangleOffsets[collapse.from];
+                 t < m_TriangleOffsets[collapse.from + 1]; t++)
+            {
+                uint32_t triangle = m_Triangles[t];
+                std::array<uint32_t, 3> corners;
+                for (size_t corner = 0; corner < 3; corner++)
+                {
+                    corners[corner] = remap[m_Indices[triangle * 3 + corner]];
+                }
+                if (corners[0] == corners[1] || corners[1] == corners[2] ||
+                    corners[2] == corners[0])
+                {
+                    continue;
+                }
+                if (std::find(corners.begin(), corners.end(), collapse.to) !=
+                    corners.end())
+                {
+                    collapsed++;
+                    continue;
+                }
+
+                double before = SignedArea(
+                    m_Points[corners[0]], m_Points[corners[1]],
+                    m_Points[corners[2]]);
+                for (uint32_t& corner : corners)
+                {
+                    if (corner == collapse.from)
+                    {
+                        corner = collapse.to;
+                    }
+                }
+                const Point& a = m_Points[corners[0]];
+                const Point& b = m_Points[corners[1]];
+                const Point& c = m_Points[corners[2]];
+                double after = SignedArea(a, b, c);
+                double longest = std::max(
+                    {SquaredLength(a, b), SquaredLength(b, c),
+                     SquaredLength(c, a)});
+                // in the winding the triangle had before
+                double oriented = before > 0.0 ? after : -after;
+                if (oriented <= MIN_TRIANGLE_SHAPE * longest)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        std::vector<uint32_t> m_Indices;
+        std::vector<Point> m_Points;
+        std::vector<Quadric> m_Quadrics;
+        // first vertex at the same position, edges and kinds go by this
+        std::vector<uint32_t> m_Positions;
+        std::vector<uint8_t> m_Seams;
+        // indexed by position
+        std::vector<VertexKind> m_Kinds;
+        // directed edges between positions, sorted
+        std::vector<uint64_t> m_Edges;
+        std::vector<uint32_t> m_TriangleOffsets;
+        std::vector<uint32_t> m_Triangles;
+    };
+}
+
+std::vector<uint32_t> SimplifyMesh(
+    std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+    size_t targetIndexCount, float maxError, float* error)
+{
+    if (indices.size() % 3 != 0)
+    {
+        LogError(fmt::format(
+            "Mesh has {} indices, not a triangle list", indices.size()));
+    }
+    for (uint32_t index : indices)
+    {
+        if (index >= vertices.size())
+        {
+            LogError(fmt::format(
+                "Mesh index {} is out of range of {} vertices", index,
+                vertices.size()));
+        }
+    }
+
+    Simplifier simplifier(vertices, indices);
+    double cost = simplifier.Run(
+        targetIndexCount, static_cast<double>(maxError) * maxError);
+    if (error)
+    {
+        *error = static_cast<float>(std::sqrt(cost));
+    }
+    return std::move(simplifier.GetIndices());
+}
+
+LodChain BuildLodChain(
+    std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+    uint32_t maxLods)
+{
+    LodChain chain;
+    chain.indices.assign(indices.begin(), indices.end());
+    chain.lods.push_back({0, static_cast<uint32_t>(indices.size()), 0.0f});
+
+    std::vector<uint32_t> level(indices.begin(), indices.end());
+    float error = 0.0f;
+    while (chain.lods.size() < maxLods && error < LOD_MAX_ERROR)
+    {
+        size_t target =
+            static_cast<size_t>(level.size() / 3 * LOD_REDUCTION) * 3;
+        float levelError = 0.0f;
+        std::vector<uint32_t> next = SimplifyMesh(
+            vertices, level, target, LOD_MAX_ERROR - error, &levelError);
+        if (next.empty() || next.size() > level.size() * LOD_MIN_REDUCTION)
+        {
+            break;
+        }
+        // each level is measured against the one before, so the errors add
+        // up along the chain
+        error += levelError;
+        chain.lods.push_back(
+            {static_cast<uint32_t>(chain.indices.size()),
+             static_cast<uint32_t>(next.size()), error});
+        chain.indices.insert(chain.indices.end(), next.begin(), next.end());
+        level = std::move(next);
+    }
+    return chain;
+}
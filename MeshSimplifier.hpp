@@ -0,0 +1,39 @@
+#pragma once
+
+#include "MeshLod.hpp"
+#include "Vertex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// edge collapse simplification of 2d triangle meshes with quadric error
+// metrics. every collapse moves a vertex onto one of its neighbours, so a
+// simplified mesh indexes the original vertices and all levels of a mesh
+// share one vertex buffer. errors are measured over position and color
+// together, with positions scaled so the mesh's bounding radius is 1
+//
+// vertices at the same position as another vertex, color seams, and
+// vertices on non-manifold edges never move. boundary vertices only slide
+// along the boundary, so the outline is kept
+
+// a triangle list of at most targetIndexCount indices, or more if going
+// further would need a collapse costing more than maxError. error is set to
+// the largest error of any collapse made
+std::vector<uint32_t> SimplifyMesh(
+    std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+    size_t targetIndexCount, float maxError, float* error = nullptr);
+
+// the indices of every level back to back, finest first
+struct LodChain
+{
+    std::vector<uint32_t> indices;
+    std::vector<MeshLod> lods;
+};
+
+// the full mesh followed by up to maxLods - 1 simplified levels, each
+// simplified from the one before. the chain stops early once a level no
+// longer removes much or strays too far from the full mesh
+LodChain BuildLodChain(
+    std::span<const Vertex> vertices, std::span<const uint32_t> indices,
+    uint32_t maxLods = MAX_MESH_LODS);
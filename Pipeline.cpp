@@ -1,33 +1,39 @@
 #include "Pipeline.hpp"
+#include "Log.hpp"
+#include "PushConstants.hpp"
 #include "Vertex.hpp"
+#include <array>
 
 GraphicsPipeline::GraphicsPipeline(
-    Device& device, RenderPass& renderPass, Surface& surface,
-    Descriptors& descriptors)
-    : m_PipelineLayout(CreatePipelineLayout(device, descriptors)),
-      m_Pipeline(CreatePipeline(device, renderPass, surface))
+    Device& device, LayoutCache& layouts, RenderPass& renderPass,
+    Descriptors& descriptors, std::vector<Shader> shaders,
+    const vk::raii::PipelineCache* cache)
+    : m_Shaders(std::move(shaders)),
+      m_PipelineLayout(CreatePipelineLayout(layouts, descriptors)),
+      m_Pipeline(CreatePipeline(device, renderPass, cache))
 {
 }
 
 vk::raii::Pipeline& GraphicsPipeline::Get() { return m_Pipeline; }
-vk::raii::PipelineLayout& GraphicsPipeline::GetLayout()
+vk::PipelineLayout GraphicsPipeline::GetLayout() const
 {
     return m_PipelineLayout;
 }
 
 vk::raii::Pipeline GraphicsPipeline::CreatePipeline(
-    Device& device, RenderPass& renderPass, Surface& surface)
+    Device& device, RenderPass& renderPass,
+    const vk::raii::PipelineCache* cache)
 {
-    m_Shaders = LoadShaders(device.Get());
+    if (m_Shaders.empty())
+    {
+        LogError("Cant create a pipeline without shaders");
+    }
     std::vector<vk::PipelineShaderStageCreateInfo> shaderStages =
         CreateShaderStage();
 
-    vk::VertexInputBindingDescription bindingDescription(
-        0, sizeof(Vertex), vk::VertexInputRate::eVertex);
-
-    std::array<vk::VertexInputAttributeDescription, 2> attributeDescription = {
-        {{0, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, pos)},
-         {1, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, color)}}};
+    vk::VertexInputBindingDescription bindingDescription =
+        GetVertexBinding<Vertex>();
+    auto attributeDescription = GetVertexAttributes<Vertex>();
 
     vk::PipelineVertexInputStateCreateInfo vertexInputState(
         {}, bindingDescription, attributeDescription);
@@ -35,12 +41,9 @@ vk::raii::Pipeline GraphicsPipeline::CreatePipeline(
     vk::PipelineInputAssemblyStateCreateInfo inputAssemblyState(
         {}, vk::PrimitiveTopology::eTriangleList, {});
 
-    vk::Viewport viewport(
-        0.0f, 0.0f, surface.surfaceCapabilities.currentExtent.width,
-        surface.surfaceCapabilities.currentExtent.height, 0.0f, 1.0f);
-    vk::Rect2D scissor({}, surface.surfaceCapabilities.currentExtent);
-
-    vk::PipelineViewportStateCreateInfo viewportState({}, viewport, scissor);
+    // only the counts matter, both are dynamic state
+    vk::PipelineViewportStateCreateInfo viewportState(
+        {}, 1, nullptr, 1, nullptr);
 
     vk::PipelineRasterizationStateCreateInfo rasteriztionState{};
     rasteriztionState.setCullMode(vk::CullModeFlagBits::eBack);
@@ -52,8 +55,9 @@ vk::raii::Pipeline GraphicsPipeline::CreatePipeline(
     vk::StencilOpState backStencil{};
 
     vk::PipelineDepthStencilStateCreateInfo depthStencilState{};
+    depthStencilState.setDepthTestEnable(VK_TRUE);
     depthStencilState.setDepthCompareOp(vk::CompareOp::eLess);
-    depthStencilState.setMaxDepthBounds(100.0f);
+    depthStencilState.setMaxDepthBounds(1.0f);
     depthStencilState.setDepthWriteEnable(VK_TRUE);
 
     vk::PipelineColorBlendAttachmentState colorAttachment{};
@@ -62,26 +66,35 @@ vk::raii::Pipeline GraphicsPipeline::CreatePipeline(
     vk::PipelineColorBlendStateCreateInfo colorBlendState(
         {}, VK_FALSE, vk::LogicOp::eClear, colorAttachment);
 
+    // viewport and scissor are set while recording so the pipeline survives
+    // swapchain resizes
+    std::array<vk::DynamicState, 2> dynamicStates = {
+        vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+    vk::PipelineDynamicStateCreateInfo dynamicState({}, dynamicStates);
+
     vk::GraphicsPipelineCreateInfo graphicsPipelineCreateInfo(
         {}, shaderStages, &vertexInputState, &inputAssemblyState, {},
         &viewportState, &rasteriztionState, &multisampleState,
-        &depthStencilState, &colorBlendState, {}, *m_PipelineLayout,
-        *renderPass.Get());
+        &depthStencilState, &colorBlendState, &dynamicState,
+        m_PipelineLayout, *renderPass.Get());
 
     return device.Get().createGraphicsPipeline(
-        nullptr, graphicsPipelineCreateInfo);
+        cache, graphicsPipelineCreateInfo);
 }
 
-vk::raii::PipelineLayout
-GraphicsPipeline::CreatePipelineLayout(Device& device, Descriptors& descriptors)
+vk::PipelineLayout GraphicsPipeline::CreatePipelineLayout(
+    LayoutCache& layouts, Descriptors& descriptors)
 {
-    std::vector<vk::DescriptorSetLayout> descriptorSetLayouts;
-    for (auto& layout : descriptors.GetLayouts())
+    if (m_Shaders.empty())
     {
-        descriptorSetLayouts.push_back(*layout);
+        LogError("Cant create a pipeline layout without shaders");
     }
-    vk::PipelineLayoutCreateInfo createInfo({}, descriptorSetLayouts);
-    return device.Get().createPipelineLayout(createInfo);
+    // the stages are built from the first shader, so is the layout. the
+    // cache checks it reads the per frame set and fits in DrawConstants
+    vk::DescriptorSetLayout setLayout = descriptors.GetLayout();
+    return layouts.GetPipelineLayout(
+        m_Shaders.front(), {&setLayout, 1},
+        PushConstantSize<DrawConstants>::value);
 }
 
 std::vector<vk::PipelineShaderStageCreateInfo>
@@ -2,33 +2,39 @@
 
 #include "Descriptors.hpp"
 #include "Device.hpp"
+#include "LayoutCache.hpp"
 #include "RenderPass.hpp"
 #include "Shader.hpp"
-#include "Surface.hpp"
 
 #include <vulkan/vulkan_raii.hpp>
 
 class GraphicsPipeline
 {
 public:
+    // viewport and scissor are dynamic, so nothing here depends on the
+    // swapchain and the pipeline can be built on any thread. a cache lets
+    // the driver skip compiling what it has compiled before. the layout
+    // comes from the shaders' reflection and is shared through the cache
     GraphicsPipeline(
-        Device& device, RenderPass& renderPass, Surface& surface,
-        Descriptors& descriptors);
+        Device& device, LayoutCache& layouts, RenderPass& renderPass,
+        Descriptors& descriptors, std::vector<Shader> shaders,
+        const vk::raii::PipelineCache* cache = nullptr);
     std::vector<vk::PipelineShaderStageCreateInfo> CreateShaderStage();
 
     vk::raii::Pipeline& Get();
-    vk::raii::PipelineLayout& GetLayout();
+    vk::PipelineLayout GetLayout() const;
 
 private:
-    vk::raii::Pipeline
-    CreatePipeline(Device& device, RenderPass& renderPass, Surface& surface);
-    vk::raii::PipelineLayout
-    CreatePipelineLayout(Device& device, Descriptors& descriptors);
+    vk::raii::Pipeline CreatePipeline(
+        Device& device, RenderPass& renderPass,
+        const vk::raii::PipelineCache* cache);
+    vk::PipelineLayout
+    CreatePipelineLayout(LayoutCache& layouts, Descriptors& descriptors);
 
     vk::DescriptorSetLayoutCreateInfo GetDescriptorSetLayoutCreateInfo();
     void CreateDescriptorSetLayoutBindings();
 
     std::vector<Shader> m_Shaders;
-    vk::raii::PipelineLayout m_PipelineLayout;
+    vk::PipelineLayout m_PipelineLayout;
     vk::raii::Pipeline m_Pipeline;
 };
\ No newline at end of file
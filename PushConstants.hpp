@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/mat2x2.hpp>
+#include <type_traits>
+#include <vulkan/vulkan_raii.hpp>
+
+// every device supports at least this many bytes of push constants, types
+// are checked against it at compile time, the device's actual limit is
+// checked when a pipeline layout declares the range
+constexpr uint32_t MIN_PUSH_CONSTANTS_SIZE = 128;
+
+// small per draw state, pushed while recording so drawing costs no buffer
+// writes or descriptor binds. std430 layout matching the push_constant
+// block in shader.vert
+struct DrawConstants
+{
+    glm::mat2 rotation;
+    float colorRotation;
+};
+
+// instantiated by the helpers below so every pushed type gets checked
+template <typename T> struct PushConstantSize
+{
+    static_assert(
+        std::is_trivially_copyable_v<T>, "push constants are copied as bytes");
+    static_assert(sizeof(T) % 4 == 0, "push constant sizes are multiples of 4");
+    static_assert(
+        sizeof(T) <= MIN_PUSH_CONSTANTS_SIZE,
+        "larger than the guaranteed push constant space");
+
+    static constexpr uint32_t value = sizeof(T);
+};
+
+template <typename T>
+vk::PushConstantRange
+MakePushConstantRange(vk::ShaderStageFlags stages, uint32_t offset = 0)
+{
+    return vk::PushConstantRange(stages, offset, PushConstantSize<T>::value);
+}
+
+template <typename T>
+void PushConstants(
+    vk::raii::CommandBuffer& commandBuffer, vk::PipelineLayout layout,
+    vk::ShaderStageFlags stages, const T& constants, uint32_t offset = 0)
+{
+    static_assert(PushConstantSize<T>::value > 0);
+    commandBuffer.pushConstants<T>(layout, stages, offset, constants);
+}
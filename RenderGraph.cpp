@@ -0,0 +1,627 @@
+#include "RenderGraph.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <numeric>
+
+RenderGraph::PassBuilder::PassBuilder(RenderGraph& graph, size_t passIndex)
+    : m_Graph(graph), m_PassIndex(passIndex)
+{
+}
+
+void RenderGraph::PassBuilder::Read(
+    RenderResource resource, ResourceUsage usage)
+{
+    m_Graph.m_Passes.at(m_PassIndex).accesses.push_back({resource, usage, false});
+}
+
+void RenderGraph::PassBuilder::Write(
+    RenderResource resource, ResourceUsage usage)
+{
+    m_Graph.m_Passes.at(m_PassIndex).accesses.push_back({resource, usage, true});
+}
+
+void RenderGraph::PassBuilder::SetSideEffect()
+{
+    m_Graph.m_Passes.at(m_PassIndex).sideEffect = true;
+}
+
+RenderResource RenderGraph::CreateImage(
+    const std::string& name, vk::Format format, vk::Extent2D extent,
+    vk::ImageAspectFlags aspect)
+{
+    Resource resource{name, format, extent, aspect, false};
+    m_Resources.push_back(resource);
+    m_Compiled = false;
+    return static_cast<RenderResource>(m_Resources.size() - 1);
+}
+
+RenderResource RenderGraph::ImportImage(
+    const std::string& name, vk::Format format, vk::Extent2D extent,
+    vk::ImageLayout finalLayout)
+{
+    Resource resource{
+        name, format, extent, vk::ImageAspectFlagBits::eColor, true,
+        finalLayout};
+    // imported images come from the swapchain, the acquire semaphore is waited
+    // on at the color attachment stage so barriers have to chain off of it
+    resource.initialState.stages =
+        vk::PipelineStageFlagBits::eColorAttachmentOutput;
+    m_Resources.push_back(resource);
+    m_Compiled = false;
+    return static_cast<RenderResource>(m_Resources.size() - 1);
+}
+
+void RenderGraph::AddPass(
+    const std::string& name, const SetupFunction& setup,
+    const RecordFunction& record)
+{
+    m_Passes.push_back({name, record});
+    PassBuilder builder(*this, m_Passes.size() - 1);
+    setup(builder);
+    m_Compiled = false;
+}
+
+void RenderGraph::Compile(Device& device)
+{
+    m_Order.clear();
+    m_MemoryBlocks.clear();
+    m_ImageViews.clear();
+    m_Images.clear();
+
+    Schedule();
+    AllocateTransients(device);
+    // nothing recorded yet says what used the memory before, the first
+    // frame waits on all of it. a recording of that frame may be submitted
+    // again later, so it has to be safe after any earlier frame
+    m_BlockStates.assign(
+        m_MemoryBlocks.size(),
+        {vk::ImageLayout::eUndefined, vk::PipelineStageFlagBits::eAllCommands,
+         vk::AccessFlagBits::eMemoryWrite, true});
+
+    LogDebug(fmt::format(
+        "Render graph: {} passes ({} culled), {} transient bytes",
+        m_Passes.size(), GetCulledPassCount(), GetTransientMemorySize()));
+    m_Compiled = true;
+}
+
+void RenderGraph::Schedule()
+{
+    m_Order.clear();
+    CullPasses();
+    SortPasses();
+    ComputeLifetimes();
+}
+
+void RenderGraph::Reset(DeletionQueue& deletions)
+{
+    m_Order.clear();
+    deletions.Retire(std::move(m_ImageViews));
+    deletions.Retire(std::move(m_Images));
+    deletions.Retire(std::move(m_MemoryBlocks));
+    m_MemoryBlocks.clear();
+    m_BlockStates.clear();
+    m_ImageViews.clear();
+    m_Images.clear();
+    m_Passes.clear();
+    m_Resources.clear();
+    m_Compiled = false;
+}
+
+void RenderGraph::CullPasses()
+{
+    // walk backwards from the imported outputs, a pass is kept only if a kept
+    // pass (or the outside world) consumes something it writes
+    std::vector<bool> needed(m_Resources.size(), false);
+    for (size_t i = 0; i < m_Resources.size(); i++)
+    {
+        needed.at(i) = m_Resources.at(i).imported;
+    }
+
+    for (size_t i = m_Passes.size(); i-- > 0;)
+    {
+        Pass& pass = m_Passes.at(i);
+        pass.culled = !pass.sideEffect;
+        for (const ResourceAccess& access : pass.accesses)
+        {
+            if (access.write && needed.at(access.resource))
+            {
+                pass.culled = false;
+            }
+        }
+        if (pass.culled)
+        {
+            continue;
+        }
+        for (const ResourceAccess& access : pass.accesses)
+        {
+            if (access.write)
+            {
+                needed.at(access.resource) = false;
+            }
+        }
+        for (const ResourceAccess& access : pass.accesses)
+        {
+            if (!access.write)
+            {
+                needed.at(access.resource) = true;
+            }
+        }
+    }
+}
+
+void RenderGraph::SortPasses()
+{
+    // edges from the last pass touching a resource to the next pass touching
+    // it, unless both only read it
+    std::vector<std::vector<size_t>> edges(m_Passes.size());
+    std::vector<size_t> incoming(m_Passes.size(), 0);
+    std::vector<size_t> lastWriter(m_Resources.size(), SIZE_MAX);
+    std::vector<std::vector<size_t>> readers(m_Resources.size());
+
+    for (size_t i = 0; i < m_Passes.size(); i++)
+    {
+        const Pass& pass = m_Passes.at(i);
+        if (pass.culled)
+        {
+            continue;
+        }
+        for (const ResourceAccess& access : pass.accesses)
+        {
+            std::vector<size_t> dependencies;
+            if (lastWriter.at(access.resource) != SIZE_MAX)
+            {
+                dependencies.push_back(lastWriter.at(access.resource));
+            }
+            if (access.write)
+            {
+                const std::vector<size_t>& resourceReaders =
+                    readers.at(access.resource);
+                dependencies.insert(
+                    dependencies.end(), resourceReaders.begin(),
+                    resourceReaders.end());
+            }
+            for (size_t dependency : dependencies)
+            {
+                if (dependency != i &&
+                    std::find(
+                        edges.at(dependency).begin(), edges.at(dependency).end(),
+                        i) == edges.at(dependency).end())
+                {
+                    edges.at(dependency).push_back(i);
+                    incoming.at(i)++;
+                }
+            }
+        }
+        for (const ResourceAccess& access : pass.accesses)
+        {
+            if (access.write)
+            {
+                lastWriter.at(access.resource) = i;
+                readers.at(access.resource).clear();
+            }
+            else
+            {
+                readers.at(access.resource).push_back(i);
+            }
+        }
+    }
+
+    // kahn's algorithm, always picking the earliest declared pass that is
+    // ready so the order stays stable
+    std::vector<size_t> ready;
+    for (size_t i = 0; i < m_Passes.size(); i++)
+    {
+        if (!m_Passes.at(i).culled && incoming.at(i) == 0)
+        {
+            ready.push_back(i);
+        }
+    }
+    while (!ready.empty())
+    {
+        auto next = std::min_element(ready.begin(), ready.end());
+        size_t passIndex = *next;
+        ready.erase(next);
+        m_Order.push_back(passIndex);
+        for (size_t dependent : edges.at(passIndex))
+        {
+            if (--incoming.at(dependent) == 0)
+            {
+                ready.push_back(dependent);
+            }
+        }
+    }
+}
+
+void RenderGraph::ComputeLifetimes()
+{
+    for (Resource& resource : m_Resources)
+    {
+        resource.usage = {};
+        resource.firstUse = SIZE_MAX;
+        resource.lastUse = 0;
+        resource.memoryBlock = SIZE_MAX;
+    }
+    for (size_t position = 0; position < m_Order.size(); position++)
+    {
+        for (const ResourceAccess& access :
+             m_Passes.at(m_Order.at(position)).accesses)
+        {
+            Resource& resource = m_Resources.at(access.resource);
+            resource.usage |= GetUsageFlags(access.usage);
+            resource.firstUse = std::min(resource.firstUse, position);
+            resource.lastUse = std::max(resource.lastUse, position);
+        }
+    }
+}
+
+void RenderGraph::AllocateTransients(Device& device)
+{
+    const vk::ImageUsageFlags attachmentUsage =
+        vk::ImageUsageFlagBits::eColorAttachment |
+        vk::ImageUsageFlagBits::eDepthStencilAttachment;
+
+    vk::PhysicalDeviceMemoryProperties memoryProperties =
+        device.GetPhysicalDevice().getMemoryProperties();
+    auto supportsLazyAllocation = [&](uint32_t memoryTypeBits)
+    {
+        for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++)
+        {
+            if ((memoryTypeBits & (1 << i)) &&
+                (memoryProperties.memoryTypes[i].propertyFlags &
+                 vk::MemoryPropertyFlagBits::eLazilyAllocated))
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::vector<RenderResource> transients;
+    std::vector<vk::MemoryRequirements> requirements(m_Resources.size());
+    std::vector<vk::MemoryPropertyFlags> properties(m_Resources.size());
+    m_Images.reserve(m_Resources.size());
+    for (RenderResource i = 0; i < m_Resources.size(); i++)
+    {
+        Resource& resource = m_Resources.at(i);
+        if (resource.imported || resource.firstUse == SIZE_MAX)
+        {
+            continue;
+        }
+
+        bool attachmentOnly = !(resource.usage & ~attachmentUsage);
+        vk::ImageUsageFlags usage = resource.usage;
+        if (attachmentOnly)
+        {
+            usage |= vk::ImageUsageFlagBits::eTransientAttachment;
+        }
+
+        vk::ImageCreateInfo createInfo(
+            {}, vk::ImageType::e2D, resource.format,
+            vk::Extent3D(resource.extent, 1), 1, 1,
+            vk::SampleCountFlagBits::e1, vk::ImageTiling::eOptimal, usage,
+            vk::SharingMode::eExclusive, 0, nullptr,
+            vk::ImageLayout::eUndefined);
+        vk::raii::Image& image = m_Images.emplace_back(device.Get(), createInfo);
+        resource.image = *image;
+
+        requirements.at(i) = image.getMemoryRequirements();
+        properties.at(i) =
+            attachmentOnly && supportsLazyAllocation(
+                                  requirements.at(i).memoryTypeBits)
+                ? vk::MemoryPropertyFlagBits::eLazilyAllocated
+                : vk::MemoryPropertyFlagBits::eDeviceLocal;
+        transients.push_back(i);
+    }
+
+    // largest first, then greedily drop each image into the first block whose
+    // current tenants are all dead by the time it is needed
+    std::sort(
+        transients.begin(), transients.end(),
+        [&](RenderResource a, RenderResource b)
+        { return requirements.at(a).size > requirements.at(b).size; });
+
+    for (RenderResource i : transients)
+    {
+        Resource& resource = m_Resources.at(i);
+        const vk::MemoryRequirements& requirement = requirements.at(i);
+        for (size_t b = 0; b < m_MemoryBlocks.size(); b++)
+        {
+            MemoryBlock& block = m_MemoryBlocks.at(b);
+            if (block.properties != properties.at(i) ||
+                !(block.memoryTypeBits & requirement.memoryTypeBits))
+            {
+                continue;
+            }
+            bool overlaps = std::any_of(
+                block.resources.begin(), block.resources.end(),
+                [&](RenderResource other)
+                {
+                    const Resource& tenant = m_Resources.at(other);
+                    return resource.firstUse <= tenant.lastUse &&
+                           tenant.firstUse <= resource.lastUse;
+                });
+            if (!overlaps)
+            {
+                resource.memoryBlock = b;
+                break;
+            }
+        }
+        if (resource.memoryBlock == SIZE_MAX)
+        {
+            resource.memoryBlock = m_MemoryBlocks.size();
+            m_MemoryBlocks.emplace_back().properties = properties.at(i);
+        }
+
+        MemoryBlock& block = m_MemoryBlocks.at(resource.memoryBlock);
+        block.size = std::max(block.size, requirement.size);
+        block.memoryTypeBits &= requirement.memoryTypeBits;
+        block.resources.push_back(i);
+    }
+
+    for (MemoryBlock& block : m_MemoryBlocks)
+    {
+        uint32_t memoryTypeIndex = device.FindMemoryType(
+            vk::MemoryRequirements(block.size, 0, block.memoryTypeBits),
+            block.properties);
+        block.memory = vk::raii::DeviceMemory(
+            device.Get(), vk::MemoryAllocateInfo(block.size, memoryTypeIndex));
+        if (block.resources.size() > 1)
+        {
+            LogDebug(fmt::format(
+                "Render graph: aliasing {} images in {} bytes",
+                block.resources.size(), block.size));
+        }
+    }
+
+    m_ImageViews.reserve(transients.size());
+    for (RenderResource i : transients)
+    {
+        Resource& resource = m_Resources.at(i);
+        vk::raii::Image& image = *std::find_if(
+            m_Images.begin(), m_Images.end(),
+            [&](vk::raii::Image& owned) { return *owned == resource.image; });
+        image.bindMemory(*m_MemoryBlocks.at(resource.memoryBlock).memory, 0);
+
+        vk::ImageViewCreateInfo createInfo(
+            {}, resource.image, vk::ImageViewType::e2D, resource.format, {},
+            vk::ImageSubresourceRange(resource.aspect, 0, 1, 0, 1));
+        resource.imageView = *m_ImageViews.emplace_back(device.Get(), createInfo);
+    }
+}
+
+void RenderGraph::Execute(
+    vk::raii::CommandBuffer& commandBuffer, std::pmr::memory_resource* memory)
+{
+    if (!m_Compiled)
+    {
+        LogError("Render graph executed before being compiled");
+    }
+
+    for (Resource& resource : m_Resources)
+    {
+        if (resource.imported && !resource.image)
+        {
+            LogError(fmt::format(
+                "Render graph import {} has no image bound", resource.name));
+        }
+        // transient contents never outlive a frame, only the layout starts
+        // over. the stages come from m_BlockStates at the first use
+        resource.state = resource.initialState;
+    }
+
+    // reused by every pass, it only ever grows to the most barriers one pass
+    // needs
+    Barrier barrier{{}, {}, std::pmr::vector<vk::ImageMemoryBarrier>(memory)};
+
+    for (size_t position = 0; position < m_Order.size(); position++)
+    {
+        Pass& pass = m_Passes.at(m_Order.at(position));
+
+        barrier.srcStages = {};
+        barrier.dstStages = {};
+        barrier.imageBarriers.clear();
+        for (const ResourceAccess& access : pass.accesses)
+        {
+            // the write's state covers a read of the same resource in the
+            // same pass, a barrier for each would not be ordered
+            if (!access.write && WritesResource(pass, access.resource))
+            {
+                continue;
+            }
+            Resource& resource = m_Resources.at(access.resource);
+            if (position == resource.firstUse &&
+                resource.memoryBlock != SIZE_MAX)
+            {
+                // whatever last lived in the block, earlier this frame or
+                // in the previous one, is waited for before it is overwritten
+                const ResourceState& blockState =
+                    m_BlockStates.at(resource.memoryBlock);
+                resource.state.stages = blockState.stages;
+                resource.state.access = blockState.access;
+                resource.state.written = blockState.written;
+            }
+
+            TransitionResource(
+                resource, GetUsageState(access.usage, access.write), barrier);
+
+            if (resource.memoryBlock != SIZE_MAX)
+            {
+                m_BlockStates.at(resource.memoryBlock) = resource.state;
+            }
+        }
+
+        if (!barrier.imageBarriers.empty())
+        {
+            commandBuffer.pipelineBarrier(
+                barrier.srcStages, barrier.dstStages, {}, nullptr, nullptr,
+                barrier.imageBarriers);
+        }
+        pass.record(commandBuffer);
+    }
+
+    barrier.srcStages = {};
+    barrier.dstStages = {};
+    barrier.imageBarriers.clear();
+    for (Resource& resource : m_Resources)
+    {
+        if (!resource.imported ||
+            resource.finalLayout == vk::ImageLayout::eUndefined ||
+            resource.finalLayout == resource.state.layout)
+        {
+            continue;
+        }
+        ResourceState finalState{
+            resource.finalLayout, vk::PipelineStageFlagBits::eBottomOfPipe, {},
+            false};
+        TransitionResource(resource, finalState, barrier);
+    }
+    if (!barrier.imageBarriers.empty())
+    {
+        commandBuffer.pipelineBarrier(
+            barrier.srcStages, barrier.dstStages, {}, nullptr, nullptr,
+            barrier.imageBarriers);
+    }
+}
+
+void RenderGraph::TransitionResource(
+    Resource& resource, const ResourceState& nextState, Barrier& barrier)
+{
+    bool layoutChange = resource.state.layout != nextState.layout;
+    bool hazard = resource.state.written || nextState.written;
+
+    if (!layoutChange && !hazard)
+    {
+        // read after read in the same layout needs nothing, just widen the
+        // scope the next writer has to wait on
+        resource.state.stages |= nextState.stages;
+        resource.state.access |= nextState.access;
+        return;
+    }
+
+    barrier.srcStages |= resource.state.stages;
+    barrier.dstStages |= nextState.stages;
+    barrier.imageBarriers.emplace_back(
+        resource.state.written ? resource.state.access : vk::AccessFlags{},
+        nextState.access, resource.state.layout, nextState.layout,
+        VK_QUEUE_FAMILY_IGNORED, VK_QUEUE_FAMILY_IGNORED, resource.image,
+        vk::ImageSubresourceRange(resource.aspect, 0, 1, 0, 1));
+
+    resource.state = nextState;
+}
+
+RenderGraph::ResourceState
+RenderGraph::GetUsageState(ResourceUsage usage, bool write)
+{
+    switch (usage)
+    {
+    case ResourceUsage::ColorAttachment:
+        return {
+            vk::ImageLayout::eColorAttachmentOptimal,
+            vk::PipelineStageFlagBits::eColorAttachmentOutput,
+            write ? vk::AccessFlagBits::eColorAttachmentWrite |
+                        vk::AccessFlagBits::eColorAttachmentRead
+                  : vk::AccessFlagBits::eColorAttachmentRead,
+            write};
+    case ResourceUsage::DepthAttachment:
+        return {
+            vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            vk::PipelineStageFlagBits::eEarlyFragmentTests |
+                vk::PipelineStageFlagBits::eLateFragmentTests,
+            write ? vk::AccessFlagBits::eDepthStencilAttachmentWrite |
+                        vk::AccessFlagBits::eDepthStencilAttachmentRead
+                  : vk::AccessFlagBits::eDepthStencilAttachmentRead,
+            write};
+    case ResourceUsage::Sampled:
+        return {
+            vk::ImageLayout::eShaderReadOnlyOptimal,
+            vk::PipelineStageFlagBits::eFragmentShader,
+            vk::AccessFlagBits::eShaderRead, false};
+    case ResourceUsage::TransferSrc:
+        return {
+            vk::ImageLayout::eTransferSrcOptimal,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::AccessFlagBits::eTransferRead, false};
+    case ResourceUsage::TransferDst:
+        return {
+            vk::ImageLayout::eTransferDstOptimal,
+            vk::PipelineStageFlagBits::eTransfer,
+            vk::AccessFlagBits::eTransferWrite, true};
+    case ResourceUsage::Present:
+        return {
+            vk::ImageLayout::ePresentSrcKHR,
+            vk::PipelineStageFlagBits::eBottomOfPipe, {}, false};
+    }
+    LogError("Unknown render graph resource usage");
+    return {};
+}
+
+bool RenderGraph::WritesResource(const Pass& pass, RenderResource resource)
+{
+    return std::any_of(
+        pass.accesses.begin(), pass.accesses.end(),
+        [&](const ResourceAccess& access)
+        { return access.write && access.resource == resource; });
+}
+
+vk::ImageUsageFlags RenderGraph::GetUsageFlags(ResourceUsage usage)
+{
+    switch (usage)
+    {
+    case ResourceUsage::ColorAttachment:
+        return vk::ImageUsageFlagBits::eColorAttachment;
+    case ResourceUsage::DepthAttachment:
+        return vk::ImageUsageFlagBits::eDepthStencilAttachment;
+    case ResourceUsage::Sampled:
+        return vk::ImageUsageFlagBits::eSampled;
+    case ResourceUsage::TransferSrc:
+        return vk::ImageUsageFlagBits::eTransferSrc;
+    case ResourceUsage::TransferDst:
+        return vk::ImageUsageFlagBits::eTransferDst;
+    case ResourceUsage::Present:
+        return {};
+    }
+    return {};
+}
+
+void RenderGraph::SetImportedImage(
+    RenderResource resource, vk::Image image, vk::ImageView imageView)
+{
+    Resource& imported = m_Resources.at(resource);
+    if (!imported.imported)
+    {
+        LogError(fmt::format(
+            "Render graph resource {} is not imported", imported.name));
+    }
+    imported.image = image;
+    imported.imageView = imageView;
+}
+
+vk::Image RenderGraph::GetImage(RenderResource resource)
+{
+    return m_Resources.at(resource).image;
+}
+
+vk::ImageView RenderGraph::GetImageView(RenderResource resource)
+{
+    return m_Resources.at(resource).imageView;
+}
+
+vk::Extent2D RenderGraph::GetExtent(RenderResource resource)
+{
+    return m_Resources.at(resource).extent;
+}
+
+size_t RenderGraph::GetCulledPassCount() const
+{
+    return std::count_if(
+        m_Passes.begin(), m_Passes.end(),
+        [](const Pass& pass) { return pass.culled; });
+}
+
+vk::DeviceSize RenderGraph::GetTransientMemorySize() const
+{
+    return std::accumulate(
+        m_MemoryBlocks.begin(), m_MemoryBlocks.end(), vk::DeviceSize(0),
+        [](vk::DeviceSize total, const MemoryBlock& block)
+        { return total + block.size; });
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include "DeletionQueue.hpp"
+#include "Device.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+using RenderResource = uint32_t;
+
+enum class ResourceUsage
+{
+    ColorAttachment,
+    DepthAttachment,
+    Sampled,
+    TransferSrc,
+    TransferDst,
+    Present
+};
+
+class RenderGraph
+{
+public:
+    class PassBuilder
+    {
+    public:
+        // a pass that keeps what is already there, a load op or blending,
+        // reads as well as writes, otherwise earlier writers are culled
+        void Read(RenderResource resource, ResourceUsage usage);
+        void Write(RenderResource resource, ResourceUsage usage);
+        // keep the pass even if nothing reads its outputs
+        void SetSideEffect();
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, size_t passIndex);
+        RenderGraph& m_Graph;
+        size_t m_PassIndex;
+    };
+
+    using SetupFunction = std::function<void(PassBuilder&)>;
+    using RecordFunction = std::function<void(vk::raii::CommandBuffer&)>;
+
+    RenderGraph() = default;
+    RenderGraph(const RenderGraph&) = delete;
+
+    // transient images are owned by the graph and may share memory with
+    // other transients whose lifetimes dont overlap
+    RenderResource CreateImage(
+        const std::string& name, vk::Format format, vk::Extent2D extent,
+        vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor);
+    // imported images are owned elsewhere (swapchain) and bound every frame
+    RenderResource ImportImage(
+        const std::string& name, vk::Format format, vk::Extent2D extent,
+        vk::ImageLayout finalLayout);
+
+    void AddPass(
+        const std::string& name, const SetupFunction& setup,
+        const RecordFunction& record);
+
+    void Compile(Device& device);
+    // culls and orders the passes, the part of Compile that needs no device
+    void Schedule();
+    // the barrier lists built while recording come out of memory, which
+    // only has to live until this returns
+    void Execute(
+        vk::raii::CommandBuffer& commandBuffer,
+        std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+    // drop passes and resources so the graph can be rebuilt (swapchain
+    // resize), the transient images are retired since frames in flight may
+    // still use them
+    void Reset(DeletionQueue& deletions);
+
+    void SetImportedImage(
+        RenderResource resource, vk::Image image, vk::ImageView imageView);
+    vk::Image GetImage(RenderResource resource);
+    vk::ImageView GetImageView(RenderResource resource);
+    vk::Extent2D GetExtent(RenderResource resource);
+
+    size_t GetPassCount() const { return m_Passes.size(); }
+    size_t GetCulledPassCount() const;
+    vk::DeviceSize GetTransientMemorySize() const;
+
+private:
+    struct ResourceAccess
+    {
+        RenderResource resource;
+        ResourceUsage usage;
+        bool write;
+    };
+
+    struct Pass
+    {
+        std::string name;
+        RecordFunction record;
+        std::vector<ResourceAccess> accesses;
+        bool sideEffect = false;
+        bool culled = false;
+    };
+
+    struct ResourceState
+    {
+        vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+        vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eTopOfPipe;
+        vk::AccessFlags access = {};
+        bool written = false;
+    };
+
+    struct Resource
+    {
+        std::string name;
+        vk::Format format;
+        vk::Extent2D extent;
+        vk::ImageAspectFlags aspect;
+        bool imported;
+        vk::ImageLayout finalLayout = vk::ImageLayout::eUndefined;
+        vk::ImageUsageFlags usage = {};
+        // first and last position in m_Order, used for aliasing
+        size_t firstUse = SIZE_MAX;
+        size_t lastUse = 0;
+        size_t memoryBlock = SIZE_MAX;
+        vk::Image image = nullptr;
+        vk::ImageView imageView = nullptr;
+        ResourceState initialState;
+        ResourceState state;
+    };
+
+    struct MemoryBlock
+    {
+        vk::DeviceSize size = 0;
+        uint32_t memoryTypeBits = ~0u;
+        vk::MemoryPropertyFlags properties;
+        std::vector<RenderResource> resources;
+        vk::raii::DeviceMemory memory = nullptr;
+    };
+
+    struct Barrier
+    {
+        vk::PipelineStageFlags srcStages;
+        vk::PipelineStageFlags dstStages;
+        std::pmr::vector<vk::ImageMemoryBarrier> imageBarriers;
+    };
+
+    static ResourceState GetUsageState(ResourceUsage usage, bool write);
+    static bool WritesResource(const Pass& pass, RenderResource resource);
+    static vk::ImageUsageFlags GetUsageFlags(ResourceUsage usage);
+
+    void CullPasses();
+    void SortPasses();
+    void ComputeLifetimes();
+    void AllocateTransients(Device& device);
+    // adds whatever the transition needs to barrier
+    void TransitionResource(
+        Resource& resource, const ResourceState& nextState, Barrier& barrier);
+
+    std::vector<Pass> m_Passes;
+    std::vector<Resource> m_Resources;
+    std::vector<size_t> m_Order;
+    std::vector<MemoryBlock> m_MemoryBlocks;
+    // last use of each block, carried from one Execute to the next. the
+    // transients are shared by every frame in flight, so a frame's first
+    // access has to wait on the previous frame's last one
+    std::vector<ResourceState> m_BlockStates;
+    std::vector<vk::raii::Image> m_Images;
+    std::vector<vk::raii::ImageView> m_ImageViews;
+    bool m_Compiled = false;
+};
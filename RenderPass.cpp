@@ -1,7 +1,8 @@
 #include "RenderPass.hpp"
+#include <array>
 
-RenderPass::RenderPass(Device& device, Surface& surface)
-    : m_RenderPass(CreateRenderPass(device, surface))
+RenderPass::RenderPass(Device& device, Surface& surface, vk::Format depthFormat)
+    : m_RenderPass(CreateRenderPass(device, surface, depthFormat))
 {
 }
 
@@ -11,20 +12,50 @@ vk::raii::RenderPass& RenderPass::Get()
 }
 
 
-vk::raii::RenderPass RenderPass::CreateRenderPass(Device& device, Surface& surface)
+vk::raii::RenderPass RenderPass::CreateRenderPass(
+    Device& device, Surface& surface, vk::Format depthFormat)
 {
+    // the render graph owns layout transitions outside of the pass, so the
+    // attachment is left in color attachment layout rather than present
     vk::AttachmentDescription colorAttachment(
         {}, surface.surfaceFormat.format, vk::SampleCountFlagBits::e1,
         vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eStore,
         vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare,
-        vk::ImageLayout::eUndefined, vk::ImageLayout::ePresentSrcKHR);
+        vk::ImageLayout::eUndefined, vk::ImageLayout::eColorAttachmentOptimal);
 
-    vk::AttachmentReference colorAttachmentReference(
-        0, vk::ImageLayout::eColorAttachmentOptimal);
+    // depth only lives for the duration of the pass, never stored
+    vk::AttachmentDescription depthAttachment(
+        {}, depthFormat, vk::SampleCountFlagBits::e1,
+        vk::AttachmentLoadOp::eClear, vk::AttachmentStoreOp::eDontCare,
+        vk::AttachmentLoadOp::eDontCare, vk::AttachmentStoreOp::eDontCare,
+        vk::ImageLayout::eUndefined,
+        vk::ImageLayout::eDepthStencilAttachmentOptimal);
 
-    vk::SubpassDescription subpass({}, vk::PipelineBindPoint::eGraphics, {}, colorAttachmentReference);
+    std::array<vk::AttachmentDescription, 2> attachments = {
+        colorAttachment, depthAttachment};
 
-    vk::RenderPassCreateInfo renderPassCreateInfo({}, colorAttachment, subpass);
+    vk::AttachmentReference colorAttachmentReference(
+        0, vk::ImageLayout::eColorAttachmentOptimal);
+    vk::AttachmentReference depthAttachmentReference(
+        1, vk::ImageLayout::eDepthStencilAttachmentOptimal);
+
+    vk::SubpassDescription subpass(
+        {}, vk::PipelineBindPoint::eGraphics, {}, colorAttachmentReference, {},
+        &depthAttachmentReference);
+
+    // the single depth image is shared by every frame in flight, so the clear
+    // has to wait for the previous frame to finish testing against it
+    vk::PipelineStageFlags depthStages =
+        vk::PipelineStageFlagBits::eEarlyFragmentTests |
+        vk::PipelineStageFlagBits::eLateFragmentTests;
+    vk::SubpassDependency depthDependency(
+        VK_SUBPASS_EXTERNAL, 0, depthStages, depthStages,
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+        vk::AccessFlagBits::eDepthStencilAttachmentWrite |
+            vk::AccessFlagBits::eDepthStencilAttachmentRead);
+
+    vk::RenderPassCreateInfo renderPassCreateInfo(
+        {}, attachments, subpass, depthDependency);
 
     return device.Get().createRenderPass(renderPassCreateInfo);
 }
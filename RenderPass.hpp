@@ -6,10 +6,11 @@
 class RenderPass
 {
 public:
-    RenderPass(Device& device, Surface& surface);
+    RenderPass(Device& device, Surface& surface, vk::Format depthFormat);
     vk::raii::RenderPass& Get();
 
 private:
-    vk::raii::RenderPass CreateRenderPass(Device& device, Surface& surface);
+    vk::raii::RenderPass CreateRenderPass(
+        Device& device, Surface& surface, vk::Format depthFormat);
     vk::raii::RenderPass m_RenderPass;
 };
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+enum class RenderBucket : uint64_t
+{
+    Opaque = 0,
+    Transparent = 1,
+    Overlay = 2
+};
+
+// 64 bit sort key, compared as a plain integer:
+// [63..60] bucket  [59..48] pipeline  [47..24] depth  [23..0] sequence
+// opaque depth is front to back so early z can reject hidden fragments,
+// transparent depth is flipped to draw back to front
+namespace SortKey
+{
+    constexpr uint64_t DEPTH_BITS = 24;
+    constexpr uint64_t DEPTH_MAX = (1ull << DEPTH_BITS) - 1;
+
+    constexpr uint64_t
+    Make(RenderBucket bucket, uint16_t pipeline, float depth, uint32_t sequence)
+    {
+        float clamped = std::clamp(depth, 0.0f, 1.0f);
+        uint64_t quantized = static_cast<uint64_t>(clamped * DEPTH_MAX);
+        if (bucket == RenderBucket::Transparent)
+        {
+            quantized = DEPTH_MAX - quantized;
+        }
+        return (static_cast<uint64_t>(bucket) << 60) |
+               ((static_cast<uint64_t>(pipeline) & 0xfff) << 48) |
+               (quantized << 24) | (sequence & 0xffffff);
+    }
+
+    constexpr RenderBucket GetBucket(uint64_t key)
+    {
+        return static_cast<RenderBucket>(key >> 60);
+    }
+    constexpr uint16_t GetPipeline(uint64_t key)
+    {
+        return static_cast<uint16_t>((key >> 48) & 0xfff);
+    }
+}
+
+struct DrawItem
+{
+    uint64_t sortKey;
+    // range of the mesh's index buffer, one level of its lod chain
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    uint32_t instanceCount = 1;
+    uint32_t firstInstance = 0;
+
+    bool operator==(const DrawItem&) const = default;
+};
+
+class RenderQueue
+{
+public:
+    void Submit(const DrawItem& item) { m_Items.push_back(item); }
+    void Sort()
+    {
+        std::sort(
+            m_Items.begin(), m_Items.end(),
+            [](const DrawItem& a, const DrawItem& b)
+            { return a.sortKey < b.sortKey; });
+    }
+    void Clear() { m_Items.clear(); }
+
+    std::span<const DrawItem> GetItems() const { return m_Items; }
+    size_t size() const { return m_Items.size(); }
+
+private:
+    std::vector<DrawItem> m_Items;
+};
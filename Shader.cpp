@@ -1,107 +1,101 @@
 #include "Shader.hpp"
 #include <algorithm>
-#include <filesystem>
 
 Shader::Shader(
     vk::raii::Device& device, const std::string& _name,
     const vk::ShaderModuleCreateInfo& vertShaderCreateInfo,
-    const vk::ShaderModuleCreateInfo& fragShaderCreateInfo)
+    const vk::ShaderModuleCreateInfo& fragShaderCreateInfo,
+    ShaderLayout _layout)
     : name(_name), vertShaderModule(device, vertShaderCreateInfo),
-        fragShaderModule(device, fragShaderCreateInfo)
+        fragShaderModule(device, fragShaderCreateInfo),
+        layout(std::move(_layout))
 {
 }
 
-std::vector<Shader> LoadShaders(vk::raii::Device& device)
+std::vector<Shader>
+LoadShaders(vk::raii::Device& device, const AssetPack& assets)
 {
     std::vector<Shader> shaders;
-    std::filesystem::path shader_directory =
-        std::filesystem::path(WORKING_DIRECTORY).append("build").append("shader");
-    for (std::filesystem::directory_entry entry :
-         std::filesystem::directory_iterator(shader_directory))
+    for (const PackEntry& entry : assets.GetEntries())
     {
-        // shaderc::Compiler c;
-        if (entry.path().extension() == ".spv") // a.frag(.spv)
+        if (entry.type != AssetType::Shader)
         {
-            std::string name =
-                entry.path().stem().stem().string(); // (a).frag.spv
-            // check if shader already exists
-            if (std::find_if(
-                    shaders.begin(), shaders.end(),
-                    [name](const Shader& shader)
-                    { return name == shader.name; }) != shaders.end())
-            {
-                continue;
-            }
-
-            // if it doesnt look for the missing half
-            std::filesystem::path shaderType =
-                entry.path().stem().extension(); // a(.frag).spv
-            std::filesystem::path vertShaderPath = shader_directory;
-            vertShaderPath.append(name + ".vert.spv");
-            std::filesystem::path fragShaderPath = shader_directory;
-            fragShaderPath.append(name + ".frag.spv");
-            if (shaderType == ".vert")
-            {
-                if (!std::filesystem::exists(fragShaderPath))
-                {
-                    LogWarning(fmt::format(
-                        "Could not find fragment shader for shader {}", name));
-                    continue;
-                }
-            }
-            else if (shaderType == ".frag")
-            {
-                if (!std::filesystem::exists(vertShaderPath))
-                {
-                    LogWarning(fmt::format(
-                        "Could not find vertex shader for shader {}", name));
-                    continue;
-                }
-            }
-            else
-            {
-                continue;
-            }
+            continue;
+        }
 
-            std::ifstream vertShaderCodeFile(vertShaderPath, std::ios::binary);
-            if (!vertShaderCodeFile.is_open())
+        // every pair is built from its vertex half, a lone fragment half
+        // only gets a warning
+        std::string_view entryName = assets.GetName(entry); // a.vert
+        std::string_view shaderType =
+            entryName.substr(std::min(entryName.rfind('.'), entryName.size()));
+        std::string name(
+            entryName.substr(0, entryName.size() - shaderType.size()));
+        if (shaderType == ".frag")
+        {
+            if (!assets.Find(name + ".vert"))
             {
                 LogWarning(fmt::format(
-                    "Requested vertex shader {} missing!",
-                    vertShaderPath.string()));
+                    "Could not find vertex shader for shader {}", name));
             }
+            continue;
+        }
+        if (shaderType != ".vert")
+        {
+            continue;
+        }
 
-            std::ifstream fragShaderCodeFile(fragShaderPath, std::ios::binary);
-            if (!fragShaderCodeFile.is_open())
-            {
-                LogWarning(fmt::format(
-                    "Requested fragment shader {} missing!",
-                    fragShaderPath.string()));
-            }
+        const PackEntry* fragEntry = assets.Find(name + ".frag");
+        if (!fragEntry)
+        {
+            LogWarning(fmt::format(
+                "Could not find fragment shader for shader {}", name));
+            continue;
+        }
 
-            const std::string vertShaderCode(
-                (std::istreambuf_iterator<char>(vertShaderCodeFile)),
-                std::istreambuf_iterator<char>());
+        // the pack keeps spir-v 4 byte aligned, so the modules are created
+        // straight from the mapping
+        std::span<const std::byte> vertShaderCode = assets.GetData(entry);
+        std::span<const std::byte> fragShaderCode = assets.GetData(*fragEntry);
 
-            std::string fragShaderCode(
-                (std::istreambuf_iterator<char>(fragShaderCodeFile)),
-                std::istreambuf_iterator<char>());
+        vk::ShaderModuleCreateInfo vertShaderCreateInfo(
+            {}, vertShaderCode.size(),
+            reinterpret_cast<const uint32_t*>(vertShaderCode.data()));
 
-            vk::ShaderModuleCreateInfo vertShaderCreateInfo(
-                {}, static_cast<uint32_t>(vertShaderCode.size()),
-                reinterpret_cast<const uint32_t*>(vertShaderCode.data()));
+        vk::ShaderModuleCreateInfo fragShaderCreateInfo(
+            {}, fragShaderCode.size(),
+            reinterpret_cast<const uint32_t*>(fragShaderCode.data()));
 
-            vk::ShaderModuleCreateInfo fragShaderCreateInfo(
-                {}, static_cast<uint32_t>(fragShaderCode.size()),
-                reinterpret_cast<const uint32_t*>(fragShaderCode.data()));
+        ShaderLayout layout = ReflectSpirv(
+            {vertShaderCreateInfo.pCode, vertShaderCode.size() / 4},
+            entryName);
+        MergeShaderLayout(
+            layout,
+            ReflectSpirv(
+                {fragShaderCreateInfo.pCode, fragShaderCode.size() / 4},
+                assets.GetName(*fragEntry)),
+            name);
 
-            shaders.emplace_back(
-                device, name, vertShaderCreateInfo, fragShaderCreateInfo);
-        }
+        shaders.emplace_back(
+            device, name, vertShaderCreateInfo, fragShaderCreateInfo,
+            std::move(layout));
     }
     if (shaders.size() == 0)
     {
         LogWarning("No shaders constructed!");
     }
     return shaders;
-}
\ No newline at end of file
+}
+
+Shader TakeShader(std::vector<Shader>& shaders, std::string_view name)
+{
+    auto shader = std::find_if(
+        shaders.begin(), shaders.end(),
+        [&](const Shader& candidate) { return candidate.name == name; });
+    if (shader == shaders.end())
+    {
+        LogError(fmt::format("Could not find shader {}", name));
+    }
+    Shader taken = std::move(*shader);
+    shaders.erase(shader);
+    return taken;
+}
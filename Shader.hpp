@@ -1,8 +1,11 @@
 #pragma once
 
+#include "AssetPack.hpp"
 #include "Device.hpp"
 #include "Log.hpp"
+#include "SpirvReflection.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
@@ -11,10 +14,19 @@ struct Shader
     Shader(
         vk::raii::Device& device, const std::string& _name,
         const vk::ShaderModuleCreateInfo& vertShaderCreateInfo,
-        const vk::ShaderModuleCreateInfo& fragShaderCreateInfo);
+        const vk::ShaderModuleCreateInfo& fragShaderCreateInfo,
+        ShaderLayout _layout);
     std::string name;
     vk::raii::ShaderModule vertShaderModule;
     vk::raii::ShaderModule fragShaderModule;
+    // descriptors and push constants of both stages, pipeline layouts are
+    // built from this
+    ShaderLayout layout;
 };
 
-std::vector<Shader> LoadShaders(vk::raii::Device& device);
\ No newline at end of file
+// builds a shader from every name.vert / name.frag pair in the pack
+std::vector<Shader>
+LoadShaders(vk::raii::Device& device, const AssetPack& assets);
+
+// moves the shader called name out of shaders, a missing shader is an error
+Shader TakeShader(std::vector<Shader>& shaders, std::string_view name);
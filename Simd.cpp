@@ -0,0 +1,59 @@
+#include "Simd.hpp"
+
+#if defined(SIMD_FLOAT4)
+void Simd::SinCos(Float4 x, Float4& sin, Float4& cos)
+{
+    // reduce to [-pi/4, pi/4] by octant j, made even so only the quadrant
+    // matters. everything stays in float lanes so sse2 needs no int ops
+    Float4 sinNegative = Less(x, Splat(0.0f));
+    x = Abs(x);
+
+    Float4 j = Truncate(Mul(x, Splat(1.27323954473516f)));
+    j = Add(j, Sub(j, Mul(Splat(2.0f), Truncate(Mul(j, Splat(0.5f))))));
+    // 0, 2, 4 or 6
+    Float4 octant = Sub(j, Mul(Splat(8.0f), Truncate(Mul(j, Splat(0.125f)))));
+
+    // pi/4 split in three so the reduction stays exact
+    x = Sub(x, Mul(j, Splat(0.78515625f)));
+    x = Sub(x, Mul(j, Splat(2.4187564849853515625e-4f)));
+    x = Sub(x, Mul(j, Splat(3.77489497744594108e-8f)));
+
+    Float4 upperHalf = GreaterEqual(octant, Splat(4.0f));
+    sinNegative = Xor(sinNegative, upperHalf);
+    Float4 cosNegative =
+        And(GreaterEqual(octant, Splat(2.0f)), Less(octant, Splat(5.0f)));
+    // octants 0 and 4 use the sine polynomial for sin, 2 and 6 swap
+    Float4 octantInQuadrant =
+        Sub(octant, Mul(Splat(4.0f), Truncate(Mul(octant, Splat(0.25f)))));
+    Float4 sinPolynomial = Less(octantInQuadrant, Splat(1.0f));
+
+    Float4 z = Mul(x, x);
+
+    Float4 cosine = Splat(2.443315711809948e-5f);
+    cosine = Add(Mul(cosine, z), Splat(-1.388731625493765e-3f));
+    cosine = Add(Mul(cosine, z), Splat(4.166664568298827e-2f));
+    cosine = Mul(Mul(cosine, z), z);
+    cosine = Sub(cosine, Mul(z, Splat(0.5f)));
+    cosine = Add(cosine, Splat(1.0f));
+
+    Float4 sine = Splat(-1.9515295891e-4f);
+    sine = Add(Mul(sine, z), Splat(8.3321608736e-3f));
+    sine = Add(Mul(sine, z), Splat(-1.6666654611e-1f));
+    sine = Mul(Mul(sine, z), x);
+    sine = Add(sine, x);
+
+    sin = NegateWhere(sinNegative, Select(sinPolynomial, sine, cosine));
+    cos = NegateWhere(cosNegative, Select(sinPolynomial, cosine, sine));
+}
+#endif
+
+const char* GetSimdInstructionSet()
+{
+#if defined(SIMD_SSE)
+    return "sse2";
+#elif defined(SIMD_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
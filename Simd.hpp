@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstdint>
+
+// compile time simd selection shared by the vectorized kernels. sse2 is the
+// x86_64 baseline and neon the arm64 one, avx2 is only there when built with
+// UNTITLED_ENABLE_AVX2. SIMD_FLOAT4 means the Float4 helpers below exist,
+// kernels keep a scalar loop for everything else and for remainders
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_AVX2
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) ||                                    \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_SSE
+#define SIMD_FLOAT4
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SIMD_NEON
+#define SIMD_FLOAT4
+#endif
+
+#if defined(SIMD_FLOAT4)
+// thin wrappers so 4 wide kernels are written once for sse and neon.
+// comparisons return all ones / all zeros lane masks
+namespace Simd
+{
+#if defined(SIMD_SSE)
+    using Float4 = __m128;
+
+    inline Float4 Splat(float value) { return _mm_set1_ps(value); }
+    inline Float4 Load(const float* data) { return _mm_loadu_ps(data); }
+    inline void Store(float* data, Float4 value) { _mm_storeu_ps(data, value); }
+    // bypasses the cache, data has to be 16 byte aligned and StreamFence
+    // has to follow before anyone else reads the memory
+    inline void Stream(float* data, Float4 value) { _mm_stream_ps(data, value); }
+    inline void StreamFence() { _mm_sfence(); }
+
+    inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+    inline Float4 Min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+    inline Float4 Max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+    // round toward zero, inputs have to fit in an int32
+    inline Float4 Truncate(Float4 a)
+    {
+        return _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+    }
+
+    inline Float4 Less(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+    inline Float4 LessEqual(Float4 a, Float4 b) { return _mm_cmple_ps(a, b); }
+    inline Float4 GreaterEqual(Float4 a, Float4 b)
+    {
+        return _mm_cmpge_ps(a, b);
+    }
+    inline Float4 And(Float4 a, Float4 b) { return _mm_and_ps(a, b); }
+    inline Float4 Or(Float4 a, Float4 b) { return _mm_or_ps(a, b); }
+    inline Float4 Xor(Float4 a, Float4 b) { return _mm_xor_ps(a, b); }
+    // mask ? a : b
+    inline Float4 Select(Float4 mask, Float4 a, Float4 b)
+    {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+    // lane i of the mask to bit i
+    inline uint32_t MoveMask(Float4 mask)
+    {
+        return static_cast<uint32_t>(_mm_movemask_ps(mask));
+    }
+
+    // splits 4 interleaved xy pairs into an x and a y vector
+    inline void LoadDeinterleaved(const float* data, Float4& x, Float4& y)
+    {
+        Float4 low = _mm_loadu_ps(data);
+        Float4 high = _mm_loadu_ps(data + 4);
+        x = _mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0));
+        y = _mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+    inline void Transpose(Float4& a, Float4& b, Float4& c, Float4& d)
+    {
+        _MM_TRANSPOSE4_PS(a, b, c, d);
+    }
+#elif defined(SIMD_NEON)
+    using Float4 = float32x4_t;
+
+    inline Float4 Splat(float value) { return vdupq_n_f32(value); }
+    inline Float4 Load(const float* data) { return vld1q_f32(data); }
+    inline void Store(float* data, Float4 value) { vst1q_f32(data, value); }
+    inline void Stream(float* data, Float4 value)
+    {
+#if defined(__clang__)
+        __builtin_nontemporal_store(value, reinterpret_cast<Float4*>(data));
+#else
+        vst1q_f32(data, value);
+#endif
+    }
+    inline void StreamFence() {}
+
+    inline Float4 Add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+    inline Float4 Sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+    inline Float4 Mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+    inline Float4 Min(Float4 a, Float4 b) { return vminq_f32(a, b); }
+    inline Float4 Max(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+    inline Float4 Truncate(Float4 a)
+    {
+        return vcvtq_f32_s32(vcvtq_s32_f32(a));
+    }
+
+    inline Float4 Less(Float4 a, Float4 b)
+    {
+        return vreinterpretq_f32_u32(vcltq_f32(a, b));
+    }
+    inline Float4 LessEqual(Float4 a, Float4 b)
+    {
+        return vreinterpretq_f32_u32(vcleq_f32(a, b));
+    }
+    inline Float4 GreaterEqual(Float4 a, Float4 b)
+    {
+        return vreinterpretq_f32_u32(vcgeq_f32(a, b));
+    }
+    inline Float4 And(Float4 a, Float4 b)
+    {
+        return vreinterpretq_f32_u32(
+            vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    }
+    inline Float4 Or(Float4 a, Float4 b)
+    {
+        return vreinterpretq_f32_u32(
+            vorrq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    }
+    inline Float4 Xor(Float4 a, Float4 b)
+    {
+        return vreinterpretq_f32_u32(
+            veorq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+    }
+    inline Float4 Select(Float4 mask, Float4 a, Float4 b)
+    {
+        return vbslq_f32(vreinterpretq_u32_f32(mask), a, b);
+    }
+    inline uint32_t MoveMask(Float4 mask)
+    {
+        // no movemask on neon, weight each lane by its bit and add across
+        const uint32_t laneBitsData[4] = {1, 2, 4, 8};
+        return vaddvq_u32(
+            vandq_u32(vreinterpretq_u32_f32(mask), vld1q_u32(laneBitsData)));
+    }
+
+    inline void LoadDeinterleaved(const float* data, Float4& x, Float4& y)
+    {
+        float32x4x2_t pairs = vld2q_f32(data);
+        x = pairs.val[0];
+        y = pairs.val[1];
+    }
+    inline void Transpose(Float4& a, Float4& b, Float4& c, Float4& d)
+    {
+        float32x4x2_t ab = vtrnq_f32(a, b);
+        float32x4x2_t cd = vtrnq_f32(c, d);
+        a = vcombine_f32(vget_low_f32(ab.val[0]), vget_low_f32(cd.val[0]));
+        b = vcombine_f32(vget_low_f32(ab.val[1]), vget_low_f32(cd.val[1]));
+        c = vcombine_f32(vget_high_f32(ab.val[0]), vget_high_f32(cd.val[0]));
+        d = vcombine_f32(vget_high_f32(ab.val[1]), vget_high_f32(cd.val[1]));
+    }
+#endif
+
+    inline Float4 Abs(Float4 a)
+    {
+        return Select(Less(a, Splat(0.0f)), Sub(Splat(0.0f), a), a);
+    }
+    // flips the sign of the lanes set in mask
+    inline Float4 NegateWhere(Float4 mask, Float4 a)
+    {
+        return Xor(a, And(mask, Splat(-0.0f)));
+    }
+
+    // cephes style sincos in float precision, a few ulp over +-8192 radians
+    void SinCos(Float4 x, Float4& sin, Float4& cos);
+}
+#endif
+
+// instruction set the Float4 kernels were compiled for
+const char* GetSimdInstructionSet();
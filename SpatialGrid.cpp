@@ -0,0 +1,250 @@
+#include "SpatialGrid.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <cmath>
+
+static int32_t ToCellCoordinate(float value)
+{
+    // clamped so far away objects end up in the outermost cells rather than
+    // overflowing
+    return static_cast<int32_t>(
+        std::clamp(std::floor(value), -1073741824.0f, 1073741824.0f));
+}
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : m_CellSize(cellSize), m_InverseCellSize(1.0f / cellSize)
+{
+    if (!(cellSize > 0.0f))
+    {
+        LogError(fmt::format("Invalid spatial grid cell size {}", cellSize));
+    }
+    // the oversized list is never part of the lookup
+    m_Cells.emplace_back();
+    m_CellKeys.push_back(0);
+}
+
+SpatialGrid::CellKey SpatialGrid::GetCellKey(int32_t x, int32_t y) const
+{
+    return (static_cast<CellKey>(static_cast<uint32_t>(x)) << 32) |
+           static_cast<uint32_t>(y);
+}
+
+bool SpatialGrid::IsOversized(const Aabb& bounds) const
+{
+    glm::vec2 size = bounds.max - bounds.min;
+    return size.x > m_CellSize || size.y > m_CellSize;
+}
+
+SpatialGrid::CellKey SpatialGrid::GetCellKey(const Aabb& bounds) const
+{
+    glm::vec2 center = (bounds.min + bounds.max) * 0.5f;
+    return GetCellKey(
+        ToCellCoordinate(center.x * m_InverseCellSize),
+        ToCellCoordinate(center.y * m_InverseCellSize));
+}
+
+uint32_t SpatialGrid::FindCell(const Aabb& bounds)
+{
+    if (IsOversized(bounds))
+    {
+        return OVERSIZED_CELL;
+    }
+    return GetOrCreateCell(GetCellKey(bounds));
+}
+
+uint32_t SpatialGrid::GetOrCreateCell(CellKey key)
+{
+    auto it = m_CellLookup.find(key);
+    if (it != m_CellLookup.end())
+    {
+        return it->second;
+    }
+
+    uint32_t index;
+    if (!m_FreeCells.empty())
+    {
+        index = m_FreeCells.back();
+        m_FreeCells.pop_back();
+        m_CellKeys.at(index) = key;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_Cells.size());
+        m_Cells.emplace_back();
+        m_CellKeys.push_back(key);
+    }
+    m_CellLookup.emplace(key, index);
+    return index;
+}
+
+SpatialProxy SpatialGrid::Insert(const Aabb& bounds, uint32_t userData)
+{
+    SpatialProxy proxy;
+    if (!m_FreeProxies.empty())
+    {
+        proxy = m_FreeProxies.back();
+        m_FreeProxies.pop_back();
+    }
+    else
+    {
+        proxy = static_cast<SpatialProxy>(m_Proxies.size());
+        m_Proxies.emplace_back();
+    }
+
+    ProxyRecord& record = m_Proxies.at(proxy);
+    record.userData = userData;
+    record.alive = true;
+    AddToCell(FindCell(bounds), proxy, bounds);
+    m_ProxyCount++;
+    return proxy;
+}
+
+void SpatialGrid::Update(SpatialProxy proxy, const Aabb& bounds)
+{
+    if (proxy >= m_Proxies.size() || !m_Proxies.at(proxy).alive)
+    {
+        LogError(fmt::format("Updating invalid spatial proxy {}", proxy));
+    }
+
+    // most updates stay in their cell, comparing keys skips the hash lookup
+    ProxyRecord& record = m_Proxies.at(proxy);
+    bool oversized = IsOversized(bounds);
+    bool sameCell = record.cell == OVERSIZED_CELL
+                        ? oversized
+                        : !oversized &&
+                              m_CellKeys.at(record.cell) == GetCellKey(bounds);
+    if (sameCell)
+    {
+        Cell& cell = m_Cells.at(record.cell);
+        cell.minX.at(record.slot) = bounds.min.x;
+        cell.minY.at(record.slot) = bounds.min.y;
+        cell.maxX.at(record.slot) = bounds.max.x;
+        cell.maxY.at(record.slot) = bounds.max.y;
+        return;
+    }
+
+    // found before removing, so an emptied old cell cant be handed straight
+    // back out
+    uint32_t cellIndex = FindCell(bounds);
+    RemoveFromCell(proxy);
+    AddToCell(cellIndex, proxy, bounds);
+}
+
+void SpatialGrid::Remove(SpatialProxy proxy)
+{
+    if (proxy >= m_Proxies.size() || !m_Proxies.at(proxy).alive)
+    {
+        LogError(fmt::format("Removing invalid spatial proxy {}", proxy));
+    }
+    RemoveFromCell(proxy);
+    m_Proxies.at(proxy).alive = false;
+    m_FreeProxies.push_back(proxy);
+    m_ProxyCount--;
+}
+
+void SpatialGrid::AddToCell(
+    uint32_t cellIndex, SpatialProxy proxy, const Aabb& bounds)
+{
+    Cell& cell = m_Cells.at(cellIndex);
+    ProxyRecord& record = m_Proxies.at(proxy);
+    record.cell = cellIndex;
+    record.slot = static_cast<uint32_t>(cell.size());
+
+    cell.minX.push_back(bounds.min.x);
+    cell.minY.push_back(bounds.min.y);
+    cell.maxX.push_back(bounds.max.x);
+    cell.maxY.push_back(bounds.max.y);
+    cell.proxies.push_back(proxy);
+}
+
+void SpatialGrid::RemoveFromCell(SpatialProxy proxy)
+{
+    const ProxyRecord& record = m_Proxies.at(proxy);
+    uint32_t cellIndex = record.cell;
+    uint32_t slot = record.slot;
+    Cell& cell = m_Cells.at(cellIndex);
+
+    size_t last = cell.size() - 1;
+    if (slot != last)
+    {
+        cell.minX.at(slot) = cell.minX.at(last);
+        cell.minY.at(slot) = cell.minY.at(last);
+        cell.maxX.at(slot) = cell.maxX.at(last);
+        cell.maxY.at(slot) = cell.maxY.at(last);
+        cell.proxies.at(slot) = cell.proxies.at(last);
+        m_Proxies.at(cell.proxies.at(slot)).slot = slot;
+    }
+    cell.minX.pop_back();
+    cell.minY.pop_back();
+    cell.maxX.pop_back();
+    cell.maxY.pop_back();
+    cell.proxies.pop_back();
+
+    // keeps the lookup proportional to the occupied area as objects move
+    // across a large level, the vectors keep their capacity for reuse
+    if (cell.size() == 0 && cellIndex != OVERSIZED_CELL)
+    {
+        m_CellLookup.erase(m_CellKeys.at(cellIndex));
+        m_FreeCells.push_back(cellIndex);
+    }
+}
+
+void SpatialGrid::QueryCell(
+    const Cell& cell, const Aabb& view, std::vector<uint32_t>& results)
+{
+    if (cell.size() == 0)
+    {
+        return;
+    }
+    if (m_Visible.size() < cell.size())
+    {
+        m_Visible.resize(cell.size());
+    }
+    size_t count = CullAabbs(cell.GetBounds(), view, m_Visible.data());
+    for (size_t i = 0; i < count; i++)
+    {
+        SpatialProxy proxy = cell.proxies[m_Visible[i]];
+        results.push_back(m_Proxies[proxy].userData);
+    }
+}
+
+void SpatialGrid::Query(const Aabb& view, std::vector<uint32_t>& results)
+{
+    QueryCell(m_Cells.at(OVERSIZED_CELL), view, results);
+
+    // centers can sit up to half a cell outside the view and still overlap
+    float margin = m_CellSize * 0.5f;
+    int32_t minX = ToCellCoordinate((view.min.x - margin) * m_InverseCellSize);
+    int32_t minY = ToCellCoordinate((view.min.y - margin) * m_InverseCellSize);
+    int32_t maxX = ToCellCoordinate((view.max.x + margin) * m_InverseCellSize);
+    int32_t maxY = ToCellCoordinate((view.max.y + margin) * m_InverseCellSize);
+    if (maxX < minX || maxY < minY)
+    {
+        return;
+    }
+
+    // zoomed far out the view covers more cells than are occupied, walking
+    // the occupied ones is cheaper than probing every coordinate
+    uint64_t coveredCells = static_cast<uint64_t>(int64_t(maxX) - minX + 1) *
+                            static_cast<uint64_t>(int64_t(maxY) - minY + 1);
+    if (coveredCells > m_CellLookup.size())
+    {
+        for (const auto& [key, index] : m_CellLookup)
+        {
+            QueryCell(m_Cells[index], view, results);
+        }
+        return;
+    }
+
+    for (int32_t y = minY; y <= maxY; y++)
+    {
+        for (int32_t x = minX; x <= maxX; x++)
+        {
+            auto it = m_CellLookup.find(GetCellKey(x, y));
+            if (it != m_CellLookup.end())
+            {
+                QueryCell(m_Cells[it->second], view, results);
+            }
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Culling.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using SpatialProxy = uint32_t;
+constexpr SpatialProxy INVALID_SPATIAL_PROXY = UINT32_MAX;
+
+// sparse loose grid for 2d levels. an object lives in the cell holding its
+// center and may stick out of it by up to half a cell, so a query only has to
+// widen its rect by half a cell to catch everything. cells are hashed, so
+// memory follows the occupied area rather than the level size, and empty
+// cells are recycled. objects bigger than a cell go in a separate list that
+// every query tests
+//
+// moving an object within its cell only rewrites its bounds, crossing into
+// another cell is a swap remove and an append
+class SpatialGrid
+{
+public:
+    SpatialGrid(float cellSize = 4.0f);
+
+    SpatialProxy Insert(const Aabb& bounds, uint32_t userData);
+    void Update(SpatialProxy proxy, const Aabb& bounds);
+    void Remove(SpatialProxy proxy);
+
+    // appends the user data of every object overlapping view to results
+    void Query(const Aabb& view, std::vector<uint32_t>& results);
+
+    float GetCellSize() const { return m_CellSize; }
+    size_t GetProxyCount() const { return m_ProxyCount; }
+    size_t GetCellCount() const { return m_CellLookup.size(); }
+
+private:
+    using CellKey = uint64_t;
+
+    // bounds stored structure of arrays for CullAabbs
+    struct Cell
+    {
+        std::vector<float> minX;
+        std::vector<float> minY;
+        std::vector<float> maxX;
+        std::vector<float> maxY;
+        std::vector<SpatialProxy> proxies;
+
+        size_t size() const { return proxies.size(); }
+        AabbArrays GetBounds() const
+        {
+            return {minX.data(), minY.data(), maxX.data(), maxY.data(), size()};
+        }
+    };
+
+    struct ProxyRecord
+    {
+        uint32_t cell = 0;
+        uint32_t slot = 0;
+        uint32_t userData = 0;
+        bool alive = false;
+    };
+
+    CellKey GetCellKey(int32_t x, int32_t y) const;
+    // key of the cell holding the center of bounds
+    CellKey GetCellKey(const Aabb& bounds) const;
+    bool IsOversized(const Aabb& bounds) const;
+    // index into m_Cells, OVERSIZED_CELL for objects bigger than a cell
+    uint32_t FindCell(const Aabb& bounds);
+    uint32_t GetOrCreateCell(CellKey key);
+    void AddToCell(uint32_t cellIndex, SpatialProxy proxy, const Aabb& bounds);
+    void RemoveFromCell(SpatialProxy proxy);
+    void QueryCell(
+        const Cell& cell, const Aabb& view, std::vector<uint32_t>& results);
+
+    static constexpr uint32_t OVERSIZED_CELL = 0;
+
+    float m_CellSize;
+    float m_InverseCellSize;
+
+    std::vector<Cell> m_Cells;
+    // cell index to its key, so emptied cells can be dropped from the lookup
+    std::vector<CellKey> m_CellKeys;
+    std::unordered_map<CellKey, uint32_t> m_CellLookup;
+    std::vector<uint32_t> m_FreeCells;
+
+    std::vector<ProxyRecord> m_Proxies;
+    std::vector<SpatialProxy> m_FreeProxies;
+    size_t m_ProxyCount = 0;
+
+    // CullAabbs output, reused between queries
+    std::vector<uint32_t> m_Visible;
+};
@@ -0,0 +1,467 @@
+#include "SpirvReflection.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+// the handful of spir-v enums reflection needs, from the spir-v spec
+namespace Spirv
+{
+    constexpr uint32_t MAGIC = 0x07230203;
+    constexpr size_t HEADER_WORDS = 5;
+
+    enum Op : uint32_t
+    {
+        OpEntryPoint = 15,
+        OpTypeInt = 21,
+        OpTypeFloat = 22,
+        OpTypeVector = 23,
+        OpTypeMatrix = 24,
+        OpTypeImage = 25,
+        OpTypeSampler = 26,
+        OpTypeSampledImage = 27,
+        OpTypeArray = 28,
+        OpTypeRuntimeArray = 29,
+        OpTypeStruct = 30,
+        OpTypePointer = 32,
+        OpConstant = 43,
+        OpVariable = 59,
+        OpDecorate = 71,
+        OpMemberDecorate = 72,
+        OpTypeAccelerationStructureKHR = 5341,
+    };
+
+    enum Decoration : uint32_t
+    {
+        Block = 2,
+        BufferBlock = 3,
+        ArrayStride = 6,
+        MatrixStride = 7,
+        Binding = 33,
+        DescriptorSet = 34,
+        Offset = 35,
+    };
+
+    enum StorageClass : uint32_t
+    {
+        UniformConstant = 0,
+        Uniform = 2,
+        PushConstant = 9,
+        StorageBuffer = 12,
+    };
+
+    enum ExecutionModel : uint32_t
+    {
+        Vertex = 0,
+        TessellationControl = 1,
+        TessellationEvaluation = 2,
+        Geometry = 3,
+        Fragment = 4,
+        GLCompute = 5,
+    };
+
+    enum Dim : uint32_t
+    {
+        DimBuffer = 5,
+        DimSubpassData = 6,
+    };
+}
+
+namespace
+{
+    struct Decorations
+    {
+        uint32_t set = 0;
+        uint32_t binding = 0;
+        uint32_t arrayStride = 0;
+        bool hasBinding = false;
+        bool bufferBlock = false;
+    };
+
+    struct MemberDecorations
+    {
+        uint32_t offset = 0;
+        uint32_t matrixStride = 0;
+    };
+
+    // one pass over the module collecting what the queries below need,
+    // instructions are kept as spans into the code
+    class Module
+    {
+    public:
+        Module(std::span<const uint32_t> code, std::string_view name)
+            : m_Name(name)
+        {
+            if (code.size() < Spirv::HEADER_WORDS || code[0] != Spirv::MAGIC)
+            {
+                LogError(fmt::format("{} is not spir-v", name));
+            }
+            size_t offset = Spirv::HEADER_WORDS;
+            while (offset < code.size())
+            {
+                uint32_t wordCount = code[offset] >> 16;
+                if (wordCount == 0 || offset + wordCount > code.size())
+                {
+                    LogError(
+                        fmt::format("{} has a truncated instruction", name));
+                }
+                Read(code.subspan(offset, wordCount));
+                offset += wordCount;
+            }
+        }
+
+        void Reflect(ShaderLayout& layout) const
+        {
+            for (uint32_t variable : m_Variables)
+            {
+                std::span<const uint32_t> pointer =
+                    GetInstruction(GetInstruction(variable)[1]);
+                uint32_t storageClass = pointer[2];
+                if (storageClass == Spirv::PushConstant)
+                {
+                    layout.pushConstantSize = std::max(
+                        layout.pushConstantSize, GetSize(pointer[3], 0));
+                    layout.pushConstantStages |= m_Stages;
+                    continue;
+                }
+                if (storageClass != Spirv::UniformConstant &&
+                    storageClass != Spirv::Uniform &&
+                    storageClass != Spirv::StorageBuffer)
+                {
+                    continue;
+                }
+
+                const Decorations& decorations = GetDecorations(variable);
+                if (!decorations.hasBinding)
+                {
+                    continue;
+                }
+                uint32_t count = 1;
+                uint32_t type = pointer[3];
+                while (IsArray(type))
+                {
+                    count *= GetArrayLength(type);
+                    type = GetInstruction(type)[2];
+                }
+                layout.bindings.push_back(
+                    {decorations.set, decorations.binding,
+                     GetDescriptorType(type, storageClass), count, m_Stages});
+            }
+        }
+
+    private:
+        void Read(std::span<const uint32_t> instruction)
+        {
+            uint32_t opcode = instruction[0] & 0xffff;
+            switch (opcode)
+            {
+            case Spirv::OpEntryPoint:
+                m_Stages |= GetStage(instruction[1]);
+                break;
+            case Spirv::OpDecorate:
+                Decorate(instruction);
+                break;
+            case Spirv::OpMemberDecorate:
+                MemberDecorate(instruction);
+                break;
+            case Spirv::OpConstant:
+                m_Instructions[instruction[2]] = instruction;
+                break;
+            case Spirv::OpVariable:
+                m_Instructions[instruction[2]] = instruction;
+                m_Variables.push_back(instruction[2]);
+                break;
+            case Spirv::OpTypeInt:
+            case Spirv::OpTypeFloat:
+            case Spirv::OpTypeVector:
+            case Spirv::OpTypeMatrix:
+            case Spirv::OpTypeImage:
+            case Spirv::OpTypeSampler:
+            case Spirv::OpTypeSampledImage:
+            case Spirv::OpTypeArray:
+            case Spirv::OpTypeRuntimeArray:
+            case Spirv::OpTypeStruct:
+            case Spirv::OpTypePointer:
+            case Spirv::OpTypeAccelerationStructureKHR:
+                m_Instructions[instruction[1]] = instruction;
+                break;
+            }
+        }
+
+        void Decorate(std::span<const uint32_t> instruction)
+        {
+            if (instruction.size() < 3)
+            {
+                return;
+            }
+            Decorations& decorations = m_Decorations[instruction[1]];
+            uint32_t value = instruction.size() > 3 ? instruction[3] : 0;
+            switch (instruction[2])
+            {
+            case Spirv::DescriptorSet:
+                decorations.set = value;
+                break;
+            case Spirv::Binding:
+                decorations.binding = value;
+                decorations.hasBinding = true;
+                break;
+            case Spirv::ArrayStride:
+                decorations.arrayStride = value;
+                break;
+            case Spirv::BufferBlock:
+                decorations.bufferBlock = true;
+                break;
+            }
+        }
+
+        void MemberDecorate(std::span<const uint32_t> instruction)
+        {
+            if (instruction.size() < 5)
+            {
+                return;
+            }
+            MemberDecorations& decorations = m_MemberDecorations
+                [GetMemberKey(instruction[1], instruction[2])];
+            if (instruction[3] == Spirv::Offset)
+            {
+                decorations.offset = instruction[4];
+            }
+            else if (instruction[3] == Spirv::MatrixStride)
+            {
+                decorations.matrixStride = instruction[4];
+            }
+        }
+
+        vk::ShaderStageFlags GetStage(uint32_t executionModel) const
+        {
+            switch (executionModel)
+            {
+            case Spirv::Vertex:
+                return vk::ShaderStageFlagBits::eVertex;
+            case Spirv::TessellationControl:
+                return vk::ShaderStageFlagBits::eTessellationControl;
+            case Spirv::TessellationEvaluation:
+                return vk::ShaderStageFlagBits::eTessellationEvaluation;
+            case Spirv::Geometry:
+                return vk::ShaderStageFlagBits::eGeometry;
+            case Spirv::Fragment:
+                return vk::ShaderStageFlagBits::eFragment;
+            case Spirv::GLCompute:
+                return vk::ShaderStageFlagBits::eCompute;
+            }
+            LogError(fmt::format(
+                "{} has unsupported execution model {}", m_Name,
+                executionModel));
+            return {};
+        }
+
+        static uint64_t GetMemberKey(uint32_t structure, uint32_t member)
+        {
+            return (static_cast<uint64_t>(structure) << 32) | member;
+        }
+
+        std::span<const uint32_t> GetInstruction(uint32_t id) const
+        {
+            auto found = m_Instructions.find(id);
+            if (found == m_Instructions.end())
+            {
+                LogError(fmt::format("{} uses undefined id {}", m_Name, id));
+            }
+            return found->second;
+        }
+
+        uint32_t GetOpcode(uint32_t type) const
+        {
+            return GetInstruction(type)[0] & 0xffff;
+        }
+
+        const Decorations& GetDecorations(uint32_t id) const
+        {
+            static const Decorations none;
+            auto found = m_Decorations.find(id);
+            return found == m_Decorations.end() ? none : found->second;
+        }
+
+        bool IsArray(uint32_t type) const
+        {
+            uint32_t opcode = GetOpcode(type);
+            return opcode == Spirv::OpTypeArray ||
+                   opcode == Spirv::OpTypeRuntimeArray;
+        }
+
+        uint32_t GetArrayLength(uint32_t type) const
+        {
+            if (GetOpcode(type) == Spirv::OpTypeRuntimeArray)
+            {
+                LogError(fmt::format(
+                    "{} has a runtime sized array, which needs descriptor "
+                    "indexing",
+                    m_Name));
+            }
+            // the length is an OpConstant, its low word is enough for any
+            // array that fits in memory
+            return GetInstruction(GetInstruction(type)[3])[3];
+        }
+
+        vk::DescriptorType
+        GetDescriptorType(uint32_t type, uint32_t storageClass) const
+        {
+            std::span<const uint32_t> instruction = GetInstruction(type);
+            switch (instruction[0] & 0xffff)
+            {
+            case Spirv::OpTypeStruct:
+                if (storageClass == Spirv::StorageBuffer ||
+                    GetDecorations(type).bufferBlock)
+                {
+                    return vk::DescriptorType::eStorageBuffer;
+                }
+                return vk::DescriptorType::eUniformBuffer;
+            case Spirv::OpTypeSampler:
+                return vk::DescriptorType::eSampler;
+            case Spirv::OpTypeSampledImage:
+                return vk::DescriptorType::eCombinedImageSampler;
+            case Spirv::OpTypeAccelerationStructureKHR:
+                return vk::DescriptorType::eAccelerationStructureKHR;
+            case Spirv::OpTypeImage:
+            {
+                // sampled is 1 for images read through a sampler and 2 for
+                // storage images
+                uint32_t dim = instruction[3];
+                bool sampled = instruction[7] == 1;
+                if (dim == Spirv::DimSubpassData)
+                {
+                    return vk::DescriptorType::eInputAttachment;
+                }
+                if (dim == Spirv::DimBuffer)
+                {
+                    return sampled ? vk::DescriptorType::eUniformTexelBuffer
+                                   : vk::DescriptorType::eStorageTexelBuffer;
+                }
+                return sampled ? vk::DescriptorType::eSampledImage
+                               : vk::DescriptorType::eStorageImage;
+            }
+            }
+            LogError(fmt::format(
+                "{} has a descriptor of unsupported type {}", m_Name,
+                instruction[0] & 0xffff));
+            return {};
+        }
+
+        // bytes the type spans in an explicitly laid out block, matrices
+        // and arrays use their decorated strides
+        uint32_t GetSize(uint32_t type, uint32_t matrixStride) const
+        {
+            std::span<const uint32_t> instruction = GetInstruction(type);
+            switch (instruction[0] & 0xffff)
+            {
+            case Spirv::OpTypeInt:
+            case Spirv::OpTypeFloat:
+                return instruction[2] / 8;
+            case Spirv::OpTypeVector:
+                return instruction[3] * GetSize(instruction[2], 0);
+            case Spirv::OpTypeMatrix:
+            {
+                uint32_t columns = instruction[3];
+                return columns * (matrixStride ? matrixStride
+                                               : GetSize(instruction[2], 0));
+            }
+            case Spirv::OpTypeArray:
+            {
+                uint32_t stride = GetDecorations(type).arrayStride;
+                uint32_t length = GetArrayLength(type);
+                return length * (stride ? stride : GetSize(instruction[2], 0));
+            }
+            case Spirv::OpTypeStruct:
+            {
+                uint32_t size = 0;
+                for (uint32_t member = 0; member + 2 < instruction.size();
+                     member++)
+                {
+                    auto decorations =
+                        m_MemberDecorations.find(GetMemberKey(type, member));
+                    MemberDecorations memberDecorations =
+                        decorations == m_MemberDecorations.end()
+                            ? MemberDecorations{}
+                            : decorations->second;
+                    size = std::max(
+                        size, memberDecorations.offset +
+                                  GetSize(
+                                      instruction[member + 2],
+                                      memberDecorations.matrixStride));
+                }
+                return size;
+            }
+            }
+            LogError(fmt::format(
+                "{} has a push constant of unsupported type {}", m_Name,
+                instruction[0] & 0xffff));
+            return 0;
+        }
+
+        std::string_view m_Name;
+        vk::ShaderStageFlags m_Stages;
+        std::unordered_map<uint32_t, std::span<const uint32_t>> m_Instructions;
+        std::unordered_map<uint32_t, Decorations> m_Decorations;
+        std::unordered_map<uint64_t, MemberDecorations> m_MemberDecorations;
+        std::vector<uint32_t> m_Variables;
+    };
+
+    bool BindingLess(const ShaderBinding& a, const ShaderBinding& b)
+    {
+        return a.set < b.set || (a.set == b.set && a.binding < b.binding);
+    }
+}
+
+uint32_t ShaderLayout::GetSetCount() const
+{
+    return bindings.empty() ? 0 : bindings.back().set + 1;
+}
+
+std::vector<vk::DescriptorSetLayoutBinding>
+ShaderLayout::GetSetBindings(uint32_t set) const
+{
+    std::vector<vk::DescriptorSetLayoutBinding> setBindings;
+    for (const ShaderBinding& binding : bindings)
+    {
+        if (binding.set == set)
+        {
+            setBindings.emplace_back(
+                binding.binding, binding.type, binding.count, binding.stages);
+        }
+    }
+    return setBindings;
+}
+
+ShaderLayout
+ReflectSpirv(std::span<const uint32_t> code, std::string_view name)
+{
+    ShaderLayout layout;
+    Module(code, name).Reflect(layout);
+    std::sort(layout.bindings.begin(), layout.bindings.end(), BindingLess);
+    return layout;
+}
+
+void MergeShaderLayout(
+    ShaderLayout& layout, const ShaderLayout& stage, std::string_view name)
+{
+    for (const ShaderBinding& binding : stage.bindings)
+    {
+        auto found = std::lower_bound(
+            layout.bindings.begin(), layout.bindings.end(), binding,
+            BindingLess);
+        if (found == layout.bindings.end() || BindingLess(binding, *found))
+        {
+            layout.bindings.insert(found, binding);
+            continue;
+        }
+        if (found->type != binding.type || found->count != binding.count)
+        {
+            LogError(fmt::format(
+                "{} declares set {} binding {} differently in two stages",
+                name, binding.set, binding.binding));
+        }
+        found->stages |= binding.stages;
+    }
+    layout.pushConstantSize =
+        std::max(layout.pushConstantSize, stage.pushConstantSize);
+    layout.pushConstantStages |= stage.pushConstantStages;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+// one descriptor a shader declares
+struct ShaderBinding
+{
+    uint32_t set;
+    uint32_t binding;
+    vk::DescriptorType type;
+    // elements of a descriptor array, 1 otherwise
+    uint32_t count;
+    vk::ShaderStageFlags stages;
+};
+
+// what the stages of a shader read through descriptors and push constants,
+// so pipeline layouts follow the shaders instead of being written out by
+// hand next to them
+struct ShaderLayout
+{
+    // sorted by set and then binding
+    std::vector<ShaderBinding> bindings;
+    // bytes up to the end of the last member, 0 without a push constant
+    // block
+    uint32_t pushConstantSize = 0;
+    vk::ShaderStageFlags pushConstantStages;
+
+    // highest set used plus one, sets in between may be empty
+    uint32_t GetSetCount() const;
+    std::vector<vk::DescriptorSetLayoutBinding>
+    GetSetBindings(uint32_t set) const;
+};
+
+// reads the descriptors and the push constant block out of a module. name
+// only appears in errors
+ShaderLayout
+ReflectSpirv(std::span<const uint32_t> code, std::string_view name);
+// adds the resources of another stage, a binding declared by both has to
+// agree on type and count
+void MergeShaderLayout(
+    ShaderLayout& layout, const ShaderLayout& stage, std::string_view name);
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+// bounded single producer single consumer ring. neither side ever locks or
+// allocates, so it is safe to use from threads that must not block, like
+// the audio callback. capacity has to be a power of two
+template <typename T, size_t Capacity> class SpscQueue
+{
+    static_assert(
+        Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+        "capacity must be a power of two");
+    static_assert(
+        std::is_trivially_copyable_v<T>, "items are copied in and out");
+
+public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+
+    // producer only, false when full
+    bool Push(const T& item)
+    {
+        uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_CachedHead == Capacity)
+        {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+            if (tail - m_CachedHead == Capacity)
+            {
+                return false;
+            }
+        }
+        m_Items[tail & (Capacity - 1)] = item;
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only, false when empty
+    bool Pop(T& item)
+    {
+        uint64_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_CachedTail)
+        {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+            if (head == m_CachedTail)
+            {
+                return false;
+            }
+        }
+        item = m_Items[head & (Capacity - 1)];
+        m_Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // producer only, pushes as many items as fit and returns how many
+    size_t Push(const T* items, size_t count)
+    {
+        uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (Capacity - (tail - m_CachedHead) < count)
+        {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+        }
+        count = std::min<size_t>(count, Capacity - (tail - m_CachedHead));
+        CopyIn(tail, items, count);
+        m_Tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // consumer only, pops up to count items and returns how many
+    size_t Pop(T* items, size_t count)
+    {
+        uint64_t head = m_Head.load(std::memory_order_relaxed);
+        if (m_CachedTail - head < count)
+        {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+        }
+        count = std::min<size_t>(count, m_CachedTail - head);
+        CopyOut(head, items, count);
+        m_Head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // only a snapshot when the other side is running
+    size_t size() const
+    {
+        return static_cast<size_t>(
+            m_Tail.load(std::memory_order_acquire) -
+            m_Head.load(std::memory_order_acquire));
+    }
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    // the range can wrap around the end of the ring, so up to two copies
+    void CopyIn(uint64_t index, const T* items, size_t count)
+    {
+        size_t start = static_cast<size_t>(index & (Capacity - 1));
+        size_t first = std::min(count, Capacity - start);
+        std::copy_n(items, first, m_Items.data() + start);
+        std::copy_n(items + first, count - first, m_Items.data());
+    }
+
+    void CopyOut(uint64_t index, T* items, size_t count) const
+    {
+        size_t start = static_cast<size_t>(index & (Capacity - 1));
+        size_t first = std::min(count, Capacity - start);
+        std::copy_n(m_Items.data() + start, first, items);
+        std::copy_n(m_Items.data(), count - first, items + first);
+    }
+
+    // producer and consumer state on separate cache lines, each side keeps a
+    // copy of the other's index and only reloads it when it looks full or
+    // empty, so in steady state neither touches the other's line
+    static constexpr size_t CACHE_LINE = 64;
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> m_Tail = 0;
+    uint64_t m_CachedHead = 0;
+    alignas(CACHE_LINE) std::atomic<uint64_t> m_Head = 0;
+    uint64_t m_CachedTail = 0;
+    alignas(CACHE_LINE) std::array<T, Capacity> m_Items;
+};
@@ -1,12 +1,25 @@
 #include "Surface.hpp"
 #include "Device.hpp"
 #include <algorithm>
+#include <limits>
 
 Surface::Surface(Window& window, VulkanInstance& instance)
-    : m_Surface(instance.Get(), createSDLVulkanSurface(window.Get(), instance.Get()))
+    : m_Window(window), m_Surface(CreateSurface(window, instance.Get()))
 {
 }
 
+vk::raii::SurfaceKHR
+Surface::CreateSurface(Window& window, vk::raii::Instance& instance)
+{
+    if (window.IsHeadless())
+    {
+        return instance.createHeadlessSurfaceEXT(
+            vk::HeadlessSurfaceCreateInfoEXT());
+    }
+    return vk::raii::SurfaceKHR(
+        instance, createSDLVulkanSurface(window.Get(), instance));
+}
+
 VkSurfaceKHR Surface::createSDLVulkanSurface(SDL_Window* window, vk::raii::Instance& instance)
 {
     VkSurfaceKHR surface;
@@ -27,6 +40,21 @@ VkSurfaceKHR Surface::createSDLVulkanSurface(SDL_Window* window, vk::raii::Insta
 void Surface::GetSurfaceCapabilities(Device& device)
 {
     surfaceCapabilities = device.GetSurfaceCapabilities(m_Surface);
+    // headless and wayland surfaces leave the size to the swapchain
+    if (surfaceCapabilities.currentExtent.width ==
+        std::numeric_limits<uint32_t>::max())
+    {
+        glm::i32vec2 size = m_Window.GetDrawableSize();
+        surfaceCapabilities.currentExtent = vk::Extent2D(
+            std::clamp(
+                static_cast<uint32_t>(size.x),
+                surfaceCapabilities.minImageExtent.width,
+                surfaceCapabilities.maxImageExtent.width),
+            std::clamp(
+                static_cast<uint32_t>(size.y),
+                surfaceCapabilities.minImageExtent.height,
+                surfaceCapabilities.maxImageExtent.height));
+    }
 
     LogDebug(fmt::format(
         "Surface capabiltiies:\t{}", surfaceCapabilities.currentExtent));
@@ -27,6 +27,9 @@ public:
     vk::SurfaceFormatKHR surfaceFormat;
 
 private:
+    vk::raii::SurfaceKHR
+    CreateSurface(Window& window, vk::raii::Instance& instance);
     VkSurfaceKHR createSDLVulkanSurface(SDL_Window* window, vk::raii::Instance& instance);
+    const Window& m_Window;
     vk::raii::SurfaceKHR m_Surface;
 };
\ No newline at end of file
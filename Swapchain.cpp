@@ -1,40 +1,81 @@
 #include "Swapchain.hpp"
+#include <algorithm>
+#include <utility>
 
-Swapchain::Swapchain(Device& device, Surface& surface)
-    : m_Swapchain(CreateSwapchain(device, surface))
+Swapchain::Swapchain(
+    Device& device, Surface& surface, vk::PresentModeKHR presentMode)
+    : m_PresentMode(presentMode), m_Swapchain(CreateSwapchain(device, surface))
 {
     CreateSwapchainImageViews(device.Get(), surface.surfaceFormat);
     m_Extent = surface.surfaceCapabilities.currentExtent;
     m_ImageCount = m_SwapchainImageViews.size();
 }
 
-vk::raii::SwapchainKHR
-Swapchain::CreateSwapchain(Device& device, Surface& surface)
+void Swapchain::Recreate(
+    Device& device, Surface& surface, DeletionQueue& deletions)
+{
+    deletions.Retire(std::move(m_SwapchainImageViews));
+    m_SwapchainImageViews.clear();
+    m_SwapchainImages.clear();
+    vk::raii::SwapchainKHR swapchain =
+        CreateSwapchain(device, surface, *m_Swapchain);
+    deletions.Retire(std::exchange(m_Swapchain, std::move(swapchain)));
+    CreateSwapchainImageViews(device.Get(), surface.surfaceFormat);
+    m_Extent = surface.surfaceCapabilities.currentExtent;
+    m_ImageCount = m_SwapchainImageViews.size();
+}
+
+vk::raii::SwapchainKHR Swapchain::CreateSwapchain(
+    Device& device, Surface& surface, vk::SwapchainKHR oldSwapchain)
 {
     surface.GetSurfaceCapabilities(device);
     surface.GetSurfaceFormat(device);
 
+    // transfer src lets FrameReadback copy presented frames, not every
+    // surface offers it
+    vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eColorAttachment |
+                                vk::ImageUsageFlagBits::eTransferDst;
+    if (surface.surfaceCapabilities.supportedUsageFlags &
+        vk::ImageUsageFlagBits::eTransferSrc)
+    {
+        usage |= vk::ImageUsageFlagBits::eTransferSrc;
+    }
+
+    m_ActivePresentMode = PickPresentMode(device, surface);
     vk::SwapchainCreateInfoKHR createInfo(
         {}, *surface.Get(), surface.surfaceCapabilities.minImageCount + 1,
         surface.surfaceFormat.format, surface.surfaceFormat.colorSpace,
-        surface.surfaceCapabilities.currentExtent, 1,
-        vk::ImageUsageFlagBits::eColorAttachment |
-            vk::ImageUsageFlagBits::eTransferDst,
+        surface.surfaceCapabilities.currentExtent, 1, usage,
         vk::SharingMode::eExclusive, 0, nullptr,
         vk::SurfaceTransformFlagBitsKHR::eIdentity,
-        vk::CompositeAlphaFlagBitsKHR::eOpaque, vk::PresentModeKHR::eFifo,
-        true);
+        vk::CompositeAlphaFlagBitsKHR::eOpaque,
+        m_ActivePresentMode, true, oldSwapchain);
 
     return device.Get().createSwapchainKHR(createInfo);
 }
 
+vk::PresentModeKHR Swapchain::PickPresentMode(Device& device, Surface& surface)
+{
+    std::vector<vk::PresentModeKHR> presentModes =
+        device.GetPhysicalDevice().getSurfacePresentModesKHR(*surface.Get());
+    if (std::find(presentModes.begin(), presentModes.end(), m_PresentMode) !=
+        presentModes.end())
+    {
+        return m_PresentMode;
+    }
+    LogWarning(fmt::format(
+        "Present mode {} not supported, using fifo",
+        vk::to_string(m_PresentMode)));
+    return vk::PresentModeKHR::eFifo;
+}
+
 void Swapchain::CreateSwapchainImageViews(
     vk::raii::Device& device, vk::SurfaceFormatKHR surfaceFormat)
 {
     VkResult result;
-    std::vector<vk::Image> swapchainImages = m_Swapchain.getImages();
-    m_SwapchainImageViews.reserve(swapchainImages.size());
-    for (auto image : swapchainImages)
+    m_SwapchainImages = m_Swapchain.getImages();
+    m_SwapchainImageViews.reserve(m_SwapchainImages.size());
+    for (auto image : m_SwapchainImages)
     {
         vk::ImageSubresourceRange subresourceRange(
             vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
@@ -1,4 +1,5 @@
 #pragma once
+#include "DeletionQueue.hpp"
 #include "Device.hpp"
 #include "Surface.hpp"
 #include <vector>
@@ -7,21 +8,41 @@
 class Swapchain
 {
 public:
-    Swapchain(Device& device, Surface& surface);
+    // falls back to fifo, the only mode every device has, when the
+    // requested present mode is not supported
+    Swapchain(
+        Device& device, Surface& surface,
+        vk::PresentModeKHR presentMode = vk::PresentModeKHR::eFifo);
+
+    // the old swapchain and its views are retired, frames in flight can
+    // still present from them
+    void Recreate(Device& device, Surface& surface, DeletionQueue& deletions);
 
     constexpr std::vector<vk::raii::ImageView>& GetImageViews()
     {
         return m_SwapchainImageViews;
     }
+    constexpr std::vector<vk::Image>& GetImages() { return m_SwapchainImages; }
     constexpr vk::raii::SwapchainKHR& Get() { return m_Swapchain; }
-    constexpr vk::Extent2D GetExtent() { return m_Extent; }
+    constexpr vk::Extent2D GetExtent() const { return m_Extent; }
     constexpr size_t GetImageCount() { return m_ImageCount; }
+    // the mode in use, fifo when the requested one was not supported
+    constexpr vk::PresentModeKHR GetPresentMode() const
+    {
+        return m_ActivePresentMode;
+    }
 
 private:
+    std::vector<vk::Image> m_SwapchainImages;
     std::vector<vk::raii::ImageView> m_SwapchainImageViews;
-    vk::raii::SwapchainKHR CreateSwapchain(Device& device, Surface& surface);
+    vk::raii::SwapchainKHR CreateSwapchain(
+        Device& device, Surface& surface,
+        vk::SwapchainKHR oldSwapchain = nullptr);
+    vk::PresentModeKHR PickPresentMode(Device& device, Surface& surface);
     void CreateSwapchainImageViews(
         vk::raii::Device& device, vk::SurfaceFormatKHR surfaceFormat);
+    vk::PresentModeKHR m_PresentMode;
+    vk::PresentModeKHR m_ActivePresentMode = vk::PresentModeKHR::eFifo;
     vk::raii::SwapchainKHR m_Swapchain;
     size_t m_ImageCount;
     vk::Extent2D m_Extent;
@@ -0,0 +1,222 @@
+#include "Tilemap.hpp"
+#include <cmath>
+
+static int32_t FloorDivide(int32_t value, int32_t divisor)
+{
+    int32_t quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+static glm::i32vec2 GetChunkRangeMin(const Aabb& view, int32_t margin)
+{
+    return glm::i32vec2(
+               static_cast<int32_t>(std::floor(view.min.x / CHUNK_SIZE)),
+               static_cast<int32_t>(std::floor(view.min.y / CHUNK_SIZE))) -
+           margin;
+}
+
+static glm::i32vec2 GetChunkRangeMax(const Aabb& view, int32_t margin)
+{
+    return glm::i32vec2(
+               static_cast<int32_t>(std::floor(view.max.x / CHUNK_SIZE)),
+               static_cast<int32_t>(std::floor(view.max.y / CHUNK_SIZE))) +
+           margin;
+}
+
+Tilemap::Tilemap(JobSystem& jobs, ChunkGenerator generator)
+    : m_Jobs(jobs), m_Generator(std::move(generator))
+{
+}
+
+Tilemap::~Tilemap()
+{
+    for (auto& [key, load] : m_Loading)
+    {
+        m_Jobs.Wait(load->counter);
+    }
+}
+
+glm::i32vec2 Tilemap::GetChunkCoord(glm::i32vec2 tile)
+{
+    return {
+        FloorDivide(tile.x, CHUNK_TILES), FloorDivide(tile.y, CHUNK_TILES)};
+}
+
+glm::i32vec2 Tilemap::GetTileCoord(glm::vec2 position)
+{
+    return {
+        static_cast<int32_t>(std::floor(position.x / TILE_SIZE)),
+        static_cast<int32_t>(std::floor(position.y / TILE_SIZE))};
+}
+
+uint32_t Tilemap::GetTileIndex(glm::i32vec2 tile)
+{
+    glm::i32vec2 local = tile - GetChunkCoord(tile) * CHUNK_TILES;
+    return static_cast<uint32_t>(local.y * CHUNK_TILES + local.x);
+}
+
+TileId Tilemap::GetTile(glm::i32vec2 tile) const
+{
+    auto found = m_Resident.find(GetChunkKey(GetChunkCoord(tile)));
+    if (found == m_Resident.end())
+    {
+        return EMPTY_TILE;
+    }
+    return found->second->tiles.at(GetTileIndex(tile));
+}
+
+void Tilemap::SetTile(glm::i32vec2 tile, TileId id)
+{
+    ChunkKey key = GetChunkKey(GetChunkCoord(tile));
+    uint32_t index = GetTileIndex(tile);
+
+    if (auto found = m_Resident.find(key); found != m_Resident.end())
+    {
+        TileChunk& chunk = *found->second;
+        if (chunk.tiles.at(index) == id)
+        {
+            return;
+        }
+        chunk.tiles.at(index) = id;
+        chunk.edited = true;
+        chunk.version = m_NextVersion++;
+        return;
+    }
+    if (auto found = m_Saved.find(key); found != m_Saved.end())
+    {
+        found->second->tiles.at(index) = id;
+        return;
+    }
+    // also covers chunks being generated right now, the job must not be
+    // raced
+    m_PendingEdits[key].push_back({index, id});
+}
+
+void Tilemap::Update(const Aabb& view)
+{
+    FinishLoads();
+    StartLoads(
+        GetChunkRangeMin(view, CHUNK_STREAM_MARGIN),
+        GetChunkRangeMax(view, CHUNK_STREAM_MARGIN));
+    // twice the margin, so a view moving back and forth over a chunk
+    // border does not keep loading and dropping the same chunks
+    Unload(
+        GetChunkRangeMin(view, CHUNK_STREAM_MARGIN * 2),
+        GetChunkRangeMax(view, CHUNK_STREAM_MARGIN * 2));
+}
+
+void Tilemap::WaitForLoads()
+{
+    for (auto& [key, load] : m_Loading)
+    {
+        m_Jobs.Wait(load->counter);
+    }
+    FinishLoads();
+}
+
+void Tilemap::GetVisible(
+    const Aabb& view, std::vector<const TileChunk*>& chunks) const
+{
+    glm::i32vec2 minChunk = GetChunkRangeMin(view, 0);
+    glm::i32vec2 maxChunk = GetChunkRangeMax(view, 0);
+    for (int32_t y = minChunk.y; y <= maxChunk.y; y++)
+    {
+        for (int32_t x = minChunk.x; x <= maxChunk.x; x++)
+        {
+            auto found = m_Resident.find(GetChunkKey({x, y}));
+            if (found != m_Resident.end())
+            {
+                chunks.push_back(found->second.get());
+            }
+        }
+    }
+}
+
+void Tilemap::FinishLoads()
+{
+    for (auto it = m_Loading.begin(); it != m_Loading.end();)
+    {
+        if (!it->second->counter.IsDone())
+        {
+            ++it;
+            continue;
+        }
+        std::unique_ptr<TileChunk> chunk = std::move(it->second->chunk);
+        it = m_Loading.erase(it);
+
+        ChunkKey key = GetChunkKey(chunk->coord);
+        if (auto edits = m_PendingEdits.find(key);
+            edits != m_PendingEdits.end())
+        {
+            for (const TileEdit& edit : edits->second)
+            {
+                chunk->tiles.at(edit.index) = edit.id;
+            }
+            chunk->edited = true;
+            m_PendingEdits.erase(edits);
+        }
+        MakeResident(std::move(chunk));
+    }
+}
+
+void Tilemap::StartLoads(glm::i32vec2 minChunk, glm::i32vec2 maxChunk)
+{
+    for (int32_t y = minChunk.y; y <= maxChunk.y; y++)
+    {
+        for (int32_t x = minChunk.x; x <= maxChunk.x; x++)
+        {
+            ChunkKey key = GetChunkKey({x, y});
+            if (m_Resident.contains(key) || m_Loading.contains(key))
+            {
+                continue;
+            }
+            // edited chunks come back as they were left, no generator
+            if (auto saved = m_Saved.find(key); saved != m_Saved.end())
+            {
+                std::unique_ptr<TileChunk> chunk = std::move(saved->second);
+                m_Saved.erase(saved);
+                MakeResident(std::move(chunk));
+                continue;
+            }
+            if (m_Loading.size() >= MAX_CHUNK_LOADS)
+            {
+                continue;
+            }
+
+            auto load = std::make_unique<ChunkLoad>();
+            load->chunk = std::make_unique<TileChunk>();
+            load->chunk->coord = {x, y};
+            TileChunk* chunk = load->chunk.get();
+            m_Jobs.Run(
+                [this, chunk]() { m_Generator(chunk->coord, chunk->tiles); },
+                &load->counter);
+            m_Loading.emplace(key, std::move(load));
+        }
+    }
+}
+
+void Tilemap::Unload(glm::i32vec2 minChunk, glm::i32vec2 maxChunk)
+{
+    for (auto it = m_Resident.begin(); it != m_Resident.end();)
+    {
+        glm::i32vec2 coord = it->second->coord;
+        if (coord.x >= minChunk.x && coord.x <= maxChunk.x &&
+            coord.y >= minChunk.y && coord.y <= maxChunk.y)
+        {
+            ++it;
+            continue;
+        }
+        if (it->second->edited)
+        {
+            m_Saved.emplace(it->first, std::move(it->second));
+        }
+        it = m_Resident.erase(it);
+    }
+}
+
+void Tilemap::MakeResident(std::unique_ptr<TileChunk> chunk)
+{
+    chunk->version = m_NextVersion++;
+    ChunkKey key = GetChunkKey(chunk->coord);
+    m_Resident.emplace(key, std::move(chunk));
+}
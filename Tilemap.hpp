@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Culling.hpp"
+#include "JobSystem.hpp"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// tiles per chunk side, a chunk is the unit of streaming and of gpu upload
+constexpr int32_t CHUNK_TILES = 32;
+constexpr uint32_t TILES_PER_CHUNK = CHUNK_TILES * CHUNK_TILES;
+// in world units, the camera spans 2 units across
+constexpr float TILE_SIZE = 1.0f / 16.0f;
+constexpr float CHUNK_SIZE = CHUNK_TILES * TILE_SIZE;
+// chunks past the edge of the view that are loaded ahead of time, so tiles
+// are there before they scroll in
+constexpr int32_t CHUNK_STREAM_MARGIN = 1;
+// generator jobs in flight at once, the rest wait for a later Update
+constexpr size_t MAX_CHUNK_LOADS = 16;
+
+using ChunkKey = uint64_t;
+
+constexpr ChunkKey GetChunkKey(glm::i32vec2 coord)
+{
+    return (static_cast<ChunkKey>(static_cast<uint32_t>(coord.x)) << 32) |
+           static_cast<uint32_t>(coord.y);
+}
+
+// index into the tile atlas, 0 draws nothing and ids past the end of the
+// atlas wrap around
+using TileId = uint16_t;
+constexpr TileId EMPTY_TILE = 0;
+
+// fills a chunk that has never been edited, rows top to bottom. runs on the
+// job system, so it must only touch the chunk it is handed
+using ChunkGenerator =
+    std::function<void(glm::i32vec2 chunk, std::span<TileId> tiles)>;
+
+struct TileChunk
+{
+    glm::i32vec2 coord{0, 0};
+    std::array<TileId, TILES_PER_CHUNK> tiles{};
+    // unique across every load and edit of every chunk, the renderer
+    // uploads again whenever it differs from what it has
+    uint64_t version = 0;
+    // edited chunks are kept when they stream out, everything else is
+    // generated again when it comes back
+    bool edited = false;
+};
+
+// an unbounded 2d tile world. only chunks around the view are resident,
+// they are generated on the job system as the view moves and dropped once
+// it has moved on, so memory follows the view and the edits rather than the
+// size of the world
+class Tilemap
+{
+public:
+    Tilemap(JobSystem& jobs, ChunkGenerator generator);
+    Tilemap(const Tilemap&) = delete;
+    // waits for loads still in flight
+    ~Tilemap();
+
+    static glm::i32vec2 GetChunkCoord(glm::i32vec2 tile);
+    static glm::i32vec2 GetTileCoord(glm::vec2 position);
+
+    // EMPTY_TILE while the tile's chunk is not resident
+    TileId GetTile(glm::i32vec2 tile) const;
+    // works anywhere, edits to chunks that are not resident are applied
+    // when they load
+    void SetTile(glm::i32vec2 tile, TileId id);
+
+    // picks up finished loads, starts loads around view and drops chunks
+    // that are too far from it. once a frame on the game thread
+    void Update(const Aabb& view);
+    // blocks until every load started so far is resident, helping the job
+    // system meanwhile. for loading screens and tools
+    void WaitForLoads();
+    // appends the resident chunks overlapping view, the pointers are valid
+    // until the next Update
+    void
+    GetVisible(const Aabb& view, std::vector<const TileChunk*>& chunks) const;
+
+    size_t GetResidentCount() const { return m_Resident.size(); }
+    size_t GetLoadingCount() const { return m_Loading.size(); }
+
+private:
+    struct ChunkLoad
+    {
+        std::unique_ptr<TileChunk> chunk;
+        JobCounter counter;
+    };
+
+    struct TileEdit
+    {
+        uint32_t index;
+        TileId id;
+    };
+
+    static uint32_t GetTileIndex(glm::i32vec2 tile);
+    void FinishLoads();
+    void StartLoads(glm::i32vec2 minChunk, glm::i32vec2 maxChunk);
+    void Unload(glm::i32vec2 minChunk, glm::i32vec2 maxChunk);
+    void MakeResident(std::unique_ptr<TileChunk> chunk);
+
+    JobSystem& m_Jobs;
+    ChunkGenerator m_Generator;
+    uint64_t m_NextVersion = 1;
+    std::unordered_map<ChunkKey, std::unique_ptr<TileChunk>> m_Resident;
+    std::unordered_map<ChunkKey, std::unique_ptr<ChunkLoad>> m_Loading;
+    // edited chunks that streamed out
+    std::unordered_map<ChunkKey, std::unique_ptr<TileChunk>> m_Saved;
+    // edits to chunks that were never loaded, applied once they are
+    std::unordered_map<ChunkKey, std::vector<TileEdit>> m_PendingEdits;
+};
@@ -0,0 +1,316 @@
+#include "TilemapRenderer.hpp"
+#include "Log.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+TilemapRenderer::SlotRelease::~SlotRelease()
+{
+    if (pool)
+    {
+        std::scoped_lock lock(pool->mutex);
+        pool->free.push_back(slot);
+    }
+}
+
+TilemapRenderer::TilemapRenderer(
+    Device& device, LayoutCache& layouts, size_t frameCount)
+    : m_Layouts(layouts), m_Tiles(
+          device, TILE_CHUNK_SLOTS * TILES_PER_CHUNK / 2,
+          vk::BufferUsageFlagBits::eStorageBuffer),
+      m_Atlas(
+          device, ATLAS_PIXELS * ATLAS_PIXELS,
+          vk::BufferUsageFlagBits::eStorageBuffer),
+      m_DescriptorSetLayout(CreateDescriptorSetLayout()),
+      m_DescriptorPool(CreateDescriptorPool(device, frameCount)),
+      m_DescriptorSets(CreateDescriptorSets(device, frameCount)),
+      m_SlotPool(std::make_shared<SlotPool>())
+{
+    m_ChunkBuffers.reserve(frameCount);
+    for (size_t i = 0; i < frameCount; i++)
+    {
+        m_ChunkBuffers.emplace_back(
+            device, MAX_VISIBLE_CHUNKS,
+            vk::BufferUsageFlagBits::eStorageBuffer);
+        // mapped once up front and left mapped
+        m_ChunkBuffers.back().GetMemory();
+    }
+    m_Tiles.GetMemory();
+    // handed out from the front, so the first chunks land at the start
+    for (uint32_t slot = TILE_CHUNK_SLOTS; slot > 0; slot--)
+    {
+        m_SlotPool->free.push_back(slot - 1);
+    }
+    FillAtlas();
+    WriteDescriptorSets(device);
+}
+
+void TilemapRenderer::FillAtlas()
+{
+    // placeholder tiles until an atlas is loaded, a flat color per id with
+    // a darker edge so the grid stays visible
+    std::span<uint32_t> texels = m_Atlas.GetMemory();
+    for (uint32_t id = 0; id < ATLAS_COLUMNS * ATLAS_COLUMNS; id++)
+    {
+        uint32_t r = 64 + (id * 53) % 160;
+        uint32_t g = 64 + (id * 97) % 160;
+        uint32_t b = 64 + (id * 29) % 160;
+        uint32_t originX = (id % ATLAS_COLUMNS) * ATLAS_TILE_PIXELS;
+        uint32_t originY = (id / ATLAS_COLUMNS) * ATLAS_TILE_PIXELS;
+        for (uint32_t y = 0; y < ATLAS_TILE_PIXELS; y++)
+        {
+            for (uint32_t x = 0; x < ATLAS_TILE_PIXELS; x++)
+            {
+                bool edge = x == 0 || y == 0;
+                uint32_t shift = edge ? 1 : 0;
+                texels[(originY + y) * ATLAS_PIXELS + originX + x] =
+                    (r >> shift) | (g >> shift) << 8 | (b >> shift) << 16 |
+                    0xffu << 24;
+            }
+        }
+    }
+}
+
+void TilemapRenderer::LoadAtlas(const PackedImage& image)
+{
+    if (image.width != ATLAS_PIXELS || image.height != ATLAS_PIXELS)
+    {
+        LogWarning(fmt::format(
+            "Tile atlas is {}x{}, expected {}x{}", image.width, image.height,
+            ATLAS_PIXELS, ATLAS_PIXELS));
+        return;
+    }
+    // the first mip level is all that is sampled
+    std::span<uint32_t> texels = m_Atlas.GetMemory();
+    std::memcpy(
+        texels.data(), image.data.data(),
+        static_cast<size_t>(ATLAS_PIXELS) * ATLAS_PIXELS *
+            PackedImage::BYTES_PER_TEXEL);
+}
+
+vk::DescriptorSetLayout TilemapRenderer::CreateDescriptorSetLayout()
+{
+    // chunk list and tile ids are pulled by the vertex shader, the atlas is
+    // read per fragment
+    std::array<vk::DescriptorSetLayoutBinding, 3> bindings = {{
+        {0, vk::DescriptorType::eStorageBuffer, 1,
+         vk::ShaderStageFlagBits::eVertex},
+        {1, vk::DescriptorType::eStorageBuffer, 1,
+         vk::ShaderStageFlagBits::eVertex},
+        {2, vk::DescriptorType::eStorageBuffer, 1,
+         vk::ShaderStageFlagBits::eFragment},
+    }};
+    return m_Layouts.GetDescriptorSetLayout(bindings);
+}
+
+vk::raii::DescriptorPool
+TilemapRenderer::CreateDescriptorPool(Device& device, size_t frameCount)
+{
+    vk::DescriptorPoolSize poolSize(
+        vk::DescriptorType::eStorageBuffer,
+        static_cast<uint32_t>(frameCount * 3));
+    vk::DescriptorPoolCreateInfo createInfo(
+        vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        static_cast<uint32_t>(frameCount), poolSize);
+    return device.Get().createDescriptorPool(createInfo);
+}
+
+vk::raii::DescriptorSets
+TilemapRenderer::CreateDescriptorSets(Device& device, size_t frameCount)
+{
+    std::vector<vk::DescriptorSetLayout> setLayouts(
+        frameCount, m_DescriptorSetLayout);
+    vk::DescriptorSetAllocateInfo allocInfo(*m_DescriptorPool, setLayouts);
+    return vk::raii::DescriptorSets(device.Get(), allocInfo);
+}
+
+void TilemapRenderer::WriteDescriptorSets(Device& device)
+{
+    vk::DescriptorBufferInfo tileInfo(*m_Tiles.Get(), 0, m_Tiles.size());
+    vk::DescriptorBufferInfo atlasInfo(*m_Atlas.Get(), 0, m_Atlas.size());
+    std::vector<vk::DescriptorBufferInfo> chunkInfos;
+    chunkInfos.reserve(m_ChunkBuffers.size());
+    std::vector<vk::WriteDescriptorSet> writes;
+    for (size_t i = 0; i < m_ChunkBuffers.size(); i++)
+    {
+        chunkInfos.emplace_back(
+            *m_ChunkBuffers.at(i).Get(), 0, m_ChunkBuffers.at(i).size());
+        writes.emplace_back(
+            *m_DescriptorSets.at(i), 0, 0, vk::DescriptorType::eStorageBuffer,
+            nullptr, chunkInfos.back(), nullptr);
+        writes.emplace_back(
+            *m_DescriptorSets.at(i), 1, 0, vk::DescriptorType::eStorageBuffer,
+            nullptr, tileInfo, nullptr);
+        writes.emplace_back(
+            *m_DescriptorSets.at(i), 2, 0, vk::DescriptorType::eStorageBuffer,
+            nullptr, atlasInfo, nullptr);
+    }
+    device.Get().updateDescriptorSets(writes, nullptr);
+}
+
+void TilemapRenderer::CreatePipeline(
+    Device& device, RenderPass& renderPass, const Shader& shader)
+{
+    // the same view rotation the scene's own pipeline is pushed
+    m_PipelineLayout = m_Layouts.GetPipelineLayout(
+        shader, {&m_DescriptorSetLayout, 1},
+        PushConstantSize<DrawConstants>::value);
+
+    std::array<vk::PipelineShaderStageCreateInfo, 2> shaderStages = {{
+        {{}, vk::ShaderStageFlagBits::eVertex, *shader.vertShaderModule,
+         "main"},
+        {{}, vk::ShaderStageFlagBits::eFragment, *shader.fragShaderModule,
+         "main"},
+    }};
+
+    // no vertex buffers, every tile is built from gl_VertexIndex
+    vk::PipelineVertexInputStateCreateInfo vertexInputState{};
+    vk::PipelineInputAssemblyStateCreateInfo inputAssemblyState(
+        {}, vk::PrimitiveTopology::eTriangleList, {});
+    vk::PipelineViewportStateCreateInfo viewportState(
+        {}, 1, nullptr, 1, nullptr);
+
+    vk::PipelineRasterizationStateCreateInfo rasterizationState{};
+    rasterizationState.setCullMode(vk::CullModeFlagBits::eNone);
+    rasterizationState.setLineWidth(1.0f);
+
+    vk::PipelineMultisampleStateCreateInfo multisampleState{};
+
+    // the background, drawn first and never hiding anything drawn after it
+    vk::PipelineDepthStencilStateCreateInfo depthStencilState{};
+    depthStencilState.setDepthTestEnable(VK_FALSE);
+    depthStencilState.setDepthWriteEnable(VK_FALSE);
+
+    vk::PipelineColorBlendAttachmentState colorAttachment{};
+    colorAttachment.setColorWriteMask(
+        vk::FlagTraits<vk::ColorComponentFlagBits>::allFlags);
+    vk::PipelineColorBlendStateCreateInfo colorBlendState(
+        {}, VK_FALSE, vk::LogicOp::eClear, colorAttachment);
+
+    std::array<vk::DynamicState, 2> dynamicStates = {
+        vk::DynamicState::eViewport, vk::DynamicState::eScissor};
+    vk::PipelineDynamicStateCreateInfo dynamicState({}, dynamicStates);
+
+    vk::GraphicsPipelineCreateInfo createInfo(
+        {}, shaderStages, &vertexInputState, &inputAssemblyState, {},
+        &viewportState, &rasterizationState, &multisampleState,
+        &depthStencilState, &colorBlendState, &dynamicState, m_PipelineLayout,
+        *renderPass.Get());
+
+    m_Pipeline = device.Get().createGraphicsPipeline(nullptr, createInfo);
+}
+
+uint32_t TilemapRenderer::Update(
+    std::span<const TileChunk* const> visible, size_t frame,
+    DeletionQueue& deletions)
+{
+    m_UpdateCount++;
+
+    std::span<ChunkInstance> instances = m_ChunkBuffers.at(frame).GetMemory();
+    uint32_t count = 0;
+    uint32_t uploads = 0;
+    for (const TileChunk* chunk : visible)
+    {
+        if (count == MAX_VISIBLE_CHUNKS)
+        {
+            LogWarning(fmt::format(
+                "Chunk list full, dropping {} chunks",
+                visible.size() - MAX_VISIBLE_CHUNKS));
+            break;
+        }
+        auto [it, inserted] = m_GpuChunks.try_emplace(
+            GetChunkKey(chunk->coord), GpuChunk{NO_SLOT, 0, 0});
+        GpuChunk& gpuChunk = it->second;
+        gpuChunk.lastVisible = m_UpdateCount;
+        if (gpuChunk.version != chunk->version &&
+            uploads < MAX_CHUNK_UPLOADS)
+        {
+            uint32_t oldSlot = gpuChunk.slot;
+            if (Upload(*chunk, gpuChunk))
+            {
+                uploads++;
+                if (oldSlot != NO_SLOT)
+                {
+                    Release(oldSlot, deletions);
+                }
+            }
+        }
+        // not uploaded yet, it shows up a frame later
+        if (gpuChunk.slot == NO_SLOT)
+        {
+            continue;
+        }
+        instances[count++] = {
+            glm::vec2(
+                static_cast<float>(chunk->coord.x),
+                static_cast<float>(chunk->coord.y)) *
+                CHUNK_SIZE,
+            gpuChunk.slot, 0};
+    }
+
+    // chunks out of view give their slot up, they are uploaded again when
+    // they come back
+    for (auto it = m_GpuChunks.begin(); it != m_GpuChunks.end();)
+    {
+        if (it->second.lastVisible == m_UpdateCount)
+        {
+            ++it;
+            continue;
+        }
+        if (it->second.slot != NO_SLOT)
+        {
+            Release(it->second.slot, deletions);
+        }
+        it = m_GpuChunks.erase(it);
+    }
+    return count;
+}
+
+bool TilemapRenderer::Upload(const TileChunk& chunk, GpuChunk& gpuChunk)
+{
+    uint32_t slot;
+    {
+        std::scoped_lock lock(m_SlotPool->mutex);
+        if (m_SlotPool->free.empty())
+        {
+            return false;
+        }
+        slot = m_SlotPool->free.back();
+        m_SlotPool->free.pop_back();
+    }
+    // nothing in flight reads a free slot, so it is written in place
+    std::memcpy(
+        m_Tiles.GetMemory().data() + slot * (TILES_PER_CHUNK / 2),
+        chunk.tiles.data(), sizeof(chunk.tiles));
+    gpuChunk.slot = slot;
+    gpuChunk.version = chunk.version;
+    return true;
+}
+
+void TilemapRenderer::Release(uint32_t slot, DeletionQueue& deletions)
+{
+    deletions.Retire(SlotRelease(m_SlotPool, slot));
+}
+
+void TilemapRenderer::Record(
+    vk::raii::CommandBuffer& commandBuffer, size_t frame, uint32_t chunkCount,
+    const DrawConstants& constants)
+{
+    if (chunkCount == 0)
+    {
+        return;
+    }
+    // viewport and scissor are left from the scene pass
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *m_Pipeline);
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics, m_PipelineLayout, 0,
+        *m_DescriptorSets.at(frame), nullptr);
+    PushConstants(
+        commandBuffer, m_PipelineLayout, vk::ShaderStageFlagBits::eVertex,
+        constants);
+    // every tile of every visible chunk in one draw, empty tiles collapse
+    // to nothing in the vertex shader
+    commandBuffer.draw(TILES_PER_CHUNK * 6, chunkCount, 0, 0);
+}
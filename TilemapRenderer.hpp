@@ -0,0 +1,132 @@
+#pragma once
+
+#include "AssetPack.hpp"
+#include "Buffer.hpp"
+#include "DeletionQueue.hpp"
+#include "Device.hpp"
+#include "LayoutCache.hpp"
+#include "PushConstants.hpp"
+#include "RenderPass.hpp"
+#include "Shader.hpp"
+#include "Tilemap.hpp"
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+// capacity of each frame's chunk list
+constexpr uint32_t MAX_VISIBLE_CHUNKS = 256;
+// chunks on the gpu at once, replaced chunks hold on to their slot until
+// the frames drawing them have completed, so there is room for both
+constexpr uint32_t TILE_CHUNK_SLOTS = MAX_VISIBLE_CHUNKS * 2;
+// chunks copied to the gpu per frame, the rest keep drawing their old tiles
+// or wait a frame, so a burst of edits never makes a frame slow
+constexpr uint32_t MAX_CHUNK_UPLOADS = 32;
+// the atlas is a grid of square tiles, indexed by TileId
+constexpr uint32_t ATLAS_TILE_PIXELS = 16;
+constexpr uint32_t ATLAS_COLUMNS = 16;
+constexpr uint32_t ATLAS_PIXELS = ATLAS_TILE_PIXELS * ATLAS_COLUMNS;
+
+// one visible chunk, std430 layout matching Chunk in tilemap.vert
+struct ChunkInstance
+{
+    // world position of the chunk's top left corner
+    glm::vec2 origin;
+    uint32_t slot;
+    uint32_t padding;
+};
+
+// draws a Tilemap in the scene pass. resident chunks keep their tile ids in
+// slots of one storage buffer and the vertex shader expands every tile
+// into a quad from those ids and the atlas, so no geometry is ever built.
+// a frame only writes the list of visible chunks and uploads the chunks
+// that changed. a changed chunk goes to a fresh slot and its old slot is
+// retired, frames still in flight keep reading the tiles they were
+// recorded with
+class TilemapRenderer
+{
+public:
+    TilemapRenderer(
+        Device& device, LayoutCache& layouts, size_t frameCount);
+    TilemapRenderer(const TilemapRenderer&) = delete;
+
+    // shaders load after the renderer is up, Record must not be called
+    // before this
+    void CreatePipeline(
+        Device& device, RenderPass& renderPass, const Shader& shader);
+    // 8 bit rgba, ATLAS_PIXELS square, replaces the generated atlas. only
+    // before the first frame that draws tiles
+    void LoadAtlas(const PackedImage& image);
+
+    // uploads what changed among the visible chunks and writes the frame's
+    // chunk list, returns how many chunks to draw. the frame's fence has to
+    // have signalled
+    uint32_t Update(
+        std::span<const TileChunk* const> visible, size_t frame,
+        DeletionQueue& deletions);
+    // inside the scene render pass, before anything depth tested
+    void Record(
+        vk::raii::CommandBuffer& commandBuffer, size_t frame,
+        uint32_t chunkCount, const DrawConstants& constants);
+
+private:
+    // slots free for reuse, shared with the deletion queue which hands
+    // retired slots back once their frames have completed
+    struct SlotPool
+    {
+        std::mutex mutex;
+        std::vector<uint32_t> free;
+    };
+
+    // retired into the deletion queue in place of the slot
+    struct SlotRelease
+    {
+        SlotRelease(std::shared_ptr<SlotPool> pool, uint32_t slot)
+            : pool(std::move(pool)), slot(slot)
+        {
+        }
+        SlotRelease(SlotRelease&&) = default;
+        ~SlotRelease();
+
+        std::shared_ptr<SlotPool> pool;
+        uint32_t slot;
+    };
+
+    struct GpuChunk
+    {
+        uint32_t slot;
+        uint64_t version;
+        // Update call the chunk was last visible in
+        uint64_t lastVisible;
+    };
+
+    vk::DescriptorSetLayout CreateDescriptorSetLayout();
+    vk::raii::DescriptorPool
+    CreateDescriptorPool(Device& device, size_t frameCount);
+    vk::raii::DescriptorSets
+    CreateDescriptorSets(Device& device, size_t frameCount);
+    void FillAtlas();
+    void WriteDescriptorSets(Device& device);
+    bool Upload(const TileChunk& chunk, GpuChunk& gpuChunk);
+    void Release(uint32_t slot, DeletionQueue& deletions);
+
+    LayoutCache& m_Layouts;
+    // two tile ids per element, TILES_PER_CHUNK ids per slot
+    Buffer<uint32_t> m_Tiles;
+    Buffer<uint32_t> m_Atlas;
+    // stay mapped for the lifetime of the renderer
+    std::vector<Buffer<ChunkInstance>> m_ChunkBuffers;
+    vk::DescriptorSetLayout m_DescriptorSetLayout;
+    vk::raii::DescriptorPool m_DescriptorPool;
+    vk::raii::DescriptorSets m_DescriptorSets;
+    vk::PipelineLayout m_PipelineLayout = nullptr;
+    vk::raii::Pipeline m_Pipeline = nullptr;
+
+    std::shared_ptr<SlotPool> m_SlotPool;
+    std::unordered_map<uint64_t, GpuChunk> m_GpuChunks;
+    uint64_t m_UpdateCount = 0;
+};
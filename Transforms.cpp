@@ -0,0 +1,72 @@
+#include "Transforms.hpp"
+#include "Simd.hpp"
+#include <cmath>
+
+static void WriteTransform(
+    const TransformArrays& transforms, size_t i, InstanceData& output)
+{
+    float sin = std::sin(transforms.rotations[i]);
+    float cos = std::cos(transforms.rotations[i]);
+    glm::vec2 scale = transforms.scales[i];
+    // same handedness the old rotation uniform had
+    output.basis = {cos * scale.x, -sin * scale.x, sin * scale.y, cos * scale.y};
+    output.translation = transforms.positions[i];
+    output.rotation = transforms.rotations[i];
+    output.padding = 0.0f;
+}
+
+void WriteTransformsScalar(
+    const TransformArrays& transforms, InstanceData* output)
+{
+    for (size_t i = 0; i < transforms.count; i++)
+    {
+        WriteTransform(transforms, i, output[i]);
+    }
+}
+
+void WriteTransforms(const TransformArrays& transforms, InstanceData* output)
+{
+    size_t i = 0;
+
+#if defined(SIMD_FLOAT4)
+    using namespace Simd;
+    for (; i + 4 <= transforms.count; i += 4)
+    {
+        Float4 rotation = Load(transforms.rotations + i);
+        Float4 sin, cos;
+        SinCos(rotation, sin, cos);
+
+        Float4 scaleX, scaleY, positionX, positionY;
+        LoadDeinterleaved(&transforms.scales[i].x, scaleX, scaleY);
+        LoadDeinterleaved(&transforms.positions[i].x, positionX, positionY);
+
+        // one vector per field across 4 instances, transposed to one vector
+        // per instance half
+        Float4 basis0 = Mul(cos, scaleX);
+        Float4 basis1 = Mul(Sub(Splat(0.0f), sin), scaleX);
+        Float4 basis2 = Mul(sin, scaleY);
+        Float4 basis3 = Mul(cos, scaleY);
+        Transpose(basis0, basis1, basis2, basis3);
+        Float4 padding = Splat(0.0f);
+        Transpose(positionX, positionY, rotation, padding);
+
+        float* destination = &output[i].basis.x;
+        Stream(destination, basis0);
+        Stream(destination + 4, positionX);
+        Stream(destination + 8, basis1);
+        Stream(destination + 12, positionY);
+        Stream(destination + 16, basis2);
+        Stream(destination + 20, rotation);
+        Stream(destination + 24, basis3);
+        Stream(destination + 28, padding);
+    }
+    // streaming stores are weakly ordered, they have to be visible before
+    // the submit that makes the gpu read them
+    StreamFence();
+#endif
+
+    for (; i < transforms.count; i++)
+    {
+        WriteTransform(transforms, i, output[i]);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+// one entry of the instance storage buffer, std430 layout matching Instance
+// in shader.vert. basis holds the two columns of rotation * scale
+struct alignas(16) InstanceData
+{
+    glm::vec4 basis;
+    glm::vec2 translation;
+    float rotation;
+    float padding;
+};
+static_assert(sizeof(InstanceData) == 32, "std430 layout of Instance");
+
+// separate arrays per field, the layout ECS chunks already hand out
+struct TransformArrays
+{
+    const glm::vec2* positions;
+    const float* rotations;
+    const glm::vec2* scales;
+    size_t count;
+};
+
+// computes instance data for a whole batch, 4 at a time with simd sincos,
+// and streams it to output with non-temporal stores so write combined gpu
+// memory is filled in full lines and the cache is left alone. output has to
+// be 16 byte aligned
+void WriteTransforms(const TransformArrays& transforms, InstanceData* output);
+// reference version with std::sin/std::cos and plain stores
+void WriteTransformsScalar(
+    const TransformArrays& transforms, InstanceData* output);
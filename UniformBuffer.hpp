@@ -1,9 +0,0 @@
-#pragma once
-#include "glm/mat2x4.hpp"
-#include "glm/mat3x4.hpp"
-
-struct UniformBufferObject
-{
-    glm::mat2x4 rotation;
-    float colorRotation;
-};
\ No newline at end of file
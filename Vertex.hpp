@@ -1,13 +1,21 @@
 #pragma once
 
-#include <glm/vec2.hpp>
-#include <glm/vec3.hpp>
+#include "VertexLayout.hpp"
 #include <vector>
 
+// 8 bytes, the same data as a vec2 and a vec3 in 20
 struct Vertex
 {
-    glm::vec2 pos;
-    glm::vec3 color;
+    Half2 pos;
+    Unorm8x4 color;
+};
+
+// matches the inputs of shader.vert
+template <> struct VertexLayout<Vertex>
+{
+    static constexpr std::array attributes = {
+        VERTEX_ATTRIBUTE(Vertex, pos, 0, Vec2),
+        VERTEX_ATTRIBUTE(Vertex, color, 1, Vec3)};
 };
 
 const std::vector<Vertex> vertices = {
@@ -0,0 +1,353 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <type_traits>
+#include <vulkan/vulkan_raii.hpp>
+
+// vertex input state generated from the vertex structs themselves. each
+// vertex type specializes VertexLayout with one VERTEX_ATTRIBUTE per member
+// the shader reads, format and offset come from the member, and the layout
+// is checked at compile time against the inputs the shader declares
+
+// ieee half precision, round to nearest even. constexpr so vertex tables can
+// be packed at compile time
+constexpr uint16_t FloatToHalf(float value)
+{
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t exponent = (bits >> 23) & 0xff;
+    uint32_t mantissa = bits & 0x7fffff;
+    if (exponent == 0xff)
+    {
+        // infinity stays infinity, nan stays a nan
+        return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    }
+
+    int32_t halfExponent = static_cast<int32_t>(exponent) - 127 + 15;
+    if (halfExponent >= 31)
+    {
+        return static_cast<uint16_t>(sign | 0x7c00);
+    }
+    if (halfExponent <= 0)
+    {
+        // subnormal, the implicit leading bit becomes explicit
+        if (halfExponent < -10)
+        {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        half += rest > halfway || (rest == halfway && (half & 1));
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = (static_cast<uint32_t>(halfExponent) << 10) |
+                    (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    // a carry out of the mantissa bumps the exponent, up to infinity
+    half += rest > 0x1000 || (rest == 0x1000 && (half & 1));
+    return static_cast<uint16_t>(sign | half);
+}
+
+constexpr float HalfToFloat(uint16_t half)
+{
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    if (exponent == 0x1f)
+    {
+        return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+    }
+    if (exponent == 0)
+    {
+        // zero or subnormal, mantissa * 2^-24 is exact in a float
+        float magnitude = static_cast<float>(mantissa) / 16777216.0f;
+        return sign ? -magnitude : magnitude;
+    }
+    return std::bit_cast<float>(
+        sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+constexpr uint8_t PackUnorm8(float value)
+{
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+constexpr int8_t PackSnorm8(float value)
+{
+    float scaled = std::clamp(value, -1.0f, 1.0f) * 127.0f;
+    return static_cast<int8_t>(scaled + (scaled < 0.0f ? -0.5f : 0.5f));
+}
+
+// 16 bit float positions, half the size of vec2. exact for small integers
+// and about 3 decimal digits otherwise, enough for meshes a few hundred
+// units across
+struct Half2
+{
+    uint16_t x = 0;
+    uint16_t y = 0;
+
+    constexpr Half2() = default;
+    constexpr Half2(float x, float y) : x(FloatToHalf(x)), y(FloatToHalf(y))
+    {
+    }
+    constexpr Half2(glm::vec2 value) : Half2(value.x, value.y) {}
+
+    glm::vec2 Unpack() const { return {HalfToFloat(x), HalfToFloat(y)}; }
+};
+
+struct Half4
+{
+    uint16_t x = 0;
+    uint16_t y = 0;
+    uint16_t z = 0;
+    uint16_t w = 0;
+
+    constexpr Half4() = default;
+    constexpr Half4(float x, float y, float z, float w)
+        : x(FloatToHalf(x)), y(FloatToHalf(y)), z(FloatToHalf(z)),
+          w(FloatToHalf(w))
+    {
+    }
+
+    glm::vec4 Unpack() const
+    {
+        return {
+            HalfToFloat(x), HalfToFloat(y), HalfToFloat(z), HalfToFloat(w)};
+    }
+};
+
+// 0..1 colors in a quarter of the space of a vec4, the shader reads floats
+struct Unorm8x4
+{
+    uint8_t r = 0;
+    uint8_t g = 0;
+    uint8_t b = 0;
+    uint8_t a = 0;
+
+    constexpr Unorm8x4() = default;
+    constexpr Unorm8x4(float r, float g, float b, float a = 1.0f)
+        : r(PackUnorm8(r)), g(PackUnorm8(g)), b(PackUnorm8(b)),
+          a(PackUnorm8(a))
+    {
+    }
+    constexpr Unorm8x4(glm::vec3 color) : Unorm8x4(color.x, color.y, color.z)
+    {
+    }
+
+    glm::vec4 Unpack() const
+    {
+        return {r / 255.0f, g / 255.0f, b / 255.0f, a / 255.0f};
+    }
+};
+
+// -1..1 directions such as normals, w is free for a tangent sign
+struct Snorm8x4
+{
+    int8_t x = 0;
+    int8_t y = 0;
+    int8_t z = 0;
+    int8_t w = 0;
+
+    constexpr Snorm8x4() = default;
+    constexpr Snorm8x4(float x, float y, float z, float w = 0.0f)
+        : x(PackSnorm8(x)), y(PackSnorm8(y)), z(PackSnorm8(z)),
+          w(PackSnorm8(w))
+    {
+    }
+    constexpr Snorm8x4(glm::vec3 normal)
+        : Snorm8x4(normal.x, normal.y, normal.z)
+    {
+    }
+
+    // -128 and -127 both decode to -1
+    glm::vec4 Unpack() const
+    {
+        return {
+            std::max(x / 127.0f, -1.0f), std::max(y / 127.0f, -1.0f),
+            std::max(z / 127.0f, -1.0f), std::max(w / 127.0f, -1.0f)};
+    }
+};
+
+// the glsl type of a vertex shader input, what the attribute's format is
+// read as
+enum class ShaderInput : uint32_t
+{
+    Float = 1,
+    Vec2 = 2,
+    Vec3 = 3,
+    Vec4 = 4,
+};
+
+// format of every type a vertex member can have, other types fail to
+// compile
+template <typename T> struct VertexFormat;
+
+#define VERTEX_FORMAT(Type, vkFormat, componentCount, bytesPerComponent)       \
+    template <> struct VertexFormat<Type>                                      \
+    {                                                                          \
+        static constexpr vk::Format format = vk::Format::vkFormat;             \
+        static constexpr uint32_t components = componentCount;                 \
+        static constexpr uint32_t componentSize = bytesPerComponent;           \
+        static_assert(sizeof(Type) == components * componentSize);             \
+    }
+
+VERTEX_FORMAT(float, eR32Sfloat, 1, 4);
+VERTEX_FORMAT(glm::vec2, eR32G32Sfloat, 2, 4);
+VERTEX_FORMAT(glm::vec3, eR32G32B32Sfloat, 3, 4);
+VERTEX_FORMAT(glm::vec4, eR32G32B32A32Sfloat, 4, 4);
+VERTEX_FORMAT(Half2, eR16G16Sfloat, 2, 2);
+VERTEX_FORMAT(Half4, eR16G16B16A16Sfloat, 4, 2);
+VERTEX_FORMAT(Unorm8x4, eR8G8B8A8Unorm, 4, 1);
+VERTEX_FORMAT(Snorm8x4, eR8G8B8A8Snorm, 4, 1);
+
+#undef VERTEX_FORMAT
+
+struct VertexAttribute
+{
+    uint32_t location;
+    ShaderInput input;
+    vk::Format format;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t components;
+    uint32_t componentSize;
+};
+
+template <typename T>
+constexpr VertexAttribute
+MakeVertexAttribute(uint32_t location, ShaderInput input, size_t offset)
+{
+    return {
+        location,
+        input,
+        VertexFormat<T>::format,
+        static_cast<uint32_t>(offset),
+        sizeof(T),
+        VertexFormat<T>::components,
+        VertexFormat<T>::componentSize};
+}
+
+// member of Vertex read by the shader as `layout(location = location) in
+// input`, e.g. VERTEX_ATTRIBUTE(Vertex, pos, 0, Vec2)
+#define VERTEX_ATTRIBUTE(Vertex, member, location, input)                      \
+    MakeVertexAttribute<decltype(Vertex::member)>(                             \
+        location, ShaderInput::input, offsetof(Vertex, member))
+
+// specialized next to every vertex type with
+//   static constexpr std::array attributes = {VERTEX_ATTRIBUTE(...), ...};
+template <typename Vertex> struct VertexLayout;
+
+namespace VertexLayoutRules
+{
+    template <size_t N>
+    constexpr bool
+    InsideVertex(const std::array<VertexAttribute, N>& attributes, size_t size)
+    {
+        return std::ranges::all_of(
+            attributes, [size](const VertexAttribute& attribute)
+            { return attribute.offset + attribute.size <= size; });
+    }
+
+    template <size_t N>
+    constexpr bool Aligned(const std::array<VertexAttribute, N>& attributes)
+    {
+        return std::ranges::all_of(
+            attributes, [](const VertexAttribute& attribute)
+            { return attribute.offset % attribute.componentSize == 0; });
+    }
+
+    template <size_t N>
+    constexpr bool Disjoint(const std::array<VertexAttribute, N>& attributes)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t j = i + 1; j < N; j++)
+            {
+                const VertexAttribute& a = attributes[i];
+                const VertexAttribute& b = attributes[j];
+                if (a.location == b.location ||
+                    (a.offset < b.offset + b.size &&
+                     b.offset < a.offset + a.size))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // a format with more components than the shader reads is fine, packed
+    // formats come in 4s. fewer would have vulkan fill in defaults, which
+    // is never what was meant
+    template <size_t N>
+    constexpr bool
+    CoversShader(const std::array<VertexAttribute, N>& attributes)
+    {
+        return std::ranges::all_of(
+            attributes, [](const VertexAttribute& attribute)
+            {
+                return attribute.components >=
+                       static_cast<uint32_t>(attribute.input);
+            });
+    }
+}
+
+// instantiated by the helpers below so every vertex type gets checked
+template <typename Vertex> struct VertexLayoutCheck
+{
+    static constexpr auto attributes = VertexLayout<Vertex>::attributes;
+
+    static_assert(
+        std::is_trivially_copyable_v<Vertex>, "vertices are copied as bytes");
+    static_assert(
+        std::is_standard_layout_v<Vertex>,
+        "attribute offsets need a standard layout vertex");
+    static_assert(
+        VertexLayoutRules::InsideVertex(attributes, sizeof(Vertex)),
+        "an attribute reads past the end of the vertex");
+    static_assert(
+        VertexLayoutRules::Aligned(attributes),
+        "attribute offsets have to be multiples of their component size");
+    static_assert(
+        VertexLayoutRules::Disjoint(attributes),
+        "two attributes share a location or overlap in the vertex");
+    static_assert(
+        VertexLayoutRules::CoversShader(attributes),
+        "a format has fewer components than its shader input");
+
+    static constexpr uint32_t stride = sizeof(Vertex);
+};
+
+template <typename Vertex>
+vk::VertexInputBindingDescription GetVertexBinding(uint32_t binding = 0)
+{
+    return vk::VertexInputBindingDescription(
+        binding, VertexLayoutCheck<Vertex>::stride,
+        vk::VertexInputRate::eVertex);
+}
+
+template <typename Vertex>
+auto GetVertexAttributes(uint32_t binding = 0)
+{
+    constexpr auto attributes = VertexLayoutCheck<Vertex>::attributes;
+    std::array<vk::VertexInputAttributeDescription, attributes.size()>
+        descriptions;
+    for (size_t i = 0; i < attributes.size(); i++)
+    {
+        descriptions[i] = vk::VertexInputAttributeDescription(
+            attributes[i].location, binding, attributes[i].format,
+            attributes[i].offset);
+    }
+    return descriptions;
+}
@@ -1,114 +1,748 @@
 #include "Video.hpp"
 #include "Buffer.hpp"
 #include "Log.hpp"
+#include "MeshSimplifier.hpp"
 #include "Pipeline.hpp"
-#include "UniformBuffer.hpp"
 #include "Vertex.hpp"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_video.h>
 #include <SDL2/SDL_vulkan.h>
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <fmt/format.h>
 #include <glm/common.hpp>
 #include <glm/mat2x2.hpp>
+#include <glm/trigonometric.hpp>
+#include <numeric>
+#include <optional>
 #include <span>
 #include <vulkan/vulkan_beta.h>
 
-Video::Video()
-    : m_Window(
-          "Untitled Game", {SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED},
-          {1200, 800}, SDL_WINDOW_SHOWN | SDL_WINDOW_VULKAN),
+namespace
+{
+    // the hard-coded vertices are a triangle list in order, indexed the same
+    // way a cooked mesh is so both draw through an index buffer
+    LodChain BuildMeshLods()
+    {
+        std::vector<uint32_t> indices(vertices.size());
+        std::iota(indices.begin(), indices.end(), 0u);
+        return BuildLodChain(vertices, indices);
+    }
+}
+
+Video::Video(JobSystem& jobs, const VideoConfig& config)
+    : m_StartTime(std::chrono::steady_clock::now()),
+      m_Window(
+          config.headless
+              ? Window(config.size)
+              : Window(
+                    "Untitled Game",
+                    {SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED},
+                    config.size,
+                    SDL_WINDOW_SHOWN | SDL_WINDOW_VULKAN |
+                        SDL_WINDOW_RESIZABLE)),
       m_Instance(m_Window, m_Context), m_Surface(m_Window, m_Instance),
-      m_Device(m_Instance, m_Surface), m_Swapchain(m_Device, m_Surface),
+      m_Device(m_Instance, m_Surface),
+      m_Swapchain(
+          m_Device, m_Surface,
+          config.vsync ? vk::PresentModeKHR::eFifo
+                       : vk::PresentModeKHR::eMailbox),
       m_Queue(m_Device.Get(), m_QueueFamilyIndex, 0),
-      m_RenderPass(m_Device, m_Surface),
+      m_FrameSerials(MAX_FRAMES_IN_FLIGHT, 0),
+      m_BlitSupported(IsBlitSupported()),
+      m_DynamicResolution(
+          m_BlitSupported ? DynamicResolutionConfig{}
+                          : DynamicResolutionConfig{.enabled = false}),
+      m_DepthBuffer(
+          m_Device,
+          m_DynamicResolution.GetAllocationExtent(m_Swapchain.GetExtent())),
+      m_RenderPass(m_Device, m_Surface, m_DepthBuffer.GetFormat()),
+      m_Mesh(BuildMeshLods()),
       m_VertexBuffer(
           m_Device, vertices.size(), vk::BufferUsageFlagBits::eVertexBuffer),
-      m_UniformBuffers(std::move(ConstructUniformBuffers())),
-      m_Framebuffers(m_Swapchain, m_RenderPass, m_Device),
-      m_CommandBuffers(
-          m_Device, m_QueueFamilyIndex, m_Swapchain.GetImageCount()),
+      m_IndexBuffer(
+          m_Device, m_Mesh.indices.size(),
+          vk::BufferUsageFlagBits::eIndexBuffer),
+      m_InstanceBuffers(ConstructInstanceBuffers()),
+      m_CommandCache(m_Device, m_QueueFamilyIndex, MAX_FRAMES_IN_FLIGHT),
       m_SyncObjects(m_Device),
-      m_Descriptors(m_Device, m_UniformBuffers, m_Swapchain.GetImageCount()),
-      m_Pipeline(m_Device, m_RenderPass, m_Surface, m_Descriptors)
+      m_LayoutCache(m_Device),
+      m_Descriptors(
+          m_Device, m_LayoutCache, m_InstanceBuffers, MAX_FRAMES_IN_FLIGHT),
+      m_Hud(
+          m_Device, m_LayoutCache, m_Surface.surfaceFormat.format,
+          MAX_FRAMES_IN_FLIGHT),
+      m_TilemapRenderer(m_Device, m_LayoutCache, MAX_FRAMES_IN_FLIGHT),
+      m_Readback(m_Surface),
+      m_GpuTimer(m_Device, m_QueueFamilyIndex, MAX_FRAMES_IN_FLIGHT),
+      m_LastFrameTime(std::chrono::steady_clock::now()),
+      m_Startup(jobs, m_StartTime)
 {
+    m_Startup.MarkPhase("window, device and swapchain");
+    StartLoading();
+
+    if (!m_GpuTimer.IsSupported())
+    {
+        LogWarning(
+            IsVsyncBound()
+                ? "Dynamic resolution is held at its scale, no timestamps to "
+                  "measure gpu time with and the cpu is paced by vblank"
+                : "Dynamic resolution follows the cpu frame time, no "
+                  "timestamps to measure gpu time with");
+    }
+
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        m_FrameArenas.push_back(
+            std::make_unique<LinearArena>(FRAME_ARENA_BYTES));
+    }
+
     // buffers
     FillVertexBuffer();
+    SetViewRotation(0.0f);
+    BuildRenderGraph();
+    m_Startup.MarkPhase("render graph");
 }
 Video::~Video()
 {
+    m_Startup.Cancel();
     m_Device.Get().waitIdle();
     m_Queue.waitIdle();
 }
 
 void Video::Render()
 {
+    if (m_SwapchainDirty && !RecreateSwapchain())
+    {
+        EndFrame();
+        return;
+    }
+
     vk::raii::Device& device = m_Device.Get();
-    device.waitForFences(
-        *m_SyncObjects.inFlightFences.at(m_CurrentImage), VK_TRUE,
-        std::numeric_limits<uint64_t>::max());
+    WaitForFrame();
+
+    UpdateFrameTiming();
+    UpdateStartup();
+
+    try
+    {
+        auto [result, imageIndex] = m_Swapchain.Get().acquireNextImage(
+            std::numeric_limits<uint64_t>::max(),
+            *m_SyncObjects.imageAvailableSemaphores.at(m_CurrentFrame));
+        m_ImageIndex = imageIndex;
+        if (result == vk::Result::eSuboptimalKHR)
+        {
+            m_SwapchainDirty = true;
+        }
+    }
+    catch (vk::OutOfDateKHRError&)
+    {
+        m_SwapchainDirty = true;
+        EndFrame();
+        return;
+    }
+    // only reset once we know something will be submitted, otherwise the next
+    // wait on this fence would never return
+    device.resetFences(*m_SyncObjects.inFlightFences.at(m_CurrentFrame));
+
+    m_RenderGraph.SetImportedImage(
+        m_Backbuffer, m_Swapchain.GetImages().at(m_ImageIndex),
+        *m_Swapchain.GetImageViews().at(m_ImageIndex));
+
+    // any fence or acquire wait is behind us, what the latch writes is
+    // recorded and submitted straight after
+    std::chrono::steady_clock::time_point inputTime;
+    if (m_LateLatch)
+    {
+        inputTime = m_LateLatch();
+    }
+
+    m_RenderQueue.Sort();
+    m_FrameStats.drawCount = static_cast<uint32_t>(m_RenderQueue.size());
+    if (m_Instance.GetValidationConfig().enabled)
+    {
+        m_FrameStats.performanceWarnings =
+            m_Instance.GetPerformanceWarnings().total;
+    }
+    m_Hud.Update(m_FrameStats, m_CurrentFrame);
+    UpdateRecordState();
+
+    // instances and hud quads were written to mapped buffers above, so an
+    // unchanged frame only needs its command buffer submitted again
+    vk::raii::CommandBuffer& commandBuffer =
+        m_CommandCache.Get(m_CurrentFrame, m_ImageIndex);
+    bool readback = m_Readback.HasRequests();
+    m_FrameStats.commandsRecorded =
+        readback || !m_CommandCache.IsRecorded(m_CurrentFrame, m_ImageIndex);
+    if (m_FrameStats.commandsRecorded)
+    {
+        RecordFrame(commandBuffer);
+        // the copy is for this frame alone
+        if (readback)
+        {
+            m_CommandCache.MarkStale(m_CurrentFrame, m_ImageIndex);
+        }
+        else
+        {
+            m_CommandCache.MarkRecorded(m_CurrentFrame, m_ImageIndex);
+        }
+    }
+
+    vk::PipelineStageFlags waitFlags =
+        vk::PipelineStageFlagBits::eColorAttachmentOutput;
+    vk::SubmitInfo submitInfo(
+        *m_SyncObjects.imageAvailableSemaphores.at(m_CurrentFrame), waitFlags,
+        *commandBuffer,
+        *m_SyncObjects.renderFinishedSemaphores.at(m_CurrentFrame));
+    m_Queue.submit(
+        submitInfo, *m_SyncObjects.inFlightFences.at(m_CurrentFrame));
+    m_FrameSerials.at(m_CurrentFrame) = m_Deletions.MarkSubmitted();
+    m_GpuTimer.MarkSubmitted(m_CurrentFrame);
 
-    device.resetFences(*m_SyncObjects.inFlightFences.at(m_CurrentImage));
-    auto [result, imageIndex] = m_Swapchain.Get().acquireNextImage(
-        std::numeric_limits<uint64_t>::max(),
-        *m_SyncObjects.imageAvailableSemaphores.at(m_CurrentImage));
+    vk::PresentInfoKHR presentInfo(
+        *m_SyncObjects.renderFinishedSemaphores.at(m_CurrentFrame),
+        *m_Swapchain.Get(), m_ImageIndex);
+    try
+    {
+        vk::Result presentResult = m_Queue.presentKHR(presentInfo);
+        if (presentResult == vk::Result::eSuboptimalKHR)
+        {
+            m_SwapchainDirty = true;
+        }
+    }
+    catch (vk::OutOfDateKHRError&)
+    {
+        m_SwapchainDirty = true;
+    }
+    // up to the present being queued, scanout comes later still and is not
+    // visible without present timing extensions
+    if (inputTime != std::chrono::steady_clock::time_point())
+    {
+        m_FrameStats.inputLatencyMs = std::chrono::duration<float, std::milli>(
+                                          std::chrono::steady_clock::now() -
+                                          inputTime)
+                                          .count();
+    }
 
-    vk::raii::CommandBuffer& commandBuffer = m_CommandBuffers[m_CurrentImage];
+    EndFrame();
+    m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
 
+    if (!m_FirstFrameMarked)
+    {
+        m_Startup.MarkPhase("first frame");
+        m_FirstFrameMarked = true;
+    }
+    if (m_PipelineReady && !m_StartupReported)
+    {
+        m_Startup.MarkPhase("first complete frame");
+        m_Startup.Report();
+        m_StartupReported = true;
+    }
+}
+
+void Video::RecordFrame(vk::raii::CommandBuffer& commandBuffer)
+{
+    // the frame's fence has signalled, so the buffer is not pending
     commandBuffer.reset();
+    commandBuffer.begin({});
+    m_GpuTimer.Reset(commandBuffer, m_CurrentFrame);
+    m_RenderGraph.Execute(commandBuffer, &GetFrameArena());
+    m_GpuTimer.End(commandBuffer, m_CurrentFrame);
+    commandBuffer.end();
+}
+
+void Video::UpdateRecordState()
+{
+    RecordState state{
+        m_PipelineReady, m_RenderExtent, m_DrawConstants,
+        m_Hud.GetQuadCount(), m_TilemapChunks};
+    std::span<const DrawItem> items = m_RenderQueue.GetItems();
+    if (state == m_RecordState &&
+        std::equal(
+            items.begin(), items.end(), m_RecordedItems.begin(),
+            m_RecordedItems.end()))
+    {
+        return;
+    }
+    m_RecordState = state;
+    m_RecordedItems.assign(items.begin(), items.end());
+    m_CommandCache.Invalidate();
+}
+
+void Video::StartLoading()
+{
+    // asset pack -> shader modules -> pipeline, anything else read from the
+    // pack can hang off the asset pack step and run next to the shaders
+    InitGraph::StepId assets = m_Startup.Add(
+        "asset pack", {},
+        [this]()
+        {
+            m_Assets = std::make_unique<AssetPack>(AssetPack::GetDefaultPath());
+            m_Assets->Prefetch();
+        });
+    InitGraph::StepId shaders = m_Startup.Add(
+        "shaders", {assets},
+        [this]() { m_LoadedShaders = LoadShaders(m_Device.Get(), *m_Assets); });
+    m_PipelineStep = m_Startup.Add(
+        "pipeline", {shaders},
+        [this]()
+        {
+            // the pack holds every shader, each pipeline takes its own
+            m_Hud.CreatePipeline(m_Device, TakeShader(m_LoadedShaders, "hud"));
+            m_TilemapRenderer.CreatePipeline(
+                m_Device, m_RenderPass, TakeShader(m_LoadedShaders, "tilemap"));
+            // optional, the renderer has placeholder tiles of its own
+            const PackEntry* atlas = m_Assets->Find("tiles");
+            if (atlas && atlas->type == AssetType::Image)
+            {
+                m_TilemapRenderer.LoadAtlas(m_Assets->GetImage(*atlas));
+            }
+            std::vector<Shader> sceneShaders;
+            sceneShaders.push_back(TakeShader(m_LoadedShaders, "shader"));
+            m_Pipeline = std::make_unique<GraphicsPipeline>(
+                m_Device, m_LayoutCache, m_RenderPass, m_Descriptors,
+                std::move(sceneShaders));
+        });
+    m_Startup.Start();
+}
+
+void Video::WaitForStartup()
+{
+    m_Startup.Wait();
+    m_PipelineReady = m_Startup.IsDone(m_PipelineStep);
+}
+
+void Video::StartCapture(const std::filesystem::path& path, uint32_t frameCount)
+{
+    if (m_Capture)
+    {
+        LogWarning("Already capturing");
+        return;
+    }
+    m_Capture = std::make_unique<CaptureWriter>(
+        path, m_Swapchain.GetExtent(), frameCount);
+}
+
+void Video::FlushReadbacks()
+{
+    m_Device.Get().waitIdle();
+    for (size_t frame = 0; frame < MAX_FRAMES_IN_FLIGHT; frame++)
+    {
+        m_Readback.OnFrameComplete(frame);
+    }
+    m_Readback.Wait();
+}
+
+void Video::UpdateStartup()
+{
+    // errors from the loading steps surface here, on the main thread
+    m_Startup.Poll();
+    // latched once per frame so a frame is recorded entirely with or
+    // entirely without the scene
+    m_PipelineReady = m_PipelineReady || m_Startup.IsDone(m_PipelineStep);
+}
+
+void Video::WaitForFrame()
+{
+    if (m_FrameReady)
+    {
+        return;
+    }
+    m_Device.Get().waitForFences(
+        *m_SyncObjects.inFlightFences.at(m_CurrentFrame), VK_TRUE,
+        std::numeric_limits<uint64_t>::max());
+    m_FrameArenas.at(m_CurrentFrame)->Reset();
+    // no extra wait, copies recorded into this frame are done by now
+    m_Readback.OnFrameComplete(m_CurrentFrame);
+    // one queue, so every submission up to this frame's has completed too
+    m_Deletions.Collect(m_FrameSerials.at(m_CurrentFrame));
+    m_FrameReady = true;
+}
+
+std::pmr::memory_resource& Video::GetFrameArena()
+{
+    WaitForFrame();
+    return *m_FrameArenas.at(m_CurrentFrame);
+}
+
+void Video::EndFrame()
+{
+    // every frame ends here, including the ones that never got presented,
+    // so the capture sees exactly what the game submitted
+    if (m_Capture)
+    {
+        m_Capture->Draw(m_RenderQueue.GetItems());
+        if (m_Capture->EndFrame())
+        {
+            m_Capture.reset();
+        }
+    }
+    m_RenderQueue.Clear();
+    m_InstanceCount = 0;
+    m_TilemapChunks = 0;
+    m_FrameReady = false;
+
+    // everything since the previous frame ended, game update included
+    AllocationCounters allocations = GetAllocationCounters();
+    m_FrameStats.heapAllocations =
+        allocations.allocations - m_FrameStartAllocations.allocations;
+    m_FrameStats.heapBytes = allocations.bytes - m_FrameStartAllocations.bytes;
+    m_FrameStats.frameArenaBytes = m_FrameArenas.at(m_CurrentFrame)->GetUsed();
+    m_FrameStartAllocations = allocations;
+
+    if (m_Hud.IsVisible())
+    {
+        std::optional<DeviceMemoryUsage> deviceMemory =
+            m_Device.GetDeviceLocalMemoryUsage();
+        m_FrameStats.deviceMemoryBytes =
+            deviceMemory ? deviceMemory->usedBytes : 0;
+        m_FrameStats.deviceMemoryBudget =
+            deviceMemory ? deviceMemory->budgetBytes : 0;
+        m_FrameStats.residentBytes = GetResidentBytes();
+    }
+}
+
+bool Video::RecreateSwapchain()
+{
+    m_Surface.GetSurfaceCapabilities(m_Device);
+    vk::Extent2D extent = m_Surface.surfaceCapabilities.currentExtent;
+    if (extent.width == 0 || extent.height == 0)
+    {
+        // minimized, try again next frame
+        return false;
+    }
+
+    // no wait for the frames in flight, everything they still use is
+    // retired and goes once they have completed
+    m_Swapchain.Recreate(m_Device, m_Surface, m_Deletions);
+    m_DepthBuffer.Recreate(
+        m_Device,
+        m_DynamicResolution.GetAllocationExtent(m_Swapchain.GetExtent()),
+        m_Deletions);
+    m_RenderGraph.Reset(m_Deletions);
+    BuildRenderGraph();
+
+    LogDebug(fmt::format("Swapchain recreated: {}", m_Swapchain.GetExtent()));
+    m_SwapchainDirty = false;
+    return true;
+}
+
+void Video::SetDynamicResolution(const DynamicResolutionConfig& config)
+{
+    DynamicResolutionConfig newConfig = config;
+    if (!m_BlitSupported)
+    {
+        LogWarning("Surface format cant be blitted, dynamic resolution is off");
+        newConfig.enabled = false;
+        newConfig.maxScale = 1.0f;
+    }
+    m_DynamicResolution.SetConfig(newConfig);
+    // the offscreen target is sized for the max scale
+    m_SwapchainDirty = true;
+}
+
+bool Video::IsVsyncBound() const
+{
+    vk::PresentModeKHR presentMode = m_Swapchain.GetPresentMode();
+    return presentMode == vk::PresentModeKHR::eFifo ||
+           presentMode == vk::PresentModeKHR::eFifoRelaxed;
+}
+
+bool Video::IsBlitSupported()
+{
+    vk::FormatProperties properties =
+        m_Device.GetPhysicalDevice().getFormatProperties(
+            m_Surface.surfaceFormat.format);
+    vk::FormatFeatureFlags required =
+        vk::FormatFeatureFlagBits::eBlitSrc |
+        vk::FormatFeatureFlagBits::eBlitDst |
+        vk::FormatFeatureFlagBits::eSampledImageFilterLinear;
+    return (properties.optimalTilingFeatures & required) == required;
+}
+
+void Video::UpdateFrameTiming()
+{
+    auto now = std::chrono::steady_clock::now();
+    m_FrameStats.cpuFrameTimeMs =
+        std::chrono::duration<float, std::milli>(now - m_LastFrameTime).count();
+    m_LastFrameTime = now;
+    m_FrameStats.frame++;
+
+    // the controller follows gpu time. cpu frame time is pinned to vblank
+    // with fifo presentation and says nothing about gpu load, it only
+    // stands in for gpu time when there are no timestamps and nothing
+    // waits for vblank
+    std::optional<float> gpuTime = m_GpuTimer.Resolve(m_CurrentFrame);
+    if (gpuTime)
+    {
+        m_FrameStats.gpuTimeMs = *gpuTime;
+        m_DynamicResolution.Update(*gpuTime);
+    }
+    else if (!m_GpuTimer.IsSupported() && !IsVsyncBound())
+    {
+        m_FrameStats.gpuTimeMs = m_FrameStats.cpuFrameTimeMs;
+        m_DynamicResolution.Update(m_FrameStats.cpuFrameTimeMs);
+    }
+
+    m_RenderExtent =
+        m_DynamicResolution.GetRenderExtent(m_Swapchain.GetExtent());
+    m_FrameStats.renderScale = m_DynamicResolution.GetScale();
+    m_FrameStats.renderExtent = m_RenderExtent;
+}
+
+void Video::BuildRenderGraph()
+{
+    vk::Extent2D allocationExtent =
+        m_DynamicResolution.GetAllocationExtent(m_Swapchain.GetExtent());
+
+    m_Backbuffer = m_RenderGraph.ImportImage(
+        "backbuffer", m_Surface.surfaceFormat.format, m_Swapchain.GetExtent(),
+        vk::ImageLayout::ePresentSrcKHR);
+    m_SceneColor = m_RenderGraph.CreateImage(
+        "scene color", m_Surface.surfaceFormat.format, allocationExtent);
+
+    m_RenderGraph.AddPass(
+        "scene",
+        [&](RenderGraph::PassBuilder& builder)
+        { builder.Write(m_SceneColor, ResourceUsage::ColorAttachment); },
+        [&](vk::raii::CommandBuffer& commandBuffer)
+        { RecordScenePass(commandBuffer); });
+
+    m_RenderGraph.AddPass(
+        "upscale",
+        [&](RenderGraph::PassBuilder& builder)
+        {
+            builder.Read(m_SceneColor, ResourceUsage::TransferSrc);
+            builder.Write(m_Backbuffer, ResourceUsage::TransferDst);
+        },
+        [&](vk::raii::CommandBuffer& commandBuffer)
+        { RecordUpscalePass(commandBuffer); });
+
+    // kept while the hud is hidden so toggling it never rebuilds the graph,
+    // all it costs then is the backbuffer transition. it draws over the
+    // upscaled frame with a load op, so it reads the backbuffer as well, a
+    // write alone would tell the graph the upscale is overwritten unseen
+    m_RenderGraph.AddPass(
+        "hud",
+        [&](RenderGraph::PassBuilder& builder)
+        {
+            builder.Read(m_Backbuffer, ResourceUsage::ColorAttachment);
+            builder.Write(m_Backbuffer, ResourceUsage::ColorAttachment);
+        },
+        [&](vk::raii::CommandBuffer& commandBuffer)
+        { RecordHudPass(commandBuffer); });
+
+    // always there when supported, like the hud, so a request never has to
+    // rebuild the graph. with nothing requested it only adds a transition
+    if (m_Readback.IsSupported())
+    {
+        m_RenderGraph.AddPass(
+            "readback",
+            [&](RenderGraph::PassBuilder& builder)
+            {
+                builder.Read(m_Backbuffer, ResourceUsage::TransferSrc);
+                builder.SetSideEffect();
+            },
+            [&](vk::raii::CommandBuffer& commandBuffer)
+            { RecordReadbackPass(commandBuffer); });
+    }
+
+    m_RenderGraph.Compile(m_Device);
+
+    std::array<vk::ImageView, 1> sceneViews = {
+        m_RenderGraph.GetImageView(m_SceneColor)};
+    m_Framebuffers.Recreate(
+        sceneViews, m_RenderPass, m_DepthBuffer, allocationExtent, m_Device,
+        m_Deletions);
+
+    std::vector<vk::ImageView> swapchainViews;
+    for (vk::raii::ImageView& imageView : m_Swapchain.GetImageViews())
+    {
+        swapchainViews.push_back(*imageView);
+    }
+    m_Hud.Recreate(
+        m_Device, swapchainViews, m_Swapchain.GetExtent(), m_Deletions);
+    // recordings reference the graph's images and the framebuffers
+    m_CommandCache.Resize(m_Device, swapchainViews.size());
+
+    m_RenderExtent =
+        m_DynamicResolution.GetRenderExtent(m_Swapchain.GetExtent());
+}
 
-    vk::ClearColorValue clearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    vk::ClearValue clearValue(clearColor);
+void Video::RecordUpscalePass(vk::raii::CommandBuffer& commandBuffer)
+{
+    vk::Extent2D outputExtent = m_Swapchain.GetExtent();
+    vk::ImageSubresourceLayers subresource(
+        vk::ImageAspectFlagBits::eColor, 0, 0, 1);
+
+    if (!m_BlitSupported)
+    {
+        // scale is pinned to 1 in this case so a straight copy is enough
+        vk::ImageCopy region(
+            subresource, {}, subresource, {}, vk::Extent3D(outputExtent, 1));
+        commandBuffer.copyImage(
+            m_RenderGraph.GetImage(m_SceneColor),
+            vk::ImageLayout::eTransferSrcOptimal,
+            m_RenderGraph.GetImage(m_Backbuffer),
+            vk::ImageLayout::eTransferDstOptimal, region);
+        return;
+    }
+
+    std::array<vk::Offset3D, 2> srcOffsets = {
+        vk::Offset3D(0, 0, 0),
+        vk::Offset3D(
+            static_cast<int32_t>(m_RenderExtent.width),
+            static_cast<int32_t>(m_RenderExtent.height), 1)};
+    std::array<vk::Offset3D, 2> dstOffsets = {
+        vk::Offset3D(0, 0, 0),
+        vk::Offset3D(
+            static_cast<int32_t>(outputExtent.width),
+            static_cast<int32_t>(outputExtent.height), 1)};
+    vk::ImageBlit region(subresource, srcOffsets, subresource, dstOffsets);
+
+    commandBuffer.blitImage(
+        m_RenderGraph.GetImage(m_SceneColor),
+        vk::ImageLayout::eTransferSrcOptimal,
+        m_RenderGraph.GetImage(m_Backbuffer),
+        vk::ImageLayout::eTransferDstOptimal, region, vk::Filter::eLinear);
+}
+
+void Video::RecordHudPass(vk::raii::CommandBuffer& commandBuffer)
+{
+    // the hud pipeline is built by the same startup step as the scene's
+    if (m_PipelineReady)
+    {
+        m_Hud.Record(commandBuffer, m_CurrentFrame, m_ImageIndex);
+    }
+}
+
+void Video::RecordReadbackPass(vk::raii::CommandBuffer& commandBuffer)
+{
+    m_Readback.Record(
+        m_Device, commandBuffer, m_RenderGraph.GetImage(m_Backbuffer),
+        m_Swapchain.GetExtent(), m_CurrentFrame);
+}
+
+void Video::RecordScenePass(vk::raii::CommandBuffer& commandBuffer)
+{
+    // the scene is the graph's first pass, its barriers are recorded by now
+    m_GpuTimer.Begin(commandBuffer, m_CurrentFrame);
+
+    vk::Extent2D extent = m_RenderExtent;
+
+    std::array<vk::ClearValue, 2> clearValues = {
+        vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f),
+        vk::ClearDepthStencilValue(1.0f, 0)};
 
     vk::RenderPassBeginInfo renderPassBeginInfo(
-        *m_RenderPass.Get(), *m_Framebuffers[m_CurrentImage],
-        vk::Rect2D({}, m_Surface.surfaceCapabilities.currentExtent),
-        clearValue);
+        *m_RenderPass.Get(), *m_Framebuffers[0],
+        vk::Rect2D({}, extent), clearValues);
 
-    commandBuffer.begin({vk::CommandBufferUsageFlagBits::eSimultaneousUse});
     commandBuffer.beginRenderPass(
         renderPassBeginInfo, vk::SubpassContents::eInline);
+    if (!m_PipelineReady)
+    {
+        // still loading, the cleared frame is presented so the window is up
+        // straight away
+        commandBuffer.endRenderPass();
+        return;
+    }
+    commandBuffer.setViewport(
+        0, vk::Viewport(
+               0.0f, 0.0f, static_cast<float>(extent.width),
+               static_cast<float>(extent.height), 0.0f, 1.0f));
+    commandBuffer.setScissor(0, vk::Rect2D({}, extent));
+
+    m_TilemapRenderer.Record(
+        commandBuffer, m_CurrentFrame, m_TilemapChunks, m_DrawConstants);
+
     commandBuffer.bindPipeline(
-        vk::PipelineBindPoint::eGraphics, *m_Pipeline.Get());
+        vk::PipelineBindPoint::eGraphics, *m_Pipeline->Get());
 
     vk::DeviceSize offset = 0;
 
     commandBuffer.bindVertexBuffers(0, *m_VertexBuffer.Get(), offset);
+    commandBuffer.bindIndexBuffer(
+        *m_IndexBuffer.Get(), 0, vk::IndexType::eUint32);
 
     commandBuffer.bindDescriptorSets(
-        vk::PipelineBindPoint::eGraphics, *m_Pipeline.GetLayout(), 0,
-        *m_Descriptors.GetSets().at(m_CurrentImage), nullptr);
+        vk::PipelineBindPoint::eGraphics, m_Pipeline->GetLayout(), 0,
+        *m_Descriptors.GetSets().at(m_CurrentFrame), nullptr);
+    PushConstants(
+        commandBuffer, m_Pipeline->GetLayout(),
+        vk::ShaderStageFlagBits::eVertex, m_DrawConstants);
 
-    commandBuffer.draw(static_cast<uint32_t>(vertices.size()), 1, 0, 0);
+    // sorted by key, so opaque draws arrive front to back
+    for (const DrawItem& item : m_RenderQueue.GetItems())
+    {
+        commandBuffer.drawIndexed(
+            item.indexCount, item.instanceCount, item.firstIndex, 0,
+            item.firstInstance);
+    }
     commandBuffer.endRenderPass();
-    commandBuffer.end();
+}
 
-    vk::PipelineStageFlags waitFlags =
-        vk::PipelineStageFlagBits::eColorAttachmentOutput;
-    vk::SubmitInfo submitInfo(
-        *m_SyncObjects.imageAvailableSemaphores.at(m_CurrentImage), waitFlags,
-        *commandBuffer,
-        *m_SyncObjects.renderFinishedSemaphores.at(m_CurrentImage));
-    m_Queue.submit(
-        submitInfo, *m_SyncObjects.inFlightFences.at(m_CurrentImage));
+void Video::SetViewRotation(float theta)
+{
+    float radians = glm::radians(theta);
+    float sin = std::sin(radians);
+    float cos = std::cos(radians);
 
-    vk::PresentInfoKHR presentInfo(
-        *m_SyncObjects.renderFinishedSemaphores.at(m_CurrentImage),
-        *m_Swapchain.Get(), m_CurrentImage);
-    vk::Result presentResult = m_Queue.presentKHR(presentInfo);
+    // only kept on the cpu, it reaches the gpu as push constants while
+    // recording
+    m_DrawConstants.rotation[0] = {cos, -sin};
+    m_DrawConstants.rotation[1] = {sin, cos};
+    m_DrawConstants.colorRotation = theta;
 
-    m_CurrentImage = (m_CurrentImage + 1) % m_Swapchain.GetImageCount();
+    if (m_Capture)
+    {
+        m_Capture->SetViewRotation(theta);
+    }
 }
 
-void Video::UpdateUnformBuffers(float theta)
+uint32_t Video::WriteInstances(const TransformArrays& transforms)
 {
-    UniformBufferObject& buffer =
-        m_UniformBuffers.at(m_CurrentImage).GetMemory().front();
-    buffer.rotation[0].x = cos(theta * M_PI / 180);
-    buffer.rotation[0].y = -sin(theta * M_PI / 180);
-    buffer.rotation[1].x = sin(theta * M_PI / 180);
-    buffer.rotation[1].y = cos(theta * M_PI / 180);
-    buffer.colorRotation = theta;
+    WaitForFrame();
+    if (m_Capture)
+    {
+        m_Capture->WriteInstances(transforms);
+    }
+    uint32_t firstInstance = m_InstanceCount;
+    size_t count = transforms.count;
+    if (firstInstance + count > MAX_INSTANCES)
+    {
+        LogWarning(fmt::format(
+            "Instance buffer full, dropping {} instances",
+            firstInstance + count - MAX_INSTANCES));
+        count = MAX_INSTANCES - firstInstance;
+    }
+
+    TransformArrays batch = transforms;
+    batch.count = count;
+    WriteTransforms(
+        batch, m_InstanceBuffers.at(m_CurrentFrame).GetMemory().data() +
+                   firstInstance);
+    m_InstanceCount += static_cast<uint32_t>(count);
+    return firstInstance;
+}
+
+void Video::DrawTilemap(const Tilemap& tilemap, const Aabb& view)
+{
+    m_VisibleChunks.clear();
+    tilemap.GetVisible(view, m_VisibleChunks);
+    DrawTileChunks(m_VisibleChunks);
+}
+
+void Video::DrawTileChunks(std::span<const TileChunk* const> chunks)
+{
+    WaitForFrame();
+    if (m_Capture)
+    {
+        m_Capture->DrawTileChunks(chunks);
+    }
+    m_TilemapChunks =
+        m_TilemapRenderer.Update(chunks, m_CurrentFrame, m_Deletions);
 }
 
 void Video::FillVertexBuffer()
@@ -116,16 +750,20 @@ void Video::FillVertexBuffer()
     // load hard-coded vertices into memory
     std::span<Vertex> memorySpan = m_VertexBuffer.GetMemory();
     std::copy_n(vertices.begin(), vertices.size(), memorySpan.begin());
+    std::span<uint32_t> indexSpan = m_IndexBuffer.GetMemory();
+    std::copy(m_Mesh.indices.begin(), m_Mesh.indices.end(), indexSpan.begin());
 }
 
-std::vector<Buffer<UniformBufferObject>> Video::ConstructUniformBuffers()
+std::vector<Buffer<InstanceData>> Video::ConstructInstanceBuffers()
 {
-    std::vector<Buffer<UniformBufferObject>> uniformBuffers;
-    for (size_t i = 0; i < m_Swapchain.GetImageCount(); i++)
+    std::vector<Buffer<InstanceData>> instanceBuffers;
+    instanceBuffers.reserve(MAX_FRAMES_IN_FLIGHT);
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
     {
-        uniformBuffers.emplace_back(
-            m_Device, 1, vk::BufferUsageFlagBits::eUniformBuffer);
+        instanceBuffers.emplace_back(
+            m_Device, MAX_INSTANCES, vk::BufferUsageFlagBits::eStorageBuffer);
+        // mapped once up front and left mapped
+        instanceBuffers.back().GetMemory();
     }
-
-    return uniformBuffers;
+    return instanceBuffers;
 }
\ No newline at end of file
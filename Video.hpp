@@ -1,36 +1,169 @@
 #pragma once
 
+#include "Allocators.hpp"
+#include "AssetPack.hpp"
 #include "Buffer.hpp"
-#include "CommandBuffer.hpp"
+#include "CommandCache.hpp"
+#include "DeletionQueue.hpp"
+#include "DepthBuffer.hpp"
 #include "Descriptors.hpp"
 #include "Device.hpp"
+#include "DynamicResolution.hpp"
+#include "FrameStats.hpp"
+#include "FrameCapture.hpp"
+#include "FrameReadback.hpp"
 #include "Framebuffers.hpp"
+#include "GpuTimer.hpp"
+#include "Hud.hpp"
+#include "InitGraph.hpp"
 #include "Instance.hpp"
+#include "JobSystem.hpp"
+#include "LayoutCache.hpp"
+#include "MeshSimplifier.hpp"
 #include "Pipeline.hpp"
+#include "PushConstants.hpp"
+#include "RenderGraph.hpp"
 #include "RenderPass.hpp"
+#include "RenderQueue.hpp"
 #include "Shader.hpp"
 #include "Surface.hpp"
 #include "Swapchain.hpp"
 #include "SyncObjects.hpp"
-#include "UniformBuffer.hpp"
+#include "Tilemap.hpp"
+#include "TilemapRenderer.hpp"
+#include "Transforms.hpp"
 #include "Vertex.hpp"
 #include "Window.hpp"
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <span>
 #include <vector>
 #include <vulkan/vulkan_raii.hpp>
 
+// capacity of each frame's instance buffer
+constexpr uint32_t MAX_INSTANCES = 16 * 1024;
+// scratch memory per frame in flight, see Video::GetFrameArena
+constexpr size_t FRAME_ARENA_BYTES = 1024 * 1024;
+
+struct VideoConfig
+{
+    glm::i32vec2 size{1200, 800};
+    // renders through VK_EXT_headless_surface without creating a window
+    bool headless = false;
+    // fifo when set, otherwise mailbox so frames are not held to vblank
+    bool vsync = true;
+};
+
 class Video
 {
 public:
-    Video();
+    // only the window, device and swapchain are created up front, assets
+    // and pipelines load on the job system while the first frames are
+    // already being presented
+    Video(JobSystem& jobs, const VideoConfig& config = {});
     ~Video();
 
     void Render();
-    void UpdateUnformBuffers(float theta);
+    // rotates the whole view, in degrees, also shifts the hue
+    void SetViewRotation(float theta);
+    // appends a batch to this frame's instance buffer and returns the index
+    // of its first instance, for DrawItem::firstInstance
+    uint32_t WriteInstances(const TransformArrays& transforms);
+    // draws the resident chunks of tilemap that overlap view behind
+    // everything else this frame, at most once a frame
+    void DrawTilemap(const Tilemap& tilemap, const Aabb& view);
+    // DrawTilemap with the visible chunks already picked, what a capture
+    // replays. chunks are uploaded again whenever their version changes
+    void DrawTileChunks(std::span<const TileChunk* const> chunks);
+    void OnResize() { m_SwapchainDirty = true; }
+    // runs inside Render once the image is acquired, right before the frame
+    // is recorded and submitted, the latest point input can still make it
+    // into this frame. returns when the oldest input it applied arrived, or
+    // a default time point if there was none, for FrameStats::inputLatencyMs
+    using LateLatch = std::function<std::chrono::steady_clock::time_point()>;
+    void SetLateLatch(LateLatch latch) { m_LateLatch = std::move(latch); }
+    // blocks until everything loaded at startup is ready
+    void WaitForStartup();
+
+    // records what the game hands to the renderer over the next frameCount
+    // frames, for CaptureReader to replay
+    void StartCapture(const std::filesystem::path& path, uint32_t frameCount);
+    bool IsCapturing() const { return m_Capture != nullptr; }
+
+    // copies the next frame presented back to the cpu, callback gets it on
+    // the readback thread a few frames later. nothing is read back when the
+    // swapchain does not allow it
+    void RequestReadback(ReadbackCallback callback)
+    {
+        m_Readback.Request(std::move(callback));
+    }
+    // blocks until every readback recorded so far has been delivered, stalls
+    // the gpu so it is meant for tools and tests
+    void FlushReadbacks();
+
+    // scratch memory for the frame being built. it is reset once this
+    // frame's fence has signalled, MAX_FRAMES_IN_FLIGHT frames from now, so
+    // it also suits data the gpu reads through a copy made at record time
+    std::pmr::memory_resource& GetFrameArena();
+    RenderQueue& GetRenderQueue() { return m_RenderQueue; }
+    // levels of the mesh every entity is drawn with, a DrawItem's index
+    // range is one of them
+    std::span<const MeshLod> GetMeshLods() const { return m_Mesh.lods; }
+    // window size in pixels, what lod selection measures errors against
+    vk::Extent2D GetOutputExtent() const { return m_Swapchain.GetExtent(); }
+    const FrameStats& GetFrameStats() const { return m_FrameStats; }
+    const InitGraph& GetStartup() const { return m_Startup; }
+    // for anything replaced while frames may still be using it, it is
+    // destroyed once they have completed instead of stalling for them
+    DeletionQueue& GetDeletionQueue() { return m_Deletions; }
+    void SetDynamicResolution(const DynamicResolutionConfig& config);
+    // performance overlay, off by default
+    void SetHudVisible(bool visible) { m_Hud.SetVisible(visible); }
+    bool IsHudVisible() const { return m_Hud.IsVisible(); }
 
 private:
+    // what recording reads besides resources fixed per swapchain, anything
+    // read from a buffer at execution time is left out
+    struct RecordState
+    {
+        bool pipelineReady = false;
+        vk::Extent2D renderExtent;
+        DrawConstants drawConstants{};
+        uint32_t hudQuads = 0;
+        uint32_t tilemapChunks = 0;
+
+        bool operator==(const RecordState&) const = default;
+    };
+
+    bool RecreateSwapchain();
+    // blocks until the gpu is done with the current frame's resources, so
+    // they can be written before Render
+    void WaitForFrame();
+    void EndFrame();
+    void BuildRenderGraph();
+    void RecordScenePass(vk::raii::CommandBuffer& commandBuffer);
+    void RecordUpscalePass(vk::raii::CommandBuffer& commandBuffer);
+    void RecordHudPass(vk::raii::CommandBuffer& commandBuffer);
+    void RecordReadbackPass(vk::raii::CommandBuffer& commandBuffer);
+    void RecordFrame(vk::raii::CommandBuffer& commandBuffer);
+    // invalidates the recorded command buffers when anything they were
+    // recorded from has changed since the last frame
+    void UpdateRecordState();
+    void UpdateFrameTiming();
+    bool IsBlitSupported();
+    // presentation waits for vblank, the cpu frame time then follows the
+    // refresh rate rather than the load
+    bool IsVsyncBound() const;
+    // copies the mesh and its lod chain into the vertex and index buffers
     void FillVertexBuffer();
-    std::vector<Buffer<UniformBufferObject>> ConstructUniformBuffers();
+    std::vector<Buffer<InstanceData>> ConstructInstanceBuffers();
+    void StartLoading();
+    void UpdateStartup();
 
+    std::chrono::steady_clock::time_point m_StartTime;
     vk::raii::Context m_Context;
     Window m_Window;
     VulkanInstance m_Instance;
@@ -38,14 +171,63 @@ private:
     Device m_Device;
     uint32_t m_QueueFamilyIndex = 0;
     vk::raii::Queue m_Queue;
+    // resources replaced at runtime wait here for the frames still using
+    // them, ahead of everything that retires into it
+    DeletionQueue m_Deletions;
+    // serial of the last submission of each frame in flight
+    std::vector<uint64_t> m_FrameSerials;
     Swapchain m_Swapchain;
+    bool m_BlitSupported;
+    DynamicResolution m_DynamicResolution;
+    DepthBuffer m_DepthBuffer;
     RenderPass m_RenderPass;
     Framebuffers m_Framebuffers;
+    // every level indexes the same vertices
+    LodChain m_Mesh;
     Buffer<Vertex> m_VertexBuffer;
+    Buffer<uint32_t> m_IndexBuffer;
     SyncObjects m_SyncObjects;
-    std::vector<Buffer<UniformBufferObject>> m_UniformBuffers;
-    uint32_t m_CurrentImage = 0;
-    CommandBuffer m_CommandBuffers;
+    DrawConstants m_DrawConstants{};
+    // stay mapped for the lifetime of the renderer
+    std::vector<Buffer<InstanceData>> m_InstanceBuffers;
+    uint32_t m_InstanceCount = 0;
+    std::vector<std::unique_ptr<LinearArena>> m_FrameArenas;
+    AllocationCounters m_FrameStartAllocations;
+    bool m_FrameReady = false;
+    uint32_t m_CurrentFrame = 0;
+    uint32_t m_ImageIndex = 0;
+    CommandCache m_CommandCache;
+    RecordState m_RecordState;
+    std::vector<DrawItem> m_RecordedItems;
+    // outlives everything holding its layouts
+    LayoutCache m_LayoutCache;
     Descriptors m_Descriptors;
-    GraphicsPipeline m_Pipeline;
+    Hud m_Hud;
+    TilemapRenderer m_TilemapRenderer;
+    uint32_t m_TilemapChunks = 0;
+    // reused by every DrawTilemap
+    std::vector<const TileChunk*> m_VisibleChunks;
+    FrameReadback m_Readback;
+    // filled in by startup steps, only touched on the main thread once the
+    // step is done
+    std::unique_ptr<AssetPack> m_Assets;
+    std::vector<Shader> m_LoadedShaders;
+    std::unique_ptr<GraphicsPipeline> m_Pipeline;
+    InitGraph::StepId m_PipelineStep = 0;
+    bool m_PipelineReady = false;
+    bool m_FirstFrameMarked = false;
+    bool m_StartupReported = false;
+    RenderGraph m_RenderGraph;
+    RenderResource m_Backbuffer;
+    RenderResource m_SceneColor;
+    vk::Extent2D m_RenderExtent;
+    RenderQueue m_RenderQueue;
+    GpuTimer m_GpuTimer;
+    FrameStats m_FrameStats;
+    std::chrono::steady_clock::time_point m_LastFrameTime;
+    bool m_SwapchainDirty = false;
+    std::unique_ptr<CaptureWriter> m_Capture;
+    LateLatch m_LateLatch;
+    // last, so it is torn down first and no step outlives what it touches
+    InitGraph m_Startup;
 };
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Log.hpp"
 #include <glm/vec2.hpp>
 #include <sdl2/SDL_vulkan.h>
+#include <utility>
 
 Window::Window(
     const char* title, glm::i32vec2 pos, glm::i32vec2 size, uint32_t flags)
@@ -13,12 +14,44 @@ Window::Window(
     }
 }
 
-Window::~Window() { SDL_DestroyWindow(m_Window); }
+Window::Window(glm::i32vec2 size) : m_HeadlessSize(size) {}
+
+Window::Window(Window&& other)
+    : m_Window(std::exchange(other.m_Window, nullptr)),
+      m_HeadlessSize(other.m_HeadlessSize)
+{
+}
+
+Window::~Window()
+{
+    if (m_Window)
+    {
+        SDL_DestroyWindow(m_Window);
+    }
+}
 
 SDL_Window* Window::Get() { return m_Window; }
 
+glm::i32vec2 Window::GetDrawableSize() const
+{
+    if (IsHeadless())
+    {
+        return m_HeadlessSize;
+    }
+    glm::i32vec2 size;
+    SDL_Vulkan_GetDrawableSize(m_Window, &size.x, &size.y);
+    return size;
+}
+
 std::vector<const char*> Window::GetRequiredExtensionNames() const
 {
+    if (IsHeadless())
+    {
+        return {
+            VK_KHR_SURFACE_EXTENSION_NAME,
+            VK_EXT_HEADLESS_SURFACE_EXTENSION_NAME};
+    }
+
     unsigned int numExtentions;
     if (SDL_Vulkan_GetInstanceExtensions(m_Window, &numExtentions, nullptr) !=
         SDL_TRUE)
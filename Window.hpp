@@ -10,10 +10,19 @@ class Window
 public:
     Window(
         const char* title, glm::i32vec2 pos, glm::i32vec2 size, uint32_t flags);
+    // no sdl window at all, the surface comes from VK_EXT_headless_surface
+    // and frames are rendered and presented without being shown anywhere
+    explicit Window(glm::i32vec2 size);
+    Window(const Window&) = delete;
+    Window(Window&& other);
     ~Window();
     SDL_Window* Get();
+    bool IsHeadless() const { return m_Window == nullptr; }
+    // size in pixels, for surfaces that leave the extent up to the swapchain
+    glm::i32vec2 GetDrawableSize() const;
     std::vector<const char*> GetRequiredExtensionNames() const;
 
 private:
-    SDL_Window* m_Window;
+    SDL_Window* m_Window = nullptr;
+    glm::i32vec2 m_HeadlessSize{0, 0};
 };
\ No newline at end of file
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// chase-lev work stealing deque, following "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (Le et al. 2013). the owning thread
+// pushes and pops at the bottom, any thread may steal from the top
+template <typename T> class WorkStealingQueue
+{
+    static_assert(std::is_pointer_v<T>, "queue stores job pointers");
+
+public:
+    WorkStealingQueue(int64_t capacity = 1024)
+        : m_Top(0), m_Bottom(0),
+          m_Array(new Array(capacity))
+    {
+        m_Retired.emplace_back(m_Array.load(std::memory_order_relaxed));
+    }
+    WorkStealingQueue(const WorkStealingQueue&) = delete;
+
+    // owner only
+    void Push(T item)
+    {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+        int64_t top = m_Top.load(std::memory_order_acquire);
+        Array* array = m_Array.load(std::memory_order_relaxed);
+        if (bottom - top > array->capacity - 1)
+        {
+            array = Grow(array, bottom, top);
+        }
+        array->Put(bottom, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+
+    // owner only, returns nullptr when empty
+    T Pop()
+    {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+        Array* array = m_Array.load(std::memory_order_relaxed);
+        m_Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_Top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T item = array->Get(bottom);
+        if (top == bottom)
+        {
+            // last item, race the thieves for it
+            if (!m_Top.compare_exchange_strong(
+                    top, top + 1, std::memory_order_seq_cst,
+                    std::memory_order_relaxed))
+            {
+                item = nullptr;
+            }
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // any thread, returns nullptr when empty or the steal lost a race
+    T Steal()
+    {
+        int64_t top = m_Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+        {
+            return nullptr;
+        }
+
+        Array* array = m_Array.load(std::memory_order_acquire);
+        T item = array->Get(top);
+        if (!m_Top.compare_exchange_strong(
+                top, top + 1, std::memory_order_seq_cst,
+                std::memory_order_relaxed))
+        {
+            return nullptr;
+        }
+        return item;
+    }
+
+    bool Empty() const
+    {
+        return m_Bottom.load(std::memory_order_relaxed) <=
+               m_Top.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Array
+    {
+        Array(int64_t _capacity)
+            : capacity(_capacity), mask(_capacity - 1),
+              data(new std::atomic<T>[_capacity])
+        {
+        }
+        void Put(int64_t index, T item)
+        {
+            data[index & mask].store(item, std::memory_order_relaxed);
+        }
+        T Get(int64_t index)
+        {
+            return data[index & mask].load(std::memory_order_relaxed);
+        }
+
+        int64_t capacity;
+        int64_t mask;
+        std::unique_ptr<std::atomic<T>[]> data;
+    };
+
+    Array* Grow(Array* array, int64_t bottom, int64_t top)
+    {
+        Array* grown = new Array(array->capacity * 2);
+        for (int64_t i = top; i < bottom; i++)
+        {
+            grown->Put(i, array->Get(i));
+        }
+        // thieves may still be reading the old array, so it is only freed
+        // with the queue
+        m_Retired.emplace_back(grown);
+        m_Array.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+    alignas(64) std::atomic<int64_t> m_Top;
+    alignas(64) std::atomic<int64_t> m_Bottom;
+    std::atomic<Array*> m_Array;
+    std::vector<std::unique_ptr<Array>> m_Retired;
+};
@@ -0,0 +1,102 @@
+#include "Allocators.hpp"
+#include "Benchmark.hpp"
+#include <memory_resource>
+#include <vector>
+
+// the pattern the frame arena replaces, a few short lived vectors built and
+// thrown away every frame, and node churn for the object pool
+
+namespace
+{
+    constexpr size_t VECTOR_COUNT = 64;
+    constexpr size_t VECTOR_SIZE = 100;
+    constexpr size_t OBJECT_COUNT = 1024;
+
+    struct Node
+    {
+        Node* next;
+        float payload[14];
+    };
+
+    template <typename Vector> void FillVectors(Vector& vector)
+    {
+        for (size_t i = 0; i < VECTOR_SIZE; i++)
+        {
+            vector.push_back(static_cast<uint32_t>(i));
+        }
+        DoNotOptimize(vector.data());
+    }
+}
+
+BENCHMARK(
+    "Allocators/Heap vectors/64x100",
+    [](BenchmarkState& state)
+    {
+        state.SetItemsPerIteration(VECTOR_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            for (size_t v = 0; v < VECTOR_COUNT; v++)
+            {
+                std::vector<uint32_t> vector;
+                FillVectors(vector);
+            }
+        }
+    });
+
+BENCHMARK(
+    "Allocators/Arena vectors/64x100",
+    [](BenchmarkState& state)
+    {
+        LinearArena arena(1024 * 1024);
+        state.SetItemsPerIteration(VECTOR_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            for (size_t v = 0; v < VECTOR_COUNT; v++)
+            {
+                std::pmr::vector<uint32_t> vector(&arena);
+                FillVectors(vector);
+            }
+            arena.Reset();
+        }
+    });
+
+BENCHMARK(
+    "Allocators/Heap objects/1024",
+    [](BenchmarkState& state)
+    {
+        std::vector<Node*> nodes(OBJECT_COUNT);
+        state.SetItemsPerIteration(OBJECT_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            for (Node*& node : nodes)
+            {
+                node = new Node{};
+            }
+            DoNotOptimize(nodes.data());
+            for (Node* node : nodes)
+            {
+                delete node;
+            }
+        }
+    });
+
+BENCHMARK(
+    "Allocators/Pooled objects/1024",
+    [](BenchmarkState& state)
+    {
+        ObjectPool<Node> pool;
+        std::vector<Node*> nodes(OBJECT_COUNT);
+        state.SetItemsPerIteration(OBJECT_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            for (Node*& node : nodes)
+            {
+                node = pool.Create();
+            }
+            DoNotOptimize(nodes.data());
+            for (Node* node : nodes)
+            {
+                pool.Destroy(node);
+            }
+        }
+    });
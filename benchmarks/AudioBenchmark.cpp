@@ -0,0 +1,78 @@
+#include "AudioMixer.hpp"
+#include "Benchmark.hpp"
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+// 256 looping voices mixed one 256 frame block at a time. an item is one
+// voice mixed for one block, 5.3 ms of audio at 48 khz, so items per second
+// divided by 187.5 blocks a second is how many voices one core could keep
+// up with in real time
+
+namespace
+{
+    constexpr uint32_t SAMPLE_RATE = 48000;
+    constexpr uint32_t VOICE_COUNT = 256;
+
+    const AudioClip& GetClip(uint32_t channels)
+    {
+        static AudioClip clips[2] = {};
+        AudioClip& clip = clips[channels - 1];
+        if (clip.samples.empty())
+        {
+            // a second of noise, long enough that the loop point is rare
+            std::mt19937 random(42);
+            std::uniform_real_distribution<float> value(-0.5f, 0.5f);
+            clip.channels = channels;
+            clip.samples.resize(SAMPLE_RATE * channels);
+            for (float& sample : clip.samples)
+            {
+                sample = value(random);
+            }
+        }
+        return clip;
+    }
+
+    void MixVoices(BenchmarkState& state, uint32_t channels, bool resample)
+    {
+        auto mixer = std::make_unique<AudioMixer>(SAMPLE_RATE);
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> pan(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> pitch(0.5f, 2.0f);
+        for (uint32_t i = 0; i < VOICE_COUNT; i++)
+        {
+            AudioCommand command{AudioCommandType::Play, {i, 0}};
+            command.clip = &GetClip(channels);
+            command.params.volume = 1.0f / VOICE_COUNT;
+            command.params.pan = pan(random);
+            command.params.pitch = resample ? pitch(random) : 1.0f;
+            command.params.loop = true;
+            mixer->Submit(command);
+        }
+
+        std::vector<float> output(AUDIO_BLOCK_FRAMES * 2);
+        state.SetItemsPerIteration(VOICE_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            mixer->Mix(output.data(), AUDIO_BLOCK_FRAMES);
+            DoNotOptimize(output.data());
+        }
+    }
+}
+
+BENCHMARK(
+    "Audio/Mono/256 voices",
+    [](BenchmarkState& state) { MixVoices(state, 1, false); });
+
+BENCHMARK(
+    "Audio/Stereo/256 voices",
+    [](BenchmarkState& state) { MixVoices(state, 2, false); });
+
+BENCHMARK(
+    "Audio/Mono resampled/256 voices",
+    [](BenchmarkState& state) { MixVoices(state, 1, true); });
+
+BENCHMARK(
+    "Audio/Stereo resampled/256 voices",
+    [](BenchmarkState& state) { MixVoices(state, 2, true); });
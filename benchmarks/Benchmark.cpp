@@ -0,0 +1,196 @@
+#include "Benchmark.hpp"
+#include <cstdio>
+#include <ctime>
+#include <fmt/chrono.h>
+#include <fmt/core.h>
+#include <string_view>
+
+namespace
+{
+    struct RegisteredBenchmark
+    {
+        std::string name;
+        BenchmarkFunction function;
+    };
+
+    std::vector<RegisteredBenchmark>& GetBenchmarks()
+    {
+        static std::vector<RegisteredBenchmark> benchmarks;
+        return benchmarks;
+    }
+
+    constexpr std::chrono::milliseconds MIN_DURATION(200);
+}
+
+BenchmarkRegistration::BenchmarkRegistration(
+    const std::string& name, BenchmarkFunction function)
+{
+    GetBenchmarks().push_back({name, function});
+}
+
+void BenchmarkState::Start()
+{
+    m_Elapsed = std::chrono::nanoseconds(0);
+    ResumeTiming();
+}
+
+void BenchmarkState::Stop() { PauseTiming(); }
+
+void BenchmarkState::PauseTiming()
+{
+    if (m_Running)
+    {
+        m_Elapsed += std::chrono::steady_clock::now() - m_Start;
+        m_Running = false;
+    }
+}
+
+void BenchmarkState::ResumeTiming()
+{
+    if (!m_Running)
+    {
+        m_Start = std::chrono::steady_clock::now();
+        m_Running = true;
+    }
+}
+
+std::chrono::nanoseconds BenchmarkState::GetElapsed() const
+{
+    return m_Elapsed;
+}
+
+namespace
+{
+    struct BenchmarkResult
+    {
+        std::string name;
+        uint64_t iterations;
+        double nanoseconds;
+        double itemsPerSecond;
+    };
+
+    std::string EscapeJson(std::string_view text)
+    {
+        std::string escaped;
+        for (char character : text)
+        {
+            if (character == '"' || character == '\\')
+            {
+                escaped.push_back('\\');
+            }
+            escaped.push_back(character);
+        }
+        return escaped;
+    }
+
+    // one object per benchmark, so runs of different commits can be lined
+    // up by name
+    void WriteJson(std::FILE* file, const std::vector<BenchmarkResult>& results)
+    {
+        fmt::print(file, "{{\n  \"context\": {{\n");
+        fmt::print(
+            file, "    \"date\": \"{:%Y-%m-%dT%H:%M:%S}\",\n",
+            fmt::localtime(std::time(nullptr)));
+#ifdef NDEBUG
+        fmt::print(file, "    \"build_type\": \"release\"\n");
+#else
+        fmt::print(file, "    \"build_type\": \"debug\"\n");
+#endif
+        fmt::print(file, "  }},\n  \"benchmarks\": [");
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const BenchmarkResult& result = results[i];
+            fmt::print(
+                file,
+                "{}\n    {{\"name\": \"{}\", \"iterations\": {}, "
+                "\"time_unit\": \"ns\", \"real_time\": {:.1f}, "
+                "\"items_per_second\": {:.0f}}}",
+                i == 0 ? "" : ",", EscapeJson(result.name),
+                result.iterations, result.nanoseconds, result.itemsPerSecond);
+        }
+        fmt::print(file, "\n  ]\n}}\n");
+    }
+}
+
+// benchmarks [filter] [--json <file>]
+//
+// runs every benchmark whose name contains filter. --json also writes the
+// results to file, - for stdout, in place of the table
+int main(int argc, char** argv)
+{
+    std::string_view filter;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string_view(argv[i]) == "--json" && i + 1 < argc)
+        {
+            jsonPath = argv[++i];
+        }
+        else
+        {
+            filter = argv[i];
+        }
+    }
+    bool jsonToStdout = jsonPath && std::string_view(jsonPath) == "-";
+
+    if (!jsonToStdout)
+    {
+        fmt::print(
+            "{:<48} {:>12} {:>14} {:>16}\n", "benchmark", "iterations",
+            "ns/iter", "items/s");
+    }
+    std::vector<BenchmarkResult> results;
+    for (RegisteredBenchmark& benchmark : GetBenchmarks())
+    {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        uint64_t iterations = 1;
+        while (true)
+        {
+            BenchmarkState state(iterations);
+            state.Start();
+            benchmark.function(state);
+            state.Stop();
+
+            if (state.GetElapsed() >= MIN_DURATION || iterations >= (1ull << 30))
+            {
+                double nanoseconds =
+                    static_cast<double>(state.GetElapsed().count()) /
+                    static_cast<double>(iterations);
+                double itemsPerSecond =
+                    state.GetItemsPerIteration() * 1e9 / nanoseconds;
+                if (!jsonToStdout)
+                {
+                    fmt::print(
+                        "{:<48} {:>12} {:>14.1f} {:>16.0f}\n",
+                        benchmark.name, iterations, nanoseconds,
+                        itemsPerSecond);
+                }
+                results.push_back(
+                    {benchmark.name, iterations, nanoseconds, itemsPerSecond});
+                break;
+            }
+            iterations *= 2;
+        }
+    }
+
+    if (jsonToStdout)
+    {
+        WriteJson(stdout, results);
+    }
+    else if (jsonPath)
+    {
+        std::FILE* file = std::fopen(jsonPath, "w");
+        if (!file)
+        {
+            fmt::print(stderr, "Could not open {}\n", jsonPath);
+            return 1;
+        }
+        WriteJson(file, results);
+        std::fclose(file);
+    }
+    return 0;
+}
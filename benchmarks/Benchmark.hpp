@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// minimal benchmark harness, each benchmark is run with a doubling iteration
+// count until it takes long enough to time reliably
+
+class BenchmarkState
+{
+public:
+    BenchmarkState(uint64_t iterations) : m_Iterations(iterations) {}
+
+    uint64_t GetIterations() const { return m_Iterations; }
+    // work items per iteration, reported as items per second
+    void SetItemsPerIteration(uint64_t items) { m_ItemsPerIteration = items; }
+    uint64_t GetItemsPerIteration() const { return m_ItemsPerIteration; }
+
+    // excluded from the measured time
+    void PauseTiming();
+    void ResumeTiming();
+    std::chrono::nanoseconds GetElapsed() const;
+    void Start();
+    void Stop();
+
+private:
+    uint64_t m_Iterations;
+    uint64_t m_ItemsPerIteration = 0;
+    std::chrono::steady_clock::time_point m_Start;
+    std::chrono::nanoseconds m_Elapsed{0};
+    bool m_Running = false;
+};
+
+using BenchmarkFunction = std::function<void(BenchmarkState&)>;
+
+struct BenchmarkRegistration
+{
+    BenchmarkRegistration(const std::string& name, BenchmarkFunction function);
+};
+
+#define BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define BENCHMARK_CONCAT(a, b) BENCHMARK_CONCAT_IMPL(a, b)
+#define BENCHMARK(name, function)                                              \
+    static BenchmarkRegistration BENCHMARK_CONCAT(                             \
+        s_BenchmarkRegistration, __LINE__)(name, function)
+
+// keeps the optimizer from dropping a computed value
+template <typename T> inline void DoNotOptimize(const T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
@@ -0,0 +1,138 @@
+#include "Benchmark.hpp"
+#include "Collision.hpp"
+#include "JobSystem.hpp"
+#include <cmath>
+#include <memory>
+#include <random>
+#include <unordered_map>
+
+// bodies of 0.25 to 1 units across at one body per 4 square units, so every
+// size sees the same few neighbours per body and time per body should stay
+// flat as the count grows. every tick moves each body a little, the
+// broadphase sees last tick's order and only re-sorts what crossed
+
+namespace
+{
+    JobSystem& GetJobSystem()
+    {
+        static JobSystem jobSystem;
+        return jobSystem;
+    }
+
+    struct Scene
+    {
+        Scene(size_t count)
+        {
+            float levelSize = std::sqrt(static_cast<float>(count) * 4.0f);
+            std::mt19937 random(1234);
+            std::uniform_real_distribution<float> position(0.0f, levelSize);
+            std::uniform_real_distribution<float> size(0.125f, 0.5f);
+            std::uniform_real_distribution<float> speed(-0.05f, 0.05f);
+            for (size_t i = 0; i < count; i++)
+            {
+                bool circle = i % 2 == 0;
+                float extent = size(random);
+                shapes.push_back(
+                    {circle ? ShapeType::Circle : ShapeType::Box,
+                     glm::vec2(extent, circle ? 0.0f : size(random))});
+                positions.emplace_back(position(random), position(random));
+                velocities.emplace_back(speed(random), speed(random));
+                proxies.push_back(broadphase.Insert(
+                    GetShapeBounds(shapes[i], positions[i]),
+                    static_cast<uint32_t>(i)));
+            }
+            broadphase.FindPairs(GetJobSystem(), pairs);
+        }
+
+        // velocities flip every 64 ticks, so bodies drift back and forth
+        // rather than piling up over long runs
+        void Move(uint64_t tick)
+        {
+            float direction = (tick / 64) % 2 == 0 ? 1.0f : -1.0f;
+            for (size_t i = 0; i < positions.size(); i++)
+            {
+                positions[i] += velocities[i] * direction;
+                broadphase.Update(
+                    proxies[i], GetShapeBounds(shapes[i], positions[i]));
+            }
+        }
+
+        Broadphase broadphase;
+        std::vector<CollisionShape> shapes;
+        std::vector<glm::vec2> positions;
+        std::vector<glm::vec2> velocities;
+        std::vector<CollisionProxy> proxies;
+        std::vector<CollisionPair> pairs;
+        std::vector<Contact> contacts;
+    };
+
+    // built on first use and kept, the 1M scene takes a while
+    Scene& GetScene(size_t count)
+    {
+        static std::unordered_map<size_t, std::unique_ptr<Scene>> scenes;
+        std::unique_ptr<Scene>& scene = scenes[count];
+        if (!scene)
+        {
+            scene = std::make_unique<Scene>(count);
+        }
+        return *scene;
+    }
+
+    void FindPairs(BenchmarkState& state, size_t count)
+    {
+        state.PauseTiming();
+        Scene& scene = GetScene(count);
+        state.ResumeTiming();
+
+        state.SetItemsPerIteration(count);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            scene.Move(i);
+            scene.broadphase.FindPairs(GetJobSystem(), scene.pairs);
+            DoNotOptimize(scene.pairs.data());
+        }
+    }
+
+    // the broadphase's pairs from the last tick through Collide
+    void Narrowphase(BenchmarkState& state, size_t count)
+    {
+        state.PauseTiming();
+        Scene& scene = GetScene(count);
+        scene.broadphase.FindPairs(GetJobSystem(), scene.pairs);
+        state.ResumeTiming();
+
+        state.SetItemsPerIteration(scene.pairs.size());
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            scene.contacts.clear();
+            for (const CollisionPair& pair : scene.pairs)
+            {
+                Contact contact;
+                if (Collide(
+                        scene.shapes[pair.a], scene.positions[pair.a],
+                        scene.shapes[pair.b], scene.positions[pair.b],
+                        contact))
+                {
+                    scene.contacts.push_back(contact);
+                }
+            }
+            DoNotOptimize(scene.contacts.data());
+        }
+    }
+}
+
+BENCHMARK(
+    "Collision/FindPairs/10k",
+    [](BenchmarkState& state) { FindPairs(state, 10'000); });
+
+BENCHMARK(
+    "Collision/FindPairs/100k",
+    [](BenchmarkState& state) { FindPairs(state, 100'000); });
+
+BENCHMARK(
+    "Collision/FindPairs/1M",
+    [](BenchmarkState& state) { FindPairs(state, 1'000'000); });
+
+BENCHMARK(
+    "Collision/Narrowphase/100k",
+    [](BenchmarkState& state) { Narrowphase(state, 100'000); });
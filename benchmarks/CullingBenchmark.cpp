@@ -0,0 +1,138 @@
+#include "Benchmark.hpp"
+#include "Culling.hpp"
+#include "SpatialGrid.hpp"
+#include <random>
+
+// a level of 1M objects spread over 4096x4096 units with a 64x36 unit camera,
+// CullAabbs against a flat array is compared to the scalar loop, and the grid
+// query shows what spatial partitioning saves over testing everything
+
+namespace
+{
+    constexpr size_t OBJECT_COUNT = 1 << 20;
+    constexpr float LEVEL_SIZE = 4096.0f;
+    const Aabb CAMERA{{1000.0f, 1000.0f}, {1064.0f, 1036.0f}};
+
+    struct Level
+    {
+        std::vector<float> minX, minY, maxX, maxY;
+        std::vector<uint32_t> visible;
+
+        AabbArrays GetBounds() const
+        {
+            return {minX.data(), minY.data(), maxX.data(), maxY.data(),
+                    minX.size()};
+        }
+    };
+
+    Level& GetLevel()
+    {
+        static Level level = []()
+        {
+            Level level;
+            std::mt19937 random(1234);
+            std::uniform_real_distribution<float> position(0.0f, LEVEL_SIZE);
+            std::uniform_real_distribution<float> size(0.25f, 2.0f);
+            for (size_t i = 0; i < OBJECT_COUNT; i++)
+            {
+                float x = position(random);
+                float y = position(random);
+                float halfWidth = size(random);
+                float halfHeight = size(random);
+                level.minX.push_back(x - halfWidth);
+                level.minY.push_back(y - halfHeight);
+                level.maxX.push_back(x + halfWidth);
+                level.maxY.push_back(y + halfHeight);
+            }
+            level.visible.resize(OBJECT_COUNT);
+            return level;
+        }();
+        return level;
+    }
+}
+
+BENCHMARK(
+    "Culling/Scalar/1M",
+    [](BenchmarkState& state)
+    {
+        Level& level = GetLevel();
+        state.SetItemsPerIteration(OBJECT_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            size_t count = CullAabbsScalar(
+                level.GetBounds(), CAMERA, level.visible.data());
+            DoNotOptimize(count);
+        }
+    });
+
+BENCHMARK(
+    std::string("Culling/Simd/1M/") + GetCullingInstructionSet(),
+    [](BenchmarkState& state)
+    {
+        Level& level = GetLevel();
+        state.SetItemsPerIteration(OBJECT_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            size_t count =
+                CullAabbs(level.GetBounds(), CAMERA, level.visible.data());
+            DoNotOptimize(count);
+        }
+    });
+
+BENCHMARK(
+    "Culling/SpatialGrid/Query/1M",
+    [](BenchmarkState& state)
+    {
+        state.PauseTiming();
+        Level& level = GetLevel();
+        SpatialGrid grid(8.0f);
+        for (size_t i = 0; i < OBJECT_COUNT; i++)
+        {
+            grid.Insert(
+                {{level.minX[i], level.minY[i]},
+                 {level.maxX[i], level.maxY[i]}},
+                static_cast<uint32_t>(i));
+        }
+        std::vector<uint32_t> results;
+        state.ResumeTiming();
+
+        state.SetItemsPerIteration(OBJECT_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            results.clear();
+            grid.Query(CAMERA, results);
+            DoNotOptimize(results.data());
+        }
+    });
+
+BENCHMARK(
+    "Culling/SpatialGrid/Update/1M",
+    [](BenchmarkState& state)
+    {
+        state.PauseTiming();
+        Level& level = GetLevel();
+        SpatialGrid grid(8.0f);
+        std::vector<SpatialProxy> proxies;
+        for (size_t i = 0; i < OBJECT_COUNT; i++)
+        {
+            proxies.push_back(grid.Insert(
+                {{level.minX[i], level.minY[i]},
+                 {level.maxX[i], level.maxY[i]}},
+                static_cast<uint32_t>(i)));
+        }
+        state.ResumeTiming();
+
+        // everything drifts a little each frame, a few objects change cells
+        state.SetItemsPerIteration(OBJECT_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            glm::vec2 offset(0.05f * static_cast<float>(i % 16));
+            for (size_t j = 0; j < OBJECT_COUNT; j++)
+            {
+                grid.Update(
+                    proxies[j],
+                    {glm::vec2(level.minX[j], level.minY[j]) + offset,
+                     glm::vec2(level.maxX[j], level.maxY[j]) + offset});
+            }
+        }
+    });
@@ -0,0 +1,103 @@
+#include "Benchmark.hpp"
+#include "JobSystem.hpp"
+#include <atomic>
+
+// scheduling overhead per job is iteration time divided by job count, the
+// jobs themselves are empty
+
+namespace
+{
+    JobSystem& GetJobSystem()
+    {
+        static JobSystem jobSystem;
+        return jobSystem;
+    }
+
+    constexpr size_t JOB_COUNT = 10'000;
+}
+
+BENCHMARK(
+    "JobSystem/RunWait/EmptyJobs",
+    [](BenchmarkState& state)
+    {
+        JobSystem& jobs = GetJobSystem();
+        state.SetItemsPerIteration(JOB_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            JobCounter counter;
+            for (size_t j = 0; j < JOB_COUNT; j++)
+            {
+                jobs.Run([]() {}, &counter);
+            }
+            jobs.Wait(counter);
+        }
+    });
+
+BENCHMARK(
+    "JobSystem/ParallelFor/Grain1",
+    [](BenchmarkState& state)
+    {
+        JobSystem& jobs = GetJobSystem();
+        state.SetItemsPerIteration(JOB_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            std::atomic<size_t> sum = 0;
+            jobs.ParallelFor(
+                0, JOB_COUNT, 1,
+                [&](size_t begin, size_t end) {
+                    sum.fetch_add(end - begin, std::memory_order_relaxed);
+                });
+            DoNotOptimize(sum);
+        }
+    });
+
+BENCHMARK(
+    "JobSystem/ParallelFor/Sum1M",
+    [](BenchmarkState& state)
+    {
+        JobSystem& jobs = GetJobSystem();
+        constexpr size_t COUNT = 1 << 20;
+        std::vector<float> values(COUNT, 1.0f);
+        state.SetItemsPerIteration(COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            std::atomic<uint64_t> sum = 0;
+            jobs.ParallelFor(
+                0, COUNT, 16 * 1024,
+                [&](size_t begin, size_t end)
+                {
+                    float local = 0.0f;
+                    for (size_t j = begin; j < end; j++)
+                    {
+                        local += values[j];
+                    }
+                    sum.fetch_add(
+                        static_cast<uint64_t>(local), std::memory_order_relaxed);
+                });
+            DoNotOptimize(sum);
+        }
+    });
+
+BENCHMARK(
+    "JobSystem/ContinuationChain",
+    [](BenchmarkState& state)
+    {
+        JobSystem& jobs = GetJobSystem();
+        constexpr size_t CHAIN_LENGTH = 1000;
+        state.SetItemsPerIteration(CHAIN_LENGTH);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            std::vector<JobCounter> counters(CHAIN_LENGTH);
+            jobs.Run([]() {}, &counters.front());
+            for (size_t j = 1; j < CHAIN_LENGTH; j++)
+            {
+                jobs.Continue(counters.at(j - 1), []() {}, &counters.at(j));
+            }
+            jobs.Wait(counters.back());
+            // earlier counters may still be held by finishing jobs
+            for (JobCounter& counter : counters)
+            {
+                jobs.Wait(counter);
+            }
+        }
+    });
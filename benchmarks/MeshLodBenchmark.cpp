@@ -0,0 +1,108 @@
+#include "Benchmark.hpp"
+#include "MeshSimplifier.hpp"
+#include <cmath>
+#include <random>
+
+// a disc of 32 rings by 128 segments with colors swirling around it, about
+// 8k triangles. building its lod chain is what the cooker pays per mesh,
+// selecting levels for 1M instances is what a frame pays when everything is
+// on screen
+
+namespace
+{
+    constexpr uint32_t RINGS = 32;
+    constexpr uint32_t SEGMENTS = 128;
+    constexpr size_t INSTANCE_COUNT = 1 << 20;
+
+    struct Disc
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+    };
+
+    const Disc& GetDisc()
+    {
+        static Disc disc = []()
+        {
+            Disc disc;
+            disc.vertices.push_back({{0.0f, 0.0f}, {0.5f, 0.5f, 0.5f}});
+            for (uint32_t ring = 1; ring <= RINGS; ring++)
+            {
+                float radius = static_cast<float>(ring) / RINGS;
+                for (uint32_t segment = 0; segment < SEGMENTS; segment++)
+                {
+                    float angle = 6.2831853f * segment / SEGMENTS;
+                    float swirl = 0.5f + 0.5f * std::sin(5.0f * angle + radius);
+                    disc.vertices.push_back(
+                        {{radius * std::cos(angle), radius * std::sin(angle)},
+                         {swirl, 0.5f, 1.0f - swirl}});
+                }
+            }
+            auto at = [](uint32_t ring, uint32_t segment)
+            {
+                return ring == 0
+                           ? 0u
+                           : 1 + (ring - 1) * SEGMENTS + segment % SEGMENTS;
+            };
+            for (uint32_t segment = 0; segment < SEGMENTS; segment++)
+            {
+                disc.indices.insert(
+                    disc.indices.end(),
+                    {0u, at(1, segment), at(1, segment + 1)});
+            }
+            for (uint32_t ring = 1; ring < RINGS; ring++)
+            {
+                for (uint32_t segment = 0; segment < SEGMENTS; segment++)
+                {
+                    uint32_t a = at(ring, segment);
+                    uint32_t b = at(ring, segment + 1);
+                    uint32_t c = at(ring + 1, segment);
+                    uint32_t d = at(ring + 1, segment + 1);
+                    disc.indices.insert(disc.indices.end(), {a, c, d, a, d, b});
+                }
+            }
+            return disc;
+        }();
+        return disc;
+    }
+}
+
+BENCHMARK(
+    "MeshLod/BuildLodChain/8k",
+    [](BenchmarkState& state)
+    {
+        const Disc& disc = GetDisc();
+        state.SetItemsPerIteration(disc.indices.size() / 3);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            LodChain chain = BuildLodChain(disc.vertices, disc.indices);
+            DoNotOptimize(chain.lods.data());
+        }
+    });
+
+BENCHMARK(
+    "MeshLod/SelectLod/1M",
+    [](BenchmarkState& state)
+    {
+        state.PauseTiming();
+        LodChain chain = BuildLodChain(GetDisc().vertices, GetDisc().indices);
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> radius(1.0f, 512.0f);
+        std::vector<float> radii(INSTANCE_COUNT);
+        for (float& value : radii)
+        {
+            value = radius(random);
+        }
+        std::vector<uint32_t> levels(INSTANCE_COUNT);
+        state.ResumeTiming();
+
+        state.SetItemsPerIteration(INSTANCE_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            for (size_t j = 0; j < INSTANCE_COUNT; j++)
+            {
+                levels[j] = SelectLod(chain.lods, radii[j], levels[j]);
+            }
+            DoNotOptimize(levels.data());
+        }
+    });
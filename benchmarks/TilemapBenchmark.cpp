@@ -0,0 +1,62 @@
+#include "Benchmark.hpp"
+#include "JobSystem.hpp"
+#include "Tilemap.hpp"
+
+// steady state cost of streaming with the camera panning across the world,
+// chunk generation included. it should stay flat however far the camera has
+// travelled
+
+namespace
+{
+    const Aabb START_VIEW{{-1.0f, -1.0f}, {1.0f, 1.0f}};
+
+    void FillChunk(glm::i32vec2 chunk, std::span<TileId> tiles)
+    {
+        for (size_t i = 0; i < tiles.size(); i++)
+        {
+            tiles[i] = static_cast<TileId>(1 + ((chunk.x ^ chunk.y) & 7));
+        }
+    }
+}
+
+BENCHMARK(
+    "Tilemap/Pan camera",
+    [](BenchmarkState& state)
+    {
+        JobSystem jobs;
+        Tilemap tilemap(jobs, FillChunk);
+        std::vector<const TileChunk*> visible;
+        Aabb view = START_VIEW;
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            // a tile a frame
+            view.min.x += TILE_SIZE;
+            view.max.x += TILE_SIZE;
+            tilemap.Update(view);
+            tilemap.WaitForLoads();
+            visible.clear();
+            tilemap.GetVisible(view, visible);
+            DoNotOptimize(visible.data());
+        }
+    });
+
+BENCHMARK(
+    "Tilemap/SetTile resident",
+    [](BenchmarkState& state)
+    {
+        JobSystem jobs;
+        Tilemap tilemap(jobs, FillChunk);
+        Aabb view = START_VIEW;
+        tilemap.Update(view);
+        tilemap.WaitForLoads();
+        state.SetItemsPerIteration(CHUNK_TILES);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            for (int32_t x = 0; x < CHUNK_TILES; x++)
+            {
+                tilemap.SetTile(
+                    {x, static_cast<int32_t>(i % CHUNK_TILES)},
+                    static_cast<TileId>(i & 15));
+            }
+        }
+    });
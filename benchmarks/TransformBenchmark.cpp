@@ -0,0 +1,73 @@
+#include "Benchmark.hpp"
+#include "Transforms.hpp"
+#include <new>
+#include <random>
+#include <vector>
+
+// 64k instances written into a 64 byte aligned block, standing in for the
+// persistently mapped instance buffer
+
+namespace
+{
+    constexpr size_t INSTANCE_COUNT = 64 * 1024;
+
+    struct Batch
+    {
+        std::vector<glm::vec2> positions;
+        std::vector<float> rotations;
+        std::vector<glm::vec2> scales;
+        InstanceData* output;
+
+        TransformArrays GetArrays() const
+        {
+            return {positions.data(), rotations.data(), scales.data(),
+                    positions.size()};
+        }
+    };
+
+    Batch& GetBatch()
+    {
+        static Batch batch = []()
+        {
+            Batch batch;
+            std::mt19937 random(42);
+            std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+            for (size_t i = 0; i < INSTANCE_COUNT; i++)
+            {
+                batch.positions.push_back({value(random), value(random)});
+                batch.rotations.push_back(value(random));
+                batch.scales.push_back({value(random), value(random)});
+            }
+            batch.output = static_cast<InstanceData*>(::operator new(
+                INSTANCE_COUNT * sizeof(InstanceData), std::align_val_t(64)));
+            return batch;
+        }();
+        return batch;
+    }
+}
+
+BENCHMARK(
+    "Transforms/Scalar/64k",
+    [](BenchmarkState& state)
+    {
+        Batch& batch = GetBatch();
+        state.SetItemsPerIteration(INSTANCE_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            WriteTransformsScalar(batch.GetArrays(), batch.output);
+            DoNotOptimize(batch.output);
+        }
+    });
+
+BENCHMARK(
+    "Transforms/Simd/64k",
+    [](BenchmarkState& state)
+    {
+        Batch& batch = GetBatch();
+        state.SetItemsPerIteration(INSTANCE_COUNT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            WriteTransforms(batch.GetArrays(), batch.output);
+            DoNotOptimize(batch.output);
+        }
+    });
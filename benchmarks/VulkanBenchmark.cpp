@@ -0,0 +1,260 @@
+#include "AssetPack.hpp"
+#include "Benchmark.hpp"
+#include "Buffer.hpp"
+#include "DepthBuffer.hpp"
+#include "Descriptors.hpp"
+#include "Device.hpp"
+#include "Instance.hpp"
+#include "JobSystem.hpp"
+#include "LayoutCache.hpp"
+#include "Pipeline.hpp"
+#include "RenderPass.hpp"
+#include "Shader.hpp"
+#include "Surface.hpp"
+#include "SyncObjects.hpp"
+#include "Transforms.hpp"
+#include "Video.hpp"
+#include "Window.hpp"
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+// cpu side cost of the renderer's setup and per frame paths. everything
+// runs headless, no window and no sdl video, so these also run on ci
+// machines without a gpu: point VK_ICD_FILENAMES at a software driver such
+// as lavapipe. numbers from a software driver only compare against runs on
+// the same driver
+
+namespace
+{
+    const glm::i32vec2 HEADLESS_SIZE{1280, 720};
+
+    // built on first use, so filtering out these benchmarks never touches
+    // vulkan at all
+    struct VulkanFixture
+    {
+        VulkanFixture()
+            : window(HEADLESS_SIZE), instance(window, context),
+              surface(window, instance), device(instance, surface),
+              depthFormat(PickDepthFormat()),
+              renderPass(device, surface, depthFormat), layouts(device),
+              assets(AssetPack::GetDefaultPath())
+        {
+        }
+
+        // also fills in the surface format, the swapchain would otherwise
+        vk::Format PickDepthFormat()
+        {
+            surface.GetSurfaceCapabilities(device);
+            surface.GetSurfaceFormat(device);
+            return DepthBuffer::PickDepthFormat(device);
+        }
+
+        vk::raii::Context context;
+        Window window;
+        VulkanInstance instance;
+        Surface surface;
+        Device device;
+        vk::Format depthFormat;
+        RenderPass renderPass;
+        // shared by every benchmark, like the renderer's
+        LayoutCache layouts;
+        AssetPack assets;
+    };
+
+    VulkanFixture& GetFixture()
+    {
+        static VulkanFixture fixture;
+        return fixture;
+    }
+
+    std::vector<Buffer<InstanceData>> CreateInstanceBuffers(Device& device)
+    {
+        std::vector<Buffer<InstanceData>> buffers;
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        {
+            buffers.emplace_back(
+                device, MAX_INSTANCES,
+                vk::BufferUsageFlagBits::eStorageBuffer);
+        }
+        return buffers;
+    }
+
+    std::vector<Shader> LoadSceneShader(VulkanFixture& fixture)
+    {
+        std::vector<Shader> shaders =
+            LoadShaders(fixture.device.Get(), fixture.assets);
+        std::vector<Shader> scene;
+        scene.push_back(TakeShader(shaders, "shader"));
+        return scene;
+    }
+
+    // shared by the Render benchmarks, the frame state they set carries
+    // over between them. dynamic resolution is off, a slow driver would
+    // otherwise change the render extent and with it what gets recorded
+    Video& GetHeadlessVideo()
+    {
+        static JobSystem jobs;
+        static std::unique_ptr<Video> video = []()
+        {
+            auto video = std::make_unique<Video>(
+                jobs, VideoConfig{HEADLESS_SIZE, true, false});
+            DynamicResolutionConfig resolution;
+            resolution.enabled = false;
+            video->SetDynamicResolution(resolution);
+            video->WaitForStartup();
+            return video;
+        }();
+        return *video;
+    }
+}
+
+BENCHMARK(
+    "Vulkan/Buffer create and map",
+    [](BenchmarkState& state)
+    {
+        VulkanFixture& fixture = GetFixture();
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            Buffer<InstanceData> buffer(
+                fixture.device, MAX_INSTANCES,
+                vk::BufferUsageFlagBits::eStorageBuffer);
+            DoNotOptimize(buffer.GetMemory().data());
+        }
+    });
+
+BENCHMARK(
+    "Vulkan/FindMemoryType",
+    [](BenchmarkState& state)
+    {
+        VulkanFixture& fixture = GetFixture();
+        Buffer<InstanceData> buffer(
+            fixture.device, MAX_INSTANCES,
+            vk::BufferUsageFlagBits::eStorageBuffer);
+        vk::MemoryRequirements requirements =
+            buffer.Get().getMemoryRequirements();
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            DoNotOptimize(fixture.device.FindMemoryType(
+                requirements, vk::MemoryPropertyFlagBits::eHostVisible |
+                                  vk::MemoryPropertyFlagBits::eHostCoherent));
+        }
+    });
+
+BENCHMARK(
+    "Vulkan/LoadShaders",
+    [](BenchmarkState& state)
+    {
+        VulkanFixture& fixture = GetFixture();
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            std::vector<Shader> shaders =
+                LoadShaders(fixture.device.Get(), fixture.assets);
+            DoNotOptimize(shaders.data());
+        }
+    });
+
+// pool, cached layout, allocation and the buffer writes for every frame in
+// flight
+BENCHMARK(
+    "Vulkan/Descriptors create and update",
+    [](BenchmarkState& state)
+    {
+        VulkanFixture& fixture = GetFixture();
+        std::vector<Buffer<InstanceData>> buffers =
+            CreateInstanceBuffers(fixture.device);
+        state.SetItemsPerIteration(MAX_FRAMES_IN_FLIGHT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            Descriptors descriptors(
+                fixture.device, fixture.layouts, buffers,
+                MAX_FRAMES_IN_FLIGHT);
+            DoNotOptimize(&descriptors);
+        }
+    });
+
+// shaders are consumed by the pipeline, loading them is not timed
+BENCHMARK(
+    "Vulkan/GraphicsPipeline/no cache",
+    [](BenchmarkState& state)
+    {
+        VulkanFixture& fixture = GetFixture();
+        std::vector<Buffer<InstanceData>> buffers =
+            CreateInstanceBuffers(fixture.device);
+        Descriptors descriptors(
+            fixture.device, fixture.layouts, buffers, MAX_FRAMES_IN_FLIGHT);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            state.PauseTiming();
+            std::vector<Shader> shaders = LoadSceneShader(fixture);
+            state.ResumeTiming();
+            GraphicsPipeline pipeline(
+                fixture.device, fixture.layouts, fixture.renderPass,
+                descriptors, std::move(shaders));
+            DoNotOptimize(&pipeline);
+        }
+    });
+
+// the cache is warmed before timing, the second launch of the game
+BENCHMARK(
+    "Vulkan/GraphicsPipeline/warm cache",
+    [](BenchmarkState& state)
+    {
+        VulkanFixture& fixture = GetFixture();
+        std::vector<Buffer<InstanceData>> buffers =
+            CreateInstanceBuffers(fixture.device);
+        Descriptors descriptors(
+            fixture.device, fixture.layouts, buffers, MAX_FRAMES_IN_FLIGHT);
+        vk::raii::PipelineCache cache(
+            fixture.device.Get(), vk::PipelineCacheCreateInfo());
+        GraphicsPipeline warmup(
+            fixture.device, fixture.layouts, fixture.renderPass, descriptors,
+            LoadSceneShader(fixture), &cache);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            state.PauseTiming();
+            std::vector<Shader> shaders = LoadSceneShader(fixture);
+            state.ResumeTiming();
+            GraphicsPipeline pipeline(
+                fixture.device, fixture.layouts, fixture.renderPass,
+                descriptors, std::move(shaders), &cache);
+            DoNotOptimize(&pipeline);
+        }
+    });
+
+// a frame nothing has changed in. once each frame in flight and swapchain
+// image has been recorded, the command cache resubmits them as they are.
+// waiting for the frame's fence is not timed, so with a software driver
+// this is the cpu cost of Render on a cache hit
+BENCHMARK(
+    "Vulkan/Video::Render/resubmit",
+    [](BenchmarkState& state)
+    {
+        Video& video = GetHeadlessVideo();
+        video.SetViewRotation(0.0f);
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            state.PauseTiming();
+            video.GetFrameArena();
+            state.ResumeTiming();
+            video.Render();
+        }
+    });
+
+// the view rotation alternates every frame, so each one misses the command
+// cache and is recorded and submitted in full, the number the single Render
+// benchmark measured before the cache
+BENCHMARK(
+    "Vulkan/Video::Render/record",
+    [](BenchmarkState& state)
+    {
+        Video& video = GetHeadlessVideo();
+        for (uint64_t i = 0; i < state.GetIterations(); i++)
+        {
+            state.PauseTiming();
+            video.GetFrameArena();
+            video.SetViewRotation(i % 2 == 0 ? 1.0f : 0.0f);
+            state.ResumeTiming();
+            video.Render();
+        }
+    });
@@ -0,0 +1,26 @@
+#version 450
+
+layout(location = 0) in vec2 fragCell;
+layout(location = 1) in vec4 fragColor;
+layout(location = 2) flat in uint fragGlyph;
+
+layout(location = 0) out vec4 outColor;
+
+// matches HUD_SOLID in Hud.hpp
+const uint SOLID = 0xffffffffu;
+
+// 8 rows per glyph, the leftmost pixel in bit 4
+layout(std430, set = 0, binding = 1) readonly buffer fontBlock {
+    uint rows[];
+};
+
+void main() {
+    if (fragGlyph != SOLID) {
+        ivec2 cell = min(ivec2(fragCell), ivec2(5, 7));
+        uint row = rows[fragGlyph * 8u + uint(cell.y)];
+        if (cell.x > 4 || ((row >> (4 - cell.x)) & 1u) == 0u) {
+            discard;
+        }
+    }
+    outColor = fragColor;
+}
@@ -0,0 +1,38 @@
+#version 450
+
+layout(location = 0) out vec2 fragCell;
+layout(location = 1) out vec4 fragColor;
+layout(location = 2) flat out uint fragGlyph;
+
+// matches HudConstants in Hud.hpp
+layout(push_constant) uniform constants {
+    vec2 pixelToClip;
+};
+
+// matches HudQuad in Hud.hpp
+struct Quad {
+    vec2 position;
+    vec2 size;
+    uint color;
+    uint glyph;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer quadBlock {
+    Quad quads[];
+};
+
+// two triangles per quad, no vertex or index buffer
+const vec2 corners[6] = vec2[](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0),
+    vec2(0.0, 1.0), vec2(1.0, 0.0), vec2(1.0, 1.0));
+
+void main() {
+    Quad quad = quads[gl_VertexIndex / 6];
+    vec2 corner = corners[gl_VertexIndex % 6];
+    vec2 pixel = quad.position + corner * quad.size;
+    gl_Position = vec4(pixel * pixelToClip - 1.0, 0.0, 1.0);
+    // glyphs are 5x7 in a 6x8 cell
+    fragCell = corner * vec2(6.0, 8.0);
+    fragColor = unpackUnorm4x8(quad.color);
+    fragGlyph = quad.glyph;
+}
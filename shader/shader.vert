@@ -5,11 +5,24 @@ layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 fragColor;
 
-layout(set = 0, binding = 0) uniform block {
+// matches DrawConstants in PushConstants.hpp
+layout(push_constant) uniform constants {
     mat2 rotation;
     float colorRotation;
 };
 
+// matches InstanceData in Transforms.hpp
+struct Instance {
+    mat2 basis;
+    vec2 translation;
+    float rotation;
+    float padding;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer instanceBlock {
+    Instance instances[];
+};
+
 // via chatgpt
 vec3 hsv2rgb(vec3 c) {
     vec4 K = vec4(1.0, 2.0 / 3.0, 1.0 / 3.0, 3.0);
@@ -18,6 +31,9 @@ vec3 hsv2rgb(vec3 c) {
 }
 
 void main() {
-    gl_Position = vec4(rotation*inPosition, 0.0, 1.0);
-    fragColor = hsv2rgb(vec3(colorRotation/360.0, 1.0, 1.0));
+    Instance instance = instances[gl_InstanceIndex];
+    vec2 position = instance.basis * inPosition + instance.translation;
+    gl_Position = vec4(rotation * position, 0.0, 1.0);
+    float hue = instance.rotation / 6.2831853 + colorRotation / 360.0;
+    fragColor = hsv2rgb(vec3(hue, 1.0, 1.0));
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#version 450
+
+layout(location = 0) in vec2 fragPixel;
+layout(location = 1) flat in uint fragTile;
+
+layout(location = 0) out vec4 outColor;
+
+// rgba8 texels, red in the low byte, rows top to bottom
+layout(std430, set = 0, binding = 2) readonly buffer atlasBlock {
+    uint texels[];
+};
+
+// match TilemapRenderer.hpp
+const uint ATLAS_TILE_PIXELS = 16u;
+const uint ATLAS_COLUMNS = 16u;
+const uint ATLAS_PIXELS = ATLAS_TILE_PIXELS * ATLAS_COLUMNS;
+
+void main() {
+    // nearest texel, tiles are pixel art
+    uvec2 pixel = min(uvec2(fragPixel), uvec2(ATLAS_TILE_PIXELS - 1u));
+    // ids past the end of the atlas wrap around
+    uint tile = fragTile % (ATLAS_COLUMNS * ATLAS_COLUMNS);
+    uvec2 origin =
+        uvec2(tile % ATLAS_COLUMNS, tile / ATLAS_COLUMNS) * ATLAS_TILE_PIXELS;
+    uvec2 texel = origin + pixel;
+    vec4 color = unpackUnorm4x8(texels[texel.y * ATLAS_PIXELS + texel.x]);
+    // cut out, nothing is sorted for blending
+    if (color.a < 0.5) {
+        discard;
+    }
+    outColor = vec4(color.rgb, 1.0);
+}
@@ -0,0 +1,56 @@
+#version 450
+
+layout(location = 0) out vec2 fragPixel;
+layout(location = 1) flat out uint fragTile;
+
+// matches DrawConstants in PushConstants.hpp
+layout(push_constant) uniform constants {
+    mat2 rotation;
+    float colorRotation;
+};
+
+// matches ChunkInstance in TilemapRenderer.hpp
+struct Chunk {
+    vec2 origin;
+    uint slot;
+    uint padding;
+};
+
+layout(std430, set = 0, binding = 0) readonly buffer chunkBlock {
+    Chunk chunks[];
+};
+
+// two 16 bit tile ids per element, the lower one first
+layout(std430, set = 0, binding = 1) readonly buffer tileBlock {
+    uint tiles[];
+};
+
+// match Tilemap.hpp and TilemapRenderer.hpp
+const uint CHUNK_TILES = 32u;
+const uint TILES_PER_CHUNK = CHUNK_TILES * CHUNK_TILES;
+const float TILE_SIZE = 1.0 / 16.0;
+const float ATLAS_TILE_PIXELS = 16.0;
+
+const vec2 corners[6] = vec2[](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0),
+    vec2(0.0, 1.0), vec2(1.0, 0.0), vec2(1.0, 1.0));
+
+void main() {
+    Chunk chunk = chunks[gl_InstanceIndex];
+    uint tile = uint(gl_VertexIndex) / 6u;
+    uint index = chunk.slot * TILES_PER_CHUNK + tile;
+    uint id = (tiles[index / 2u] >> ((index & 1u) * 16u)) & 0xffffu;
+    fragTile = id;
+    if (id == 0u) {
+        // every corner in the same spot, the triangles have no area
+        gl_Position = vec4(-2.0, -2.0, 0.0, 1.0);
+        fragPixel = vec2(0.0);
+        return;
+    }
+
+    vec2 corner = corners[gl_VertexIndex % 6];
+    vec2 cell = vec2(tile % CHUNK_TILES, tile / CHUNK_TILES);
+    vec2 position = chunk.origin + (cell + corner) * TILE_SIZE;
+    gl_Position = vec4(rotation * position, 0.0, 1.0);
+    fragPixel = corner * ATLAS_TILE_PIXELS;
+}
@@ -0,0 +1,43 @@
+#include "Allocators.hpp"
+#include "Test.hpp"
+#include <cstdint>
+
+namespace
+{
+    bool IsAligned(const void* pointer, size_t alignment)
+    {
+        return reinterpret_cast<uintptr_t>(pointer) % alignment == 0;
+    }
+}
+
+TEST(
+    "LinearArena/OverAligned",
+    [](TestState& state)
+    {
+        LinearArena arena(4096);
+        // an odd sized allocation first, so the offset alone being a
+        // multiple of 64 says nothing about the address
+        CHECK(arena.allocate(3, 1) != nullptr);
+        for (int i = 0; i < 8; i++)
+        {
+            void* pointer = arena.allocate(24, 64);
+            CHECK(IsAligned(pointer, 64));
+        }
+        void* page = arena.allocate(16, 256);
+        CHECK(IsAligned(page, 256));
+        CHECK(arena.GetOverflowBytes() == 0);
+    });
+
+TEST(
+    "LinearArena/OverflowAligned",
+    [](TestState& state)
+    {
+        LinearArena arena(128);
+        CHECK(arena.allocate(100, 1) != nullptr);
+        // does not fit once aligned, has to come from upstream
+        void* pointer = arena.allocate(64, 64);
+        CHECK(IsAligned(pointer, 64));
+        CHECK(arena.GetOverflowBytes() == 64);
+        arena.Reset();
+        CHECK(arena.GetUsed() == 0);
+    });
@@ -0,0 +1,183 @@
+#include "Collision.hpp"
+#include "Test.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace
+{
+    constexpr float BAND_HEIGHT = 4.0f;
+    // more than one BROADPHASE_BLOCK_SIZE, so the sweep splits into jobs
+    constexpr size_t BODY_COUNT = 6000;
+    constexpr int TICKS = 12;
+
+    // a random world run through the broadphase tick by tick, with the
+    // boxes kept alongside for the brute force check
+    class World
+    {
+    public:
+        World(uint32_t seed) : m_Random(seed)
+        {
+            m_Bodies.resize(BODY_COUNT);
+            for (uint32_t i = 0; i < BODY_COUNT; i++)
+            {
+                Insert(i);
+            }
+        }
+
+        // everything moves a little, some bodies jump across bands, and
+        // some are removed and others inserted, so freed proxies get reused
+        void Tick(int tick)
+        {
+            std::uniform_real_distribution<float> drift(-0.3f, 0.3f);
+            std::uniform_real_distribution<float> jump(-40.0f, 40.0f);
+            std::uniform_int_distribution<int> roll(0, 99);
+            for (uint32_t i = 0; i < BODY_COUNT; i++)
+            {
+                Body& body = m_Bodies[i];
+                int dice = roll(m_Random);
+                if (body.alive && dice < 4)
+                {
+                    m_Broadphase.Remove(body.proxy);
+                    body.alive = false;
+                    continue;
+                }
+                if (!body.alive)
+                {
+                    if (dice < 30)
+                    {
+                        Insert(i);
+                    }
+                    continue;
+                }
+                glm::vec2 offset(drift(m_Random), drift(m_Random));
+                if (dice < 4 + tick % 3 * 5)
+                {
+                    offset = {jump(m_Random), jump(m_Random)};
+                }
+                body.bounds = {
+                    body.bounds.min + offset, body.bounds.max + offset};
+                m_Broadphase.Update(body.proxy, body.bounds);
+            }
+        }
+
+        std::vector<CollisionPair> FindPairs(JobSystem& jobs)
+        {
+            std::vector<CollisionPair> pairs;
+            m_Broadphase.FindPairs(jobs, pairs);
+            return pairs;
+        }
+
+        std::vector<CollisionPair> FindPairsBruteForce() const
+        {
+            std::vector<CollisionPair> pairs;
+            for (uint32_t i = 0; i < BODY_COUNT; i++)
+            {
+                const Body& a = m_Bodies[i];
+                for (uint32_t j = i + 1; j < BODY_COUNT && a.alive; j++)
+                {
+                    const Body& b = m_Bodies[j];
+                    if (b.alive && a.bounds.min.x <= b.bounds.max.x &&
+                        a.bounds.max.x >= b.bounds.min.x &&
+                        a.bounds.min.y <= b.bounds.max.y &&
+                        a.bounds.max.y >= b.bounds.min.y)
+                    {
+                        pairs.push_back({i, j});
+                    }
+                }
+            }
+            return pairs;
+        }
+
+        size_t GetAliveCount() const
+        {
+            return std::count_if(
+                m_Bodies.begin(), m_Bodies.end(),
+                [](const Body& body) { return body.alive; });
+        }
+
+    private:
+        struct Body
+        {
+            Aabb bounds{};
+            CollisionProxy proxy = 0;
+            bool alive = false;
+        };
+
+        // mostly small boxes, every 40th is taller than several bands and
+        // every 7th starts right across a band edge
+        void Insert(uint32_t i)
+        {
+            std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+            std::uniform_real_distribution<float> extent(0.1f, 1.5f);
+            std::uniform_real_distribution<float> tall(
+                BAND_HEIGHT, BAND_HEIGHT * 5.0f);
+            glm::vec2 center(position(m_Random), position(m_Random));
+            glm::vec2 extents(
+                extent(m_Random),
+                i % 40 == 0 ? tall(m_Random) : extent(m_Random));
+            if (i % 7 == 0)
+            {
+                center.y = std::round(center.y / BAND_HEIGHT) * BAND_HEIGHT;
+            }
+            Body& body = m_Bodies[i];
+            body.bounds = {center - extents, center + extents};
+            body.proxy = m_Broadphase.Insert(body.bounds, i);
+            body.alive = true;
+        }
+
+        std::mt19937 m_Random;
+        Broadphase m_Broadphase{BAND_HEIGHT};
+        std::vector<Body> m_Bodies;
+    };
+
+    bool PairLess(const CollisionPair& x, const CollisionPair& y)
+    {
+        return x.a < y.a || (x.a == y.a && x.b < y.b);
+    }
+}
+
+TEST(
+    "Broadphase/MatchesBruteForce",
+    [](TestState& state)
+    {
+        JobSystem jobs;
+        World world(1234);
+        for (int tick = 0; tick < TICKS; tick++)
+        {
+            std::vector<CollisionPair> pairs = world.FindPairs(jobs);
+            std::vector<CollisionPair> expected = world.FindPairsBruteForce();
+            CHECK(!expected.empty());
+            for (const CollisionPair& pair : pairs)
+            {
+                CHECK(pair.a < pair.b);
+            }
+            std::sort(pairs.begin(), pairs.end(), PairLess);
+            CHECK(
+                std::adjacent_find(pairs.begin(), pairs.end()) == pairs.end());
+            CHECK(pairs == expected);
+            world.Tick(tick);
+        }
+        CHECK(world.GetAliveCount() < BODY_COUNT);
+    });
+
+TEST(
+    "Broadphase/Deterministic",
+    [](TestState& state)
+    {
+        // the same ticks on a single worker and on every worker, pairs have
+        // to come out in the same order however the blocks were scheduled
+        JobSystem serial(1);
+        JobSystem parallel;
+        World a(99);
+        World b(99);
+        for (int tick = 0; tick < TICKS; tick++)
+        {
+            std::vector<CollisionPair> pairs = a.FindPairs(serial);
+            CHECK(pairs == b.FindPairs(parallel));
+            // nothing changed in between
+            CHECK(pairs == a.FindPairs(parallel));
+            a.Tick(tick);
+            b.Tick(tick);
+        }
+    });
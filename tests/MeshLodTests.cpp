@@ -0,0 +1,267 @@
+#include "MeshLod.hpp"
+#include "MeshSimplifier.hpp"
+#include "Test.hpp"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+
+namespace
+{
+    constexpr uint32_t RINGS = 32;
+    constexpr uint32_t SEGMENTS = 128;
+
+    struct Disc
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        // the outer ring
+        std::set<uint32_t> outline;
+        // second copies of the vertices along a color seam, and the
+        // vertices they copy
+        std::set<uint32_t> seam;
+    };
+
+    // the disc MeshLodBenchmark simplifies, counter clockwise. with seam
+    // set the triangles of the last segment use copies of the first
+    // spoke's vertices in another color, the way a texture seam would
+    Disc MakeDisc(bool seam)
+    {
+        Disc disc;
+        disc.vertices.push_back({{0.0f, 0.0f}, {0.5f, 0.5f, 0.5f}});
+        for (uint32_t ring = 1; ring <= RINGS; ring++)
+        {
+            float radius = static_cast<float>(ring) / RINGS;
+            for (uint32_t segment = 0; segment < SEGMENTS; segment++)
+            {
+                float angle = 6.2831853f * segment / SEGMENTS;
+                float swirl = 0.5f + 0.5f * std::sin(5.0f * angle + radius);
+                disc.vertices.push_back(
+                    {{radius * std::cos(angle), radius * std::sin(angle)},
+                     {swirl, 0.5f, 1.0f - swirl}});
+            }
+        }
+        uint32_t firstCopy = static_cast<uint32_t>(disc.vertices.size());
+        if (seam)
+        {
+            for (uint32_t ring = 1; ring <= RINGS; ring++)
+            {
+                uint32_t original = 1 + (ring - 1) * SEGMENTS;
+                disc.vertices.push_back(
+                    {disc.vertices[original].pos, {1.0f, 0.0f, 0.0f}});
+                disc.seam.insert({original, firstCopy + ring - 1});
+            }
+        }
+        auto at = [&](uint32_t ring, uint32_t segment)
+        {
+            if (ring == 0)
+            {
+                return 0u;
+            }
+            if (seam && segment == SEGMENTS)
+            {
+                return firstCopy + ring - 1;
+            }
+            return 1 + (ring - 1) * SEGMENTS + segment % SEGMENTS;
+        };
+        for (uint32_t segment = 0; segment < SEGMENTS; segment++)
+        {
+            disc.indices.insert(
+                disc.indices.end(), {0u, at(1, segment), at(1, segment + 1)});
+            disc.outline.insert(at(RINGS, segment));
+        }
+        disc.outline.insert(at(RINGS, SEGMENTS));
+        for (uint32_t ring = 1; ring < RINGS; ring++)
+        {
+            for (uint32_t segment = 0; segment < SEGMENTS; segment++)
+            {
+                uint32_t a = at(ring, segment);
+                uint32_t b = at(ring, segment + 1);
+                uint32_t c = at(ring + 1, segment);
+                uint32_t d = at(ring + 1, segment + 1);
+                disc.indices.insert(disc.indices.end(), {a, c, d, a, d, b});
+            }
+        }
+        return disc;
+    }
+
+    std::span<const uint32_t> GetLevel(const LodChain& chain, uint32_t level)
+    {
+        const MeshLod& lod = chain.lods[level];
+        return std::span(chain.indices).subspan(lod.firstIndex, lod.indexCount);
+    }
+
+    float SignedArea(
+        const std::vector<Vertex>& vertices, uint32_t a, uint32_t b,
+        uint32_t c)
+    {
+        glm::vec2 p = vertices[a].pos.Unpack();
+        glm::vec2 q = vertices[b].pos.Unpack();
+        glm::vec2 r = vertices[c].pos.Unpack();
+        return (q.x - p.x) * (r.y - p.y) - (q.y - p.y) * (r.x - p.x);
+    }
+
+    // edges used by one triangle only, by position so the seam between two
+    // copies does not count
+    std::set<std::pair<uint32_t, uint32_t>> FindBoundaryEdges(
+        const Disc& disc, std::span<const uint32_t> indices)
+    {
+        std::map<uint32_t, uint32_t> canonical;
+        for (uint32_t vertex = 0; vertex < disc.vertices.size(); vertex++)
+        {
+            const Half2& pos = disc.vertices[vertex].pos;
+            uint32_t key = static_cast<uint32_t>(pos.x) |
+                           static_cast<uint32_t>(pos.y) << 16;
+            canonical.emplace(key, vertex);
+        }
+        auto position = [&](uint32_t vertex)
+        {
+            const Half2& pos = disc.vertices[vertex].pos;
+            return canonical.at(
+                static_cast<uint32_t>(pos.x) |
+                static_cast<uint32_t>(pos.y) << 16);
+        };
+
+        std::multiset<std::pair<uint32_t, uint32_t>> edges;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            for (size_t corner = 0; corner < 3; corner++)
+            {
+                edges.insert(
+                    {position(indices[i + corner]),
+                     position(indices[i + (corner + 1) % 3])});
+            }
+        }
+        std::set<std::pair<uint32_t, uint32_t>> boundary;
+        for (const auto& [from, to] : edges)
+        {
+            if (!edges.contains({to, from}))
+            {
+                boundary.insert({from, to});
+            }
+        }
+        return boundary;
+    }
+}
+
+TEST(
+    "MeshLod/ChainShrinks",
+    [](TestState& state)
+    {
+        Disc disc = MakeDisc(false);
+        LodChain chain = BuildLodChain(disc.vertices, disc.indices);
+        CHECK(chain.lods.size() > 2);
+        CHECK(chain.lods.size() <= MAX_MESH_LODS);
+        CHECK(chain.lods[0].indexCount == disc.indices.size());
+        CHECK(chain.lods[0].error == 0.0f);
+
+        uint32_t next = 0;
+        for (uint32_t level = 0; level < chain.lods.size(); level++)
+        {
+            const MeshLod& lod = chain.lods[level];
+            CHECK(lod.firstIndex == next);
+            CHECK(lod.indexCount % 3 == 0);
+            CHECK(lod.indexCount > 0);
+            next = lod.firstIndex + lod.indexCount;
+            if (level > 0)
+            {
+                CHECK(lod.indexCount < chain.lods[level - 1].indexCount);
+                CHECK(lod.error >= chain.lods[level - 1].error);
+            }
+        }
+        CHECK(next == chain.indices.size());
+        for (uint32_t index : chain.indices)
+        {
+            CHECK(index < disc.vertices.size());
+        }
+    });
+
+TEST(
+    "MeshLod/NoFlips",
+    [](TestState& state)
+    {
+        Disc disc = MakeDisc(true);
+        LodChain chain = BuildLodChain(disc.vertices, disc.indices);
+        for (uint32_t level = 0; level < chain.lods.size(); level++)
+        {
+            std::span<const uint32_t> indices = GetLevel(chain, level);
+            size_t flipped = 0;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                flipped += SignedArea(
+                               disc.vertices, indices[i], indices[i + 1],
+                               indices[i + 2]) <= 0.0f;
+            }
+            CHECK(flipped == 0);
+        }
+    });
+
+TEST(
+    "MeshLod/CollapsedVerticesStayGone",
+    [](TestState& state)
+    {
+        Disc disc = MakeDisc(true);
+        LodChain chain = BuildLodChain(disc.vertices, disc.indices);
+        CHECK(chain.lods.size() > 2);
+        std::set<uint32_t> previous(disc.indices.begin(), disc.indices.end());
+        for (uint32_t level = 1; level < chain.lods.size(); level++)
+        {
+            std::span<const uint32_t> indices = GetLevel(chain, level);
+            std::set<uint32_t> used(indices.begin(), indices.end());
+            // each level is simplified from the one before, nothing it
+            // collapsed comes back
+            CHECK(std::includes(
+                previous.begin(), previous.end(), used.begin(), used.end()));
+            // seam vertices never move
+            CHECK(std::includes(
+                used.begin(), used.end(), disc.seam.begin(), disc.seam.end()));
+            // boundary vertices only slide along the outline, so every
+            // boundary edge left joins two vertices of it
+            for (const auto& [from, to] : FindBoundaryEdges(disc, indices))
+            {
+                CHECK(disc.outline.contains(from));
+                CHECK(disc.outline.contains(to));
+            }
+            previous = std::move(used);
+        }
+    });
+
+TEST(
+    "MeshLod/SelectLodHysteresis",
+    [](TestState& state)
+    {
+        Disc disc = MakeDisc(false);
+        LodChain chain = BuildLodChain(disc.vertices, disc.indices);
+        CHECK(chain.lods.size() > 2);
+        LodSelection selection;
+        // where level 1 starts being allowed
+        float threshold = selection.maxPixelError / chain.lods[1].error;
+
+        // wobbling around the threshold from the full mesh never coarsens
+        uint32_t level = SelectLod(chain.lods, threshold * 1.01f, 0);
+        CHECK(level == 0);
+        for (int frame = 0; frame < 100; frame++)
+        {
+            float wobble = frame % 2 == 0 ? 0.99f : 1.01f;
+            level = SelectLod(chain.lods, threshold * wobble, level);
+            CHECK(level == 0);
+        }
+
+        // once coarsened, the same wobble switches back at most once
+        level = SelectLod(chain.lods, threshold * 0.5f, 0);
+        CHECK(level >= 1);
+        level = SelectLod(chain.lods, threshold * 0.99f, level);
+        CHECK(level == 1);
+        int switches = 0;
+        for (int frame = 0; frame < 100; frame++)
+        {
+            float wobble = frame % 2 == 0 ? 1.01f : 0.99f;
+            uint32_t next = SelectLod(chain.lods, threshold * wobble, level);
+            switches += next != level;
+            level = next;
+        }
+        CHECK(switches <= 1);
+
+        // too close for anything but the full mesh
+        CHECK(SelectLod(chain.lods, threshold * 2.0f, level) == 0);
+    });
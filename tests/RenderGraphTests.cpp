@@ -0,0 +1,72 @@
+#include "RenderGraph.hpp"
+#include "Test.hpp"
+#include <functional>
+
+namespace
+{
+    constexpr vk::Format FORMAT = vk::Format::eB8G8R8A8Unorm;
+    constexpr vk::Extent2D EXTENT{64, 64};
+
+    using OverlaySetup =
+        std::function<void(RenderGraph::PassBuilder&, RenderResource)>;
+
+    // the frame Video builds, scene into a transient, upscale into the
+    // backbuffer and an overlay on top of it
+    void AddFrame(RenderGraph& graph, const OverlaySetup& overlaySetup)
+    {
+        RenderResource backbuffer = graph.ImportImage(
+            "backbuffer", FORMAT, EXTENT, vk::ImageLayout::ePresentSrcKHR);
+        RenderResource scene = graph.CreateImage("scene", FORMAT, EXTENT);
+        auto record = [](vk::raii::CommandBuffer&) {};
+        graph.AddPass(
+            "scene",
+            [=](RenderGraph::PassBuilder& builder)
+            { builder.Write(scene, ResourceUsage::ColorAttachment); },
+            record);
+        graph.AddPass(
+            "upscale",
+            [=](RenderGraph::PassBuilder& builder)
+            {
+                builder.Read(scene, ResourceUsage::TransferSrc);
+                builder.Write(backbuffer, ResourceUsage::TransferDst);
+            },
+            record);
+        graph.AddPass(
+            "overlay",
+            [=](RenderGraph::PassBuilder& builder)
+            { overlaySetup(builder, backbuffer); },
+            record);
+    }
+}
+
+TEST(
+    "RenderGraph/LoadKeepsWriter",
+    [](TestState& state)
+    {
+        RenderGraph graph;
+        AddFrame(
+            graph,
+            [](RenderGraph::PassBuilder& builder, RenderResource backbuffer)
+            {
+                builder.Read(backbuffer, ResourceUsage::ColorAttachment);
+                builder.Write(backbuffer, ResourceUsage::ColorAttachment);
+            });
+        graph.Schedule();
+        CHECK(graph.GetPassCount() == 3);
+        CHECK(graph.GetCulledPassCount() == 0);
+    });
+
+TEST(
+    "RenderGraph/OverwriteCullsWriter",
+    [](TestState& state)
+    {
+        // a pass that only writes replaces the contents, nothing upstream
+        // of it is seen
+        RenderGraph graph;
+        AddFrame(
+            graph,
+            [](RenderGraph::PassBuilder& builder, RenderResource backbuffer)
+            { builder.Write(backbuffer, ResourceUsage::ColorAttachment); });
+        graph.Schedule();
+        CHECK(graph.GetCulledPassCount() == 2);
+    });
@@ -0,0 +1,66 @@
+#include "Test.hpp"
+#include <exception>
+#include <fmt/core.h>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+    struct RegisteredTest
+    {
+        std::string name;
+        TestFunction function;
+    };
+
+    std::vector<RegisteredTest>& GetTests()
+    {
+        static std::vector<RegisteredTest> tests;
+        return tests;
+    }
+}
+
+TestRegistration::TestRegistration(
+    const std::string& name, TestFunction function)
+{
+    GetTests().push_back({name, function});
+}
+
+void TestState::Fail(const char* expression, const char* file, int line)
+{
+    fmt::print("  {}:{}: CHECK({}) failed\n", file, line, expression);
+    m_Failures++;
+}
+
+// tests [filter]
+//
+// runs every test whose name contains filter, exits with the number of
+// failed tests. an exception out of a test fails it
+int main(int argc, char** argv)
+{
+    std::string_view filter = argc > 1 ? argv[1] : "";
+    int failed = 0;
+    int run = 0;
+    for (RegisteredTest& test : GetTests())
+    {
+        if (!filter.empty() && test.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        run++;
+
+        TestState state;
+        try
+        {
+            test.function(state);
+        }
+        catch (const std::exception& e)
+        {
+            fmt::print("  threw: {}\n", e.what());
+            state.Fail("no exception", __FILE__, __LINE__);
+        }
+        fmt::print("{} {}\n", state.HasFailed() ? "FAIL" : "ok  ", test.name);
+        failed += state.HasFailed();
+    }
+    fmt::print("{} of {} tests failed\n", failed, run);
+    return failed;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+// minimal test harness, every registered test runs once and a failed CHECK
+// reports the expression and carries on with the next check
+
+class TestState
+{
+public:
+    void Fail(const char* expression, const char* file, int line);
+    bool HasFailed() const { return m_Failures > 0; }
+
+private:
+    int m_Failures = 0;
+};
+
+using TestFunction = std::function<void(TestState&)>;
+
+struct TestRegistration
+{
+    TestRegistration(const std::string& name, TestFunction function);
+};
+
+#define TEST_CONCAT_IMPL(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_IMPL(a, b)
+#define TEST(name, function)                                                   \
+    static TestRegistration TEST_CONCAT(s_TestRegistration, __LINE__)(         \
+        name, function)
+
+#define CHECK(expression)                                                      \
+    do                                                                         \
+    {                                                                          \
+        if (!(expression))                                                     \
+        {                                                                      \
+            state.Fail(#expression, __FILE__, __LINE__);                       \
+        }                                                                      \
+    } while (false)
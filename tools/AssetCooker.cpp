@@ -0,0 +1,391 @@
+#include "AssetPack.hpp"
+#include "Log.hpp"
+#include "MeshSimplifier.hpp"
+#include "Vertex.hpp"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vulkan/vulkan.h>
+
+// AssetCooker <output.pack> <input>...
+//
+// turns source assets into an AssetPack, the asset type follows the
+// extension:
+//   .spv                  spir-v, named after the file without .spv so
+//                         shader.vert.spv becomes shader.vert
+//   .obj                  mesh, "v x y [z] [r g b]" and "f" lines, faces are
+//                         triangulated as fans, z is dropped. cooked with a
+//                         lod chain, see BuildLodChain
+//   .png .jpg .bmp .tga   image, decoded to rgba8 srgb with a full mip chain
+// meshes and images are named after the file without its extension
+
+namespace
+{
+    struct CookedAsset
+    {
+        std::string name;
+        AssetType type;
+        std::array<uint32_t, 5> parameters{};
+        std::vector<std::byte> data;
+    };
+
+    std::vector<std::byte> ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open())
+        {
+            LogError(fmt::format("Could not open {}", path.string()));
+        }
+        std::vector<std::byte> data(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), data.size());
+        return data;
+    }
+
+    template <typename T>
+    void Append(std::vector<std::byte>& data, std::span<const T> values)
+    {
+        const std::byte* bytes =
+            reinterpret_cast<const std::byte*>(values.data());
+        data.insert(data.end(), bytes, bytes + values.size_bytes());
+    }
+
+    CookedAsset CookShader(const std::filesystem::path& path)
+    {
+        CookedAsset asset;
+        asset.name = path.stem().string();
+        asset.type = AssetType::Shader;
+        asset.data = ReadFile(path);
+        if (asset.data.size() % 4 != 0 || asset.data.size() < 4 ||
+            *reinterpret_cast<const uint32_t*>(asset.data.data()) != 0x07230203)
+        {
+            LogError(fmt::format("{} is not spir-v", path.string()));
+        }
+        return asset;
+    }
+
+    CookedAsset CookMesh(const std::filesystem::path& path)
+    {
+        std::ifstream file(path);
+        if (!file.is_open())
+        {
+            LogError(fmt::format("Could not open {}", path.string()));
+        }
+
+        std::vector<Vertex> meshVertices;
+        std::vector<uint32_t> indices;
+        std::string line;
+        while (std::getline(file, line))
+        {
+            std::istringstream stream(line);
+            std::string keyword;
+            stream >> keyword;
+            if (keyword == "v")
+            {
+                std::vector<float> values;
+                float value;
+                while (stream >> value)
+                {
+                    values.push_back(value);
+                }
+                Vertex vertex{{0.0f, 0.0f}, {1.0f, 1.0f, 1.0f}};
+                if (values.size() >= 2)
+                {
+                    vertex.pos = {values[0], values[1]};
+                }
+                if (values.size() >= 6)
+                {
+                    vertex.color = {values[3], values[4], values[5]};
+                }
+                meshVertices.push_back(vertex);
+            }
+            else if (keyword == "f")
+            {
+                std::vector<uint32_t> face;
+                std::string corner;
+                while (stream >> corner)
+                {
+                    // v, v/vt, v//vn or v/vt/vn, only the position matters
+                    long index = std::stol(corner.substr(0, corner.find('/')));
+                    if (index < 0)
+                    {
+                        index += static_cast<long>(meshVertices.size()) + 1;
+                    }
+                    if (index < 1 ||
+                        index > static_cast<long>(meshVertices.size()))
+                    {
+                        LogError(fmt::format(
+                            "{} has an out of range face index",
+                            path.string()));
+                    }
+                    face.push_back(static_cast<uint32_t>(index - 1));
+                }
+                for (size_t i = 2; i < face.size(); i++)
+                {
+                    indices.insert(
+                        indices.end(), {face[0], face[i - 1], face[i]});
+                }
+            }
+        }
+
+        CookedAsset asset;
+        asset.name = path.stem().string();
+        asset.type = AssetType::Mesh;
+        LodChain chain = BuildLodChain(meshVertices, indices);
+        Append<Vertex>(asset.data, meshVertices);
+        // indices start 4 byte aligned, vertex sizes are multiples of 4
+        uint32_t indexOffset = static_cast<uint32_t>(asset.data.size());
+        Append<uint32_t>(asset.data, chain.indices);
+        Append<MeshLod>(asset.data, chain.lods);
+        asset.parameters = {
+            static_cast<uint32_t>(meshVertices.size()), sizeof(Vertex),
+            static_cast<uint32_t>(chain.indices.size()), indexOffset,
+            static_cast<uint32_t>(chain.lods.size())};
+        return asset;
+    }
+
+    // mips are averaged in linear space, averaging srgb values directly
+    // darkens every level
+    float ToLinear(uint8_t value)
+    {
+        float c = value / 255.0f;
+        return c <= 0.04045f ? c / 12.92f
+                             : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    uint8_t ToSrgb(float value)
+    {
+        float c = value <= 0.0031308f
+                      ? value * 12.92f
+                      : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    CookedAsset CookImage(const std::filesystem::path& path)
+    {
+        SDL_Surface* loaded = IMG_Load(path.string().c_str());
+        if (!loaded)
+        {
+            LogError(fmt::format(
+                "Could not load {}: {}", path.string(), IMG_GetError()));
+        }
+        SDL_Surface* surface =
+            SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+        SDL_FreeSurface(loaded);
+        if (!surface)
+        {
+            LogError(fmt::format(
+                "Could not convert {}: {}", path.string(), SDL_GetError()));
+        }
+
+        uint32_t width = static_cast<uint32_t>(surface->w);
+        uint32_t height = static_cast<uint32_t>(surface->h);
+        std::vector<uint8_t> level(width * height * 4);
+        for (uint32_t y = 0; y < height; y++)
+        {
+            std::memcpy(
+                level.data() + y * width * 4,
+                static_cast<const uint8_t*>(surface->pixels) +
+                    y * surface->pitch,
+                width * 4);
+        }
+        SDL_FreeSurface(surface);
+
+        CookedAsset asset;
+        asset.name = path.stem().string();
+        asset.type = AssetType::Image;
+        uint32_t mipLevels = 1;
+        Append<uint8_t>(asset.data, level);
+
+        uint32_t levelWidth = width;
+        uint32_t levelHeight = height;
+        while (levelWidth > 1 || levelHeight > 1)
+        {
+            uint32_t nextWidth = std::max(levelWidth / 2, 1u);
+            uint32_t nextHeight = std::max(levelHeight / 2, 1u);
+            std::vector<uint8_t> next(nextWidth * nextHeight * 4);
+            for (uint32_t y = 0; y < nextHeight; y++)
+            {
+                for (uint32_t x = 0; x < nextWidth; x++)
+                {
+                    // 2x2 box, clamped for odd and 1 texel wide levels
+                    uint32_t x0 = std::min(x * 2, levelWidth - 1);
+                    uint32_t x1 = std::min(x * 2 + 1, levelWidth - 1);
+                    uint32_t y0 = std::min(y * 2, levelHeight - 1);
+                    uint32_t y1 = std::min(y * 2 + 1, levelHeight - 1);
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        auto texel = [&](uint32_t tx, uint32_t ty)
+                        { return level[(ty * levelWidth + tx) * 4 + c]; };
+                        uint8_t* out = &next[(y * nextWidth + x) * 4 + c];
+                        if (c == 3)
+                        {
+                            // alpha is linear already
+                            *out = static_cast<uint8_t>(
+                                (texel(x0, y0) + texel(x1, y0) +
+                                 texel(x0, y1) + texel(x1, y1) + 2) /
+                                4);
+                            continue;
+                        }
+                        *out = ToSrgb(
+                            (ToLinear(texel(x0, y0)) + ToLinear(texel(x1, y0)) +
+                             ToLinear(texel(x0, y1)) +
+                             ToLinear(texel(x1, y1))) *
+                            0.25f);
+                    }
+                }
+            }
+            Append<uint8_t>(asset.data, next);
+            level = std::move(next);
+            levelWidth = nextWidth;
+            levelHeight = nextHeight;
+            mipLevels++;
+        }
+
+        asset.parameters = {
+            width, height, mipLevels,
+            static_cast<uint32_t>(VK_FORMAT_R8G8B8A8_SRGB), 0};
+        return asset;
+    }
+
+    CookedAsset Cook(const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().string();
+        std::transform(
+            extension.begin(), extension.end(), extension.begin(),
+            [](unsigned char c) { return std::tolower(c); });
+
+        if (extension == ".spv")
+        {
+            return CookShader(path);
+        }
+        if (extension == ".obj")
+        {
+            return CookMesh(path);
+        }
+        if (extension == ".png" || extension == ".jpg" ||
+            extension == ".jpeg" || extension == ".bmp" || extension == ".tga")
+        {
+            return CookImage(path);
+        }
+        LogError(fmt::format("Dont know how to cook {}", path.string()));
+        return {};
+    }
+
+    void Pad(std::vector<std::byte>& file, uint64_t alignment)
+    {
+        file.resize((file.size() + alignment - 1) / alignment * alignment);
+    }
+
+    void WritePack(
+        const std::filesystem::path& output, std::vector<CookedAsset>& assets)
+    {
+        // sorted by name first so the same inputs always give the same file
+        std::sort(
+            assets.begin(), assets.end(),
+            [](const CookedAsset& a, const CookedAsset& b)
+            { return a.name < b.name; });
+        for (size_t i = 1; i < assets.size(); i++)
+        {
+            if (assets[i].name == assets[i - 1].name)
+            {
+                LogError(fmt::format("Duplicate asset {}", assets[i].name));
+            }
+        }
+
+        std::vector<std::byte> file(sizeof(PackHeader));
+        std::vector<PackEntry> entries;
+        std::string strings;
+        for (const CookedAsset& asset : assets)
+        {
+            Pad(file, PACK_ALIGNMENT);
+            PackEntry entry{};
+            entry.nameHash = HashAssetName(asset.name);
+            entry.nameOffset = static_cast<uint32_t>(strings.size());
+            entry.nameLength = static_cast<uint32_t>(asset.name.size());
+            entry.type = asset.type;
+            std::copy(
+                asset.parameters.begin(), asset.parameters.end(),
+                entry.parameters);
+            entry.offset = file.size();
+            entry.size = asset.data.size();
+            entries.push_back(entry);
+
+            strings += asset.name;
+            file.insert(file.end(), asset.data.begin(), asset.data.end());
+        }
+
+        std::stable_sort(
+            entries.begin(), entries.end(),
+            [](const PackEntry& a, const PackEntry& b)
+            { return a.nameHash < b.nameHash; });
+
+        Pad(file, alignof(PackEntry));
+        PackHeader header{};
+        header.magic = PACK_MAGIC;
+        header.version = PACK_VERSION;
+        header.entryCount = static_cast<uint32_t>(entries.size());
+        header.tocOffset = file.size();
+        Append<PackEntry>(file, entries);
+        header.stringsOffset = file.size();
+        header.stringsSize = strings.size();
+        Append<char>(file, strings);
+        header.fileSize = file.size();
+        std::memcpy(file.data(), &header, sizeof(header));
+
+        // written next to the target and renamed, so a running game never
+        // maps a half written pack
+        std::filesystem::path temporary = output;
+        temporary += ".tmp";
+        {
+            std::ofstream stream(temporary, std::ios::binary | std::ios::trunc);
+            if (!stream.is_open())
+            {
+                LogError(fmt::format("Could not write {}", temporary.string()));
+            }
+            stream.write(
+                reinterpret_cast<const char*>(file.data()), file.size());
+        }
+        std::filesystem::rename(temporary, output);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fmt::print(std::cerr, "usage: {} <output.pack> <input>...\n", argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        std::vector<CookedAsset> assets;
+        for (int i = 2; i < argc; i++)
+        {
+            assets.push_back(Cook(argv[i]));
+        }
+        WritePack(argv[1], assets);
+
+        uint64_t total = 0;
+        for (const CookedAsset& asset : assets)
+        {
+            total += asset.data.size();
+        }
+        fmt::print(
+            "Cooked {} assets, {} bytes into {}\n", assets.size(), total,
+            argv[1]);
+    }
+    catch (std::exception& e)
+    {
+        fmt::print(std::cerr, "{}\n", e.what());
+        return 1;
+    }
+    return 0;
+}
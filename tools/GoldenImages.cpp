@@ -0,0 +1,214 @@
+#include "FrameCapture.hpp"
+#include "FrameReadback.hpp"
+#include "JobSystem.hpp"
+#include "Log.hpp"
+#include "Video.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// GoldenImages <scene dir> [--update] [--tolerance <n>] [--max-pixels <n>]
+//
+// regression test for the renderer. every capture in the scene directory,
+// made with f12 in the game or Video::StartCapture, is a scripted scene. it
+// is replayed headless with dynamic resolution off, and its last frame is
+// compared against <name>.png next to it. a pixel counts as different when
+// a channel is more than --tolerance apart (default 2), a scene fails when
+// more than --max-pixels pixels differ (default 0). failures leave
+// <name>.actual.png and <name>.diff.png behind. --update writes the golden
+// images instead. exits with the number of failed scenes
+
+namespace
+{
+    struct GoldenOptions
+    {
+        const char* directory = nullptr;
+        bool update = false;
+        uint8_t tolerance = 2;
+        uint64_t maxPixels = 0;
+    };
+
+    GoldenOptions ParseOptions(int argc, char** argv)
+    {
+        GoldenOptions options;
+        for (int i = 1; i < argc; i++)
+        {
+            if (!strcmp(argv[i], "--update"))
+            {
+                options.update = true;
+            }
+            else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc)
+            {
+                options.tolerance = static_cast<uint8_t>(
+                    std::clamp(std::stoi(argv[++i]), 0, 255));
+            }
+            else if (!strcmp(argv[i], "--max-pixels") && i + 1 < argc)
+            {
+                options.maxPixels = std::stoull(argv[++i]);
+            }
+            else if (!options.directory)
+            {
+                options.directory = argv[i];
+            }
+            else
+            {
+                LogError(fmt::format("Unknown argument {}", argv[i]));
+            }
+        }
+        if (!options.directory)
+        {
+            LogError("No scene directory given");
+        }
+        return options;
+    }
+
+    // the pixels of the scene's last frame
+    std::vector<uint8_t> RenderScene(
+        JobSystem& jobs, const CaptureReader& capture, vk::Extent2D& extent)
+    {
+        extent = capture.GetExtent();
+        Video video(
+            jobs, {{static_cast<int32_t>(extent.width),
+                    static_cast<int32_t>(extent.height)},
+                   true,
+                   false});
+        video.WaitForStartup();
+        // the scale would follow gpu time and differ from run to run
+        video.SetDynamicResolution({.enabled = false});
+
+        std::vector<uint8_t> pixels;
+        for (uint32_t frame = 0; frame < capture.GetFrameCount(); frame++)
+        {
+            capture.Replay(frame, video);
+            if (frame + 1 == capture.GetFrameCount())
+            {
+                video.RequestReadback(
+                    [&](const ReadbackImage& image)
+                    {
+                        pixels.assign(
+                            image.pixels.begin(), image.pixels.end());
+                        extent = vk::Extent2D(image.width, image.height);
+                    });
+            }
+            video.Render();
+        }
+        video.FlushReadbacks();
+        if (pixels.empty())
+        {
+            LogError("The last frame was not read back");
+        }
+        return pixels;
+    }
+
+    // true when the scene matches its golden image
+    bool RunScene(
+        JobSystem& jobs, const std::filesystem::path& path,
+        const GoldenOptions& options)
+    {
+        CaptureReader capture(path);
+        if (capture.GetFrameCount() == 0)
+        {
+            LogError(fmt::format("{} has no frames", path.string()));
+        }
+        std::filesystem::path golden =
+            std::filesystem::path(path).replace_extension(".png");
+        std::filesystem::path actualPath =
+            std::filesystem::path(path).replace_extension(".actual.png");
+        std::filesystem::path diffPath =
+            std::filesystem::path(path).replace_extension(".diff.png");
+
+        vk::Extent2D extent;
+        std::vector<uint8_t> pixels = RenderScene(jobs, capture, extent);
+        ReadbackImage actual{extent.width, extent.height, pixels};
+
+        if (options.update)
+        {
+            SavePng(actual, golden);
+            fmt::print("{}: updated\n", path.filename().string());
+            return true;
+        }
+        if (!std::filesystem::exists(golden))
+        {
+            SavePng(actual, actualPath);
+            fmt::print(
+                "{}: FAILED, no golden image\n", path.filename().string());
+            return false;
+        }
+
+        std::vector<uint8_t> expectedPixels;
+        ReadbackImage expected = LoadPng(golden, expectedPixels);
+        std::vector<uint8_t> diff;
+        ImageDifference difference =
+            CompareImages(actual, expected, options.tolerance, &diff);
+        if (!difference.comparable)
+        {
+            SavePng(actual, actualPath);
+            fmt::print(
+                "{}: FAILED, {}x{} rendered, {}x{} expected\n",
+                path.filename().string(), actual.width, actual.height,
+                expected.width, expected.height);
+            return false;
+        }
+        if (difference.pixels > options.maxPixels)
+        {
+            SavePng(actual, actualPath);
+            SavePng({actual.width, actual.height, diff}, diffPath);
+            fmt::print(
+                "{}: FAILED, {} pixels differ, by up to {}\n",
+                path.filename().string(), difference.pixels,
+                difference.maxChannel);
+            return false;
+        }
+        // a stale failure would only be confusing
+        std::filesystem::remove(actualPath);
+        std::filesystem::remove(diffPath);
+        fmt::print(
+            "{}: ok, {} pixels differ, by up to {}\n",
+            path.filename().string(), difference.pixels,
+            difference.maxChannel);
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int failed = 0;
+    try
+    {
+        GoldenOptions options = ParseOptions(argc, argv);
+
+        std::vector<std::filesystem::path> scenes;
+        for (const auto& entry :
+             std::filesystem::directory_iterator(options.directory))
+        {
+            if (entry.path().extension() == ".ufcp")
+            {
+                scenes.push_back(entry.path());
+            }
+        }
+        // stable output order between runs
+        std::sort(scenes.begin(), scenes.end());
+        if (scenes.empty())
+        {
+            LogError(fmt::format("No captures in {}", options.directory));
+        }
+
+        JobSystem jobs;
+        for (const std::filesystem::path& scene : scenes)
+        {
+            if (!RunScene(jobs, scene, options))
+            {
+                failed++;
+            }
+        }
+        fmt::print("{} of {} scenes failed\n", failed, scenes.size());
+    }
+    catch (std::exception& e)
+    {
+        fmt::print(std::cerr, "{}\n", e.what());
+        return 1;
+    }
+    return failed;
+}
@@ -0,0 +1,177 @@
+#include "FrameCapture.hpp"
+#include "JobSystem.hpp"
+#include "Log.hpp"
+#include "Video.hpp"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// ReplayCapture <capture.ufcp> [--headless] [--vsync] [--loops <n>]
+//
+// feeds a capture made with Video::StartCapture back through the renderer as
+// fast as presentation allows and prints frame time statistics, so renderer
+// changes can be compared on the exact same workload. --headless renders
+// without a window through VK_EXT_headless_surface
+
+namespace
+{
+    struct ReplayOptions
+    {
+        const char* path = nullptr;
+        bool headless = false;
+        bool vsync = false;
+        uint32_t loops = 1;
+    };
+
+    ReplayOptions ParseOptions(int argc, char** argv)
+    {
+        ReplayOptions options;
+        for (int i = 1; i < argc; i++)
+        {
+            if (!strcmp(argv[i], "--headless"))
+            {
+                options.headless = true;
+            }
+            else if (!strcmp(argv[i], "--vsync"))
+            {
+                options.vsync = true;
+            }
+            else if (!strcmp(argv[i], "--loops") && i + 1 < argc)
+            {
+                options.loops =
+                    static_cast<uint32_t>(std::max(std::stoi(argv[++i]), 1));
+            }
+            else if (!options.path)
+            {
+                options.path = argv[i];
+            }
+            else
+            {
+                LogError(fmt::format("Unknown argument {}", argv[i]));
+            }
+        }
+        if (!options.path)
+        {
+            LogError("No capture given");
+        }
+        return options;
+    }
+
+    float Percentile(std::vector<float> values, float percentile)
+    {
+        std::sort(values.begin(), values.end());
+        size_t index = static_cast<size_t>(percentile * (values.size() - 1));
+        return values[index];
+    }
+
+    // false once the window was closed
+    bool PumpEvents()
+    {
+        SDL_Event event;
+        while (SDL_PollEvent(&event))
+        {
+            if (event.type == SDL_QUIT ||
+                (event.type == SDL_WINDOWEVENT &&
+                 event.window.event == SDL_WINDOWEVENT_CLOSE))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        ReplayOptions options = ParseOptions(argc, argv);
+        CaptureReader capture(options.path);
+        if (capture.GetFrameCount() == 0)
+        {
+            LogError(fmt::format("{} has no frames", options.path));
+        }
+
+        // a headless run never touches the display, so it works without one
+        if (!options.headless && SDL_Init(SDL_INIT_VIDEO) != 0)
+        {
+            LogError(
+                fmt::format("Error initializing sdl: {}", SDL_GetError()));
+        }
+
+        JobSystem jobs;
+        vk::Extent2D extent = capture.GetExtent();
+        Video video(
+            jobs, {{static_cast<int32_t>(extent.width),
+                    static_cast<int32_t>(extent.height)},
+                   options.headless,
+                   options.vsync});
+        // loading is not part of what is measured
+        video.WaitForStartup();
+
+        std::vector<float> cpuTimes;
+        std::vector<float> gpuTimes;
+        cpuTimes.reserve(capture.GetFrameCount() * options.loops);
+        bool running = true;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t loop = 0; loop < options.loops && running; loop++)
+        {
+            for (uint32_t frame = 0; frame < capture.GetFrameCount(); frame++)
+            {
+                if (!options.headless && !PumpEvents())
+                {
+                    running = false;
+                    break;
+                }
+                auto frameStart = std::chrono::steady_clock::now();
+                capture.Replay(frame, video);
+                video.Render();
+                cpuTimes.push_back(std::chrono::duration<float, std::milli>(
+                                       std::chrono::steady_clock::now() -
+                                       frameStart)
+                                       .count());
+                gpuTimes.push_back(video.GetFrameStats().gpuTimeMs);
+            }
+        }
+        float seconds = std::chrono::duration<float>(
+                            std::chrono::steady_clock::now() - start)
+                            .count();
+
+        if (cpuTimes.empty())
+        {
+            return 0;
+        }
+        // gpu times lag a few frames behind, the first ones are still 0
+        gpuTimes.erase(
+            gpuTimes.begin(),
+            gpuTimes.begin() +
+                std::min<size_t>(MAX_FRAMES_IN_FLIGHT + 1, gpuTimes.size()));
+        fmt::print(
+            "{} frames of {}x{} in {:.2f} s, {:.1f} fps\n", cpuTimes.size(),
+            extent.width, extent.height, seconds, cpuTimes.size() / seconds);
+        fmt::print(
+            "cpu ms  median {:.3f}  p99 {:.3f}  max {:.3f}\n",
+            Percentile(cpuTimes, 0.5f), Percentile(cpuTimes, 0.99f),
+            Percentile(cpuTimes, 1.0f));
+        if (!gpuTimes.empty())
+        {
+            fmt::print(
+                "gpu ms  median {:.3f}  p99 {:.3f}  max {:.3f}\n",
+                Percentile(gpuTimes, 0.5f), Percentile(gpuTimes, 0.99f),
+                Percentile(gpuTimes, 1.0f));
+        }
+    }
+    catch (std::exception& e)
+    {
+        fmt::print(std::cerr, "{}\n", e.what());
+        return 1;
+    }
+    if (SDL_WasInit(SDL_INIT_VIDEO))
+    {
+        SDL_Quit();
+    }
+    return 0;
+}